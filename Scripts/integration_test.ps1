@@ -59,11 +59,13 @@
     the structured log).
 
 .PARAMETER Backend
-    "opengl" (default), "dx11", or "both". Toggles r.render_backend in the
-    [game_test]/[editor_test] sections of EngineVars.ini for the duration of the
-    run (restored on exit, even on failure). "both" runs the full requested
+    "opengl" (default), "dx11", "null", or "both". Toggles r.render_backend in
+    the [game_test]/[editor_test] sections of EngineVars.ini for the duration of
+    the run (restored on exit, even on failure). "both" runs the full requested
     pass set on opengl, then again on dx11. dx11 always forces
-    r_indirect_loop 1 (DX11 has no MultiDrawIndirect).
+    r_indirect_loop 1 (DX11 has no MultiDrawIndirect). "null" runs headless on
+    the logging null device; renderer/null_device_draw_calls only checks
+    anything there.
 
 .EXAMPLE
     Scripts/integration_test.ps1
@@ -96,6 +98,10 @@
 .EXAMPLE
     Scripts/integration_test.ps1 -Config Release -Promote
     Release build, regenerate screenshot goldens.
+
+.EXAMPLE
+    Scripts/integration_test.ps1 -Mode game -Backend null -Pattern "renderer/null_device*"
+    Draw-call regression checks on the null device.
 #>
 param(
     [string]$Config       = "Debug",
@@ -110,10 +116,10 @@ param(
     [switch]$TimingAssert,
     [switch]$ShowEngineLog,
     [switch]$Debugger,
-    # "opengl" (default), "dx11", or "both" (run the full pass set on opengl,
-    # then again on dx11). Toggled via r.render_backend in the [game_test] /
-    # [editor_test] sections of EngineVars.ini, restored on exit.
-    [ValidateSet("opengl", "dx11", "both")]
+    # "opengl" (default), "dx11", "null", or "both" (run the full pass set on
+    # opengl, then again on dx11). Toggled via r.render_backend in the
+    # [game_test] / [editor_test] sections of EngineVars.ini, restored on exit.
+    [ValidateSet("opengl", "dx11", "null", "both")]
     [string]$Backend = "opengl"
 )
 
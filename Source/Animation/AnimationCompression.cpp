@@ -0,0 +1,387 @@
+#include "AnimationCompression.h"
+#include "SkeletonData.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define IS_HIGH_BIT_SET(x) (x & (1u << 31u))
+#define UNSET_HIGH_BIT(x) (x & ~(1u << 31u))
+
+// smallest three components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+static const float QUAT_COMPONENT_RANGE = 0.70710678f;
+static const int QUAT_COMPONENT_MAX = 32767;
+static const int RANGE_COMPONENT_MAX = 65535;
+// a segment is never stretched over more frames than this, keeps the greedy reduction from going quadratic on
+// long nearly-linear tracks
+static const int MAX_SEGMENT_FRAMES = 256;
+
+static void pack_quat(glm::quat q, uint16_t out[3]) {
+	q = glm::normalize(q);
+	const float c[4] = {q.x, q.y, q.z, q.w};
+	int largest = 0;
+	for (int i = 1; i < 4; i++) {
+		if (std::abs(c[i]) > std::abs(c[largest]))
+			largest = i;
+	}
+	// q and -q are the same rotation, flip so the dropped component is positive
+	const float sign = (c[largest] < 0.f) ? -1.f : 1.f;
+	int j = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		const float n = (c[i] * sign / QUAT_COMPONENT_RANGE) * 0.5f + 0.5f;
+		const int u = (int)std::lround(n * QUAT_COMPONENT_MAX);
+		out[j++] = (uint16_t)std::clamp(u, 0, QUAT_COMPONENT_MAX);
+	}
+	out[0] |= uint16_t((largest & 1) << 15);
+	out[1] |= uint16_t((largest >> 1) << 15);
+}
+
+static glm::quat unpack_quat(const uint16_t* in) {
+	const int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+	float c[4];
+	float sum = 0.f;
+	int j = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		const float v = ((in[j++] & 0x7fff) * (2.f / QUAT_COMPONENT_MAX) - 1.f) * QUAT_COMPONENT_RANGE;
+		c[i] = v;
+		sum += v * v;
+	}
+	c[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+	glm::quat q;
+	q.x = c[0];
+	q.y = c[1];
+	q.z = c[2];
+	q.w = c[3];
+	return q;
+}
+
+static glm::quat nlerp_shortest(const glm::quat& a, glm::quat b, float t) {
+	if (glm::dot(a, b) < 0.f)
+		b = -b;
+	return glm::normalize(a * (1.f - t) + b * t);
+}
+
+// sin of half the angle between two rotations. computed from the chord |a-b| instead of 1-dot^2, which has no
+// precision left at the sub-millimeter errors we care about.
+static float rotation_half_angle_sin(glm::quat a, glm::quat b) {
+	a = glm::normalize(a);
+	b = glm::normalize(b);
+	if (glm::dot(a, b) < 0.f)
+		b = -b;
+	const glm::quat d = a - b;
+	const float chord_sq = glm::dot(d, d);
+	return std::min(std::sqrt(chord_sq * std::max(0.f, 1.f - chord_sq * 0.25f)), 1.f);
+}
+
+// distance a point shell_distance from the joint moves between the two rotations
+static float rotation_shell_error(const glm::quat& a, const glm::quat& b, float shell_distance) {
+	return 2.f * shell_distance * rotation_half_angle_sin(a, b);
+}
+
+static uint32_t append_data(std::vector<uint8_t>& data, const void* src, size_t size) {
+	while (data.size() % 4 != 0)
+		data.push_back(0);
+	const uint32_t ofs = (uint32_t)data.size();
+	data.resize(data.size() + size);
+	memcpy(data.data() + ofs, src, size);
+	return ofs;
+}
+
+// Keeps the first and last frame, then extends each segment while every frame it skips is reproduced by
+// interpolating the segment's end keys. segment_ok(first,last) checks the frames strictly between them.
+template <typename SegmentOk> static std::vector<uint16_t> reduce_keys(int num_frames, const SegmentOk& segment_ok) {
+	std::vector<uint16_t> keys;
+	keys.push_back(0);
+	int start = 0;
+	while (start < num_frames - 1) {
+		int end = start + 1;
+		while (end + 1 < num_frames && end + 1 - start <= MAX_SEGMENT_FRAMES && segment_ok(start, end + 1))
+			end++;
+		keys.push_back((uint16_t)end);
+		start = end;
+	}
+	return keys;
+}
+
+// layout: float min[N], float extent[N], uint16 values[num_keys*N], uint16 frames[num_keys] (sparse only)
+template <int N>
+static CompressedTrack compress_range_track(const std::vector<float>& frames, int num_frames, float metric_scale,
+											float tolerance, std::vector<uint8_t>& data) {
+	auto error = [&](const float* a, const float* b) -> float {
+		float sum = 0.f;
+		for (int c = 0; c < N; c++)
+			sum += (a[c] - b[c]) * (a[c] - b[c]);
+		return std::sqrt(sum) * metric_scale;
+	};
+
+	CompressedTrack track;
+	bool is_constant = true;
+	for (int f = 1; f < num_frames && is_constant; f++)
+		is_constant = error(&frames[f * N], &frames[0]) <= tolerance;
+	if (is_constant) {
+		track.offset = append_data(data, frames.data(), sizeof(float) * N);
+		return track;
+	}
+
+	float header[N * 2];
+	for (int c = 0; c < N; c++) {
+		float lo = frames[c], hi = frames[c];
+		for (int f = 1; f < num_frames; f++) {
+			lo = std::min(lo, frames[f * N + c]);
+			hi = std::max(hi, frames[f * N + c]);
+		}
+		header[c] = lo;
+		header[N + c] = hi - lo;
+	}
+	std::vector<uint16_t> quantized(num_frames * N);
+	std::vector<float> decoded(num_frames * N);
+	for (int f = 0; f < num_frames; f++) {
+		for (int c = 0; c < N; c++) {
+			const float extent = header[N + c];
+			const float n = (extent > 0.f) ? (frames[f * N + c] - header[c]) / extent : 0.f;
+			const int u = std::clamp((int)std::lround(n * RANGE_COMPONENT_MAX), 0, RANGE_COMPONENT_MAX);
+			quantized[f * N + c] = (uint16_t)u;
+			decoded[f * N + c] = header[c] + extent * (u * (1.f / RANGE_COMPONENT_MAX));
+		}
+	}
+
+	std::vector<uint16_t> keys = reduce_keys(num_frames, [&](int first, int last) {
+		for (int f = first + 1; f < last; f++) {
+			const float t = float(f - first) / float(last - first);
+			float v[N];
+			for (int c = 0; c < N; c++)
+				v[c] = decoded[first * N + c] + (decoded[last * N + c] - decoded[first * N + c]) * t;
+			if (error(v, &frames[f * N]) > tolerance)
+				return false;
+		}
+		return true;
+	});
+
+	track.num_keys = (uint16_t)keys.size();
+	track.flags = ((int)keys.size() == num_frames) ? CompressedAnimClip::TRACK_DENSE : 0;
+	track.offset = append_data(data, header, sizeof(header));
+	std::vector<uint16_t> values;
+	values.reserve(keys.size() * N);
+	for (uint16_t k : keys) {
+		for (int c = 0; c < N; c++)
+			values.push_back(quantized[k * N + c]);
+	}
+	data.insert(data.end(), (const uint8_t*)values.data(), (const uint8_t*)(values.data() + values.size()));
+	if (!(track.flags & CompressedAnimClip::TRACK_DENSE))
+		data.insert(data.end(), (const uint8_t*)keys.data(), (const uint8_t*)(keys.data() + keys.size()));
+	return track;
+}
+
+// layout: uint16 values[num_keys*3], uint16 frames[num_keys] (sparse only). constant tracks store a float quat.
+static CompressedTrack compress_rotation_track(const std::vector<glm::quat>& frames, int num_frames,
+											   float shell_distance, float tolerance, std::vector<uint8_t>& data) {
+	CompressedTrack track;
+	bool is_constant = true;
+	for (int f = 1; f < num_frames && is_constant; f++)
+		is_constant = rotation_shell_error(frames[f], frames[0], shell_distance) <= tolerance;
+	if (is_constant) {
+		const float q[4] = {frames[0].x, frames[0].y, frames[0].z, frames[0].w};
+		track.offset = append_data(data, q, sizeof(q));
+		return track;
+	}
+
+	std::vector<uint16_t> quantized(num_frames * 3);
+	std::vector<glm::quat> decoded(num_frames);
+	for (int f = 0; f < num_frames; f++) {
+		pack_quat(frames[f], &quantized[f * 3]);
+		decoded[f] = unpack_quat(&quantized[f * 3]);
+	}
+
+	std::vector<uint16_t> keys = reduce_keys(num_frames, [&](int first, int last) {
+		for (int f = first + 1; f < last; f++) {
+			const float t = float(f - first) / float(last - first);
+			const glm::quat q = nlerp_shortest(decoded[first], decoded[last], t);
+			if (rotation_shell_error(q, frames[f], shell_distance) > tolerance)
+				return false;
+		}
+		return true;
+	});
+
+	track.num_keys = (uint16_t)keys.size();
+	track.flags = ((int)keys.size() == num_frames) ? CompressedAnimClip::TRACK_DENSE : 0;
+	std::vector<uint16_t> values;
+	values.reserve(keys.size() * 3);
+	for (uint16_t k : keys) {
+		for (int c = 0; c < 3; c++)
+			values.push_back(quantized[k * 3 + c]);
+	}
+	track.offset = append_data(data, values.data(), values.size() * sizeof(uint16_t));
+	if (!(track.flags & CompressedAnimClip::TRACK_DENSE))
+		data.insert(data.end(), (const uint8_t*)keys.data(), (const uint8_t*)(keys.data() + keys.size()));
+	return track;
+}
+
+// reads the uncompressed pose_data directly, get_keyframe() touches keyframe+1 even when lerp is 0
+static ScalePositionRot read_raw_keyframe(const AnimationSeq& seq, int channel, int keyframe) {
+	const ChannelOffset& ofs = seq.channel_offsets[channel];
+	const float* base = seq.pose_data.data();
+	const int pos_frame = IS_HIGH_BIT_SET(ofs.pos) ? 0 : keyframe;
+	const int rot_frame = IS_HIGH_BIT_SET(ofs.rot) ? 0 : keyframe;
+	const int scale_frame = IS_HIGH_BIT_SET(ofs.scale) ? 0 : keyframe;
+	ScalePositionRot out;
+	out.pos = ((const glm::vec3*)(base + UNSET_HIGH_BIT(ofs.pos)))[pos_frame];
+	out.rot = ((const glm::quat*)(base + UNSET_HIGH_BIT(ofs.rot)))[rot_frame];
+	out.scale = ((const float*)(base + UNSET_HIGH_BIT(ofs.scale)))[scale_frame];
+	return out;
+}
+
+CompressedAnimClip compress_animation_clip(const AnimationSeq& seq, const AnimCompressionSettings& settings) {
+	CompressedAnimClip clip;
+	const int num_frames = seq.get_num_keyframes_inclusive();
+	if (num_frames < 1 || num_frames > 0xffff || seq.channel_offsets.empty())
+		return clip;
+
+	// pos + rot + scale error can add up, give each its own share of the budget
+	const float pos_tolerance = settings.max_error * 0.4f;
+	const float rot_tolerance = settings.max_error * 0.4f;
+	const float scale_tolerance = settings.max_error * 0.2f;
+
+	clip.num_keyframes = num_frames;
+	clip.channels.resize(seq.channel_offsets.size());
+	std::vector<float> pos(num_frames * 3);
+	std::vector<glm::quat> rot(num_frames);
+	std::vector<float> scale(num_frames);
+	for (int ch = 0; ch < (int)seq.channel_offsets.size(); ch++) {
+		for (int f = 0; f < num_frames; f++) {
+			ScalePositionRot k = read_raw_keyframe(seq, ch, f);
+			pos[f * 3 + 0] = k.pos.x;
+			pos[f * 3 + 1] = k.pos.y;
+			pos[f * 3 + 2] = k.pos.z;
+			rot[f] = k.rot;
+			scale[f] = k.scale;
+		}
+		CompressedChannel& out = clip.channels[ch];
+		out.pos = compress_range_track<3>(pos, num_frames, 1.f, pos_tolerance, clip.data);
+		out.rot = compress_rotation_track(rot, num_frames, settings.shell_distance, rot_tolerance, clip.data);
+		out.scale = compress_range_track<1>(scale, num_frames, settings.shell_distance, scale_tolerance, clip.data);
+	}
+	while (clip.data.size() % 4 != 0)
+		clip.data.push_back(0);
+	return clip;
+}
+
+struct KeySpan
+{
+	int k0 = 0;
+	int k1 = 0;
+	float t = 0.f;
+};
+static KeySpan find_key_span(const CompressedTrack& track, const uint16_t* frames, int keyframe, float lerp) {
+	KeySpan span;
+	const int last = track.num_keys - 1;
+	if (track.flags & CompressedAnimClip::TRACK_DENSE) {
+		span.k0 = std::clamp(keyframe, 0, last);
+		span.k1 = std::min(span.k0 + 1, last);
+		span.t = lerp;
+		return span;
+	}
+	// last key at or before keyframe. keys always include frame 0 and the final frame.
+	span.k0 = std::clamp(int(std::upper_bound(frames, frames + track.num_keys, keyframe) - frames) - 1, 0, last);
+	if (span.k0 == last) {
+		span.k1 = last;
+		return span;
+	}
+	span.k1 = span.k0 + 1;
+	const float f0 = frames[span.k0];
+	const float f1 = frames[span.k1];
+	span.t = std::min((float(keyframe) + lerp - f0) / (f1 - f0), 1.f);
+	return span;
+}
+
+template <int N> static void sample_range_track(const uint8_t* data, const CompressedTrack& track, int keyframe,
+												float lerp, float* out) {
+	const float* header = (const float*)(data + track.offset);
+	if (track.num_keys == 0) {
+		for (int c = 0; c < N; c++)
+			out[c] = header[c];
+		return;
+	}
+	const uint16_t* values = (const uint16_t*)(header + N * 2);
+	const uint16_t* frames = values + track.num_keys * N;
+	const KeySpan span = find_key_span(track, frames, keyframe, lerp);
+	const float scale = 1.f / RANGE_COMPONENT_MAX;
+	for (int c = 0; c < N; c++) {
+		const float v0 = values[span.k0 * N + c] * scale;
+		const float v1 = values[span.k1 * N + c] * scale;
+		out[c] = header[c] + header[N + c] * (v0 + (v1 - v0) * span.t);
+	}
+}
+
+static glm::quat sample_rotation_track(const uint8_t* data, const CompressedTrack& track, int keyframe, float lerp) {
+	if (track.num_keys == 0) {
+		const float* q = (const float*)(data + track.offset);
+		glm::quat out;
+		out.x = q[0];
+		out.y = q[1];
+		out.z = q[2];
+		out.w = q[3];
+		return out;
+	}
+	const uint16_t* values = (const uint16_t*)(data + track.offset);
+	const uint16_t* frames = values + track.num_keys * 3;
+	const KeySpan span = find_key_span(track, frames, keyframe, lerp);
+	const glm::quat q0 = unpack_quat(values + span.k0 * 3);
+	if (span.k0 == span.k1 || span.t <= 0.f)
+		return q0;
+	return nlerp_shortest(q0, unpack_quat(values + span.k1 * 3), span.t);
+}
+
+ScalePositionRot CompressedAnimClip::sample(int channel, int keyframe, float lerp) const {
+	const CompressedChannel& ch = channels[channel];
+	ScalePositionRot out;
+	sample_range_track<3>(data.data(), ch.pos, keyframe, lerp, &out.pos.x);
+	out.rot = sample_rotation_track(data.data(), ch.rot, keyframe, lerp);
+	sample_range_track<1>(data.data(), ch.scale, keyframe, lerp, &out.scale);
+	return out;
+}
+
+AnimCompressionReport measure_compressed_clip(const AnimationSeq& raw, const CompressedAnimClip& compressed,
+											  float shell_distance) {
+	AnimCompressionReport report;
+	report.raw_bytes = raw.channel_offsets.size() * sizeof(ChannelOffset) + raw.pose_data.size() * sizeof(float);
+	report.compressed_bytes = compressed.get_size_bytes();
+	report.ratio = (report.compressed_bytes > 0) ? float(report.raw_bytes) / float(report.compressed_bytes) : 0.f;
+	if (compressed.empty())
+		return report;
+
+	for (const CompressedChannel& ch : compressed.channels) {
+		for (const CompressedTrack* t : {&ch.pos, &ch.rot, &ch.scale})
+			report.kept_keys += (t->num_keys == 0) ? 1 : t->num_keys;
+	}
+	report.total_keys = (int)compressed.channels.size() * 3 * compressed.num_keyframes;
+
+	const glm::vec3 shell_points[] = {glm::vec3(0.f), glm::vec3(shell_distance, 0, 0), glm::vec3(0, shell_distance, 0),
+									  glm::vec3(0, 0, shell_distance)};
+	for (int ch = 0; ch < (int)compressed.channels.size(); ch++) {
+		for (int f = 0; f < compressed.num_keyframes; f++) {
+			const ScalePositionRot a = read_raw_keyframe(raw, ch, f);
+			const ScalePositionRot b = compressed.sample(ch, f, 0.f);
+
+			report.max_pos_error = std::max(report.max_pos_error, glm::length(a.pos - b.pos));
+			const float rot_error = glm::degrees(2.f * std::asin(rotation_half_angle_sin(a.rot, b.rot)));
+			report.max_rot_error = std::max(report.max_rot_error, rot_error);
+			report.max_scale_error = std::max(report.max_scale_error, std::abs(a.scale - b.scale));
+
+			float bone_error = 0.f;
+			for (const glm::vec3& p : shell_points) {
+				const glm::vec3 pa = a.pos + glm::normalize(a.rot) * (p * a.scale);
+				const glm::vec3 pb = b.pos + b.rot * (p * b.scale);
+				bone_error = std::max(bone_error, glm::length(pa - pb));
+			}
+			if (bone_error > report.max_error) {
+				report.max_error = bone_error;
+				report.worst_channel = ch;
+				report.worst_keyframe = f;
+			}
+		}
+	}
+	return report;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class AnimationSeq;
+struct ScalePositionRot;
+
+// Compressed storage for AnimationSeq pose data.
+// Every channel has a pos/rot/scale track. A track is either constant (one full precision value) or a list of
+// keys: rotations are stored "smallest three" (3x15 bits + 2 bit index of the dropped component), translations and
+// scales are range reduced to 16 bits per component against the track's min/extent. Keys that can be reproduced by
+// interpolating their neighbours within the error bound are dropped, sparse tracks keep the frame index of each key.
+struct CompressedTrack
+{
+	uint32_t offset = 0;   // byte offset into CompressedAnimClip::data
+	uint16_t num_keys = 0; // 0 = constant track
+	uint16_t flags = 0;	   // TRACK_DENSE: one key per frame, no frame index table
+};
+struct CompressedChannel
+{
+	CompressedTrack pos;
+	CompressedTrack rot;
+	CompressedTrack scale;
+};
+
+class CompressedAnimClip
+{
+public:
+	static const uint16_t TRACK_DENSE = 1;
+
+	std::vector<CompressedChannel> channels;
+	std::vector<uint8_t> data;
+	int num_keyframes = 0; // inclusive, same as AnimationSeq::get_num_keyframes_inclusive()
+
+	bool empty() const { return channels.empty(); }
+	size_t get_size_bytes() const { return channels.size() * sizeof(CompressedChannel) + data.size(); }
+	// same contract as AnimationSeq::get_keyframe: blend keyframe -> keyframe+1 by lerp
+	ScalePositionRot sample(int channel, int keyframe, float lerp) const;
+};
+
+struct AnimCompressionSettings
+{
+	// max error in meters of a point shell_distance away from the joint, in the bone's local space.
+	// split across the pos/rot/scale tracks so their sum stays under it.
+	float max_error = 0.0005f;
+	float shell_distance = 0.1f;
+};
+
+// returns an empty clip if seq can't be compressed (too many frames for 16 bit key indices)
+CompressedAnimClip compress_animation_clip(const AnimationSeq& seq, const AnimCompressionSettings& settings);
+
+struct AnimCompressionReport
+{
+	size_t raw_bytes = 0;
+	size_t compressed_bytes = 0;
+	float ratio = 0.f;			// raw / compressed
+	float max_error = 0.f;		// bone space error at shell_distance, meters
+	int worst_channel = -1;
+	int worst_keyframe = -1;
+	float max_pos_error = 0.f;	// meters
+	float max_rot_error = 0.f;	// degrees
+	float max_scale_error = 0.f;
+	int kept_keys = 0;
+	int total_keys = 0;
+};
+// Compares every keyframe of raw (uncompressed) against compressed.
+AnimCompressionReport measure_compressed_clip(const AnimationSeq& raw, const CompressedAnimClip& compressed,
+											  float shell_distance);
@@ -0,0 +1,71 @@
+#include "Animation/AnimationLod.h"
+#include "glm/gtc/quaternion.hpp"
+#include <algorithm>
+#include <cmath>
+
+// left/right/bottom/top planes of viewproj (Gribb/Hartmann), the reversed infinite projection has no useful far
+// plane and the near plane is covered by the behind-the-camera check
+static bool sphere_in_view(const glm::mat4& viewproj, glm::vec3 center, float radius) {
+	for (int i = 0; i < 4; i++) {
+		const int axis = i / 2;
+		const float sign = (i % 2 == 0) ? 1.f : -1.f;
+		glm::vec4 plane;
+		for (int c = 0; c < 4; c++)
+			plane[c] = viewproj[c][3] + sign * viewproj[c][axis];
+		const float len = glm::length(glm::vec3(plane));
+		if (len <= 0.f)
+			continue;
+		if ((glm::dot(glm::vec3(plane), center) + plane.w) / len < -radius)
+			return false;
+	}
+	return true;
+}
+
+AnimUpdateLod compute_anim_update_lod(const AnimUpdateLodSettings& settings, const AnimUpdateLodView& view,
+									  glm::vec3 center, float radius) {
+	AnimUpdateLod lod;
+	const float dist = glm::length(center - view.origin);
+	if (dist <= radius)
+		return lod; // camera inside the bounds
+
+	if (!sphere_in_view(view.viewproj, center, radius + settings.offscreen_margin)) {
+		lod.interval = std::max(settings.offscreen_interval, 1);
+		lod.offscreen = true;
+		return lod;
+	}
+
+	const float screen_size = radius / (dist * std::max(view.tan_half_fov, 0.0001f));
+	if (dist >= settings.quarter_rate_distance || screen_size <= settings.quarter_rate_screen_size)
+		lod.interval = 4;
+	else if (dist >= settings.half_rate_distance || screen_size <= settings.half_rate_screen_size)
+		lod.interval = 2;
+	return lod;
+}
+
+void interpolate_bone_matrices(const glm::mat4* a, const glm::mat4* b, float t, int count, glm::mat4* out) {
+	for (int i = 0; i < count; i++) {
+		const glm::mat4& ma = a[i];
+		const glm::mat4& mb = b[i];
+		glm::vec3 scale_a, scale_b;
+		glm::mat3 rot_a, rot_b;
+		for (int c = 0; c < 3; c++) {
+			scale_a[c] = glm::length(glm::vec3(ma[c]));
+			scale_b[c] = glm::length(glm::vec3(mb[c]));
+			rot_a[c] = glm::vec3(ma[c]) / std::max(scale_a[c], 1e-8f);
+			rot_b[c] = glm::vec3(mb[c]) / std::max(scale_b[c], 1e-8f);
+		}
+		const glm::quat qa = glm::quat_cast(rot_a);
+		glm::quat qb = glm::quat_cast(rot_b);
+		if (glm::dot(qa, qb) < 0.f)
+			qb = -qb;
+		const glm::quat q = glm::normalize(qa * (1.f - t) + qb * t);
+		const glm::vec3 scale = glm::mix(scale_a, scale_b, t);
+
+		const glm::mat3 rot = glm::mat3_cast(q);
+		glm::mat4& o = out[i];
+		o[0] = glm::vec4(rot[0] * scale.x, 0.f);
+		o[1] = glm::vec4(rot[1] * scale.y, 0.f);
+		o[2] = glm::vec4(rot[2] * scale.z, 0.f);
+		o[3] = glm::mix(ma[3], mb[3], t);
+	}
+}
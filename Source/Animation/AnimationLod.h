@@ -0,0 +1,38 @@
+#pragma once
+#include "glm/glm.hpp"
+
+// Update rate LOD for animators. GameAnimationMgr picks an interval per AnimatorObject each frame: far or small on
+// screen animators evaluate their graph every 2nd/4th frame with the accumulated dt and interpolate bone matrices in
+// between, animators outside the view evaluate every offscreen_interval frames just to keep graph time, events and
+// slot callbacks moving, and hold their last matrices.
+struct AnimUpdateLodSettings
+{
+	float half_rate_distance = 20.f;
+	float quarter_rate_distance = 40.f;
+	// fraction of the screen height the bounding sphere covers
+	float half_rate_screen_size = 0.15f;
+	float quarter_rate_screen_size = 0.06f;
+	int offscreen_interval = 8;
+	// grows the sphere for the view test, so characters just outside the edge (and their shadows) keep animating
+	float offscreen_margin = 1.f;
+};
+
+struct AnimUpdateLodView
+{
+	glm::vec3 origin{};
+	glm::mat4 viewproj{};
+	float tan_half_fov = 1.f;
+};
+
+struct AnimUpdateLod
+{
+	int interval = 1; // evaluate every interval frames
+	bool offscreen = false;
+};
+
+AnimUpdateLod compute_anim_update_lod(const AnimUpdateLodSettings& settings, const AnimUpdateLodView& view,
+									  glm::vec3 center, float radius);
+
+// out = a blended towards b by t. Matrices are split into rotation, translation and per axis scale and blended
+// separately, a plain matrix lerp would shrink joints that rotate a lot between the two poses.
+void interpolate_bone_matrices(const glm::mat4* a, const glm::mat4* b, float t, int count, glm::mat4* out);
@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 
 class Model;
 using std::unique_ptr;
@@ -87,12 +90,84 @@ struct Animation_Index
 	int16_t skel = -1;
 };
 
+// Local space bone transforms, sized to the skeleton's bone count. Pose only points at the arrays, storage comes
+// from one of the types below or from a PoseArena (Animation/PoseArena.h) during graph evaluation.
+// Copying a Pose is a bone data copy, use copy_from().
 class Pose
 {
 public:
-	const static int MAX_BONES = 256;
+	static constexpr int MAX_BONES = 256;
+	static constexpr int BYTES_PER_BONE = sizeof(glm::quat) + sizeof(glm::vec3) + sizeof(float);
 
-	glm::quat q[MAX_BONES];
-	glm::vec3 pos[MAX_BONES];
-	float scale[MAX_BONES];
+	Pose() = default;
+	Pose(const Pose& other) = delete;
+	Pose& operator=(const Pose& other) = delete;
+
+	int get_num_bones() const { return num_bones; }
+	// other must have the same bone count
+	void copy_from(const Pose& other) {
+		assert(other.num_bones == num_bones);
+		memcpy(q, other.q, sizeof(glm::quat) * num_bones);
+		memcpy(pos, other.pos, sizeof(glm::vec3) * num_bones);
+		memcpy(scale, other.scale, sizeof(float) * num_bones);
+	}
+	// points q/pos/scale into memory, which must hold BYTES_PER_BONE*bones bytes (16 byte aligned)
+	void set_storage(void* memory, int bones) {
+		assert(bones >= 0 && bones <= MAX_BONES);
+		uint8_t* ptr = (uint8_t*)memory;
+		q = (glm::quat*)ptr;
+		pos = (glm::vec3*)(ptr + sizeof(glm::quat) * bones);
+		scale = (float*)(ptr + (sizeof(glm::quat) + sizeof(glm::vec3)) * bones);
+		num_bones = bones;
+	}
+
+	glm::quat* q = nullptr;
+	glm::vec3* pos = nullptr;
+	float* scale = nullptr;
+
+protected:
+	int num_bones = 0;
+};
+
+// Heap owned pose for poses that outlive a graph evaluation (cached poses, statemachine blend outs).
+class PoseBuffer : public Pose
+{
+public:
+	PoseBuffer() = default;
+	explicit PoseBuffer(int bones) { resize(bones); }
+	PoseBuffer(const PoseBuffer& other) : Pose() {
+		resize(other.num_bones);
+		copy_from(other);
+	}
+	PoseBuffer& operator=(const PoseBuffer& other) {
+		resize(other.num_bones);
+		copy_from(other);
+		return *this;
+	}
+	// contents are undefined after a size change
+	void resize(int bones) {
+		if (bones == num_bones)
+			return;
+		storage.reset(bones > 0 ? new glm::vec4[bones * BYTES_PER_BONE / sizeof(glm::vec4)] : nullptr);
+		set_storage(storage.get(), bones);
+	}
+
+private:
+	unique_ptr<glm::vec4[]> storage;
+};
+static_assert(Pose::BYTES_PER_BONE % sizeof(glm::vec4) == 0, "PoseBuffer allocates in vec4 units");
+
+// MAX_BONES pose with inline storage for tools and tests that want a pose on the stack.
+class InlinePose : public Pose
+{
+public:
+	InlinePose() { set_storage(storage, MAX_BONES); }
+	InlinePose(const InlinePose& other) : InlinePose() { copy_from(other); }
+	InlinePose& operator=(const InlinePose& other) {
+		copy_from(other);
+		return *this;
+	}
+
+private:
+	alignas(16) uint8_t storage[MAX_BONES * BYTES_PER_BONE];
 };
@@ -2,6 +2,11 @@
 
 #include "Debug.h"
 #include "Animation/SkeletonData.h"
+#include "Animation/PoseSimd.h"
+#include "Framework/Config.h"
+
+ConfigVar anim_simd_pose("anim.simd_pose", "1", CVAR_BOOL | CVAR_DEV,
+						 "use the SIMD pose blend/mesh space kernels, 0 = scalar reference versions");
 
 static glm::mat4 debug_animation_transform = glm::mat4(1);
 
@@ -31,31 +36,25 @@ void Animation_Debug::push_sphere(const glm::vec3& p, float radius) {
 
 // source = reference pose - source
 void util_subtract(int bonecount, const Pose& reference, Pose& source) {
-	for (int i = 0; i < bonecount; i++) {
-		source.pos[i] = source.pos[i] - reference.pos[i];
-		source.scale[i] = source.scale[i] - reference.scale[i];
-
-		source.q[i] = quat_delta(reference.q[i], source.q[i]);
-	}
+	if (anim_simd_pose.get_bool())
+		pose_subtract_simd(bonecount, reference, source);
+	else
+		pose_subtract_reference(bonecount, reference, source);
 }
 
 // b = lerp(a,b,f)
 void util_blend(int bonecount, const Pose& a, Pose& b, float factor) {
-	for (int i = 0; i < bonecount; i++) {
-		b.q[i] = glm::slerp(b.q[i], a.q[i], factor);
-		b.q[i] = glm::normalize(b.q[i]);
-		b.pos[i] = glm::mix(b.pos[i], a.pos[i], factor);
-		b.scale[i] = glm::mix(b.scale[i], a.scale[i], factor);
-	}
+	if (anim_simd_pose.get_bool())
+		pose_blend_simd(bonecount, a, b, factor);
+	else
+		pose_blend_reference(bonecount, a, b, factor);
 }
 void util_blend_with_mask(int bonecount, const Pose& a, Pose& b, float factor, const std::vector<float>& mask) {
 	ASSERT(mask.size() >= bonecount);
-	for (int i = 0; i < bonecount; i++) {
-		b.q[i] = glm::slerp(a.q[i], b.q[i], factor * mask[i]);
-		b.q[i] = glm::normalize(b.q[i]);
-		b.pos[i] = glm::mix(a.pos[i], b.pos[i], factor * mask[i]);
-		b.scale[i] = glm::mix(a.scale[i], b.scale[i], factor * mask[i]);
-	}
+	if (anim_simd_pose.get_bool())
+		pose_blend_masked_simd(bonecount, a, b, factor, mask.data());
+	else
+		pose_blend_masked_reference(bonecount, a, b, factor, mask.data());
 }
 
 static glm::quat quat_blend_additive(const glm::quat& a, const glm::quat& b, float t) {
@@ -109,21 +108,23 @@ void util_meshspace_to_localspace(const glm::mat4* mesh, const MSkeleton* mod, P
 	}
 }
 
-void util_localspace_to_meshspace_ptr_2(const Pose& local, glm::mat4* out_bone_matricies, const MSkeleton* skel) {
-	for (int i = 0; i < skel->get_num_bones(); i++) {
-		glm::mat4x4 matrix = glm::mat4_cast(local.q[i]);
-		matrix[3] = glm::vec4(local.pos[i], 1.0);
-		matrix = glm::scale(matrix, glm::vec3(local.scale[i]));
-
-		if (skel->get_bone_parent(i) == -1) {
-			out_bone_matricies[i] = matrix;
-		} else {
-			assert(skel->get_bone_parent(i) < skel->get_num_bones());
-			out_bone_matricies[i] = out_bone_matricies[skel->get_bone_parent(i)] * matrix;
-		}
+static void localspace_to_meshspace_kernel(const Pose& local, glm::mat4* out_bone_matricies, const MSkeleton* skel) {
+	const int count = skel->get_num_bones();
+	ASSERT(count <= Pose::MAX_BONES);
+	const auto& bones = skel->get_all_bones();
+	int16_t parents[Pose::MAX_BONES];
+	for (int i = 0; i < count; i++) {
+		assert(bones[i].parent < i);
+		parents[i] = bones[i].parent;
 	}
-	// for (int i = 0; i < model->bones.size(); i++)
-	//	out_bone_matricies[i] =  out_bone_matricies[i];
+	if (anim_simd_pose.get_bool())
+		pose_local_to_mesh_simd(local, parents, count, out_bone_matricies);
+	else
+		pose_local_to_mesh_reference(local, parents, count, out_bone_matricies);
+}
+
+void util_localspace_to_meshspace_ptr_2(const Pose& local, glm::mat4* out_bone_matricies, const MSkeleton* skel) {
+	localspace_to_meshspace_kernel(local, out_bone_matricies, skel);
 }
 
 void util_global_blend(const MSkeleton* skel, const Pose* a, Pose* b, float factor, const std::vector<float>& mask) {
@@ -157,15 +158,10 @@ void util_global_blend(const MSkeleton* skel, const Pose* a, Pose* b, float fact
 
 // base = lerp(base,base+additive,f)
 void util_add(int bonecount, const Pose& additive, Pose& base, float fac) {
-	for (int i = 0; i < bonecount; i++) {
-		base.pos[i] = glm::mix(base.pos[i], base.pos[i] + additive.pos[i], fac);
-		base.scale[i] = glm::mix(base.scale[i], base.scale[i] + additive.scale[i], fac);
-
-		glm::quat target = additive.q[i] * base.q[i];
-
-		base.q[i] = glm::slerp(base.q[i], target, fac);
-		// base.q[i] = glm::normalize(base.q[i]);
-	}
+	if (anim_simd_pose.get_bool())
+		pose_add_simd(bonecount, additive, base, fac);
+	else
+		pose_add_reference(bonecount, additive, base, fac);
 }
 
 // Shortest-arc rotation that takes unit vector `from` onto unit vector `to`.
@@ -331,7 +327,9 @@ glm::quat* AnimationSeq::get_quat_write_ptr(int channel, int keyframe) {
 }
 
 ScalePositionRot AnimationSeq::get_keyframe(int bone, int keyframe, float lerpamt) const {
-	// TODO: insert return statement here
+	if (is_compressed())
+		return compressed.sample(bone, keyframe, lerpamt);
+
 	ChannelOffset offset = channel_offsets[bone];
 
 	ScalePositionRot output;
@@ -495,20 +493,8 @@ static const int ROOT_BONE = -1;
 // ConfigVar skip_scale_in_animation("skip_scale_in_animation", "0", CVAR_BOOL, "");
 void util_localspace_to_meshspace(const Pose& local, std::vector<glm::mat4x4>& out_bone_matricies,
 								  const MSkeleton* model) {
-	// const bool skip_scale = skip_scale_in_animation.get_bool();
-	for (int i = 0; i < model->get_num_bones(); i++) {
-		glm::mat4x4 matrix = glm::mat4_cast(local.q[i]);
-		matrix[3] = glm::vec4(local.pos[i], 1.0);
-		// if(!skip_scale)
-		matrix = glm::scale(matrix, glm::vec3(local.scale[i]));
-
-		if (model->get_bone_parent(i) == ROOT_BONE) {
-			out_bone_matricies[i] = matrix;
-		} else {
-			assert(model->get_bone_parent(i) < model->get_num_bones());
-			out_bone_matricies[i] = out_bone_matricies[model->get_bone_parent(i)] * matrix;
-		}
-	}
+	ASSERT(out_bone_matricies.size() >= model->get_num_bones());
+	localspace_to_meshspace_kernel(local, out_bone_matricies.data(), model);
 }
 
 void util_localspace_to_meshspace_with_physics(const Pose& local, std::vector<glm::mat4x4>& out_bone_matricies,
@@ -530,18 +516,5 @@ void util_localspace_to_meshspace_with_physics(const Pose& local, std::vector<gl
 	}
 }
 void util_localspace_to_meshspace_ptr(const Pose& local, glm::mat4* out_bone_matricies, const MSkeleton* model) {
-	for (int i = 0; i < model->get_num_bones(); i++) {
-		glm::mat4x4 matrix = glm::mat4_cast(local.q[i]);
-		matrix[3] = glm::vec4(local.pos[i], 1.0);
-		matrix = glm::scale(matrix, glm::vec3(local.scale[i]));
-
-		if (model->get_bone_parent(i) == ROOT_BONE) {
-			out_bone_matricies[i] = matrix;
-		} else {
-			assert(model->get_bone_parent(i) < model->get_num_bones());
-			out_bone_matricies[i] = out_bone_matricies[model->get_bone_parent(i)] * matrix;
-		}
-	}
-	// for (int i = 0; i < model->bones.size(); i++)
-	//	out_bone_matricies[i] =  out_bone_matricies[i];
+	localspace_to_meshspace_kernel(local, out_bone_matricies, model);
 }
@@ -0,0 +1,71 @@
+#include "Animation/PoseArena.h"
+#include "Framework/Profiler.h"
+#include <new>
+
+// a graph rarely nests more than ~20 contexts deep, 512 KB covers that at MAX_BONES
+static const int64_t THREAD_POSE_ARENA_SIZE = 512 * 1024;
+
+PoseArena::PoseArena(const char* name, int64_t size) {
+	arena.init(name, size);
+	base = arena.get_bottom_marker();
+}
+
+PoseArena& PoseArena::get_thread_arena() {
+	static thread_local PoseArena arena("anim_pose_arena", THREAD_POSE_ARENA_SIZE);
+	return arena;
+}
+
+void PoseArena::report_stats() {
+	PROF_COUNTER_ADD("anim pose pool allocs", prof::CounterUnit::Count, num_allocations);
+	PROF_COUNTER_MAX("anim pose pool high water", prof::CounterUnit::Bytes, high_water);
+	num_allocations = 0;
+	high_water = get_bytes_in_use();
+}
+
+void PoseArena::note_allocation() {
+	num_allocations++;
+	const int64_t used = get_bytes_in_use();
+	if (used > high_water)
+		high_water = used;
+}
+
+ScopedPose::ScopedPose(PoseArena& arena, int num_bones) : parent(arena) {
+	marker = arena.arena.get_bottom_marker();
+	pose.set_storage(arena.arena.alloc_bottom((int64_t)num_bones * Pose::BYTES_PER_BONE), num_bones);
+	arena.note_allocation();
+}
+
+ScopedPose::ScopedPose(PoseArena& arena, Pose& borrowed) : parent(arena), owned(false) {
+	pose.set_storage(borrowed.q, borrowed.get_num_bones());
+}
+
+ScopedPose::~ScopedPose() {
+	if (!owned)
+		return;
+	// anything allocated after this pose must be gone already, or freeing to our marker would pull the memory out
+	// from under it
+	ASSERT(parent.arena.get_bottom_marker() == (uintptr_t)pose.q + (uintptr_t)pose.get_num_bones() * Pose::BYTES_PER_BONE);
+	parent.arena.free_bottom_to_marker(marker);
+}
+
+ScopedPoseArray::ScopedPoseArray(PoseArena& arena, int num_bones, int count) : parent(arena), count(count) {
+	marker = arena.arena.get_bottom_marker();
+	if (count <= 0)
+		return;
+	// Pose views first, then the bone data. alloc_bottom returns 16 byte aligned memory
+	const int64_t views_bytes = ((int64_t)sizeof(Pose) * count + 15) & ~int64_t(15);
+	const int64_t pose_bytes = (int64_t)num_bones * Pose::BYTES_PER_BONE;
+	uint8_t* mem = (uint8_t*)arena.arena.alloc_bottom(views_bytes + pose_bytes * count);
+	poses = (Pose*)mem;
+	for (int i = 0; i < count; i++) {
+		new (&poses[i]) Pose();
+		poses[i].set_storage(mem + views_bytes + pose_bytes * i, num_bones);
+	}
+	end = (uintptr_t)mem + views_bytes + pose_bytes * count;
+	arena.note_allocation();
+}
+
+ScopedPoseArray::~ScopedPoseArray() {
+	ASSERT(count <= 0 || parent.arena.get_bottom_marker() == end);
+	parent.arena.free_bottom_to_marker(marker);
+}
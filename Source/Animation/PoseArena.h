@@ -0,0 +1,82 @@
+#pragma once
+#include "Animation/AnimationTypes.h"
+#include "Framework/MemArena.h"
+
+// Scratch poses for anim graph evaluation. Every agGetPoseCtx takes its pose from here at the skeleton's bone count
+// (Pose::BYTES_PER_BONE a bone, so a 60 bone rig is ~2 KB instead of a MAX_BONES sized 8 KB), which keeps the poses
+// one evaluation touches in L2.
+// Allocations are a stack on top of a Memory_Arena: ScopedPose hands its memory back when it goes out of scope, which
+// matches contexts being copied on the way down the graph and destroyed on the way back up.
+// Not thread safe, use one per thread (get_thread_arena).
+class PoseArena
+{
+public:
+	PoseArena(const char* name, int64_t size);
+	PoseArena(const PoseArena& other) = delete;
+	PoseArena& operator=(const PoseArena& other) = delete;
+
+	// the calling thread's arena
+	static PoseArena& get_thread_arena();
+
+	int64_t get_bytes_in_use() const { return (int64_t)(arena.get_bottom_marker() - base); }
+	int64_t get_high_water_bytes() const { return high_water; }
+	int get_num_allocations() const { return num_allocations; }
+	// adds the numbers since the last call to the "anim pose pool" profiler counters and resets them
+	void report_stats();
+
+private:
+	friend class ScopedPose;
+	friend class ScopedPoseArray;
+	void note_allocation();
+
+	Memory_Arena arena;
+	uintptr_t base = 0;
+	int64_t high_water = 0;
+	int num_allocations = 0;
+};
+
+class ScopedPose
+{
+public:
+	ScopedPose(PoseArena& arena, int num_bones);
+	// views a pose the caller owns (laid out by Pose::set_storage), nothing is allocated or freed. Lets the graph
+	// program hand its registers to nodes as an agGetPoseCtx.
+	ScopedPose(PoseArena& arena, Pose& borrowed);
+	~ScopedPose();
+	ScopedPose(const ScopedPose& other) = delete;
+	ScopedPose& operator=(const ScopedPose& other) = delete;
+
+	Pose* get() { return &pose; }
+	const Pose* get() const { return &pose; }
+	Pose& operator*() { return pose; }
+	const Pose& operator*() const { return pose; }
+	Pose* operator->() { return &pose; }
+	const Pose* operator->() const { return &pose; }
+	PoseArena& get_parent() const { return parent; }
+
+private:
+	PoseArena& parent;
+	uintptr_t marker = 0;
+	bool owned = true;
+	Pose pose;
+};
+
+// count poses from one allocation, the Pose views live in the arena too. Same LIFO rule as ScopedPose.
+class ScopedPoseArray
+{
+public:
+	ScopedPoseArray(PoseArena& arena, int num_bones, int count);
+	~ScopedPoseArray();
+	ScopedPoseArray(const ScopedPoseArray& other) = delete;
+	ScopedPoseArray& operator=(const ScopedPoseArray& other) = delete;
+
+	Pose& operator[](int i) { return poses[i]; }
+	int size() const { return count; }
+
+private:
+	PoseArena& parent;
+	uintptr_t marker = 0;
+	uintptr_t end = 0;
+	Pose* poses = nullptr;
+	int count = 0;
+};
@@ -0,0 +1,380 @@
+#include "PoseSimd.h"
+#include "AnimationTypes.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include <immintrin.h>
+#include <cstddef>
+
+static_assert(offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 12, "pose kernels expect xyzw quaternions");
+static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::mat4) == 64, "pose kernels expect tightly packed glm types");
+
+// vfloat is one register of LANES floats. AVX builds (/arch:AVX) go 8 bones wide, everything else uses SSE.
+// "groups" are the 4 float rows that get transposed: a quaternion, or a matrix column. With AVX, group k of a
+// block is bone k in the low half and bone k+4 in the high half.
+#ifdef __AVX__
+typedef __m256 vfloat;
+static const int LANES = 8;
+static inline vfloat v_set1(float f) { return _mm256_set1_ps(f); }
+static inline vfloat v_load(const float* p) { return _mm256_loadu_ps(p); }
+static inline void v_store(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat v_add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat v_sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat v_mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat v_div(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline vfloat v_sqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+static inline vfloat v_xor(vfloat a, vfloat b) { return _mm256_xor_ps(a, b); }
+static inline vfloat v_and(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+static inline vfloat v_cmplt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vfloat v_load_group(const float* base, int stride, int k) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(base + stride * k)),
+								_mm_loadu_ps(base + stride * (k + 4)), 1);
+}
+static inline void v_store_group(float* base, int stride, int k, vfloat v) {
+	_mm_storeu_ps(base + stride * k, _mm256_castps256_ps128(v));
+	_mm_storeu_ps(base + stride * (k + 4), _mm256_extractf128_ps(v, 1));
+}
+static inline void transpose4(vfloat& r0, vfloat& r1, vfloat& r2, vfloat& r3) {
+	const vfloat t0 = _mm256_unpacklo_ps(r0, r1);
+	const vfloat t1 = _mm256_unpackhi_ps(r0, r1);
+	const vfloat t2 = _mm256_unpacklo_ps(r2, r3);
+	const vfloat t3 = _mm256_unpackhi_ps(r2, r3);
+	r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+#else
+typedef __m128 vfloat;
+static const int LANES = 4;
+static inline vfloat v_set1(float f) { return _mm_set1_ps(f); }
+static inline vfloat v_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void v_store(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+static inline vfloat v_add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat v_sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat v_mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat v_div(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+static inline vfloat v_sqrt(vfloat a) { return _mm_sqrt_ps(a); }
+static inline vfloat v_xor(vfloat a, vfloat b) { return _mm_xor_ps(a, b); }
+static inline vfloat v_and(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+static inline vfloat v_cmplt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+static inline vfloat v_load_group(const float* base, int stride, int k) { return _mm_loadu_ps(base + stride * k); }
+static inline void v_store_group(float* base, int stride, int k, vfloat v) { _mm_storeu_ps(base + stride * k, v); }
+static inline void transpose4(vfloat& r0, vfloat& r1, vfloat& r2, vfloat& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+#endif
+
+static inline vfloat v_lerp(vfloat a, vfloat b, vfloat t) { return v_add(a, v_mul(v_sub(b, a), t)); }
+
+struct QuatLanes
+{
+	vfloat x, y, z, w;
+};
+
+static inline QuatLanes load_quats(const glm::quat* q) {
+	QuatLanes r;
+	const float* base = &q->x;
+	r.x = v_load_group(base, 4, 0);
+	r.y = v_load_group(base, 4, 1);
+	r.z = v_load_group(base, 4, 2);
+	r.w = v_load_group(base, 4, 3);
+	transpose4(r.x, r.y, r.z, r.w);
+	return r;
+}
+static inline void store_quats(glm::quat* q, QuatLanes r) {
+	transpose4(r.x, r.y, r.z, r.w);
+	float* base = &q->x;
+	v_store_group(base, 4, 0, r.x);
+	v_store_group(base, 4, 1, r.y);
+	v_store_group(base, 4, 2, r.z);
+	v_store_group(base, 4, 3, r.w);
+}
+
+struct Vec3Lanes
+{
+	vfloat x, y, z;
+};
+// positions are 12 byte strided, not worth the shuffles: go through the stack
+static inline Vec3Lanes load_vec3s(const glm::vec3* v) {
+	alignas(32) float t[3][LANES];
+	for (int k = 0; k < LANES; k++) {
+		t[0][k] = v[k].x;
+		t[1][k] = v[k].y;
+		t[2][k] = v[k].z;
+	}
+	return {v_load(t[0]), v_load(t[1]), v_load(t[2])};
+}
+static inline void store_vec3s(glm::vec3* v, const Vec3Lanes& l) {
+	alignas(32) float t[3][LANES];
+	v_store(t[0], l.x);
+	v_store(t[1], l.y);
+	v_store(t[2], l.z);
+	for (int k = 0; k < LANES; k++)
+		v[k] = glm::vec3(t[0][k], t[1][k], t[2][k]);
+}
+
+static inline vfloat dot4(const QuatLanes& a, const QuatLanes& b) {
+	return v_add(v_add(v_mul(a.x, b.x), v_mul(a.y, b.y)), v_add(v_mul(a.z, b.z), v_mul(a.w, b.w)));
+}
+
+static inline QuatLanes normalize4(QuatLanes q) {
+	const vfloat inv_len = v_div(v_set1(1.f), v_sqrt(dot4(q, q)));
+	q.x = v_mul(q.x, inv_len);
+	q.y = v_mul(q.y, inv_len);
+	q.z = v_mul(q.z, inv_len);
+	q.w = v_mul(q.w, inv_len);
+	return q;
+}
+
+static inline QuatLanes nlerp4(const QuatLanes& a, QuatLanes b, vfloat t) {
+	// b and -b are the same rotation, take the one on a's side
+	const vfloat sign = v_and(v_cmplt(dot4(a, b), v_set1(0.f)), v_set1(-0.f));
+	b.x = v_xor(b.x, sign);
+	b.y = v_xor(b.y, sign);
+	b.z = v_xor(b.z, sign);
+	b.w = v_xor(b.w, sign);
+	QuatLanes r;
+	r.x = v_lerp(a.x, b.x, t);
+	r.y = v_lerp(a.y, b.y, t);
+	r.z = v_lerp(a.z, b.z, t);
+	r.w = v_lerp(a.w, b.w, t);
+	return normalize4(r);
+}
+
+// p * q, same convention as glm
+static inline QuatLanes mul4(const QuatLanes& p, const QuatLanes& q) {
+	QuatLanes r;
+	r.w = v_sub(v_sub(v_mul(p.w, q.w), v_mul(p.x, q.x)), v_add(v_mul(p.y, q.y), v_mul(p.z, q.z)));
+	r.x = v_add(v_add(v_mul(p.w, q.x), v_mul(p.x, q.w)), v_sub(v_mul(p.y, q.z), v_mul(p.z, q.y)));
+	r.y = v_add(v_add(v_mul(p.w, q.y), v_mul(p.y, q.w)), v_sub(v_mul(p.z, q.x), v_mul(p.x, q.z)));
+	r.z = v_add(v_add(v_mul(p.w, q.z), v_mul(p.z, q.w)), v_sub(v_mul(p.x, q.y), v_mul(p.y, q.x)));
+	return r;
+}
+
+// flat float arrays (positions as 3*count floats, scales), out = lerp(a,b,t)
+static void lerp_floats(const float* a, const float* b, float* out, int count, float t) {
+	const vfloat vt = v_set1(t);
+	int i = 0;
+	for (; i + LANES <= count; i += LANES)
+		v_store(out + i, v_lerp(v_load(a + i), v_load(b + i), vt));
+	for (; i < count; i++)
+		out[i] = a[i] + (b[i] - a[i]) * t;
+}
+
+static glm::quat nlerp_reference(const glm::quat& a, glm::quat b, float t) {
+	if (glm::dot(a, b) < 0.f)
+		b = -b;
+	return glm::normalize(a * (1.f - t) + b * t);
+}
+
+// scalar per-bone versions, the _reference functions and the SIMD tails share these
+static inline void blend_bone(const Pose& a, Pose& b, int i, float t) {
+	b.q[i] = nlerp_reference(b.q[i], a.q[i], t);
+	b.pos[i] = glm::mix(b.pos[i], a.pos[i], t);
+	b.scale[i] = glm::mix(b.scale[i], a.scale[i], t);
+}
+static inline void blend_masked_bone(const Pose& a, Pose& b, int i, float t) {
+	b.q[i] = nlerp_reference(a.q[i], b.q[i], t);
+	b.pos[i] = glm::mix(a.pos[i], b.pos[i], t);
+	b.scale[i] = glm::mix(a.scale[i], b.scale[i], t);
+}
+static inline void add_bone(const Pose& additive, Pose& base, int i, float t) {
+	base.pos[i] = glm::mix(base.pos[i], base.pos[i] + additive.pos[i], t);
+	base.scale[i] = glm::mix(base.scale[i], base.scale[i] + additive.scale[i], t);
+	base.q[i] = nlerp_reference(base.q[i], additive.q[i] * base.q[i], t);
+}
+static inline void subtract_bone(const Pose& reference, Pose& source, int i) {
+	source.pos[i] = source.pos[i] - reference.pos[i];
+	source.scale[i] = source.scale[i] - reference.scale[i];
+	source.q[i] = source.q[i] * glm::inverse(reference.q[i]);
+}
+
+void pose_blend_reference(int bonecount, const Pose& a, Pose& b, float factor) {
+	for (int i = 0; i < bonecount; i++)
+		blend_bone(a, b, i, factor);
+}
+
+void pose_blend_simd(int bonecount, const Pose& a, Pose& b, float factor) {
+	const vfloat t = v_set1(factor);
+	int i = 0;
+	for (; i + LANES <= bonecount; i += LANES)
+		store_quats(&b.q[i], nlerp4(load_quats(&b.q[i]), load_quats(&a.q[i]), t));
+	for (; i < bonecount; i++)
+		b.q[i] = nlerp_reference(b.q[i], a.q[i], factor);
+	lerp_floats(&b.pos[0].x, &a.pos[0].x, &b.pos[0].x, bonecount * 3, factor);
+	lerp_floats(b.scale, a.scale, b.scale, bonecount, factor);
+}
+
+void pose_blend_masked_reference(int bonecount, const Pose& a, Pose& b, float factor, const float* mask) {
+	for (int i = 0; i < bonecount; i++)
+		blend_masked_bone(a, b, i, factor * mask[i]);
+}
+
+void pose_blend_masked_simd(int bonecount, const Pose& a, Pose& b, float factor, const float* mask) {
+	const vfloat f = v_set1(factor);
+	int i = 0;
+	for (; i + LANES <= bonecount; i += LANES) {
+		const vfloat t = v_mul(f, v_load(mask + i));
+		store_quats(&b.q[i], nlerp4(load_quats(&a.q[i]), load_quats(&b.q[i]), t));
+		const Vec3Lanes pa = load_vec3s(&a.pos[i]);
+		const Vec3Lanes pb = load_vec3s(&b.pos[i]);
+		store_vec3s(&b.pos[i], {v_lerp(pa.x, pb.x, t), v_lerp(pa.y, pb.y, t), v_lerp(pa.z, pb.z, t)});
+		v_store(&b.scale[i], v_lerp(v_load(&a.scale[i]), v_load(&b.scale[i]), t));
+	}
+	for (; i < bonecount; i++)
+		blend_masked_bone(a, b, i, factor * mask[i]);
+}
+
+void pose_add_reference(int bonecount, const Pose& additive, Pose& base, float fac) {
+	for (int i = 0; i < bonecount; i++)
+		add_bone(additive, base, i, fac);
+}
+
+void pose_add_simd(int bonecount, const Pose& additive, Pose& base, float fac) {
+	const vfloat t = v_set1(fac);
+	int i = 0;
+	for (; i + LANES <= bonecount; i += LANES) {
+		const QuatLanes b = load_quats(&base.q[i]);
+		store_quats(&base.q[i], nlerp4(b, mul4(load_quats(&additive.q[i]), b), t));
+	}
+	for (; i < bonecount; i++)
+		base.q[i] = nlerp_reference(base.q[i], additive.q[i] * base.q[i], fac);
+
+	// lerp(base, base + additive, t) == base + additive * t
+	const float* add_pos = &additive.pos[0].x;
+	float* base_pos = &base.pos[0].x;
+	int j = 0;
+	for (; j + LANES <= bonecount * 3; j += LANES)
+		v_store(base_pos + j, v_add(v_load(base_pos + j), v_mul(v_load(add_pos + j), t)));
+	for (; j < bonecount * 3; j++)
+		base_pos[j] += add_pos[j] * fac;
+	j = 0;
+	for (; j + LANES <= bonecount; j += LANES)
+		v_store(base.scale + j, v_add(v_load(base.scale + j), v_mul(v_load(additive.scale + j), t)));
+	for (; j < bonecount; j++)
+		base.scale[j] += additive.scale[j] * fac;
+}
+
+void pose_subtract_reference(int bonecount, const Pose& reference, Pose& source) {
+	for (int i = 0; i < bonecount; i++)
+		subtract_bone(reference, source, i);
+}
+
+void pose_subtract_simd(int bonecount, const Pose& reference, Pose& source) {
+	const vfloat sign = v_set1(-0.f);
+	int i = 0;
+	for (; i + LANES <= bonecount; i += LANES) {
+		// inverse(r) = conjugate(r) / |r|^2
+		QuatLanes r = load_quats(&reference.q[i]);
+		const vfloat inv_len_sq = v_div(v_set1(1.f), dot4(r, r));
+		r.x = v_mul(v_xor(r.x, sign), inv_len_sq);
+		r.y = v_mul(v_xor(r.y, sign), inv_len_sq);
+		r.z = v_mul(v_xor(r.z, sign), inv_len_sq);
+		r.w = v_mul(r.w, inv_len_sq);
+		store_quats(&source.q[i], mul4(load_quats(&source.q[i]), r));
+	}
+	for (; i < bonecount; i++)
+		source.q[i] = source.q[i] * glm::inverse(reference.q[i]);
+
+	float* src_pos = &source.pos[0].x;
+	const float* ref_pos = &reference.pos[0].x;
+	int j = 0;
+	for (; j + LANES <= bonecount * 3; j += LANES)
+		v_store(src_pos + j, v_sub(v_load(src_pos + j), v_load(ref_pos + j)));
+	for (; j < bonecount * 3; j++)
+		src_pos[j] -= ref_pos[j];
+	j = 0;
+	for (; j + LANES <= bonecount; j += LANES)
+		v_store(source.scale + j, v_sub(v_load(source.scale + j), v_load(reference.scale + j)));
+	for (; j < bonecount; j++)
+		source.scale[j] -= reference.scale[j];
+}
+
+static inline glm::mat4 local_matrix_reference(const Pose& local, int i) {
+	glm::mat4 matrix = glm::mat4_cast(local.q[i]);
+	matrix[3] = glm::vec4(local.pos[i], 1.0);
+	return glm::scale(matrix, glm::vec3(local.scale[i]));
+}
+
+void pose_local_to_mesh_reference(const Pose& local, const int16_t* parents, int bonecount, glm::mat4* out) {
+	for (int i = 0; i < bonecount; i++) {
+		const glm::mat4 matrix = local_matrix_reference(local, i);
+		out[i] = (parents[i] == -1) ? matrix : out[parents[i]] * matrix;
+	}
+}
+
+// out = a * b. out may alias b (but not a): column j of b is read before column j of out is written.
+static inline void mat4_mul_sse(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+	const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+	const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+	const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+	const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+	for (int j = 0; j < 4; j++) {
+		const __m128 col = _mm_loadu_ps(&b[j][0]);
+		__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_storeu_ps(&out[j][0], r);
+	}
+}
+
+void pose_local_to_mesh_simd(const Pose& local, const int16_t* parents, int bonecount, glm::mat4* out) {
+	// 1. local matrices, LANES bones at a time, written straight into out
+	const vfloat one = v_set1(1.f);
+	const vfloat two = v_set1(2.f);
+	const vfloat zero = v_set1(0.f);
+	int i = 0;
+	for (; i + LANES <= bonecount; i += LANES) {
+		const QuatLanes q = load_quats(&local.q[i]);
+		const Vec3Lanes p = load_vec3s(&local.pos[i]);
+		const vfloat s = v_load(&local.scale[i]);
+
+		const vfloat xx = v_mul(q.x, q.x), yy = v_mul(q.y, q.y), zz = v_mul(q.z, q.z);
+		const vfloat xy = v_mul(q.x, q.y), xz = v_mul(q.x, q.z), yz = v_mul(q.y, q.z);
+		const vfloat wx = v_mul(q.w, q.x), wy = v_mul(q.w, q.y), wz = v_mul(q.w, q.z);
+		const vfloat s2 = v_mul(s, two);
+
+		// same terms as glm::mat4_cast, columns scaled by s
+		vfloat c0x = v_mul(v_sub(one, v_mul(two, v_add(yy, zz))), s);
+		vfloat c0y = v_mul(v_add(xy, wz), s2);
+		vfloat c0z = v_mul(v_sub(xz, wy), s2);
+		vfloat c0w = zero;
+		vfloat c1x = v_mul(v_sub(xy, wz), s2);
+		vfloat c1y = v_mul(v_sub(one, v_mul(two, v_add(xx, zz))), s);
+		vfloat c1z = v_mul(v_add(yz, wx), s2);
+		vfloat c1w = zero;
+		vfloat c2x = v_mul(v_add(xz, wy), s2);
+		vfloat c2y = v_mul(v_sub(yz, wx), s2);
+		vfloat c2z = v_mul(v_sub(one, v_mul(two, v_add(xx, yy))), s);
+		vfloat c2w = zero;
+		vfloat c3x = p.x, c3y = p.y, c3z = p.z, c3w = one;
+
+		float* base = &out[i][0][0];
+		transpose4(c0x, c0y, c0z, c0w);
+		v_store_group(base + 0, 16, 0, c0x);
+		v_store_group(base + 0, 16, 1, c0y);
+		v_store_group(base + 0, 16, 2, c0z);
+		v_store_group(base + 0, 16, 3, c0w);
+		transpose4(c1x, c1y, c1z, c1w);
+		v_store_group(base + 4, 16, 0, c1x);
+		v_store_group(base + 4, 16, 1, c1y);
+		v_store_group(base + 4, 16, 2, c1z);
+		v_store_group(base + 4, 16, 3, c1w);
+		transpose4(c2x, c2y, c2z, c2w);
+		v_store_group(base + 8, 16, 0, c2x);
+		v_store_group(base + 8, 16, 1, c2y);
+		v_store_group(base + 8, 16, 2, c2z);
+		v_store_group(base + 8, 16, 3, c2w);
+		transpose4(c3x, c3y, c3z, c3w);
+		v_store_group(base + 12, 16, 0, c3x);
+		v_store_group(base + 12, 16, 1, c3y);
+		v_store_group(base + 12, 16, 2, c3z);
+		v_store_group(base + 12, 16, 3, c3w);
+	}
+	for (; i < bonecount; i++)
+		out[i] = local_matrix_reference(local, i);
+
+	// 2. walk the hierarchy. parents come first, so out[parent] is already in mesh space.
+	for (int j = 0; j < bonecount; j++) {
+		if (parents[j] != -1)
+			mat4_mul_sse(out[parents[j]], out[j], out[j]);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include "glm/glm.hpp"
+
+class Pose;
+
+// SIMD kernels behind util_blend, util_add, util_subtract, util_blend_with_mask and the local->mesh space
+// conversions. Pose keeps its layout: quaternions are loaded 4 bones at a time (8 in AVX builds) and transposed
+// into x/y/z/w registers, worked on as SoA, then transposed back. Rotations blend with nlerp (flip onto the
+// shortest path, lerp, normalize) instead of slerp.
+// The _reference versions are the same math in scalar code. The tests check the SIMD versions against them, and
+// the util_ functions fall back to them when anim.simd_pose is off.
+
+// b = lerp(b,a,factor)
+void pose_blend_simd(int bonecount, const Pose& a, Pose& b, float factor);
+void pose_blend_reference(int bonecount, const Pose& a, Pose& b, float factor);
+// b = lerp(a,b,factor*mask[i])
+void pose_blend_masked_simd(int bonecount, const Pose& a, Pose& b, float factor, const float* mask);
+void pose_blend_masked_reference(int bonecount, const Pose& a, Pose& b, float factor, const float* mask);
+// base = lerp(base,base+additive,fac)
+void pose_add_simd(int bonecount, const Pose& additive, Pose& base, float fac);
+void pose_add_reference(int bonecount, const Pose& additive, Pose& base, float fac);
+// source = source - reference
+void pose_subtract_simd(int bonecount, const Pose& reference, Pose& source);
+void pose_subtract_reference(int bonecount, const Pose& reference, Pose& source);
+
+// parents[i] < i, -1 for roots. Local matrices are built SIMD-wide, then the hierarchy is walked with SSE matrix
+// multiplies.
+void pose_local_to_mesh_simd(const Pose& local, const int16_t* parents, int bonecount, glm::mat4* out);
+void pose_local_to_mesh_reference(const Pose& local, const int16_t* parents, int bonecount, glm::mat4* out);
@@ -0,0 +1,225 @@
+#include "AnimGraphProgram.h"
+#include "RuntimeNodesNew2.h"
+#include "Animation.h"
+#include "Animation/AnimationUtil.h"
+#include "Animation/PoseArena.h"
+#include "Framework/Profiler.h"
+#include "Framework/Util.h"
+#include <algorithm>
+
+// same cutoffs as agBlendNode/agAddNode::get_pose
+static const float ALPHA_ZERO = 0.00001f;
+static const float ALPHA_ONE = 0.99999f;
+
+void agGraphProgram::compile(agBuilder& graph) {
+	functions.clear();
+	function_of_node.clear();
+	add_function(graph.get_root());
+	for (agBaseNode* n : graph.get_all_nodes()) {
+		if (!n)
+			continue;
+		if (auto* sm = n->cast_to<agStatemachineBase>()) {
+			for (agBaseNode* tree : sm->get_trees())
+				add_function(tree);
+			if (auto* slot = n->cast_to<agSlotPlayer>())
+				add_function(slot->input);
+		} else if (auto* save = n->cast_to<agSaveCachedPose>()) {
+			add_function(save->input);
+		}
+	}
+}
+
+int agGraphProgram::get_num_ops() const {
+	int count = 0;
+	for (auto& f : functions)
+		count += (int)f.ops.size();
+	return count;
+}
+
+void agGraphProgram::add_function(agBaseNode* root) {
+	if (!root || function_of_node.find(root) != function_of_node.end())
+		return;
+	Function f;
+	emit(f, root, 0, 0);
+	// a lone Node op is just the recursive call with extra steps
+	if (f.ops.size() == 1 && f.ops[0].code == agOpCode::Node)
+		return;
+	if (f.num_registers > 255 || f.num_slots > UINT16_MAX || f.ops.size() > UINT16_MAX) {
+		sys_print(Warning, "agGraphProgram: subgraph too deep to flatten, using get_pose\n");
+		return;
+	}
+	f.weights.resize(f.num_slots);
+	f.alphas.resize(f.num_slots);
+	f.registers.resize(f.num_registers);
+	function_of_node.insert({root, (int)functions.size()});
+	functions.push_back(std::move(f));
+}
+
+void agGraphProgram::emit(Function& f, agBaseNode* node, int dst, int slot) {
+	f.num_registers = std::max(f.num_registers, dst + 1);
+	agOp op;
+	op.node = node;
+	op.dst = (uint8_t)dst;
+	op.src = (uint8_t)(dst + 1);
+	op.slot = (uint16_t)slot;
+
+	// input0 into dst and input1 into dst+1, then the combine. Begin decides which inputs run and their weights.
+	auto emit_binary = [&](agOpCode begin, agBaseNode* input0, agBaseNode* input1, agOpCode combine) {
+		op.code = begin;
+		op.input0 = (uint16_t)f.num_slots++;
+		op.input1 = (uint16_t)f.num_slots++;
+		const int begin_at = (int)f.ops.size();
+		f.ops.push_back(op);
+		emit(f, input0, dst, op.input0);
+		const int skip_at = (int)f.ops.size();
+		f.ops.push_back(op);
+		f.ops[skip_at].code = agOpCode::SkipIfZero;
+		f.ops[begin_at].jump = (uint16_t)f.ops.size();
+		emit(f, input1, dst + 1, op.input1);
+		op.code = combine;
+		f.ops.push_back(op);
+		f.ops[skip_at].jump = (uint16_t)f.ops.size();
+	};
+	// input into dst at the same weight, then the node works on it
+	auto emit_unary = [&](agBaseNode* input, agOpCode code) {
+		emit(f, input, dst, slot);
+		op.code = code;
+		f.ops.push_back(op);
+	};
+
+	if (auto* blend = node->cast_to<agBlendNode>(); blend && blend->input0 && blend->input1) {
+		emit_binary(agOpCode::BlendBegin, blend->input0, blend->input1, agOpCode::Blend);
+	} else if (auto* masked = node->cast_to<agBlendMasked>(); masked && masked->input0 && masked->input1) {
+		emit_binary(agOpCode::MaskedBegin, masked->input0, masked->input1, agOpCode::BlendMasked);
+	} else if (auto* add = node->cast_to<agAddNode>(); add && add->input0 && add->input1) {
+		emit_binary(agOpCode::AddBegin, add->input0, add->input1, agOpCode::Add);
+	} else if (auto* additive = node->cast_to<agMakeAdditive>(); additive && additive->input && additive->reference) {
+		emit(f, additive->input, dst, slot);
+		emit(f, additive->reference, dst + 1, slot);
+		op.code = agOpCode::MakeAdditive;
+		f.ops.push_back(op);
+	} else if (auto* ik = node->cast_to<agIk2Bone>(); ik && ik->input) {
+		emit_unary(ik->input, agOpCode::Ik2Bone);
+	} else if (auto* modify = node->cast_to<agModifyBone>(); modify && modify->input) {
+		emit_unary(modify->input, agOpCode::ModifyBone);
+	} else if (auto* copy = node->cast_to<agCopyBone>(); copy && copy->input) {
+		emit_unary(copy->input, agOpCode::CopyBone);
+	} else if (node->cast_to<agBindPose>()) {
+		op.code = agOpCode::BindPose;
+		f.ops.push_back(op);
+	} else {
+		op.code = agOpCode::Node;
+		f.ops.push_back(op);
+	}
+}
+
+bool agGraphProgram::run(agBaseNode* node, agGetPoseCtx& ctx) {
+	auto find = function_of_node.find(node);
+	if (find == function_of_node.end())
+		return false;
+	Function& f = functions[find->second];
+	if (f.running)
+		return false;
+	f.running = true;
+	execute(f, ctx);
+	f.running = false;
+	return true;
+}
+
+void agGraphProgram::execute(Function& f, agGetPoseCtx& ctx) {
+	PoseArena& arena = ctx.pose.get_parent();
+	const MSkeleton& skel = ctx.get_skeleton();
+	const int num_bones = ctx.get_num_bones();
+	ScopedPoseArray scratch(arena, num_bones, f.num_registers - 1);
+
+	Pose** regs = f.registers.data();
+	regs[0] = ctx.pose.get();
+	for (int i = 1; i < f.num_registers; i++)
+		regs[i] = &scratch[i - 1];
+	float* weights = f.weights.data();
+	float* alphas = f.alphas.data();
+	weights[0] = ctx.weight;
+
+	const agOp* ops = f.ops.data();
+	const int num_ops = (int)f.ops.size();
+	int executed = 0;
+	int pc = 0;
+	while (pc < num_ops) {
+		const agOp& op = ops[pc++];
+		executed++;
+		switch (op.code) {
+		case agOpCode::Node: {
+			agGetPoseCtx node_ctx(ctx.object, arena, *regs[op.dst], ctx.dt);
+			node_ctx.weight = weights[op.slot];
+			op.node->get_pose(node_ctx);
+			break;
+		}
+		case agOpCode::BindPose:
+			util_set_to_bind_pose(*regs[op.dst], &skel);
+			break;
+		case agOpCode::BlendBegin: {
+			const float a = static_cast<agBlendNode*>(op.node)->alpha.get_float(ctx);
+			const float w = weights[op.slot];
+			alphas[op.slot] = a;
+			if (a <= ALPHA_ZERO) {
+				weights[op.input0] = w;
+			} else if (a >= ALPHA_ONE) {
+				weights[op.input1] = w;
+				pc = op.jump;
+			} else {
+				weights[op.input0] = w * (1.f - a);
+				weights[op.input1] = w * a;
+			}
+			break;
+		}
+		case agOpCode::MaskedBegin:
+		case agOpCode::AddBegin: {
+			// base keeps the full weight, the layer scales with alpha
+			const float a = op.code == agOpCode::MaskedBegin ? static_cast<agBlendMasked*>(op.node)->alpha.get_float(ctx)
+															  : static_cast<agAddNode*>(op.node)->alpha.get_float(ctx);
+			alphas[op.slot] = a;
+			weights[op.input0] = weights[op.slot];
+			weights[op.input1] = weights[op.slot] * a;
+			break;
+		}
+		case agOpCode::SkipIfZero:
+			if (alphas[op.slot] <= ALPHA_ZERO)
+				pc = op.jump;
+			break;
+		case agOpCode::Blend:
+			if (alphas[op.slot] >= ALPHA_ONE)
+				std::swap(regs[op.dst], regs[op.src]);
+			else
+				util_blend(num_bones, *regs[op.src], *regs[op.dst], alphas[op.slot]);
+			break;
+		case agOpCode::BlendMasked:
+			// the masked blend writes into the layer's pose
+			static_cast<agBlendMasked*>(op.node)->blend_layer(skel, *regs[op.dst], *regs[op.src], alphas[op.slot]);
+			std::swap(regs[op.dst], regs[op.src]);
+			break;
+		case agOpCode::Add:
+			util_add(num_bones, *regs[op.src], *regs[op.dst], alphas[op.slot]);
+			break;
+		case agOpCode::MakeAdditive:
+			static_cast<agMakeAdditive*>(op.node)->make_delta(num_bones, *regs[op.src], *regs[op.dst]);
+			break;
+		case agOpCode::Ik2Bone:
+		case agOpCode::ModifyBone:
+		case agOpCode::CopyBone: {
+			agGetPoseCtx node_ctx(ctx.object, arena, *regs[op.dst], ctx.dt);
+			node_ctx.weight = weights[op.slot];
+			if (op.code == agOpCode::Ik2Bone)
+				static_cast<agIk2Bone*>(op.node)->apply(node_ctx);
+			else if (op.code == agOpCode::ModifyBone)
+				static_cast<agModifyBone*>(op.node)->apply(node_ctx);
+			else
+				static_cast<agCopyBone*>(op.node)->apply(node_ctx);
+			break;
+		}
+		}
+	}
+	// a swap can leave the result in a scratch register
+	if (regs[0] != ctx.pose.get())
+		ctx.pose->copy_from(*regs[0]);
+	PROF_COUNTER_ADD("anim graph program ops", prof::CounterUnit::Count, executed);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+class agBaseNode;
+class agBuilder;
+class agGetPoseCtx;
+class Pose;
+
+// The agBaseNode tree flattened into a linear list of ops over indexed pose registers, so evaluating it is a loop
+// instead of a virtual get_pose() recursion with a context copy (and pose allocation) per blend.
+//
+// Compiled once per AnimatorObject. There's one function per subgraph root: the graph root, every statemachine state,
+// slot player inputs and cached pose inputs. Inside a function the stateless nodes (blends, masked blends, adds,
+// make additive, bind pose, two bone ik, modify/copy bone) become ops, everything else is a Node op that calls
+// get_pose() on a context writing straight into the register. Nodes that pick a subgraph at runtime evaluate it with
+// agGetPoseCtx::evaluate(), which runs that subgraph's function, so statemachine states are flattened too.
+//
+// Event weights follow the same rules as the recursive evaluator and so does the output pose; the per-node
+// debug_enter text is only written by the Node ops.
+enum class agOpCode : uint8_t
+{
+	Node,		// op.node->get_pose() into dst
+	BindPose,	// dst = bind pose
+	BlendBegin, // agBlendNode alpha and input weights, alpha ~1 jumps to input1
+	MaskedBegin,
+	AddBegin,
+	SkipIfZero, // jumps past the combine when alpha ~0, between the two inputs
+	Blend,		// dst = lerp(dst, src, alpha), alpha ~1 just takes src's register
+	BlendMasked,
+	Add,
+	MakeAdditive, // dst = dst - src
+	Ik2Bone,	  // op.node->apply() on dst
+	ModifyBone,
+	CopyBone,
+};
+
+struct agOp
+{
+	agOpCode code = agOpCode::Node;
+	uint8_t dst = 0; // pose registers
+	uint8_t src = 0;
+	uint16_t slot = 0; // this node's weight/alpha slot
+	uint16_t input0 = 0; // weight slots of the inputs
+	uint16_t input1 = 0;
+	uint16_t jump = 0;
+	agBaseNode* node = nullptr;
+};
+
+class agGraphProgram
+{
+public:
+	void compile(agBuilder& graph);
+	// evaluates node's function into ctx.pose, false if node has none
+	bool run(agBaseNode* node, agGetPoseCtx& ctx);
+
+	int get_num_functions() const { return (int)functions.size(); }
+	int get_num_ops() const;
+
+private:
+	struct Function
+	{
+		std::vector<agOp> ops;
+		int num_registers = 1;
+		int num_slots = 1;
+		// per run scratch, a function never runs inside itself
+		std::vector<float> weights;
+		std::vector<float> alphas;
+		std::vector<Pose*> registers;
+		bool running = false;
+	};
+
+	void add_function(agBaseNode* root);
+	void emit(Function& f, agBaseNode* node, int dst, int slot);
+	void execute(Function& f, agGetPoseCtx& ctx);
+
+	std::vector<Function> functions;
+	std::unordered_map<const agBaseNode*, int> function_of_node;
+};
@@ -17,8 +17,10 @@ using namespace glm;
 #include "RuntimeNodesNew.h"
 
 #include "Debug.h"
+#include "Framework/Profiler.h"
 #include "Game/Components/GameAnimationMgr.h"
 #include "RuntimeNodesNew2.h"
+#include "AnimGraphProgram.h"
 
 #define ROOT_BONE -1
 #define INVALID_ANIMATION -1
@@ -101,13 +103,16 @@ AnimatorObject::AnimatorObject(const Model& model, agBuilder& ingraph, Entity* e
 		if (auto* use = n ? n->cast_to<agUseCachedPose>() : nullptr)
 			use->resolve(*this);
 
+	program = std::make_unique<agGraphProgram>();
+	program->compile(graph);
+
 	// Init bone arrays
 	const int bones = model.get_skel()->get_num_bones();
 	cached_bonemats.resize(bones);
 	if (using_global_bonemat_double_buffer)
 		last_cached_bonemats.resize(bones);
 
-	auto pose = g_pose_pool.allocate_scoped();
+	ScopedPose pose(PoseArena::get_thread_arena(), bones);
 	util_set_to_bind_pose(*pose.get(), get_skel());
 	util_localspace_to_meshspace(*pose.get(), cached_bonemats, get_skel());
 	if (using_global_bonemat_double_buffer) {
@@ -142,23 +147,90 @@ static std::vector<int> get_indicies(const Animation_Set* set, const std::vector
 	return out;
 }
 #include "Game/Components/RagdollComponent.h"
+#include "Animation/SharedPoseCache.h"
 
 ConfigVar force_animation_to_bind_pose("force_animation_to_bind_pose", "0", CVAR_BOOL | CVAR_DEV, "");
+ConfigVar anim_graph_program("anim.graph_program", "1", CVAR_BOOL | CVAR_DEV,
+							 "evaluate anim graphs with the flattened op program instead of recursing through get_pose");
+
+agGraphProgram* AnimatorObject::get_graph_program() const {
+	return use_graph_program && anim_graph_program.get_bool() ? program.get() : nullptr;
+}
+
 void AnimatorObject::update(float dt) {
+	evaluate(dt, PoseArena::get_thread_arena());
+	run_deferred_callbacks();
+}
+
+void AnimatorObject::run_deferred_callbacks() {
+	// callbacks can re-enter play_animation, so swap out first
+	std::vector<function<void(bool)>> callbacks;
+	callbacks.swap(deferred_slot_callbacks);
+	for (auto& cb : callbacks)
+		cb(true);
+}
+
+void AnimatorObject::evaluate(float dt, PoseArena& pose_scratch) {
 	assert(model.get_skel());
+	const int interval = std::max(update_lod.interval, 1);
+	const bool interpolate = interval > 1 && !update_lod.offscreen;
+	if (!interpolate) {
+		lod_from_bonemats.clear();
+		lod_to_bonemats.clear();
+	}
+	// offset by address, so animators that switch rate on the same frame spread their evaluations out
+	const int phase = int((uintptr_t(this) >> 4) % interval);
+	if (interval != lod_interval) {
+		lod_interval = interval;
+		lod_frames_since_eval = phase;
+	}
+	lod_pending_dt += dt;
+	lod_frames_since_eval++;
+	sampled_events.clear();
+
+	const bool first_interpolated = interpolate && lod_to_bonemats.empty();
+	if (interval == 1 || first_interpolated || lod_frames_since_eval >= interval) {
+		evaluate_graph(lod_pending_dt, pose_scratch, !update_lod.offscreen);
+		lod_pending_dt = 0.f;
+		lod_frames_since_eval = first_interpolated ? phase : 0;
+		if (interpolate) {
+			lod_from_bonemats.swap(lod_to_bonemats);
+			lod_to_bonemats = cached_bonemats;
+			if (lod_from_bonemats.empty())
+				lod_from_bonemats = cached_bonemats;
+		}
+	} else if (using_global_bonemat_double_buffer) {
+		last_cached_bonemats = cached_bonemats;
+	}
+	if (interpolate) {
+		// lags the graph by up to one interval, in exchange the motion stays continuous
+		const float t = std::min(float(lod_frames_since_eval + 1) / interval, 1.f);
+		interpolate_bone_matrices(lod_from_bonemats.data(), lod_to_bonemats.data(), t, num_bones(),
+								  cached_bonemats.data());
+	}
+
+	ConcatWithInvPose();
+	pose_scratch.report_stats();
+}
+
+void AnimatorObject::evaluate_graph(float dt, PoseArena& pose_scratch, bool build_pose) {
+	PROF_COUNTER_ADD("anim graph evaluations", prof::CounterUnit::Count, 1);
 	evalFrameId++;
 	root_motion = RootMotionTransform();
-	sampled_events.clear();
-	if (using_global_bonemat_double_buffer)
-		last_cached_bonemats.swap(cached_bonemats);
+	if (using_global_bonemat_double_buffer) {
+		if (build_pose)
+			last_cached_bonemats.swap(cached_bonemats);
+		else
+			last_cached_bonemats = cached_bonemats;
+	}
 	debug_output_messages.clear();
 
-	agGetPoseCtx graphCtx(*this, g_pose_pool, dt);
+	agGetPoseCtx graphCtx(*this, pose_scratch, dt);
 	auto& pose_base = graphCtx.pose;
 
 	// call into tree
 	if (!force_animation_to_bind_pose.get_bool()) {
-		get_root_node().get_pose(graphCtx);
+		graphCtx.evaluate(&get_root_node());
 	} else {
 		util_set_to_bind_pose(*pose_base.get(), get_skel());
 	}
@@ -175,6 +247,9 @@ void AnimatorObject::update(float dt) {
 	for (int i = 0; i < slots.size(); i++) {
 		update_slot(i, dt);
 	}
+	// offscreen: graph time, events and slots moved on, the bones keep their last matrices
+	if (!build_pose)
+		return;
 	// add physics driven bones
 	// physics bones are in world space, wont cover every bone
 	if (RagdollComponent* rd = ragdoll.get()) {
@@ -184,66 +259,97 @@ void AnimatorObject::update(float dt) {
 	}
 	const glm::mat4 ownerWorld = owner ? owner->get_ws_transform() : glm::mat4(1.f);
 	springBones.update(dt, *pose_base, cached_bonemats, get_skel(), ownerWorld);
-
-	ConcatWithInvPose();
 }
 
 
-opt<float> AnimatorObject::get_float_variable(StringName name) const {
-	auto find = MapUtil::get_opt(blackboard, name.get_hash());
-	if (find && std::holds_alternative<float>(*find))
-		return std::get<float>(*find);
+int AnimatorObject::find_variable_slot(StringName name) {
+	auto find = variable_slots.find(name.get_hash());
+	if (find != variable_slots.end())
+		return find->second;
+	const int slot = (int)variables.size();
+	variables.emplace_back();
+	variable_slots.insert({name.get_hash(), slot});
+	return slot;
+}
+
+opt<float> AnimatorObject::get_float_slot(int slot) const {
+	auto& var = variables.at(slot);
+	if (std::holds_alternative<float>(var))
+		return std::get<float>(var);
 	return std::nullopt;
 }
 
-opt<bool> AnimatorObject::get_bool_variable(StringName name) const {
-	auto find = MapUtil::get_opt(blackboard, name.get_hash());
-	if (find && std::holds_alternative<bool>(*find))
-		return std::get<bool>(*find);
+opt<bool> AnimatorObject::get_bool_slot(int slot) const {
+	auto& var = variables.at(slot);
+	if (std::holds_alternative<bool>(var))
+		return std::get<bool>(var);
 	return std::nullopt;
 }
 
-opt<int> AnimatorObject::get_int_variable(StringName name) const {
-	auto find = MapUtil::get_opt(blackboard, name.get_hash());
-	if (find && std::holds_alternative<int>(*find))
-		return std::get<int>(*find);
+opt<int> AnimatorObject::get_int_slot(int slot) const {
+	auto& var = variables.at(slot);
+	if (std::holds_alternative<int>(var))
+		return std::get<int>(var);
 	return std::nullopt;
 }
 
-opt<glm::vec3> AnimatorObject::get_vec3_variable(StringName name) const {
-	auto find = MapUtil::get_opt(blackboard, name.get_hash());
-	if (find && std::holds_alternative<glm::vec3>(*find))
-		return std::get<glm::vec3>(*find);
+opt<glm::vec3> AnimatorObject::get_vec3_slot(int slot) const {
+	auto& var = variables.at(slot);
+	if (std::holds_alternative<glm::vec3>(var))
+		return std::get<glm::vec3>(var);
 	return std::nullopt;
 }
 
-opt<glm::quat> AnimatorObject::get_quat_variable(StringName name) const {
-	auto find = MapUtil::get_opt(blackboard, name.get_hash());
-	if (!find)
-		return std::nullopt;
-	if (std::holds_alternative<glm::quat>(*find))
-		return std::get<glm::quat>(*find);
+opt<glm::quat> AnimatorObject::get_quat_slot(int slot) const {
+	auto& var = variables.at(slot);
+	if (std::holds_alternative<glm::quat>(var))
+		return std::get<glm::quat>(var);
 	// Back-compat: a vec3 variable is interpreted as euler radians.
-	if (std::holds_alternative<glm::vec3>(*find))
-		return glm::quat(std::get<glm::vec3>(*find));
+	if (std::holds_alternative<glm::vec3>(var))
+		return glm::quat(std::get<glm::vec3>(var));
 	return std::nullopt;
 }
 
+opt<float> AnimatorObject::get_float_variable(StringName name) const {
+	auto find = MapUtil::get_opt(variable_slots, name.get_hash());
+	return find ? get_float_slot(*find) : std::nullopt;
+}
+
+opt<bool> AnimatorObject::get_bool_variable(StringName name) const {
+	auto find = MapUtil::get_opt(variable_slots, name.get_hash());
+	return find ? get_bool_slot(*find) : std::nullopt;
+}
+
+opt<int> AnimatorObject::get_int_variable(StringName name) const {
+	auto find = MapUtil::get_opt(variable_slots, name.get_hash());
+	return find ? get_int_slot(*find) : std::nullopt;
+}
+
+opt<glm::vec3> AnimatorObject::get_vec3_variable(StringName name) const {
+	auto find = MapUtil::get_opt(variable_slots, name.get_hash());
+	return find ? get_vec3_slot(*find) : std::nullopt;
+}
+
+opt<glm::quat> AnimatorObject::get_quat_variable(StringName name) const {
+	auto find = MapUtil::get_opt(variable_slots, name.get_hash());
+	return find ? get_quat_slot(*find) : std::nullopt;
+}
+
 void AnimatorObject::set_float_variable(StringName name, float f) {
-	blackboard[name.get_hash()] = f;
+	variables[find_variable_slot(name)] = f;
 }
 
 void AnimatorObject::set_int_variable(StringName name, int f) {
-	blackboard[name.get_hash()] = f;
+	variables[find_variable_slot(name)] = f;
 }
 void AnimatorObject::set_bool_variable(StringName name, bool f) {
-	blackboard[name.get_hash()] = f;
+	variables[find_variable_slot(name)] = f;
 }
 void AnimatorObject::set_vec3_variable(StringName name, const glm::vec3& f) {
-	blackboard[name.get_hash()] = f;
+	variables[find_variable_slot(name)] = f;
 }
 void AnimatorObject::set_quat_variable(StringName name, const glm::quat& q) {
-	blackboard[name.get_hash()] = q;
+	variables[find_variable_slot(name)] = q;
 }
 
 #include "Assets/AssetDatabase.h"
@@ -270,16 +376,21 @@ bool AnimatorObject::update_sync_group(int idx) {
 		assert(!data.is_first_update);
 		return false;
 	}
+	const bool was_first_update = data.is_first_update;
 	// clear first update flag
 	data.is_first_update = false;
 
 	// set updated data into data used for next tree tick
 	data.time = data.update_time;
+	// a new group starts on a shared phase, after that it advances like every other group started there
+	if (was_first_update && share_poses && allow_phase_snap && SharedPoseCache::get().is_enabled())
+		data.time = Percentage(SharedPoseCache::get().snap_phase(data.time.get(), data.update_duration));
 	data.has_sync_marker = data.update_has_sync_marker;
 	data.sync_marker_name = data.update_sync_marker_name;
 
 	// clear update data
 	data.update_time = Percentage();
+	data.update_duration = 0.f;
 	data.update_weight = 0.0;
 	data.update_owner = nullptr;
 	data.update_owner_synctype = sync_opt::Default;
@@ -297,7 +408,7 @@ void AnimatorObject::update_slot(int idx, float dt) {
 	slot.time += dt * slot.playspeed; // also update time
 	if (slot.time > seq->seq->get_duration()) {
 		if (slot.on_finished) {
-			slot.on_finished(true);
+			deferred_slot_callbacks.push_back(std::move(slot.on_finished));
 			slot.on_finished = {};
 		}
 		slot.active = nullptr;
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include "../AnimationTypes.h"
+#include "Animation/AnimationLod.h"
 
 #include "Render/Model.h"
 #include <vector>
@@ -27,6 +28,8 @@
 using std::function;
 class atGraphContext;
 class Pose;
+class PoseArena;
+template <typename T> class Pool_Allocator;
 class Animator;
 class MSkeleton;
 class Entity;
@@ -55,6 +58,7 @@ struct DirectAnimationSlot
 
 // create this through code however you want
 class agBaseNode;
+class agGraphProgram;
 class agBuilder : public ClassBase
 {
 public:
@@ -99,6 +103,29 @@ public:
 	~AnimatorObject();
 	// Main update method
 	void update(float dt);
+	// The part of update() that is safe to run on a worker (GameAnimationMgr's parallel path):
+	// evaluates the graph with scratch poses from pose_scratch (the calling thread's PoseArena) and doesn't
+	// call back into game code. Owner's world transform must already be resolved. Finish with
+	// run_deferred_callbacks() on the main thread.
+	// Follows the update rate LOD: on frames the graph is skipped it only interpolates bone matrices.
+	void evaluate(float dt, PoseArena& pose_scratch);
+	void run_deferred_callbacks();
+	// set by GameAnimationMgr before evaluate(), defaults to full rate
+	void set_update_lod(const AnimUpdateLod& lod) { update_lod = lod; }
+	const AnimUpdateLod& get_update_lod() const { return update_lod; }
+	// false for animators gameplay reads bones from every frame, they always run at full rate. Animators with
+	// entities attached to their bones (attachments, bone-following hit boxes) already do, see GameAnimationMgr.
+	REF void set_allow_update_lod(bool b) { allow_update_lod = b; }
+	REF bool get_allow_update_lod() const { return allow_update_lod; }
+	// crowd sharing: clip samples go through the frame's SharedPoseCache (anim.pose_cache), and with phase snap
+	// allowed, sync groups start on one of the shared phases so animators in a crowd line up on the same samples.
+	// off by default, TopDownEnemyComponent opts its enemies in
+	REF void set_share_poses(bool b) { share_poses = b; }
+	REF bool get_share_poses() const { return share_poses; }
+	REF void set_allow_phase_snap(bool b) { allow_phase_snap = b; }
+	bool get_allow_phase_snap() const { return allow_phase_snap; }
+	// ragdoll driven bones pull from physics bodies, keep those on the main thread
+	bool needs_serial_update() const { return ragdoll.get() != nullptr; }
 	// what game/physics stuff consumes
 	const std::vector<glm::mat4x4> get_global_bonemats() const { return cached_bonemats; }
 	bool is_using_double_buffer() const { return using_global_bonemat_double_buffer; }
@@ -147,8 +174,26 @@ public:
 	// Rotations are delivered as quaternions (no euler round-trip). agModifyBone reads
 	// rotationVal as a quat; a vec3 variable is still accepted and treated as euler radians.
 	REF void set_quat_variable(StringName name, const glm::quat& q);
+	// Variables live in slots. Graph nodes resolve their variable names to slots on the first read, game code that
+	// sets the same variable every frame can look its slot up once and skip the name hash lookup.
+	// Adds an unset slot for names that haven't been set yet.
+	int find_variable_slot(StringName name);
+	void set_float_slot(int slot, float f) { variables[slot] = f; }
+	void set_int_slot(int slot, int i) { variables[slot] = i; }
+	void set_bool_slot(int slot, bool b) { variables[slot] = b; }
+	void set_vec3_slot(int slot, const glm::vec3& v) { variables[slot] = v; }
+	void set_quat_slot(int slot, const glm::quat& q) { variables[slot] = q; }
+	opt<float> get_float_slot(int slot) const;
+	opt<bool> get_bool_slot(int slot) const;
+	opt<int> get_int_slot(int slot) const;
+	opt<glm::vec3> get_vec3_slot(int slot) const;
+	opt<glm::quat> get_quat_slot(int slot) const;
 	agBaseNode* find_cached_pose_node(StringName name);
 	agBaseNode& get_root_node() const;
+	// the linear version of the graph, null when anim.graph_program is off or for this animator
+	agGraphProgram* get_graph_program() const;
+	void set_use_graph_program(bool b) { use_graph_program = b; }
+	bool get_use_graph_program() const { return use_graph_program; }
 	// Incremented once per update(). agSaveCachedPose compares this against the frame it
 	// last evaluated on to decide whether to re-run its input or reuse the stored pose --
 	// this is what makes a cached pose evaluate at most once per frame regardless of how
@@ -176,7 +221,9 @@ private:
 	vector<string> debug_output_messages;
 
 	std::vector<agClipNode*> playingClipsThisUpdate;
-	std::unordered_map<uint64_t, std::variant<bool, float, int, glm::vec3, glm::quat>> blackboard;
+	std::vector<function<void(bool)>> deferred_slot_callbacks; // finished slots, fired from run_deferred_callbacks
+	std::vector<std::variant<std::monostate, bool, float, int, glm::vec3, glm::quat>> variables; // by slot
+	std::unordered_map<uint64_t, int> variable_slots; // name hash -> slot
 	uint64_t evalFrameId = 0;
 	bool using_global_bonemat_double_buffer = true;
 	vector<glm::mat4> cached_bonemats; // global bonemats
@@ -195,12 +242,29 @@ private:
 	vector<SyncGroupData> active_sync_groups;
 	vector<DirectAnimationSlot> slots;
 	agBuilder graph;
+	std::unique_ptr<agGraphProgram> program;
+	bool use_graph_program = true;
 
 	bool update_sync_group(int idx);
 	void update_slot(int idx, float dt);
 	void update_physics_bones(const Pose& inpose, RagdollComponent* rd);
+	// one run of the graph, build_pose=false skips mesh space bones and spring bones
+	void evaluate_graph(float dt, PoseArena& pose_scratch, bool build_pose);
 	void ConcatWithInvPose();
 
+	bool share_poses = false;
+	bool allow_phase_snap = false;
+
+	// update rate LOD
+	AnimUpdateLod update_lod;
+	bool allow_update_lod = true;
+	int lod_interval = 1;
+	int lod_frames_since_eval = 0;
+	float lod_pending_dt = 0.f;
+	// the last two graph evaluations, interpolated between while running below full rate
+	vector<glm::mat4> lod_from_bonemats;
+	vector<glm::mat4> lod_to_bonemats;
+
 	friend class NodeRt_Ctx;
 	friend class EditModelAnimations;
 	friend class AnimationEditorTool;
@@ -23,7 +23,6 @@ struct MatrixPose
 	glm::mat4 mats[256];
 };
 
-extern Pool_Allocator<Pose> g_pose_pool;
 extern Pool_Allocator<MatrixPose> g_matrix_pool;
 
 NEWENUM(rootmotion_setting, uint8_t){keep, remove, add_velocity};
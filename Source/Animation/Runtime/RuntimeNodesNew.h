@@ -10,6 +10,7 @@
 
 #include "Framework/MapUtil.h"
 #include "Framework/PoolAllocator.h"
+#include "Animation/PoseArena.h"
 #include <variant>
 using glm::vec2;
 using glm::vec3;
@@ -65,13 +66,14 @@ public:
 class atUpdateStack
 {
 public:
-	atUpdateStack(atGraphContext& graph, Pool_Allocator<Pose>& allocator)
-		: graph(graph), pose(allocator.allocate_scoped()) {}
+	atUpdateStack(atGraphContext& graph, PoseArena& allocator)
+		: graph(graph), pose(allocator, graph.get_num_bones()) {}
 	atGraphContext& graph;
-	ScopedPoolPtr<Pose> pose;
+	ScopedPose pose;
 	RootMotionTransform rootMotion;
 	float weight = 1.f;
-	atUpdateStack(const atUpdateStack& other) : graph(other.graph), pose(other.pose.get_parent().allocate_scoped()) {}
+	atUpdateStack(const atUpdateStack& other)
+		: graph(other.graph), pose(other.pose.get_parent(), other.pose->get_num_bones()) {}
 };
 
 struct atClipNodeStruct
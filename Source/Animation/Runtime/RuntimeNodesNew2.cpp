@@ -4,6 +4,8 @@
 #include "Render/Model.h"
 #include "Framework/Util.h"
 #include "Animation.h"
+#include "AnimGraphProgram.h"
+#include "Animation/SharedPoseCache.h"
 #include <algorithm>
 #include <limits>
 #include <cstdio>
@@ -113,6 +115,29 @@ struct ActiveBlendSample
 	float weight = 0.f;
 };
 
+// Samples `clip` at `time` into outpose. Animators without pose sharing (or with anim.pose_cache off) go straight to
+// util_calc_rotations; the rest go through the frame's SharedPoseCache, keyed on skeleton, clip, quantized time step,
+// retarget map and loop flag. Those sample at the cache's time step even on a miss, so every animator in a step gets
+// the same pose whoever sampled it first.
+static void sample_clip(agGetPoseCtx& ctx, const AnimationSeq* clip, float time, const BoneIndexRetargetMap* remap,
+						Pose& outpose, bool loop) {
+	SharedPoseCache& cache = SharedPoseCache::get();
+	if (!ctx.object.get_share_poses() || !cache.is_enabled()) {
+		util_calc_rotations(&ctx.get_skeleton(), clip, time, remap, outpose, loop);
+		return;
+	}
+	SharedPoseKey key;
+	key.skeleton = &ctx.get_skeleton();
+	key.clip = clip;
+	key.time_step = cache.quantize_time(time);
+	key.state = (uint32_t)std::hash<const void*>()(remap) * 2u + (loop ? 1u : 0u);
+	if (cache.find(key, outpose))
+		return;
+	const float step_time = glm::clamp(cache.get_step_time(key.time_step), 0.f, clip->get_duration());
+	util_calc_rotations(&ctx.get_skeleton(), clip, step_time, remap, outpose, loop);
+	cache.store(key, outpose);
+}
+
 // Advances a blend space's own normalized [0,1) playhead. Participates in an optional
 // SyncGroup exactly like a virtual clip of duration 1 -- SyncGroupData::time is already a
 // plain ratio, so a blend space's normalized time and a clip's normalized time interoperate
@@ -142,7 +167,7 @@ static float advance_blendspace_time(agGetPoseCtx& ctx, StringName syncGroup, sy
 			eval_time = sync.time.get();
 		if (sync.should_write_new_update_weight(syncType, ctx.weight)) {
 			const float next = step(eval_time);
-			sync.write_to_update_time(syncType, ctx.weight, nullptr, Percentage(next, 1.f));
+			sync.write_to_update_time(syncType, ctx.weight, nullptr, Percentage(next, 1.f), avg_duration);
 			animTime = next;
 		} else {
 			animTime = eval_time; // another node in the group owns advancing this frame
@@ -189,11 +214,11 @@ static void blend_space_evaluate(agGetPoseCtx& ctx, std::vector<ActiveBlendSampl
 		const float local_time = glm::clamp(eval_time * dur, 0.f, dur);
 
 		if (i == 0) {
-			util_calc_rotations(&ctx.get_skeleton(), a.seq, local_time, a.remap, *ctx.pose, loop);
+			sample_clip(ctx, a.seq, local_time, a.remap, *ctx.pose, loop);
 			running_weight = a.weight;
 		} else {
 			agGetPoseCtx other(ctx);
-			util_calc_rotations(&ctx.get_skeleton(), a.seq, local_time, a.remap, *other.pose, loop);
+			sample_clip(ctx, a.seq, local_time, a.remap, *other.pose, loop);
 			const float total = running_weight + a.weight;
 			const float lerp_alpha = total > 0.00001f ? a.weight / total : 0.f;
 			util_blend(ctx.get_num_bones(), *other.pose, *ctx.pose, lerp_alpha);
@@ -237,8 +262,9 @@ static void get_clip_pose_shared(agGetPoseCtx& ctx, const AnimationSeq* clip, bo
 					stopped_flag = true;
 				}
 			}
-			sync.write_to_update_time(SyncOption, 0.5 /*TODO*/, owner, Percentage(anim_time, clip->duration));
-			util_calc_rotations(&ctx.get_skeleton(), clip, time_to_evaluate_sequence, remap, *ctx.pose, loop);
+			sync.write_to_update_time(SyncOption, 0.5 /*TODO*/, owner, Percentage(anim_time, clip->duration),
+									 clip->duration);
+			sample_clip(ctx, clip, time_to_evaluate_sequence, remap, *ctx.pose, loop);
 		}
 	}
 	// unsynced update
@@ -253,7 +279,7 @@ static void get_clip_pose_shared(agGetPoseCtx& ctx, const AnimationSeq* clip, bo
 				stopped_flag = true;
 			}
 		}
-		util_calc_rotations(&ctx.get_skeleton(), clip, time_to_evaluate_sequence, remap, *ctx.pose, loop);
+		sample_clip(ctx, clip, time_to_evaluate_sequence, remap, *ctx.pose, loop);
 	}
 }
 
@@ -336,11 +362,12 @@ void agSaveCachedPose::get_pose(agGetPoseCtx& ctx) {
 	ASSERT(input && "agSaveCachedPose: no input set");
 	const uint64_t frame = ctx.object.get_eval_frame_id();
 	if (frame != evaluatedFrame) {
-		input->get_pose(ctx);
-		cachedPose = *ctx.pose;
+		ctx.evaluate(input);
+		cachedPose.resize(ctx.get_num_bones());
+		cachedPose.copy_from(*ctx.pose);
 		evaluatedFrame = frame;
 	} else {
-		*ctx.pose = cachedPose;
+		ctx.pose->copy_from(cachedPose);
 	}
 }
 
@@ -449,9 +476,12 @@ void agMakeAdditive::get_pose(agGetPoseCtx& ctx) {
 	agGetPoseCtx refCtx(ctx);
 	reference->get_pose(refCtx);
 
-	const int nb = ctx.get_num_bones();
-	Pose& delta = *ctx.pose;
-	util_subtract(nb, *refCtx.pose, delta); // delta = motion - reference
+	make_delta(ctx.get_num_bones(), *refCtx.pose, *ctx.pose);
+	ctx.debug_exit();
+}
+
+void agMakeAdditive::make_delta(int nb, const Pose& reference, Pose& delta) const {
+	util_subtract(nb, reference, delta); // delta = motion - reference
 
 	// Zero the delta on masked bones so a later agAddNode leaves them untouched
 	// (identity rotation, zero translation, zero scale-delta == no change in util_add).
@@ -462,7 +492,6 @@ void agMakeAdditive::get_pose(agGetPoseCtx& ctx) {
 			delta.scale[i] = 0.f;
 		}
 	}
-	ctx.debug_exit();
 }
 
 void agMakeAdditive::init_mask(const Model* model) {
@@ -494,11 +523,17 @@ SyncGroupData& agGetPoseCtx::find_sync_group(StringName name) const {
 	return object.find_or_create_sync_group(name);
 }
 
+int ValueType::get_slot(agGetPoseCtx& ctx) {
+	if (slot == -1)
+		slot = ctx.object.find_variable_slot(std::get<StringName>(value));
+	return slot;
+}
+
 float ValueType::get_float(agGetPoseCtx& ctx) {
 	if (std::holds_alternative<float>(value))
 		return std::get<float>(value);
 	else if (std::holds_alternative<StringName>(value))
-		return ctx.get_float_var(std::get<StringName>(value));
+		return ctx.get_float_var(get_slot(ctx), std::get<StringName>(value));
 	throw std::runtime_error("ValueType::get_float: doesn't hold float");
 }
 
@@ -506,7 +541,7 @@ int ValueType::get_int(agGetPoseCtx& ctx) {
 	if (std::holds_alternative<int>(value))
 		return std::get<int>(value);
 	else if (std::holds_alternative<StringName>(value))
-		return ctx.get_int_var(std::get<StringName>(value));
+		return ctx.get_int_var(get_slot(ctx), std::get<StringName>(value));
 	throw std::runtime_error("ValueType::get_int: doesn't hold int");
 }
 
@@ -514,7 +549,7 @@ int ValueType::get_bool(agGetPoseCtx& ctx) {
 	if (std::holds_alternative<bool>(value))
 		return std::get<bool>(value);
 	else if (std::holds_alternative<StringName>(value))
-		return ctx.get_bool_var(std::get<StringName>(value));
+		return ctx.get_bool_var(get_slot(ctx), std::get<StringName>(value));
 	throw std::runtime_error("ValueType::get_bool: doesn't hold bool");
 }
 
@@ -522,7 +557,7 @@ glm::vec3 ValueType::get_vec3(agGetPoseCtx& ctx) {
 	if (std::holds_alternative<glm::vec3>(value))
 		return std::get<glm::vec3>(value);
 	else if (std::holds_alternative<StringName>(value))
-		return ctx.get_vec3_var(std::get<StringName>(value));
+		return ctx.get_vec3_var(get_slot(ctx), std::get<StringName>(value));
 	throw std::runtime_error("ValueType::get_vec3: doesn't hold vec3");
 }
 
@@ -532,7 +567,7 @@ glm::quat ValueType::get_quat(agGetPoseCtx& ctx) {
 	else if (std::holds_alternative<glm::vec3>(value))
 		return glm::quat(std::get<glm::vec3>(value)); // inline euler radians
 	else if (std::holds_alternative<StringName>(value))
-		return ctx.get_quat_var(std::get<StringName>(value));
+		return ctx.get_quat_var(get_slot(ctx), std::get<StringName>(value));
 	throw std::runtime_error("ValueType::get_quat: doesn't hold a rotation");
 }
 
@@ -594,6 +629,11 @@ static void draw_ik_debug_visualization(const glm::mat4& ent_transform, Pose& po
 	Debug::add_text(ent_transform * glm::vec4(effector_pos, 1.0), buf, COLOR_WHITE, 0.0f, true);
 }
 void agIk2Bone::get_pose(agGetPoseCtx& ctx) {
+	input->get_pose(ctx);
+	apply(ctx);
+}
+
+void agIk2Bone::apply(agGetPoseCtx& ctx) {
 	if (!has_init) {
 		bone_idx = ctx.get_skeleton().get_bone_index(bone_name);
 		if (bone_idx == -1)
@@ -610,31 +650,20 @@ void agIk2Bone::get_pose(agGetPoseCtx& ctx) {
 		}
 		has_init = true;
 	}
-	if (bone_idx == -1 || (ik_in_bone_space && other_bone_idx == -1) || (pole_in_bone_space && pole_bone_idx == -1)) {
-		input->get_pose(ctx);
+	if (bone_idx == -1 || (ik_in_bone_space && other_bone_idx == -1) || (pole_in_bone_space && pole_bone_idx == -1))
 		return;
-	}
 	const float alphaVal = alpha.get_float(ctx);
 	vec3 tagetVec = target.get_vec3(ctx);
 	vec3 poleVec = pole.get_vec3(ctx);
 
-	if (alphaVal <= 0.00001f) {
-		input->get_pose(ctx);
+	if (alphaVal <= 0.00001f)
 		return;
-	}
-
-	input->get_pose(ctx);
 
 	// Capture pre-IK pose for alpha blend-back; avoid re-evaluating input.
-	Pose prePose;
 	const bool partial = alphaVal < 0.99999f;
-	if (partial) {
-		const int nb = ctx.get_num_bones();
-		Pose& cur = *ctx.pose;
-		std::memcpy(prePose.q,     cur.q,     sizeof(glm::quat) * nb);
-		std::memcpy(prePose.pos,   cur.pos,   sizeof(glm::vec3) * nb);
-		std::memcpy(prePose.scale, cur.scale, sizeof(float)      * nb);
-	}
+	ScopedPose prePose(ctx.pose.get_parent(), partial ? ctx.get_num_bones() : 0);
+	if (partial)
+		prePose->copy_from(*ctx.pose);
 	auto& pose = *ctx.pose;
 	// build up global matrix when needed instead of recreating it every step
 	// not sure if this is optimal, should profile different ways to pass around pose
@@ -746,7 +775,7 @@ void agIk2Bone::get_pose(agGetPoseCtx& ctx) {
 	}
 
 	if (partial)
-		util_blend(ctx.get_num_bones(), prePose, *ctx.pose, alphaVal);
+		util_blend(ctx.get_num_bones(), *prePose, *ctx.pose, alphaVal);
 }
 
 void agModifyBone::reset() {
@@ -754,24 +783,24 @@ void agModifyBone::reset() {
 }
 
 void agModifyBone::get_pose(agGetPoseCtx& ctx) {
+	input->get_pose(ctx);
+	apply(ctx);
+}
+
+void agModifyBone::apply(agGetPoseCtx& ctx) {
 	if (!has_init) {
 		bone_index = ctx.get_skeleton().get_bone_index(boneName);
 		if (bone_index == -1)
 			sys_print(Error, "agModifyBone::get_pose: no bone found '%s'\n", boneName.get_c_str());
 		has_init = true;
 	}
-	if (bone_index == -1) {
-		input->get_pose(ctx);
+	if (bone_index == -1)
 		return;
-	}
 
 	const float alphaVal = alpha.get_float(ctx);
-	if (alphaVal <= 0.00001f) {
-		input->get_pose(ctx);
+	if (alphaVal <= 0.00001f)
 		return;
-	}
 
-	input->get_pose(ctx);
 	const int B = bone_index;
 	const MSkeleton& skel = ctx.get_skeleton();
 	Pose& pose = *ctx.pose;
@@ -871,6 +900,11 @@ void agCopyBone::reset() {
 }
 
 void agCopyBone::get_pose(agGetPoseCtx& ctx) {
+	input->get_pose(ctx);
+	apply(ctx);
+}
+
+void agCopyBone::apply(agGetPoseCtx& ctx) {
 	if (!has_init) {
 		source_bone_idx = ctx.get_skeleton().get_bone_index(sourceBone);
 		target_bone_idx = ctx.get_skeleton().get_bone_index(targetBone);
@@ -879,18 +913,12 @@ void agCopyBone::get_pose(agGetPoseCtx& ctx) {
 				sourceBone.get_c_str(), targetBone.get_c_str());
 		has_init = true;
 	}
-	if (source_bone_idx == -1 || target_bone_idx == -1) {
-		input->get_pose(ctx);
+	if (source_bone_idx == -1 || target_bone_idx == -1)
 		return;
-	}
 
 	const float alphaVal = alpha.get_float(ctx);
-	if (alphaVal <= 0.00001f) {
-		input->get_pose(ctx);
+	if (alphaVal <= 0.00001f)
 		return;
-	}
-
-	input->get_pose(ctx);
 
 	const bool doRot   = copyRotation.get_bool(ctx);
 	const bool doTrans = copyTranslation.get_bool(ctx);
@@ -964,6 +992,53 @@ int agGetPoseCtx::get_int_var(StringName name) const {
 	throw std::runtime_error("no variable exists");
 }
 
+float agGetPoseCtx::get_float_var(int slot, StringName name) const {
+	auto var = object.get_float_slot(slot);
+	if (var.has_value())
+		return var.value();
+	sys_print(Error, "agGetPoseCtx::get_float_var: no variable exists: %s\n", name.get_c_str());
+
+	return 0.f;
+}
+
+glm::vec3 agGetPoseCtx::get_vec3_var(int slot, StringName name) const {
+	auto var = object.get_vec3_slot(slot);
+	if (var.has_value())
+		return var.value();
+	sys_print(Error, "agGetPoseCtx::get_vec3_var: no variable exists: %s\n", name.get_c_str());
+	throw std::runtime_error("no variable exists");
+}
+
+glm::quat agGetPoseCtx::get_quat_var(int slot, StringName name) const {
+	auto var = object.get_quat_slot(slot);
+	if (var.has_value())
+		return var.value();
+	sys_print(Error, "agGetPoseCtx::get_quat_var: no variable exists: %s\n", name.get_c_str());
+	throw std::runtime_error("no variable exists");
+}
+
+bool agGetPoseCtx::get_bool_var(int slot, StringName name) const {
+	auto var = object.get_bool_slot(slot);
+	if (var.has_value())
+		return var.value();
+	sys_print(Error, "agGetPoseCtx::get_bool_var: no variable exists: %s\n", name.get_c_str());
+	throw std::runtime_error("no variable exists");
+}
+
+int agGetPoseCtx::get_int_var(int slot, StringName name) const {
+	auto var = object.get_int_slot(slot);
+	if (var.has_value())
+		return var.value();
+	sys_print(Error, "agGetPoseCtx::get_int_var: no variable exists: %s\n", name.get_c_str());
+	throw std::runtime_error("no variable exists");
+}
+
+void agGetPoseCtx::evaluate(agBaseNode* node) {
+	agGraphProgram* program = object.get_graph_program();
+	if (!program || !program->run(node, *this))
+		node->get_pose(*this);
+}
+
 void agBlendMasked::reset() {
 	input0->reset();
 	input1->reset();
@@ -988,15 +1063,18 @@ void agBlendMasked::get_pose(agGetPoseCtx& ctx) {
 		input0->get_pose(basePose);
 		input1->get_pose(ctx);
 		ctx.weight = basePose.weight;
-		if (meshspace_blend) {
-			util_global_blend(&ctx.get_skeleton(), &(*basePose.pose), &(*ctx.pose), alpha_val, maskWeights);
-		} else {
-			util_blend_with_mask(ctx.get_num_bones(), (*basePose.pose), (*ctx.pose), alpha_val, maskWeights);
-		}
+		blend_layer(ctx.get_skeleton(), *basePose.pose, *ctx.pose, alpha_val);
 	}
 	ctx.debug_exit();
 }
 
+void agBlendMasked::blend_layer(const MSkeleton& skel, const Pose& base, Pose& layer, float alpha) const {
+	if (meshspace_blend)
+		util_global_blend(&skel, &base, &layer, alpha, maskWeights);
+	else
+		util_blend_with_mask(skel.get_num_bones(), base, layer, alpha, maskWeights);
+}
+
 void agBlendMasked::init_mask_for_model(const Model* model, float default_weight) {
 	assert(model);
 	maskWeights.resize(model->get_skel()->get_num_bones(), default_weight);
@@ -1028,10 +1106,7 @@ void agBlendMasked::set_one_bone_weight(const Model* model, string bone, float w
 void agStatemachineBase::reset() {
 	currentTree = nullptr;
 	curTime = 0.0;
-	if (blendingOut) {
-		g_pose_pool.free(blendingOut);
-		blendingOut = nullptr;
-	}
+	blendingOut = nullptr;
 }
 
 void agStatemachineBase::get_pose(agGetPoseCtx& ctx) {
@@ -1056,7 +1131,7 @@ void agStatemachineBase::get_pose(agGetPoseCtx& ctx) {
 	} else {
 		ctx.debug_enter("agStatemachineBase");
 	}
-	currentTree->get_pose(ctx);
+	ctx.evaluate(currentTree);
 	// ctx is a reference to the caller's context (not a copy); weight must only
 	// propagate downward into children, so restore it before returning -- otherwise
 	// a sibling node evaluated after us on the same ctx (or the parent itself) would
@@ -1074,7 +1149,6 @@ void agStatemachineBase::get_pose(agGetPoseCtx& ctx) {
 				   1.0 - alpha); // blend the last transition pose to the cur tree
 
 		if (curTransitionTime >= curTransitionDuration) {
-			g_pose_pool.free(blendingOut);
 			blendingOut = nullptr;
 			//sys_print(Debug, "agStatemachineBase: transition end\n");
 		} else {
@@ -1091,13 +1165,11 @@ void agStatemachineBase::get_pose(agGetPoseCtx& ctx) {
 		//sys_print(Debug, "agStatemachineBase: transition\n");
 		if (blendingOut) {
 		//	sys_print(Debug, "agStatemachineBase: transition interrupted\n");
-		} else {
-			blendingOut = g_pose_pool.allocate();
 		}
-		auto& curPose = *ctx.pose;
-		std::memcpy(blendingOut->pos, curPose.pos, sizeof(glm::vec3) * ctx.get_num_bones());
-		std::memcpy(blendingOut->q, curPose.q, sizeof(glm::quat) * ctx.get_num_bones());
-		std::memcpy(blendingOut->scale, curPose.scale, sizeof(float) * ctx.get_num_bones());
+		// sized once, reused by every later transition of this node
+		blendingOutPose.resize(ctx.get_num_bones());
+		blendingOutPose.copy_from(*ctx.pose);
+		blendingOut = &blendingOutPose;
 	}
 }
 
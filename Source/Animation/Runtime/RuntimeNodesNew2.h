@@ -26,6 +26,12 @@ struct ValueType
 	glm::quat get_quat(agGetPoseCtx& ctx);
 
 	variant<bool, int, float, glm::vec3, glm::quat, StringName> value;
+	// the animator's variable slot for a StringName value, resolved on the first read so later reads skip the name
+	// lookup. Nodes belong to one AnimatorObject, so the slot stays valid.
+	int slot = -1;
+
+private:
+	int get_slot(agGetPoseCtx& ctx);
 };
 
 
@@ -36,10 +42,13 @@ class agGetPoseCtx : public ClassBase
 public:
 	CLASS_BODY(agGetPoseCtx);
 
-	agGetPoseCtx(AnimatorObject& obj, Pool_Allocator<Pose>& allocator, float dt)
-		: object(obj), pose(allocator.allocate_scoped()), dt(dt) {}
+	agGetPoseCtx(AnimatorObject& obj, PoseArena& allocator, float dt)
+		: pose(allocator, obj.get_skel()->get_num_bones()), object(obj), dt(dt) {}
 	agGetPoseCtx(const agGetPoseCtx& other)
-		: object(other.object), pose(other.pose.get_parent().allocate_scoped()), dt(other.dt) {}
+		: pose(other.pose.get_parent(), other.pose->get_num_bones()), object(other.object), dt(other.dt) {}
+	// writes into target instead of a pose of its own (the graph program's registers)
+	agGetPoseCtx(AnimatorObject& obj, PoseArena& allocator, Pose& target, float dt)
+		: pose(allocator, target), object(obj), dt(dt) {}
 
 	agGetPoseCtx& operator=(const agGetPoseCtx& other) = delete;
 
@@ -48,6 +57,15 @@ public:
 	glm::quat get_quat_var(StringName name) const;
 	bool get_bool_var(StringName name) const;
 	int get_int_var(StringName name) const;
+	// by slot (AnimatorObject::find_variable_slot), name is only for the error message
+	float get_float_var(int slot, StringName name) const;
+	glm::vec3 get_vec3_var(int slot, StringName name) const;
+	glm::quat get_quat_var(int slot, StringName name) const;
+	bool get_bool_var(int slot, StringName name) const;
+	int get_int_var(int slot, StringName name) const;
+	// evaluates node into pose. Goes through the animator's graph program when it has node compiled, nodes that
+	// evaluate a subgraph chosen at runtime (statemachines, cached poses) call this instead of node->get_pose
+	void evaluate(agBaseNode* node);
 	bool is_event_active(const ClassTypeInfo& info) const;
 	bool did_event_start(const ClassTypeInfo& info) const;
 	bool did_event_end(const ClassTypeInfo& info) const;
@@ -59,7 +77,7 @@ public:
 	void debug_enter(string msg) { object.debug_enter_node(msg); }
 	void debug_exit() { object.debug_exit_node(); }
 
-	ScopedPoolPtr<Pose> pose;
+	ScopedPose pose;
 	AnimatorObject& object;
 	// agSampledAnimEvents& events;
 	float weight = 1.f;
@@ -179,6 +197,9 @@ public:
 	REF void set_all_children_weights(const Model* model, string bone, float weight);
 	REF void set_one_bone_weight(const Model* model, string bone, float weight);
 
+	// layer = masked blend of base toward layer, what get_pose does once both inputs are evaluated
+	void blend_layer(const MSkeleton& skel, const Pose& base, Pose& layer, float alpha) const;
+
 private:
 	std::vector<float> maskWeights;
 };
@@ -209,6 +230,8 @@ public:
 
 	REF void init_mask(const Model* model);                            // all bones contribute by default
 	REF void mask_bone_and_children(const Model* model, string bone);  // zero the delta for bone + descendants
+	// delta = delta - reference, masked bones zeroed
+	void make_delta(int num_bones, const Pose& reference, Pose& delta) const;
 
 	agBaseNode* input = nullptr;      // the motion clip
 	agBaseNode* reference = nullptr;  // pose subtracted from input (e.g. first frame of the motion)
@@ -223,6 +246,8 @@ public:
 	void reset() final;
 	void get_pose(agGetPoseCtx& ctx) final;
 	void refresh_after_model_reload(Model* reloaded) final;
+	// the IK on its own, ctx.pose already holds input's pose
+	void apply(agGetPoseCtx& ctx);
 
 	agBaseNode* input = nullptr;
 	StringName bone_name; // bone that is being IK'd
@@ -257,6 +282,8 @@ public:
 	void reset() final;
 	void get_pose(agGetPoseCtx& ctx) final;
 	void refresh_after_model_reload(Model* reloaded) final;
+	// ctx.pose already holds input's pose
+	void apply(agGetPoseCtx& ctx);
 
 	agBaseNode* input = nullptr;
 	ValueType translationVal = glm::vec3(0.f);
@@ -279,6 +306,8 @@ public:
 	void reset() final;
 	void get_pose(agGetPoseCtx& ctx) final;
 	void refresh_after_model_reload(Model* reloaded) final;
+	// ctx.pose already holds input's pose
+	void apply(agGetPoseCtx& ctx);
 	agBaseNode* input = nullptr;
 	StringName sourceBone;
 	StringName targetBone;
@@ -504,6 +533,7 @@ public:
 
 		trees.push_back(tree);
 	}
+	const std::vector<agBaseNode*>& get_trees() const { return trees; }
 
 private:
 	std::vector<agBaseNode*> trees;
@@ -514,7 +544,8 @@ private:
 	Easing curTransition{};
 	float curTransitionDuration = 0.0;
 	float curTransitionTime = 0.0;
-	Pose* blendingOut = nullptr;
+	Pose* blendingOut = nullptr; // points at blendingOutPose while transitioning
+	PoseBuffer blendingOutPose;
 };
 
 // Unreal's "Save Cached Pose": wraps a subgraph and evaluates it at most once per frame,
@@ -533,7 +564,7 @@ public:
 
 private:
 	StringName cacheName;
-	Pose cachedPose{};
+	PoseBuffer cachedPose;
 	uint64_t evaluatedFrame = UINT64_MAX;
 };
 
@@ -22,6 +22,7 @@ struct SyncGroupData
 	// thse are updated as the graph updates by checking if the node's weight is heigher than the current
 	// post graph update, the last_time is copied to time for the next round of updates
 	Percentage update_time;
+	float update_duration = 0.f; // seconds the owner takes for the full normalized range, 0 if unknown
 	StringName update_sync_marker_name;
 	bool update_has_sync_marker = false;
 
@@ -54,11 +55,13 @@ struct SyncGroupData
 		else
 			return false;
 	}
-	void write_to_update_time(sync_opt option, float new_update_weight, const Node_CFG* node, Percentage newtime) {
+	void write_to_update_time(sync_opt option, float new_update_weight, const Node_CFG* node, Percentage newtime,
+							  float duration = 0.f) {
 		this->update_owner = node;
 		this->update_weight = new_update_weight;
 		this->update_owner_synctype = option;
 		this->update_time = newtime;
+		this->update_duration = duration;
 		this->update_has_sync_marker = false; // TODO
 	}
 };
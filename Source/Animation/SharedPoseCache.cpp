@@ -0,0 +1,93 @@
+#include "Animation/SharedPoseCache.h"
+#include "Animation/AnimationTypes.h"
+#include <cmath>
+
+SharedPoseCache& SharedPoseCache::get() {
+	static SharedPoseCache inst;
+	return inst;
+}
+
+SharedPoseCache::SharedPoseCache() = default;
+SharedPoseCache::~SharedPoseCache() = default;
+
+uint64_t SharedPoseKey::hash() const {
+	// splitmix style mixing, the pointers alone are aligned and cluster
+	auto mix = [](uint64_t h, uint64_t v) {
+		h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		h ^= h >> 31;
+		h *= 0xbf58476d1ce4e5b9ull;
+		return h ^ (h >> 27);
+	};
+	uint64_t h = mix(0, (uint64_t)(uintptr_t)skeleton);
+	h = mix(h, (uint64_t)(uintptr_t)clip);
+	h = mix(h, (uint64_t)(uint32_t)time_step);
+	return mix(h, state);
+}
+
+void SharedPoseCache::begin_frame(float dt, const SharedPoseCacheSettings& new_settings) {
+	settings = new_settings;
+	if (settings.time_step <= 0.f)
+		settings.time_step = 1.f / 30.f;
+	clock += dt;
+	for (Shard& s : shards) {
+		s.index.clear();
+		s.num_used = 0;
+	}
+	hits = 0;
+	misses = 0;
+}
+
+int32_t SharedPoseCache::quantize_time(float time) const {
+	return (int32_t)std::floor(time / settings.time_step + 0.5f);
+}
+
+bool SharedPoseCache::find(const SharedPoseKey& key, Pose& out) {
+	Shard& s = get_shard(key);
+	std::lock_guard<std::mutex> lock(s.lock);
+	auto it = s.index.find(key);
+	if (it == s.index.end()) {
+		misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	const Pose& pose = *s.poses[it->second];
+	if (pose.get_num_bones() != out.get_num_bones()) {
+		misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	out.copy_from(pose);
+	hits.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void SharedPoseCache::store(const SharedPoseKey& key, const Pose& pose) {
+	Shard& s = get_shard(key);
+	std::lock_guard<std::mutex> lock(s.lock);
+	if (s.index.find(key) != s.index.end())
+		return;
+	if (s.num_used == (int)s.poses.size())
+		s.poses.push_back(std::make_unique<PoseBuffer>());
+	PoseBuffer& buffer = *s.poses[s.num_used];
+	buffer.resize(pose.get_num_bones());
+	buffer.copy_from(pose);
+	s.index.insert({key, s.num_used++});
+}
+
+float SharedPoseCache::snap_phase(float phase, float duration) const {
+	return shared_phase_snap(phase, duration, clock, settings.num_phases);
+}
+
+int SharedPoseCache::get_num_poses() const {
+	int count = 0;
+	for (const Shard& s : shards)
+		count += s.num_used;
+	return count;
+}
+
+float shared_phase_snap(float phase, float duration, double clock, int num_phases) {
+	if (duration <= 0.f || num_phases <= 0)
+		return phase;
+	const double base = clock / duration - std::floor(clock / duration);
+	const double offset = std::round((phase - base) * num_phases) / num_phases;
+	const double snapped = base + offset;
+	return (float)(snapped - std::floor(snapped));
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Pose;
+class PoseBuffer;
+
+// Clip samples shared between animators for one frame. A crowd playing the same clips samples each (skeleton, clip,
+// time) once: animators that opted in round their sample time to the cache's time step, look the result up and copy
+// it out instead of decompressing the clip again, so the sampling cost follows the number of distinct states instead
+// of the number of animators. The key's state hash covers whatever else changes the sampled pose (retarget map,
+// looping).
+//
+// GameAnimationMgr calls begin_frame() before evaluating animators, which drops last frame's poses (their buffers
+// are reused). find/store are safe to call from the parallel animator update. Disabled until begin_frame() enables
+// it, so animators updated outside the manager (editor tools) never touch it.
+struct SharedPoseKey
+{
+	const void* skeleton = nullptr;
+	const void* clip = nullptr;
+	int32_t time_step = 0;
+	uint32_t state = 0;
+
+	bool operator==(const SharedPoseKey& other) const {
+		return skeleton == other.skeleton && clip == other.clip && time_step == other.time_step &&
+			   state == other.state;
+	}
+	uint64_t hash() const;
+};
+
+struct SharedPoseCacheSettings
+{
+	bool enabled = false;
+	float time_step = 1.f / 30.f; // seconds, samples within half a step of each other share a pose
+	int num_phases = 32;		  // phases per clip that sync groups snap to, 0 disables snapping
+};
+
+class SharedPoseCache
+{
+public:
+	static SharedPoseCache& get();
+
+	SharedPoseCache();
+	~SharedPoseCache();
+
+	// dt advances the clock the snap phases move with
+	void begin_frame(float dt, const SharedPoseCacheSettings& settings);
+	bool is_enabled() const { return settings.enabled; }
+
+	int32_t quantize_time(float time) const;
+	float get_step_time(int32_t time_step) const { return time_step * settings.time_step; }
+
+	// copies the stored pose into out, false if nobody sampled key this frame
+	bool find(const SharedPoseKey& key, Pose& out);
+	// first store of a key wins, a later one (two animators missed at once) is dropped
+	void store(const SharedPoseKey& key, const Pose& pose);
+
+	// normalized phase moved to the nearest of num_phases shared phases of a clip with this duration. The phases move
+	// with the clock at the clip's rate, so groups started on different frames still land on the same ones.
+	float snap_phase(float phase, float duration) const;
+
+	int get_num_poses() const;
+	int get_num_hits() const { return hits.load(std::memory_order_relaxed); }
+	int get_num_misses() const { return misses.load(std::memory_order_relaxed); }
+
+private:
+	static const int NUM_SHARDS = 16;
+	struct KeyHash
+	{
+		size_t operator()(const SharedPoseKey& k) const { return (size_t)k.hash(); }
+	};
+	struct Shard
+	{
+		std::mutex lock;
+		std::unordered_map<SharedPoseKey, int, KeyHash> index;
+		std::vector<std::unique_ptr<PoseBuffer>> poses;
+		int num_used = 0;
+	};
+	Shard& get_shard(const SharedPoseKey& key) { return shards[key.hash() % NUM_SHARDS]; }
+
+	Shard shards[NUM_SHARDS];
+	SharedPoseCacheSettings settings;
+	double clock = 0.0;
+	std::atomic<int> hits = 0;
+	std::atomic<int> misses = 0;
+};
+
+// the nearest shared phase to phase, num_phases of them spaced evenly and offset by clock/duration
+float shared_phase_snap(float phase, float duration, double clock, int num_phases);
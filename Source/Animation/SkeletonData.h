@@ -7,6 +7,7 @@
 #include "Framework/StringName.h"
 #include "AnimEvent.h"
 #include "AnimationTypes.h"
+#include "AnimationCompression.h"
 #include "Runtime/Easing.h"
 #include "Framework/ConsoleCmdGroup.h"
 
@@ -45,6 +46,8 @@ public:
 	int num_frames = 0;
 	std::vector<ChannelOffset> channel_offsets;
 	std::vector<float> pose_data;
+	// loaded clips keep their pose data here instead, channel_offsets/pose_data are then empty
+	CompressedAnimClip compressed;
 	bool is_additive_clip = false;
 	float duration = 0.0;
 	float fps = 30.0;
@@ -59,7 +62,10 @@ public:
 	int get_num_keyframes_inclusive() const { return num_frames + 1; }
 	int get_num_keyframes_exclusive() const { return num_frames; }
 	bool is_pose_clip() const { return num_frames == 1; }
-	uint32_t get_num_channels() const { return channel_offsets.size(); }
+	uint32_t get_num_channels() const {
+		return is_compressed() ? compressed.channels.size() : channel_offsets.size();
+	}
+	bool is_compressed() const { return !compressed.empty(); }
 	double get_clip_play_speed_for_linear_velocity(float velocity) const {
 		return (average_linear_velocity >= 0.000001) ? velocity / average_linear_velocity : 0.0;
 	}
@@ -102,6 +102,8 @@ public:
 	REF int prune_disconnected_islands_min_lod = 1; // auto-LOD level (1-based) at which meshopt is allowed to drop disconnected islands; 0 disables pruning entirely
 
 	REF float animations_set_fps = 30.0;
+	REF bool compressAnimations = true;
+	REF float animationCompressionError = 0.0005f; // max bone space error in meters, 10cm from the joint
 
 	REF BoneRenameContainer bone_rename;
 	REF BoneReparentContainer bone_reparent;
@@ -480,7 +480,7 @@ void ModelCompileHelper::append_animation_seq_to_list(AnimationSourceToCompile s
 
 void ModelCompileHelper::subtract_clips(const int num_bones, AnimationSeq* target, const AnimationSeq* source, int ref_frame) {
 	ref_frame = glm::clamp(ref_frame, 0, std::max(0, source->get_num_keyframes_inclusive() - 1));
-	Pose ref_pose;
+	PoseBuffer ref_pose(num_bones);
 	for (int i = 0; i < num_bones; i++) {
 		ScalePositionRot transform = source->get_keyframe(i, ref_frame, 0.0);
 		ref_pose.pos[i] = transform.pos;
@@ -716,4 +716,58 @@ ProcessNodesAndMeshOutput process_nodes_and_mesh(cgltf_data* data, const Skeleto
 	return output;
 }
 
+ConfigVar mod_meshlets("mod.meshlets", "1", CVAR_BOOL, "split model parts into culling chunks");
+
+void build_submesh_meshlets(FinalModelData& finalmod, Submesh& part) {
+	part.meshlet_ofs = (int)finalmod.chunks.size();
+	part.meshlet_count = 0;
+	if (!mod_meshlets.get_bool() || part.element_count == 0)
+		return;
+
+	const int index_start = part.element_offset / sizeof(uint16_t);
+	uint16_t* part_indicies = &finalmod.indicies.at(index_start);
+	const std::vector<unsigned> source(part_indicies, part_indicies + part.element_count);
+	size_t vertex_count = 0;
+	for (unsigned index : source)
+		vertex_count = std::max(vertex_count, size_t(index) + 1);
+	const float* positions = &finalmod.verticies.at(part.base_vertex).pos.x;
+
+	const size_t max_meshlets =
+		meshopt_buildMeshletsBound(source.size(), Chunk::MAX_VERTICES, Chunk::MAX_TRIANGLES);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned> meshlet_verticies(max_meshlets * Chunk::MAX_VERTICES);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * Chunk::MAX_TRIANGLES * 3);
+	const size_t num_meshlets = meshopt_buildMeshlets(
+		meshlets.data(), meshlet_verticies.data(), meshlet_triangles.data(), source.data(), source.size(), positions,
+		vertex_count, sizeof(ModelVertex), Chunk::MAX_VERTICES, Chunk::MAX_TRIANGLES, 0.25f /* cone weight */);
+
+	// rewrite the part's indicies in chunk order, each chunk is then a contiguous range
+	std::vector<uint16_t> reordered;
+	reordered.reserve(source.size());
+	std::vector<Chunk> chunks;
+	chunks.reserve(num_meshlets);
+	for (size_t i = 0; i < num_meshlets; i++) {
+		const meshopt_Meshlet& m = meshlets[i];
+		const meshopt_Bounds b =
+			meshopt_computeMeshletBounds(&meshlet_verticies[m.vertex_offset], &meshlet_triangles[m.triangle_offset],
+										 m.triangle_count, positions, vertex_count, sizeof(ModelVertex));
+		Chunk c{};
+		c.bounding_sphere = glm::vec4(b.center[0], b.center[1], b.center[2], b.radius);
+		c.cone = pack_chunk_cone(b.cone_axis_s8, b.cone_cutoff_s8);
+		c.offset = index_start + (uint32_t)reordered.size();
+		c.count = m.triangle_count * 3;
+		for (unsigned j = 0; j < m.triangle_count * 3; j++)
+			reordered.push_back((uint16_t)meshlet_verticies[m.vertex_offset + meshlet_triangles[m.triangle_offset + j]]);
+		chunks.push_back(c);
+	}
+	if (reordered.size() != source.size()) {
+		sys_print(Warning, "build_submesh_meshlets: chunks have %d indicies, part has %d, leaving part unsplit\n",
+				  (int)reordered.size(), (int)source.size());
+		return;
+	}
+	std::copy(reordered.begin(), reordered.end(), part_indicies);
+	finalmod.chunks.insert(finalmod.chunks.end(), chunks.begin(), chunks.end());
+	part.meshlet_count = (int)chunks.size();
+}
+
 #endif
@@ -13,6 +13,7 @@
 #include <algorithm>
 
 #include "Animation/AnimationUtil.h"
+#include "Animation/AnimationCompression.h"
 
 #include "Framework/BinaryReadWrite.h"
 #include "Physics/Physics2.h"
@@ -459,6 +460,7 @@ static FinalModelData create_final_model_data(const FinalSkeletonOutput* skel, c
 				auto& my_submesh = final_mod.submeshes.back();
 				my_submesh.base_vertex = submesh.base_vertex;
 			}
+			build_submesh_meshlets(final_mod, final_mod.submeshes.back());
 		}
 		out_lod.part_count = final_mod.submeshes.size() - out_lod.part_ofs;
 
@@ -481,7 +483,7 @@ static FinalModelData create_final_model_data(const FinalSkeletonOutput* skel, c
 }
 
 static bool write_out_compilied_model(const std::string& gamepath, const FinalModelData* model,
-							   const FinalSkeletonOutput* skel) {
+							   const FinalSkeletonOutput* skel, const ModelDefData& def) {
 	FileWriter out;
 	out.write_int32('CMDL');
 	out.write_int32(MODEL_VERSION);
@@ -514,6 +516,8 @@ static bool write_out_compilied_model(const std::string& gamepath, const FinalMo
 		out.write_struct(&model->tags[i].transform);
 		out.write_int32(model->tags[i].bone_index);
 	}
+	out.write_int32(model->chunks.size());
+	out.write_bytes_ptr((uint8_t*)model->chunks.data(), model->chunks.size() * sizeof(Chunk));
 
 	size_t marker = out.tell();
 	out.write_int32(model->indicies.size());
@@ -555,6 +559,9 @@ static bool write_out_compilied_model(const std::string& gamepath, const FinalMo
 
 	size_t skel_size = 0;
 	size_t animation_size = 0;
+	size_t raw_animation_size = 0;
+	float worst_anim_error = 0.f;
+	const std::string* worst_anim_clip = nullptr;
 
 	if (!skel)
 		out.write_int32(0);
@@ -586,13 +593,51 @@ static bool write_out_compilied_model(const std::string& gamepath, const FinalMo
 			out.write_byte(seq.second.has_rootmotion);
 
 			assert(seq.second.channel_offsets.size() == skel->bones.size());
-			out.write_bytes_ptr((uint8_t*)seq.second.channel_offsets.data(),
-								seq.second.channel_offsets.size() * sizeof(ChannelOffset));
+			raw_animation_size +=
+				seq.second.channel_offsets.size() * sizeof(ChannelOffset) + seq.second.pose_data.size() * sizeof(float);
+
+			AnimCompressionSettings settings;
+			settings.max_error = def.anim_compression_error;
+			CompressedAnimClip compressed;
+			if (def.compress_animations)
+				compressed = compress_animation_clip(seq.second, settings);
+
+			out.write_byte(!compressed.empty());
+			if (!compressed.empty()) {
+				const AnimCompressionReport r = measure_compressed_clip(seq.second, compressed, settings.shell_distance);
+				sys_print(Debug, "    -clip %s: %d -> %d bytes (%.1fx), keys %d/%d, max error %.3fmm (bone %d, frame %d)\n",
+						  seq.first.c_str(), (int)r.raw_bytes, (int)r.compressed_bytes, r.ratio, r.kept_keys, r.total_keys,
+						  r.max_error * 1000.f, r.worst_channel, r.worst_keyframe);
+				if (r.max_error >= worst_anim_error) {
+					worst_anim_error = r.max_error;
+					worst_anim_clip = &seq.first;
+				}
+				if (r.max_error > settings.max_error) {
+					sys_print(Warning, "clip %s compressed error %.3fmm is over the %.3fmm bound (bone %s)\n",
+							  seq.first.c_str(), r.max_error * 1000.f, settings.max_error * 1000.f,
+							  skel->bones[r.worst_channel].strname.c_str());
+				}
 
-			out.write_int32(seq.second.pose_data.size());
-			out.write_bytes_ptr((uint8_t*)seq.second.pose_data.data(), seq.second.pose_data.size() * sizeof(float));
+				out.write_bytes_ptr((uint8_t*)compressed.channels.data(),
+									compressed.channels.size() * sizeof(CompressedChannel));
+				out.write_int32(compressed.data.size());
+				out.write_bytes_ptr(compressed.data.data(), compressed.data.size());
+			} else {
+				out.write_bytes_ptr((uint8_t*)seq.second.channel_offsets.data(),
+									seq.second.channel_offsets.size() * sizeof(ChannelOffset));
+
+				out.write_int32(seq.second.pose_data.size());
+				out.write_bytes_ptr((uint8_t*)seq.second.pose_data.data(),
+									seq.second.pose_data.size() * sizeof(float));
+			}
 		}
 		animation_size = out.tell() - marker;
+		if (worst_anim_clip) {
+			sys_print(Info, "animation compression: %d -> %d bytes (%.1fx), worst error %.3fmm in %s\n",
+					  (int)raw_animation_size, (int)animation_size,
+					  float(raw_animation_size) / float(std::max(animation_size, size_t(1))), worst_anim_error * 1000.f,
+					  worst_anim_clip->c_str());
+		}
 
 		out.write_int32(skel->imported_models.size());
 		for (int i = 0; i < skel->imported_models.size(); i++)
@@ -614,8 +659,14 @@ static bool write_out_compilied_model(const std::string& gamepath, const FinalMo
 	sys_print(Debug, "Writing out model (%s) (size: %d)\n", gamepath.c_str(), (int)out.get_size());
 	sys_print(Debug, "    -vert bytes: %d\n", (int)vert_size);
 	sys_print(Debug, "    -index bytes: %d\n", (int)index_size);
+	size_t chunk_indicies = 0;
+	for (const Chunk& c : model->chunks)
+		chunk_indicies += c.count;
+	sys_print(Debug, "    -chunks: %d (%.1f triangles avg, %d bytes)\n", (int)model->chunks.size(),
+			  float(chunk_indicies / 3) / float(std::max(model->chunks.size(), size_t(1))),
+			  (int)(model->chunks.size() * sizeof(Chunk)));
 	sys_print(Debug, "    -bone bytes: %d\n", (int)skel_size);
-	sys_print(Debug, "    -anim bytes: %d\n", (int)animation_size);
+	sys_print(Debug, "    -anim bytes: %d (uncompressed: %d)\n", (int)animation_size, (int)raw_animation_size);
 
 	outfile->write(out.get_buffer(), out.get_size());
 	outfile->close();
@@ -666,7 +717,7 @@ ModelCompilier::Ret ModelCompileHelper::compile_model(const std::string& defname
 		create_final_model_data(final_skeleton.get(), final_material_names, post_traverse.meshout.material_is_used,
 								post_traverse.mcd, post_traverse.meshout.LOAD_bone_to_FINAL_bone, def);
 
-	bool res = write_out_compilied_model(finalpath, &final_model, final_skeleton.get());
+	bool res = write_out_compilied_model(finalpath, &final_model, final_skeleton.get(), def);
 
 	// Debug dump for skeleton diagnostics
 	if (final_skeleton) {
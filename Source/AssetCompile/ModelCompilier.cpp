@@ -92,6 +92,8 @@ ModelDefData new_import_settings_to_modeldef_data(const std::string& gamepath, M
 		}
 	}
 	mdd.override_fps = is->animations_set_fps;
+	mdd.compress_animations = is->compressAnimations;
+	mdd.anim_compression_error = is->animationCompressionError;
 
 	auto& boneRemap = is->bone_rename;
 	for (int i = 0; i < (int)boneRemap.remap.size() - 1; i += 2) {
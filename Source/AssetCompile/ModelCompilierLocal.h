@@ -132,6 +132,8 @@ public:
 	std::vector<WeightlistDef> weightlists;
 	float override_fps = 30.0;
 	bool apply_armature_transform = true;
+	bool compress_animations = true;
+	float anim_compression_error = 0.0005f; // see AnimCompressionSettings::max_error
 
 	// PHYSICS
 	std::vector<PhysicsCollisionShapeDefLoad> physicsshapes;
@@ -326,6 +328,7 @@ struct FinalModelData
 	std::vector<uint16_t> indicies;
 	std::vector<MeshLod> lods;
 	std::vector<Submesh> submeshes;
+	std::vector<Chunk> chunks; // see Submesh::meshlet_ofs
 	std::vector<std::string> material_names;
 	Bounds AABB;
 	std::vector<ModelTag> tags;
@@ -343,7 +346,7 @@ struct ProcessNodesAndMeshOutput
 	ProcessMeshOutput meshout;
 };
 
-constexpr int MODEL_VERSION = 19;
+constexpr int MODEL_VERSION = 21;
 
 struct cgltf_and_binary
 {
@@ -366,6 +369,8 @@ std::vector<ImportedSkeleton> read_animation_imports(const std::vector<int>& LOA
 													 const ModelDefData& data);
 ProcessNodesAndMeshOutput process_nodes_and_mesh(cgltf_data* data, const SkeletonCompileData* scd,
 												 const cgltf_skin* using_skin, const ModelDefData& def);
+// splits a finished part into chunks: reorders its indicies in finalmod and appends the chunks
+void build_submesh_meshlets(FinalModelData& finalmod, Submesh& part);
 
 // ModelCompileHelper: static methods implemented across split files
 #include "Compiliers.h"
@@ -2,7 +2,9 @@
 #include "AssetSizeViewer.h"
 #include "AssetRegistry.h"
 #include "AssetRegistryLocal.h"
+#include "AssetDatabase.h"
 #include "Framework/Files.h"
+#include "Render/Model.h"
 #include "imgui.h"
 #include <filesystem>
 #include <algorithm>
@@ -37,6 +39,16 @@ void AssetSizeViewer::refresh() {
 	all_assets.clear();
 	folder_groups.clear();
 	total_size = 0;
+	num_chunked_models = 0;
+	total_chunks = 0;
+	total_chunk_triangles = 0;
+
+	// chunk stats come from models that are already loaded, the viewer doesn't load anything itself
+	std::vector<IAsset*> loaded_models;
+	g_assets.get_assets_of_type(loaded_models, &Model::StaticType);
+	std::map<std::string, const Model*> models_by_path;
+	for (IAsset* a : loaded_models)
+		models_by_path[a->get_name()] = static_cast<const Model*>(a);
 
 	auto& reg = AssetRegistrySystem::get();
 	const auto& linear = reg.get_linear_list();
@@ -55,6 +67,16 @@ void AssetSizeViewer::refresh() {
 		sa.folder = get_folder(sa.path);
 		sa.size_bytes = sz;
 		sa.type_index = (int)node->asset.type->self_index;
+		auto model = models_by_path.find(sa.path);
+		if (model != models_by_path.end()) {
+			const Model* m = model->second;
+			sa.num_chunks = m->get_num_chunks();
+			for (int i = 0; i < m->get_num_chunks(); i++)
+				sa.num_chunk_triangles += m->get_chunks()[i].count / 3;
+			num_chunked_models += 1;
+			total_chunks += sa.num_chunks;
+			total_chunk_triangles += sa.num_chunk_triangles;
+		}
 		total_size += sz;
 		all_assets.push_back(std::move(sa));
 	}
@@ -94,6 +116,11 @@ void AssetSizeViewer::imgui_draw() {
 	ImGui::Text("Total: %s  (%zu assets)", format_size(total_size, buf, sizeof(buf)), all_assets.size());
 	ImGui::SameLine();
 	if (ImGui::Button("Refresh")) needs_refresh = true;
+	if (num_chunked_models > 0) {
+		const float avg = total_chunks > 0 ? float(total_chunk_triangles) / total_chunks : 0.f;
+		ImGui::Text("Chunks: %d in %d loaded models, %.1f triangles avg (%.0f%% full)", total_chunks,
+					num_chunked_models, avg, 100.f * avg / Chunk::MAX_TRIANGLES);
+	}
 	ImGui::Separator();
 
 	draw_treemap();
@@ -284,6 +311,8 @@ void AssetSizeViewer::draw_treemap() {
 					if (asset->type_index < (int)types.size())
 						ImGui::Text("Type: %s", types[asset->type_index]->get_type_name().c_str());
 				}
+				if (asset->num_chunks >= 0)
+					ImGui::Text("Chunks: %d (%d triangles)", asset->num_chunks, asset->num_chunk_triangles);
 				ImGui::EndTooltip();
 			}
 		}
@@ -18,6 +18,9 @@ private:
 		std::string folder;
 		uint64_t size_bytes = 0;
 		int type_index = -1;
+		// culling chunks of a loaded model, -1 for other assets or models that aren't loaded
+		int num_chunks = -1;
+		int num_chunk_triangles = 0;
 	};
 
 	struct FolderGroup
@@ -33,6 +36,9 @@ private:
 	std::vector<SizedAsset> all_assets;
 	std::vector<FolderGroup> folder_groups;
 	uint64_t total_size = 0;
+	int num_chunked_models = 0;
+	int total_chunks = 0;
+	int total_chunk_triangles = 0;
 	bool needs_refresh = true;
 };
 
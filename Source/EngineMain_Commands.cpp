@@ -377,6 +377,19 @@ void GameEngineLocal::add_commands() {
 		}
 		sys_print(Warning, "dump_ik: select an entity with AnimGraphTester first\n");
 	});
+	commands->add("anim_graph_bench", [](const Cmd_Args& args) {
+		IEditorTool* tool = eng->get_tool();
+		if (!tool) { sys_print(Warning, "anim_graph_bench: no editor tool active\n"); return; }
+		const int iterations = args.size() >= 2 ? std::max(std::atoi(args.at(1)), 1) : 1000;
+		auto selected = tool->get_editor_api().selection()->get_selected();
+		for (auto& ptr : selected) {
+			Entity* e = ptr.get();
+			if (!e) continue;
+			auto* tester = e->get_component<AnimGraphTester>();
+			if (tester) { tester->run_graph_benchmark(iterations); return; }
+		}
+		sys_print(Warning, "anim_graph_bench: select an entity with AnimGraphTester first\n");
+	});
 #endif
 }
 
@@ -116,15 +116,19 @@ void GameEngineLocal::init_sdl_window() {
 
 	sys_print(Info, "initializing window...\n");
 
+	const bool use_dx11 = !strcmp(g_render_backend.get_string(), "dx11");
+	const bool use_null = !strcmp(g_render_backend.get_string(), "null");
+	// the null backend never presents, SDL's offscreen driver gives it a window without a display
+	if (use_null)
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
 	if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_GAMEPAD | SDL_INIT_AUDIO)) {
 		sys_print(Error, "init sdl failed: %s\n", SDL_GetError());
 		exit(-1);
 	}
 
-	const bool use_dx11 = !strcmp(g_render_backend.get_string(), "dx11");
-
 	SDL_WindowFlags window_flags = SDL_WINDOW_RESIZABLE;
-	if (!use_dx11) {
+	if (!use_dx11 && !use_null) {
 		// GL backend sets the GL context attribs (major/minor/depth/double-buffer)
 		// before the window is created — see gfx_opengl_pre_window_setup docs.
 		gfx_opengl_pre_window_setup();
@@ -140,6 +144,8 @@ void GameEngineLocal::init_sdl_window() {
 
 	if (use_dx11)
 		gfx_init_dx11(window);
+	else if (use_null)
+		gfx_init_null(window);
 	else
 		// Backend creates the GL context, loads glad, takes over swap-interval.
 		gfx_init_opengl(window);
@@ -70,6 +70,10 @@ ConfigVar r_frame_limit_fps("r.frame_limit_fps", "60", CVAR_INTEGER | CVAR_UNBOU
 ConfigVar r_editor_fast_frame_limit_fps("r.editor_fast_frame_limit_fps", "0",
 										 CVAR_INTEGER | CVAR_UNBOUNDED,
 										 "editor fps cap while dragging/panning the viewport; 0 = uncapped");
+// Overlaps the frame's last physics step with the gameplay update and animation: the step is started where it used to
+// run and fetched after post_animate, so gameplay sees physics results one step later than with this off.
+ConfigVar physics_async("physics.async", "0", CVAR_BOOL | CVAR_DEV,
+						"run the last physics step of a frame alongside update and animation, fetch it afterwards");
 
 // Free functions defined in EngineMain_Debug.cpp
 extern void debug_shape_ctx_update(float dt, const View_Setup& upcoming_vs);
@@ -212,14 +216,6 @@ void GameEngineLocal::game_update_tick() {
 		debug_shape_ctx_fixed_update_start();
 		g_physics.simulate_and_fetch(dt);
 	};
-	auto update = [&](double dt) {
-		CPU_SCOPE("update");
-		if (level)
-			level->update_level();
-		if (app)
-			app->update();
-		GameAnimationMgr::inst->update_animating();
-	};
 	const double dt = frame_time;
 
 	double secs_per_tick = tick_interval;
@@ -248,12 +244,49 @@ void GameEngineLocal::game_update_tick() {
 		steps = 0;
 	if (steps > 5)
 		steps = 5;
-	for (int i = 0; i < steps; i++) {
-		fixed_update(tick_interval);
-	}
 
-	// call level update
-	update(frame_time);
+	// Frame stages as a job graph: physics -> gameplay update -> animation -> spring bones (-> physics fetch).
+	// Everything here still touches Lua/asset loading/entity state, so the stages are pinned
+	// to the main thread; the graph gives each one a profiler zone and a place to hang
+	// independent work off of later.
+	JobGraph frame_graph;
+	const bool async_physics = physics_async.get_bool() && steps > 0;
+	auto physics_node = frame_graph.add_node(
+		"physics",
+		[&]() {
+			const int sync_steps = async_physics ? steps - 1 : steps;
+			for (int i = 0; i < sync_steps; i++) {
+				fixed_update(tick_interval);
+			}
+			if (async_physics) {
+				debug_shape_ctx_fixed_update_start();
+				g_physics.begin_simulate(tick_interval);
+			}
+		},
+		JobGraph::MainThread);
+	auto update_node = frame_graph.add_node(
+		"update",
+		[&]() {
+			if (level)
+				level->update_level();
+			if (app)
+				app->update();
+		},
+		JobGraph::MainThread);
+	auto animation_node = frame_graph.add_node(
+		"animation", [&]() { GameAnimationMgr::inst->update_animating(); }, JobGraph::MainThread);
+	auto post_animate_node = frame_graph.add_node(
+		"post_animate", [&]() { GameAnimationMgr::inst->update_post_animate(); }, JobGraph::MainThread);
+	frame_graph.run_after(update_node, physics_node);
+	frame_graph.run_after(animation_node, update_node);
+	frame_graph.run_after(post_animate_node, animation_node);
+	if (async_physics) {
+		// sync point, contact and trigger callbacks run here after everything else in the frame
+		auto physics_fetch_node =
+			frame_graph.add_node("physics_fetch", [&]() { g_physics.end_simulate(); }, JobGraph::MainThread);
+		frame_graph.run_after(physics_fetch_node, post_animate_node);
+	}
+	frame_graph.run();
 
 	time += frame_time;
 
@@ -269,6 +302,8 @@ void GameEngineLocal::stop_game() {
 	assert(level);
 	string name = level->get_source_asset_name();
 	sys_print(Info, "Clearing Map (%s)\n", name.c_str());
+	// a level change from gameplay code can land while physics.async has a step in flight
+	g_physics.end_simulate();
 	on_leave_level.invoke();
 	idraw->on_level_end();
 	level->close_level();
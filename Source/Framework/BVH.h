@@ -1,5 +1,6 @@
 #pragma once
 #include "Framework/MathLib.h"
+#include "Framework/Util.h"
 #include <vector>
 
 // from my previous raytracing project
@@ -18,15 +19,54 @@ struct BVHNode
 	int count = BVH_BRANCH; // if not a branch, count of indicies
 };
 
+// 4 children of a wide node as x/y/z arrays so one SSE test covers all of them
+struct BVHWideNode
+{
+	float min_x[4], min_y[4], min_z[4];
+	float max_x[4], max_y[4], max_z[4];
+	int child[4];  // wide node index if count is BVH_BRANCH, otherwise start in indicies
+	int count[4];  // 0 for an unused slot
+	int source[4]; // binary node the box came from, for refit()
+};
+
 class BVHBuilder;
 
+// Binary BVH over a list of bounds plus a 4-wide copy of it for CPU queries. The binary nodes are what the GPU
+// traverses (DDGI), children of a branch are at left_node and left_node+1 and always come after their parent.
+// Queries return indices into the bounds the BVH was built from, for every leaf the query touches, so callers
+// still do the exact primitive test.
 class BVH
 {
 public:
+	// binned SAH (or middle split), big ranges are split in parallel on the JobSystem when there is one
 	static BVH build(const std::vector<Bounds>& bounds, int max_per_node, PartitionStrategy strat);
+	// recomputes every box after the primitives moved, the tree shape is kept. bounds is the same size and order
+	// as in build(). O(nodes), quality drops as things move away from where they were built.
+	void refit(const std::vector<Bounds>& bounds);
 
-	void find(glm::vec3 point, std::vector<int>& outIdx);
+	void find(glm::vec3 point, std::vector<int>& outIdx) const;
+	void query_aabb(const Bounds& aabb, std::vector<int>& outIdx) const;
+	// planes as (normal, d) with dot(normal, p) + d >= 0 on the inside, like Frustum
+	void query_planes(const glm::vec4* planes, int num_planes, std::vector<int>& outIdx) const;
+	// fn(index, t_enter) for primitives in leaves the ray hits before max_t, nearest leaf first. fn returns the new
+	// max_t: the hit distance to clip, max_t to keep going, 0 to stop.
+	template <typename Fn> void query_ray(const Ray& ray, float max_t, const Fn& fn) const {
+		ray_walk(ray, max_t, [](const void* user, int index, float t) { return (*(const Fn*)user)(index, t); }, &fn);
+	}
+	// same as query_ray from a to b, t is 0 at a and 1 at b
+	template <typename Fn> void query_segment(const glm::vec3& a, const glm::vec3& b, const Fn& fn) const {
+		query_ray(Ray(a, b - a), 1.f, fn);
+	}
+
+	static const int MAX_QUERY_PLANES = 8;
 
 	std::vector<BVHNode> nodes;
 	std::vector<int> indicies;
+	std::vector<BVHWideNode> wide_nodes;
+
+private:
+	typedef float (*RayHitFn)(const void* user, int index, float t_enter);
+	void ray_walk(const Ray& ray, float max_t, RayHitFn fn, const void* user) const;
+	int build_wide_node(int node);
+	void refit_wide();
 };
@@ -1,44 +1,71 @@
 #include "Framework/BVH.h"
+#include "Framework/Jobs.h"
 #include <algorithm>
+#include <cfloat>
+#include <immintrin.h>
+
+static const int NUM_BINS = 20;
+// ranges at or below this are built as one job
+static const int SUBTREE_TASK_SIZE = 4096;
+// ranges above this are binned in chunks on the job system
+static const int PARALLEL_BIN_SIZE = 65536;
+static const int BIN_CHUNK_SIZE = 16384;
+static const int STACK_SIZE = 512;
+
+struct Bin
+{
+	Bounds aabb;
+	int tri_count = 0;
+};
+// bins for all 3 axes, filled in one pass over the range
+struct BinSet
+{
+	Bin bins[3][NUM_BINS];
+	void merge(const BinSet& other) {
+		for (int a = 0; a < 3; a++) {
+			for (int i = 0; i < NUM_BINS; i++) {
+				bins[a][i].tri_count += other.bins[a][i].tri_count;
+				bins[a][i].aabb = bounds_union(bins[a][i].aabb, other.bins[a][i].aabb);
+			}
+		}
+	}
+};
+struct RangeBounds
+{
+	Bounds aabb;
+	Bounds centroids;
+};
+
 class BVHBuilder
 {
 public:
-	BVHBuilder(const std::vector<Bounds>& bounds, int max_per_leaf) : bounds(bounds), max_per_leaf(max_per_leaf) {
+	BVHBuilder(const std::vector<Bounds>& bounds, int max_per_leaf, PartitionStrategy strat)
+		: bounds(bounds), max_per_leaf(max_per_leaf), strat(strat) {
 		indicies.resize(bounds.size());
 		centroids.resize(bounds.size());
 		for (int i = 0; i < bounds.size(); i++)
 			indicies[i] = i;
 		for (int i = 0; i < bounds.size(); i++)
 			centroids[i] = bounds[i].get_center();
+		parallel = JobSystem::inst != nullptr;
 	}
-	void build_R(int start, int end, int node_num);
 
-	int add_new_node() {
-		nodes.resize(nodes.size() + 1);
-		return nodes.size() - 1;
-	}
-	Bounds calc_bounds(int start, int end) {
-		Bounds b;
-		for (int i = start; i < end; i++)
-			b = bounds_union(b, bounds[indicies[i]]);
-		return b;
-	}
+	// a range handed to a job, built into its own node list with the subtree root at 0
+	struct Subtree
+	{
+		int start = 0;
+		int end = 0;
+		int node = 0; // in the final node list
+		std::vector<BVHNode> nodes;
+	};
 
-	float EvalSAH(int start, int end, int axis, float pos) const {
-		Bounds left, right;
-		int left_count = 0, right_count = 0;
-		for (int i = start; i < end; i++) {
-			if (centroids[indicies[i]][axis] < pos) {
-				left_count++;
-				left = bounds_union(left, bounds[indicies[i]]);
-			} else {
-				right_count++;
-				right = bounds_union(right, bounds[indicies[i]]);
-			}
-		}
-		float cost = left_count * left.surface_area() + right_count * right.surface_area();
-		return cost > 0 ? cost : 1e30f;
-	}
+	// splits the top of the tree into the final node list until ranges are small enough to be jobs
+	void build_top(int start, int end, int node_number, std::vector<Subtree>& tasks);
+	void build_R(int start, int end, int node_number, std::vector<BVHNode>& out);
+	// returns where [start,end) was partitioned, or -1 if it should be a leaf
+	int split_range(int start, int end, const RangeBounds& rb, bool use_jobs);
+	RangeBounds calc_bounds(int start, int end, bool use_jobs) const;
+	void bin_range(int start, int end, const Bounds& centroid_bounds, BinSet& out) const;
 
 	std::vector<glm::vec3> centroids;
 	std::vector<BVHNode> nodes;
@@ -46,149 +73,455 @@ public:
 	const std::vector<Bounds>& bounds;
 
 	int max_per_leaf;
+	PartitionStrategy strat;
+	bool parallel = false;
 };
 
-struct Bin
-{
-	Bounds aabb;
-	int tri_count = 0;
-};
-static const int NUM_BINS = 20;
-
-#define SAH
-#ifndef _DEBUG
-#endif // ! _DEBUG
-
-void BVHBuilder::build_R(int start, int end, int node_number) {
-	assert(start >= 0 && end <= bounds.size());
-	int num_elements = end - start;
-	BVHNode* node = &nodes[node_number];
-	node->aabb = calc_bounds(start, end);
-
-	if (num_elements <= max_per_leaf) {
-		node->left_node = start;
-		node->count = num_elements;
-		return;
-	}
-	int split = start;
-
-#ifndef SAH
-
-	glm::vec3 bounds_center = node->aabb.get_center();
-	int longest_axis = node->aabb.longest_axis();
-	float mid = bounds_center[longest_axis];
-
-	auto split_iter =
-		std::partition(indicies.begin() + start, indicies.begin() + end,
-					   [longest_axis, mid, this](int index) { return this->centroids[index][longest_axis] < mid; });
-	split = split_iter - indicies.begin();
-	if (split == start || split == end)
-		split = (start + end) / 2;
-#else
-	float parent_cost = node->aabb.surface_area() * num_elements;
-
-	Bounds centroid_bounds;
-	for (int i = start; i < end; i++) {
-		centroid_bounds = bounds_union(centroid_bounds, centroids[indicies[i]]);
+RangeBounds BVHBuilder::calc_bounds(int start, int end, bool use_jobs) const {
+	auto calc = [&](int b, int e) {
+		RangeBounds rb;
+		for (int i = b; i < e; i++) {
+			rb.aabb = bounds_union(rb.aabb, bounds[indicies[i]]);
+			rb.centroids = bounds_union(rb.centroids, centroids[indicies[i]]);
+		}
+		return rb;
+	};
+	if (!use_jobs)
+		return calc(start, end);
+	const int num_chunks = (end - start + BIN_CHUNK_SIZE - 1) / BIN_CHUNK_SIZE;
+	std::vector<RangeBounds> chunks(num_chunks);
+	JobSystem::inst->parallel_for_chunks(start, end, BIN_CHUNK_SIZE, [&](int b, int e) {
+		chunks[(b - start) / BIN_CHUNK_SIZE] = calc(b, e);
+	});
+	RangeBounds rb;
+	for (auto& c : chunks) {
+		rb.aabb = bounds_union(rb.aabb, c.aabb);
+		rb.centroids = bounds_union(rb.centroids, c.centroids);
 	}
+	return rb;
+}
 
-	float mid;
-	int axis = -1;
-	float best_cost = 1e30f;
+void BVHBuilder::bin_range(int start, int end, const Bounds& centroid_bounds, BinSet& out) const {
 	for (int a = 0; a < 3; a++) {
-		float bounds_min = centroid_bounds.bmin[a]; // node->aabb.bmin[a];
-		float bounds_max = centroid_bounds.bmax[a]; // node->aabb.bmax[a];
+		const float bounds_min = centroid_bounds.bmin[a];
+		const float bounds_max = centroid_bounds.bmax[a];
 		if (bounds_min == bounds_max)
 			continue;
-		Bin bins[NUM_BINS];
-#ifdef NO_BIN
-		float scale = (bounds_max - bounds_min) / 100.f;
-		for (int i = 0; i < 100; i++) {
-			// float centroid = centroids[indicies[start + i]][a];
-			float pos = bounds_min + i * scale;
-			float cost = EvalSAH(start, end, a, pos);
-			if (cost < best_cost) {
-				mid = pos;
-				axis = a;
-				best_cost = cost;
-			}
-		}
-#endif // NO_BIN
-		float scale = NUM_BINS / (bounds_max - bounds_min);
+		const float scale = NUM_BINS / (bounds_max - bounds_min);
 		for (int i = start; i < end; i++) {
-			glm::vec3 centroid = centroids[indicies[i]];
-			int bin_idx = glm::min(NUM_BINS - 1, (int)((centroid[a] - bounds_min) * scale));
+			const float centroid = centroids[indicies[i]][a];
+			int bin_idx = glm::min(NUM_BINS - 1, (int)((centroid - bounds_min) * scale));
 			bin_idx = glm::max(bin_idx, 0);
-			bins[bin_idx].tri_count++;
-			bins[bin_idx].aabb = bounds_union(bins[bin_idx].aabb, bounds[indicies[i]]);
+			out.bins[a][bin_idx].tri_count++;
+			out.bins[a][bin_idx].aabb = bounds_union(out.bins[a][bin_idx].aabb, bounds[indicies[i]]);
 		}
+	}
+}
+
+int BVHBuilder::split_range(int start, int end, const RangeBounds& rb, bool use_jobs) {
+	const int num_elements = end - start;
+	int axis = -1;
+	float mid = 0.f;
 
-		float left_area[NUM_BINS - 1], right_area[NUM_BINS - 1];
-		int left_count[NUM_BINS - 1], right_count[NUM_BINS - 1];
-		Bounds left_aabb, right_aabb;
-		int left_sum = 0, right_sum = 0;
-		for (int i = 0; i < NUM_BINS - 1; i++) {
-			left_sum += bins[i].tri_count;
-			left_count[i] = left_sum;
-			left_aabb = bounds_union(left_aabb, bins[i].aabb);
-			left_area[i] = left_aabb.surface_area();
-
-			right_sum += bins[NUM_BINS - 1 - i].tri_count;
-			right_count[NUM_BINS - 2 - i] = right_sum;
-			right_aabb = bounds_union(right_aabb, bins[NUM_BINS - 1 - i].aabb);
-			right_area[NUM_BINS - 2 - i] = right_aabb.surface_area();
+	if (strat == BVH_MIDDLE) {
+		axis = rb.aabb.longest_axis();
+		mid = rb.aabb.get_center()[axis];
+	} else {
+		BinSet bins;
+		if (use_jobs) {
+			const int num_chunks = (num_elements + BIN_CHUNK_SIZE - 1) / BIN_CHUNK_SIZE;
+			std::vector<BinSet> chunks(num_chunks);
+			JobSystem::inst->parallel_for_chunks(start, end, BIN_CHUNK_SIZE, [&](int b, int e) {
+				bin_range(b, e, rb.centroids, chunks[(b - start) / BIN_CHUNK_SIZE]);
+			});
+			for (auto& c : chunks)
+				bins.merge(c);
+		} else {
+			bin_range(start, end, rb.centroids, bins);
 		}
 
-		scale = (bounds_max - bounds_min) / NUM_BINS;
-		for (int i = 0; i < NUM_BINS - 1; i++) {
-			float plane_cost = left_count[i] * left_area[i] + right_count[i] * right_area[i];
-			if (plane_cost < best_cost) {
-				mid = bounds_min + scale * (i + 1);
-				axis = a;
-				best_cost = plane_cost;
+		const float parent_cost = rb.aabb.surface_area() * num_elements;
+		float best_cost = 1e30f;
+		for (int a = 0; a < 3; a++) {
+			const float bounds_min = rb.centroids.bmin[a];
+			const float bounds_max = rb.centroids.bmax[a];
+			if (bounds_min == bounds_max)
+				continue;
+			const Bin* axis_bins = bins.bins[a];
+
+			float left_area[NUM_BINS - 1], right_area[NUM_BINS - 1];
+			int left_count[NUM_BINS - 1], right_count[NUM_BINS - 1];
+			Bounds left_aabb, right_aabb;
+			int left_sum = 0, right_sum = 0;
+			for (int i = 0; i < NUM_BINS - 1; i++) {
+				left_sum += axis_bins[i].tri_count;
+				left_count[i] = left_sum;
+				left_aabb = bounds_union(left_aabb, axis_bins[i].aabb);
+				left_area[i] = left_aabb.surface_area();
+
+				right_sum += axis_bins[NUM_BINS - 1 - i].tri_count;
+				right_count[NUM_BINS - 2 - i] = right_sum;
+				right_aabb = bounds_union(right_aabb, axis_bins[NUM_BINS - 1 - i].aabb);
+				right_area[NUM_BINS - 2 - i] = right_aabb.surface_area();
 			}
-		}
-	}
 
-	if (axis == -1 || best_cost >= parent_cost) {
-		node->left_node = start;
-		node->count = num_elements;
-		return;
+			const float scale = (bounds_max - bounds_min) / NUM_BINS;
+			for (int i = 0; i < NUM_BINS - 1; i++) {
+				// an empty side has an inverted box, its area isn't meaningful
+				if (left_count[i] == 0 || right_count[i] == 0)
+					continue;
+				const float plane_cost = left_count[i] * left_area[i] + right_count[i] * right_area[i];
+				if (plane_cost < best_cost) {
+					mid = bounds_min + scale * (i + 1);
+					axis = a;
+					best_cost = plane_cost;
+				}
+			}
+		}
+		if (axis == -1 || best_cost >= parent_cost)
+			return -1;
 	}
 
 	auto split_iter = std::partition(indicies.begin() + start, indicies.begin() + end,
 									 [axis, mid, this](int index) { return this->centroids[index][axis] < mid; });
-	split = split_iter - indicies.begin();
-
+	int split = split_iter - indicies.begin();
 	if (split == start || split == end)
 		split = (start + end) / 2;
+	return split;
+}
+
+void BVHBuilder::build_R(int start, int end, int node_number, std::vector<BVHNode>& out) {
+	assert(start >= 0 && end <= bounds.size());
+	const RangeBounds rb = calc_bounds(start, end, false);
+	out[node_number].aabb = rb.aabb;
 
-#endif // !SAH
+	const int split = (end - start <= max_per_leaf) ? -1 : split_range(start, end, rb, false);
+	if (split == -1) {
+		out[node_number].left_node = start;
+		out[node_number].count = end - start;
+		return;
+	}
+	// resizing invalidates references into out, index again
+	const int left_child = (int)out.size();
+	out.resize(out.size() + 2);
+	out[node_number].count = BVH_BRANCH;
+	out[node_number].left_node = left_child;
+	build_R(start, split, left_child, out);
+	build_R(split, end, left_child + 1, out);
+}
 
-	node->count = BVH_BRANCH;
-	// These may invalidate the pointer
-	int left_child = add_new_node();
-	int right_child = add_new_node();
-	// So just set it again lol
+void BVHBuilder::build_top(int start, int end, int node_number, std::vector<Subtree>& tasks) {
+	const int num_elements = end - start;
+	if (!parallel || num_elements <= SUBTREE_TASK_SIZE) {
+		Subtree t;
+		t.start = start;
+		t.end = end;
+		t.node = node_number;
+		tasks.push_back(std::move(t));
+		return;
+	}
+	const bool use_jobs = num_elements > PARALLEL_BIN_SIZE;
+	const RangeBounds rb = calc_bounds(start, end, use_jobs);
+	nodes[node_number].aabb = rb.aabb;
+	const int split = split_range(start, end, rb, use_jobs);
+	if (split == -1) {
+		nodes[node_number].left_node = start;
+		nodes[node_number].count = num_elements;
+		return;
+	}
+	const int left_child = (int)nodes.size();
+	nodes.resize(nodes.size() + 2);
+	nodes[node_number].count = BVH_BRANCH;
 	nodes[node_number].left_node = left_child;
-	build_R(start, split, left_child);
-	build_R(split, end, right_child);
+	build_top(start, split, left_child, tasks);
+	build_top(split, end, left_child + 1, tasks);
 }
 
 // Static builder function
 BVH BVH::build(const std::vector<Bounds>& bounds, int max_per_node, PartitionStrategy strat) {
-	BVHBuilder builder(bounds, max_per_node);
+	BVH bvh;
+	if (bounds.empty())
+		return bvh;
+	BVHBuilder builder(bounds, max_per_node, strat);
 
-	int start_node = builder.add_new_node(); // =0
-	builder.build_R(0, bounds.size(), start_node);
+	// the top is split serially (with parallel binning), the subtrees below are independent ranges of indicies
+	std::vector<BVHBuilder::Subtree> tasks;
+	builder.nodes.resize(1);
+	builder.build_top(0, (int)bounds.size(), 0, tasks);
+	auto build_task = [&](int i) {
+		auto& t = tasks[i];
+		t.nodes.resize(1);
+		builder.build_R(t.start, t.end, 0, t.nodes);
+	};
+	if (builder.parallel && tasks.size() > 1)
+		JobSystem::inst->parallel_for(0, (int)tasks.size(), 1, build_task);
+	else
+		for (int i = 0; i < (int)tasks.size(); i++)
+			build_task(i);
 
-	if (builder.nodes.size() == 0) {
-		printf("Error on BVH construction\n");
-		return BVH();
+	// append the subtrees after the top nodes, so children still come after their parents
+	for (auto& t : tasks) {
+		const int base = (int)builder.nodes.size() - 1; // local node i > 0 goes to base + i
+		for (int i = 0; i < (int)t.nodes.size(); i++) {
+			BVHNode n = t.nodes[i];
+			if (n.count == BVH_BRANCH)
+				n.left_node += base;
+			if (i == 0)
+				builder.nodes[t.node] = n;
+			else
+				builder.nodes.push_back(n);
+		}
 	}
-	BVH bvh;
+
 	bvh.nodes = std::move(builder.nodes);
 	bvh.indicies = std::move(builder.indicies);
-
+	bvh.wide_nodes.reserve(bvh.nodes.size() / 2 + 1);
+	bvh.build_wide_node(0);
 	return bvh;
 }
+
+void BVH::refit(const std::vector<Bounds>& bounds) {
+	ASSERT(bounds.size() == indicies.size());
+	for (int i = (int)nodes.size() - 1; i >= 0; i--) {
+		BVHNode& n = nodes[i];
+		if (n.count == BVH_BRANCH) {
+			n.aabb = bounds_union(nodes[n.left_node].aabb, nodes[n.left_node + 1].aabb);
+			continue;
+		}
+		Bounds b;
+		for (int j = n.left_node; j < n.left_node + n.count; j++)
+			b = bounds_union(b, bounds[indicies[j]]);
+		n.aabb = b;
+	}
+	refit_wide();
+}
+
+// Collapses binary levels into one wide node: branches are opened largest first until there are 4 children.
+int BVH::build_wide_node(int node) {
+	const int wide = (int)wide_nodes.size();
+	wide_nodes.push_back(BVHWideNode());
+
+	int children[4] = {node, -1, -1, -1};
+	int num_children = 1;
+	if (nodes[node].count == BVH_BRANCH) {
+		children[0] = nodes[node].left_node;
+		children[1] = nodes[node].left_node + 1;
+		num_children = 2;
+	}
+	while (num_children < 4) {
+		int expand = -1;
+		float expand_area = -1.f;
+		for (int i = 0; i < num_children; i++) {
+			const BVHNode& c = nodes[children[i]];
+			if (c.count == BVH_BRANCH && c.aabb.surface_area() > expand_area) {
+				expand = i;
+				expand_area = c.aabb.surface_area();
+			}
+		}
+		if (expand == -1)
+			break;
+		const int c = children[expand];
+		children[expand] = nodes[c].left_node;
+		children[num_children++] = nodes[c].left_node + 1;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		Bounds b(glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX));
+		int child = 0;
+		int count = 0;
+		int source = -1;
+		if (i < num_children) {
+			const BVHNode& c = nodes[children[i]];
+			b = c.aabb;
+			source = children[i];
+			count = c.count;
+			child = c.count == BVH_BRANCH ? build_wide_node(children[i]) : c.left_node;
+		}
+		// wide_nodes may have grown, index again
+		BVHWideNode& w = wide_nodes[wide];
+		w.min_x[i] = b.bmin.x;
+		w.min_y[i] = b.bmin.y;
+		w.min_z[i] = b.bmin.z;
+		w.max_x[i] = b.bmax.x;
+		w.max_y[i] = b.bmax.y;
+		w.max_z[i] = b.bmax.z;
+		w.child[i] = child;
+		w.count[i] = count;
+		w.source[i] = source;
+	}
+	return wide;
+}
+
+void BVH::refit_wide() {
+	for (auto& w : wide_nodes) {
+		for (int i = 0; i < 4; i++) {
+			if (w.count[i] == 0)
+				continue;
+			const Bounds& b = nodes[w.source[i]].aabb;
+			w.min_x[i] = b.bmin.x;
+			w.min_y[i] = b.bmin.y;
+			w.min_z[i] = b.bmin.z;
+			w.max_x[i] = b.bmax.x;
+			w.max_y[i] = b.bmax.y;
+			w.max_z[i] = b.bmax.z;
+		}
+	}
+}
+
+// ---- queries -------------------------------------------------------------
+
+void BVH::find(glm::vec3 point, std::vector<int>& outIdx) const {
+	if (nodes.empty())
+		return;
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = 0;
+	while (count > 0) {
+		const BVHNode& n = nodes[stack[--count]];
+		if (!n.aabb.inside(point, 0.f))
+			continue;
+		if (n.count != BVH_BRANCH) {
+			for (int i = n.left_node; i < n.left_node + n.count; i++)
+				outIdx.push_back(indicies[i]);
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		stack[count++] = n.left_node;
+		stack[count++] = n.left_node + 1;
+	}
+}
+
+// walks the wide nodes, hit_mask(w) returns which of the 4 slots to visit
+template <typename HitMask>
+static void walk_wide(const BVH& bvh, std::vector<int>& outIdx, const HitMask& hit_mask) {
+	if (bvh.wide_nodes.empty())
+		return;
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = 0;
+	while (count > 0) {
+		const BVHWideNode& w = bvh.wide_nodes[stack[--count]];
+		const int mask = hit_mask(w);
+		for (int i = 0; i < 4; i++) {
+			if (!(mask & (1 << i)) || w.count[i] == 0)
+				continue;
+			if (w.count[i] == BVH_BRANCH) {
+				ASSERT(count < STACK_SIZE);
+				stack[count++] = w.child[i];
+			} else {
+				for (int j = w.child[i]; j < w.child[i] + w.count[i]; j++)
+					outIdx.push_back(bvh.indicies[j]);
+			}
+		}
+	}
+}
+
+void BVH::query_aabb(const Bounds& aabb, std::vector<int>& outIdx) const {
+	const __m128 q_min_x = _mm_set1_ps(aabb.bmin.x), q_max_x = _mm_set1_ps(aabb.bmax.x);
+	const __m128 q_min_y = _mm_set1_ps(aabb.bmin.y), q_max_y = _mm_set1_ps(aabb.bmax.y);
+	const __m128 q_min_z = _mm_set1_ps(aabb.bmin.z), q_max_z = _mm_set1_ps(aabb.bmax.z);
+	walk_wide(*this, outIdx, [&](const BVHWideNode& w) {
+		__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(w.min_x), q_max_x),
+									_mm_cmpge_ps(_mm_loadu_ps(w.max_x), q_min_x));
+		overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(w.min_y), q_max_y));
+		overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_loadu_ps(w.max_y), q_min_y));
+		overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(w.min_z), q_max_z));
+		overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_loadu_ps(w.max_z), q_min_z));
+		return _mm_movemask_ps(overlap);
+	});
+}
+
+void BVH::query_planes(const glm::vec4* planes, int num_planes, std::vector<int>& outIdx) const {
+	ASSERT(num_planes <= MAX_QUERY_PLANES);
+	__m128 px[MAX_QUERY_PLANES], py[MAX_QUERY_PLANES], pz[MAX_QUERY_PLANES], pw[MAX_QUERY_PLANES];
+	for (int p = 0; p < num_planes; p++) {
+		px[p] = _mm_set1_ps(planes[p].x);
+		py[p] = _mm_set1_ps(planes[p].y);
+		pz[p] = _mm_set1_ps(planes[p].z);
+		pw[p] = _mm_set1_ps(planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+	walk_wide(*this, outIdx, [&](const BVHWideNode& w) {
+		const __m128 min_x = _mm_loadu_ps(w.min_x), max_x = _mm_loadu_ps(w.max_x);
+		const __m128 min_y = _mm_loadu_ps(w.min_y), max_y = _mm_loadu_ps(w.max_y);
+		const __m128 min_z = _mm_loadu_ps(w.min_z), max_z = _mm_loadu_ps(w.max_z);
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+		for (int p = 0; p < num_planes; p++) {
+			// distance of the corner furthest along the normal
+			const __m128 dx = _mm_max_ps(_mm_mul_ps(px[p], min_x), _mm_mul_ps(px[p], max_x));
+			const __m128 dy = _mm_max_ps(_mm_mul_ps(py[p], min_y), _mm_mul_ps(py[p], max_y));
+			const __m128 dz = _mm_max_ps(_mm_mul_ps(pz[p], min_z), _mm_mul_ps(pz[p], max_z));
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(dx, dy), dz), pw[p]);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+		}
+		return _mm_movemask_ps(inside);
+	});
+}
+
+void BVH::ray_walk(const Ray& ray, float max_t, RayHitFn fn, const void* user) const {
+	if (wide_nodes.empty())
+		return;
+	// a huge finite inverse instead of inf keeps 0 * inv out of the slab test when the ray starts on a plane
+	auto safe_inv = [](float d) { return glm::abs(d) > 1e-30f ? 1.f / d : (d >= 0.f ? 1e30f : -1e30f); };
+	const __m128 ox = _mm_set1_ps(ray.pos.x), oy = _mm_set1_ps(ray.pos.y), oz = _mm_set1_ps(ray.pos.z);
+	const __m128 ix = _mm_set1_ps(safe_inv(ray.dir.x));
+	const __m128 iy = _mm_set1_ps(safe_inv(ray.dir.y));
+	const __m128 iz = _mm_set1_ps(safe_inv(ray.dir.z));
+
+	// entries are wide nodes (count BVH_BRANCH) or leaves, with the distance the box was entered at
+	struct Entry
+	{
+		int child;
+		int count;
+		float t;
+	};
+	Entry stack[STACK_SIZE];
+	int num = 0;
+	stack[num++] = {0, BVH_BRANCH, 0.f};
+	while (num > 0) {
+		const Entry e = stack[--num];
+		if (e.t > max_t)
+			continue;
+		if (e.count != BVH_BRANCH) {
+			for (int j = e.child; j < e.child + e.count; j++) {
+				max_t = fn(user, indicies[j], e.t);
+				if (max_t <= 0.f)
+					return;
+			}
+			continue;
+		}
+		const BVHWideNode& w = wide_nodes[e.child];
+		const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.min_x), ox), ix);
+		const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.max_x), ox), ix);
+		const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.min_y), oy), iy);
+		const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.max_y), oy), iy);
+		const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.min_z), oz), iz);
+		const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(w.max_z), oz), iz);
+		__m128 t_enter = _mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1));
+		t_enter = _mm_max_ps(t_enter, _mm_max_ps(_mm_min_ps(tz0, tz1), _mm_setzero_ps()));
+		__m128 t_exit = _mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1));
+		t_exit = _mm_min_ps(t_exit, _mm_max_ps(tz0, tz1));
+		const __m128 hit = _mm_and_ps(_mm_cmple_ps(t_enter, t_exit), _mm_cmple_ps(t_enter, _mm_set1_ps(max_t)));
+		const int mask = _mm_movemask_ps(hit);
+		if (mask == 0)
+			continue;
+		alignas(16) float t[4];
+		_mm_store_ps(t, t_enter);
+
+		// farthest first, so the nearest is popped first and can clip max_t
+		Entry hits[4];
+		int num_hits = 0;
+		for (int i = 0; i < 4; i++) {
+			if (!(mask & (1 << i)) || w.count[i] == 0)
+				continue;
+			Entry h = {w.child[i], w.count[i], t[i]};
+			int j = num_hits++;
+			for (; j > 0 && hits[j - 1].t < h.t; j--)
+				hits[j] = hits[j - 1];
+			hits[j] = h;
+		}
+		ASSERT(num + num_hits <= STACK_SIZE);
+		for (int i = 0; i < num_hits; i++)
+			stack[num++] = hits[i];
+	}
+}
@@ -88,6 +88,14 @@ public:
 		ptr += write_size;
 		return true;
 	}
+	// the next view_size bytes in place, no copy. Valid as long as the reader, null if there aren't enough bytes.
+	const uint8_t* read_bytes_view(size_t view_size) {
+		if (!can_read_these_bytes(view_size))
+			return nullptr;
+		const uint8_t* ret = &data[ptr];
+		ptr += view_size;
+		return ret;
+	}
 	template <typename T> bool read_struct(T* dest) { return read_bytes_ptr(dest, sizeof(T)); }
 	bool seek(size_t where_) {
 		if (where_ >= size)
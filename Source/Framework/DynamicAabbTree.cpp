@@ -0,0 +1,562 @@
+#include "Framework/DynamicAabbTree.h"
+#include <algorithm>
+#include <cfloat>
+#include <immintrin.h>
+
+static Bounds fatten(const Bounds& b, float margin) {
+	return Bounds(b.bmin - glm::vec3(margin), b.bmax + glm::vec3(margin));
+}
+
+static bool contains(const Bounds& outer, const Bounds& inner) {
+	return glm::all(glm::lessThanEqual(outer.bmin, inner.bmin)) && glm::all(glm::greaterThanEqual(outer.bmax, inner.bmax));
+}
+
+int DynamicAabbTree::alloc_node() {
+	if (free_list == NULL_NODE) {
+		nodes.push_back(Node());
+		return (int)nodes.size() - 1;
+	}
+	const int node = free_list;
+	free_list = nodes[node].parent;
+	nodes[node] = Node();
+	return node;
+}
+
+void DynamicAabbTree::free_node(int node) {
+	nodes[node] = Node();
+	nodes[node].parent = free_list;
+	free_list = node;
+}
+
+void DynamicAabbTree::clear() {
+	nodes.clear();
+	wide_nodes.clear();
+	root = NULL_NODE;
+	free_list = NULL_NODE;
+	num_leaves = 0;
+	wide_dirty = true;
+}
+
+int DynamicAabbTree::insert(const Bounds& aabb, int user_data) {
+	ASSERT(user_data >= 0);
+	const int leaf = alloc_node();
+	nodes[leaf].aabb = fatten(aabb, margin);
+	nodes[leaf].user_data = user_data;
+	nodes[leaf].height = 0;
+	insert_leaf(leaf);
+	num_leaves++;
+	wide_dirty = true;
+	return leaf;
+}
+
+void DynamicAabbTree::remove(int proxy) {
+	ASSERT(proxy >= 0 && proxy < (int)nodes.size() && nodes[proxy].is_leaf() && nodes[proxy].height == 0);
+	remove_leaf(proxy);
+	free_node(proxy);
+	num_leaves--;
+	wide_dirty = true;
+}
+
+bool DynamicAabbTree::move(int proxy, const Bounds& aabb) {
+	ASSERT(proxy >= 0 && proxy < (int)nodes.size() && nodes[proxy].is_leaf());
+	// keep the fat box unless the object left it or shrank well inside it
+	const Bounds& fat = nodes[proxy].aabb;
+	if (contains(fat, aabb) && contains(fatten(aabb, margin * 4.f), fat))
+		return false;
+	remove_leaf(proxy);
+	nodes[proxy].aabb = fatten(aabb, margin);
+	insert_leaf(proxy);
+	wide_dirty = true;
+	return true;
+}
+
+void DynamicAabbTree::insert_leaf(int leaf) {
+	if (root == NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// descend towards the sibling that grows the tree's surface area least
+	const Bounds leaf_aabb = nodes[leaf].aabb;
+	int index = root;
+	while (!nodes[index].is_leaf()) {
+		const Node& n = nodes[index];
+		const float area = n.aabb.surface_area();
+		const float combined_area = bounds_union(n.aabb, leaf_aabb).surface_area();
+		// pairing with this node makes a new parent here
+		const float cost = 2.f * combined_area;
+		// every ancestor below grows too
+		const float inheritance_cost = 2.f * (combined_area - area);
+
+		auto descend_cost = [&](int child) {
+			const Bounds merged = bounds_union(nodes[child].aabb, leaf_aabb);
+			if (nodes[child].is_leaf())
+				return merged.surface_area() + inheritance_cost;
+			return merged.surface_area() - nodes[child].aabb.surface_area() + inheritance_cost;
+		};
+		const float cost1 = descend_cost(n.child1);
+		const float cost2 = descend_cost(n.child2);
+		if (cost < cost1 && cost < cost2)
+			break;
+		index = cost1 < cost2 ? n.child1 : n.child2;
+	}
+	const int sibling = index;
+
+	const int old_parent = nodes[sibling].parent;
+	const int new_parent = alloc_node();
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].aabb = bounds_union(leaf_aabb, nodes[sibling].aabb);
+	nodes[new_parent].height = nodes[sibling].height + 1;
+	nodes[new_parent].child1 = sibling;
+	nodes[new_parent].child2 = leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+	if (old_parent == NULL_NODE) {
+		root = new_parent;
+	} else if (nodes[old_parent].child1 == sibling) {
+		nodes[old_parent].child1 = new_parent;
+	} else {
+		nodes[old_parent].child2 = new_parent;
+	}
+
+	fix_upwards(new_parent, true);
+}
+
+void DynamicAabbTree::remove_leaf(int leaf) {
+	if (leaf == root) {
+		root = NULL_NODE;
+		return;
+	}
+	const int parent = nodes[leaf].parent;
+	const int grand_parent = nodes[parent].parent;
+	const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	// the sibling takes the parent's place
+	if (grand_parent == NULL_NODE) {
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+	} else {
+		if (nodes[grand_parent].child1 == parent)
+			nodes[grand_parent].child1 = sibling;
+		else
+			nodes[grand_parent].child2 = sibling;
+		nodes[sibling].parent = grand_parent;
+		fix_upwards(grand_parent, false);
+	}
+	free_node(parent);
+	nodes[leaf].parent = NULL_NODE;
+}
+
+void DynamicAabbTree::fix_upwards(int index, bool rotate_nodes) {
+	while (index != NULL_NODE) {
+		Node& n = nodes[index];
+		n.aabb = bounds_union(nodes[n.child1].aabb, nodes[n.child2].aabb);
+		n.height = 1 + std::max(nodes[n.child1].height, nodes[n.child2].height);
+		if (rotate_nodes)
+			rotate(index);
+		index = nodes[index].parent;
+	}
+}
+
+// Swaps a child of A with a grandchild on the other side when that shrinks the area of A's children (Box2D v3's
+// b2RotateNodes). A's own box doesn't change, it covers the same leaves.
+//       A
+//     /   \
+//    B     C
+//   / \   / \
+//  D   E F   G
+void DynamicAabbTree::rotate(int ia) {
+	Node& A = nodes[ia];
+	if (A.height < 2)
+		return;
+	const int ib = A.child1;
+	const int ic = A.child2;
+	Node& B = nodes[ib];
+	Node& C = nodes[ic];
+
+	if (B.height == 0) {
+		// B is a leaf, C is internal: try B <-> F or B <-> G
+		ASSERT(C.height > 0);
+		const int iF = C.child1;
+		const int iG = C.child2;
+		const float cost_base = C.aabb.surface_area();
+		const Bounds aabb_bg = bounds_union(B.aabb, nodes[iG].aabb);
+		const Bounds aabb_bf = bounds_union(B.aabb, nodes[iF].aabb);
+		const float cost_bf = aabb_bg.surface_area();
+		const float cost_bg = aabb_bf.surface_area();
+		if (cost_base < cost_bf && cost_base < cost_bg)
+			return;
+		if (cost_bf < cost_bg) {
+			A.child1 = iF;
+			C.child1 = ib;
+			B.parent = ic;
+			nodes[iF].parent = ia;
+			C.aabb = aabb_bg;
+			C.height = 1 + std::max(B.height, nodes[iG].height);
+			A.height = 1 + std::max(C.height, nodes[iF].height);
+		} else {
+			A.child1 = iG;
+			C.child2 = ib;
+			B.parent = ic;
+			nodes[iG].parent = ia;
+			C.aabb = aabb_bf;
+			C.height = 1 + std::max(B.height, nodes[iF].height);
+			A.height = 1 + std::max(C.height, nodes[iG].height);
+		}
+		return;
+	}
+	if (C.height == 0) {
+		// C is a leaf, B is internal: try C <-> D or C <-> E
+		const int iD = B.child1;
+		const int iE = B.child2;
+		const float cost_base = B.aabb.surface_area();
+		const Bounds aabb_ce = bounds_union(C.aabb, nodes[iE].aabb);
+		const Bounds aabb_cd = bounds_union(C.aabb, nodes[iD].aabb);
+		const float cost_cd = aabb_ce.surface_area();
+		const float cost_ce = aabb_cd.surface_area();
+		if (cost_base < cost_cd && cost_base < cost_ce)
+			return;
+		if (cost_cd < cost_ce) {
+			A.child2 = iD;
+			B.child1 = ic;
+			C.parent = ib;
+			nodes[iD].parent = ia;
+			B.aabb = aabb_ce;
+			B.height = 1 + std::max(C.height, nodes[iE].height);
+			A.height = 1 + std::max(B.height, nodes[iD].height);
+		} else {
+			A.child2 = iE;
+			B.child2 = ic;
+			C.parent = ib;
+			nodes[iE].parent = ia;
+			B.aabb = aabb_cd;
+			B.height = 1 + std::max(C.height, nodes[iD].height);
+			A.height = 1 + std::max(B.height, nodes[iE].height);
+		}
+		return;
+	}
+
+	// both internal, pick the best of the four swaps
+	const int iD = B.child1;
+	const int iE = B.child2;
+	const int iF = C.child1;
+	const int iG = C.child2;
+	const float area_b = B.aabb.surface_area();
+	const float area_c = C.aabb.surface_area();
+	const Bounds aabb_bg = bounds_union(B.aabb, nodes[iG].aabb);
+	const Bounds aabb_bf = bounds_union(B.aabb, nodes[iF].aabb);
+	const Bounds aabb_ce = bounds_union(C.aabb, nodes[iE].aabb);
+	const Bounds aabb_cd = bounds_union(C.aabb, nodes[iD].aabb);
+	const float costs[4] = {
+		area_b + aabb_bg.surface_area(), // B <-> F
+		area_b + aabb_bf.surface_area(), // B <-> G
+		area_c + aabb_ce.surface_area(), // C <-> D
+		area_c + aabb_cd.surface_area(), // C <-> E
+	};
+	int best = -1;
+	float best_cost = area_b + area_c;
+	for (int i = 0; i < 4; i++) {
+		if (costs[i] < best_cost) {
+			best_cost = costs[i];
+			best = i;
+		}
+	}
+	switch (best) {
+	case 0:
+		A.child1 = iF;
+		C.child1 = ib;
+		B.parent = ic;
+		nodes[iF].parent = ia;
+		C.aabb = aabb_bg;
+		C.height = 1 + std::max(B.height, nodes[iG].height);
+		A.height = 1 + std::max(C.height, nodes[iF].height);
+		break;
+	case 1:
+		A.child1 = iG;
+		C.child2 = ib;
+		B.parent = ic;
+		nodes[iG].parent = ia;
+		C.aabb = aabb_bf;
+		C.height = 1 + std::max(B.height, nodes[iF].height);
+		A.height = 1 + std::max(C.height, nodes[iG].height);
+		break;
+	case 2:
+		A.child2 = iD;
+		B.child1 = ic;
+		C.parent = ib;
+		nodes[iD].parent = ia;
+		B.aabb = aabb_ce;
+		B.height = 1 + std::max(C.height, nodes[iE].height);
+		A.height = 1 + std::max(B.height, nodes[iD].height);
+		break;
+	case 3:
+		A.child2 = iE;
+		B.child2 = ic;
+		C.parent = ib;
+		nodes[iE].parent = ia;
+		B.aabb = aabb_cd;
+		B.height = 1 + std::max(C.height, nodes[iD].height);
+		A.height = 1 + std::max(B.height, nodes[iE].height);
+		break;
+	default:
+		break;
+	}
+}
+
+void DynamicAabbTree::collect_leaves(int node, std::vector<int>& out) const {
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = node;
+	while (count > 0) {
+		const Node& n = nodes[stack[--count]];
+		if (n.is_leaf()) {
+			out.push_back(n.user_data);
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		stack[count++] = n.child1;
+		stack[count++] = n.child2;
+	}
+}
+
+void DynamicAabbTree::query_planes(const glm::vec4* planes, int num_planes, std::vector<int>& out) const {
+	ASSERT(num_planes <= MAX_QUERY_PLANES);
+	if (root == NULL_NODE)
+		return;
+
+	// each entry carries the planes its parent wasn't fully inside of, a subtree inside all of them is taken whole
+	struct Entry
+	{
+		int node;
+		uint32_t plane_mask;
+	};
+	Entry stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = {root, (1u << num_planes) - 1};
+	while (count > 0) {
+		const Entry e = stack[--count];
+		const Node& n = nodes[e.node];
+		uint32_t mask = e.plane_mask;
+		bool outside = false;
+		for (int p = 0; p < num_planes; p++) {
+			if (!(mask & (1u << p)))
+				continue;
+			const glm::vec3 normal = glm::vec3(planes[p]);
+			// corner furthest along the normal, and the one furthest against it
+			const glm::vec3 far_corner = glm::mix(n.aabb.bmin, n.aabb.bmax, glm::greaterThanEqual(normal, glm::vec3(0.f)));
+			const glm::vec3 near_corner = glm::mix(n.aabb.bmax, n.aabb.bmin, glm::greaterThanEqual(normal, glm::vec3(0.f)));
+			if (glm::dot(normal, far_corner) + planes[p].w < 0.f) {
+				outside = true;
+				break;
+			}
+			if (glm::dot(normal, near_corner) + planes[p].w >= 0.f)
+				mask &= ~(1u << p);
+		}
+		if (outside)
+			continue;
+		if (mask == 0) {
+			collect_leaves(e.node, out);
+			continue;
+		}
+		if (n.is_leaf()) {
+			out.push_back(n.user_data);
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		stack[count++] = {n.child1, mask};
+		stack[count++] = {n.child2, mask};
+	}
+}
+
+void DynamicAabbTree::query_sphere(const glm::vec3& center, float radius, std::vector<int>& out) const {
+	if (root == NULL_NODE)
+		return;
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = root;
+	while (count > 0) {
+		const Node& n = nodes[stack[--count]];
+		const glm::vec3 closest = glm::clamp(center, n.aabb.bmin, n.aabb.bmax);
+		const glm::vec3 d = closest - center;
+		if (glm::dot(d, d) > radius * radius)
+			continue;
+		if (n.is_leaf()) {
+			out.push_back(n.user_data);
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		stack[count++] = n.child1;
+		stack[count++] = n.child2;
+	}
+}
+
+void DynamicAabbTree::query_aabb(const Bounds& aabb, std::vector<int>& out) const {
+	if (root == NULL_NODE)
+		return;
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = root;
+	while (count > 0) {
+		const Node& n = nodes[stack[--count]];
+		if (!n.aabb.intersect(aabb))
+			continue;
+		if (n.is_leaf()) {
+			out.push_back(n.user_data);
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		stack[count++] = n.child1;
+		stack[count++] = n.child2;
+	}
+}
+
+float DynamicAabbTree::get_area_ratio() const {
+	if (root == NULL_NODE)
+		return 0.f;
+	const float root_area = nodes[root].aabb.surface_area();
+	if (root_area <= 0.f)
+		return 0.f;
+	float total = 0.f;
+	for (const Node& n : nodes)
+		if (n.height > 0)
+			total += n.aabb.surface_area();
+	return total / root_area;
+}
+
+bool DynamicAabbTree::validate() const {
+	if (root == NULL_NODE)
+		return num_leaves == 0;
+	if (nodes[root].parent != NULL_NODE)
+		return false;
+	int leaves = 0;
+	std::vector<int> stack = {root};
+	while (!stack.empty()) {
+		const int index = stack.back();
+		stack.pop_back();
+		const Node& n = nodes[index];
+		if (n.is_leaf()) {
+			if (n.height != 0 || n.child2 != NULL_NODE)
+				return false;
+			leaves++;
+			continue;
+		}
+		const Node& c1 = nodes[n.child1];
+		const Node& c2 = nodes[n.child2];
+		if (c1.parent != index || c2.parent != index)
+			return false;
+		if (n.height != 1 + std::max(c1.height, c2.height))
+			return false;
+		if (!contains(n.aabb, c1.aabb) || !contains(n.aabb, c2.aabb))
+			return false;
+		stack.push_back(n.child1);
+		stack.push_back(n.child2);
+	}
+	return leaves == num_leaves;
+}
+
+// Collapses two binary levels into one wide node: children are expanded largest first until there are 4.
+int DynamicAabbTree::build_wide_node(int node) {
+	const int wide = (int)wide_nodes.size();
+	wide_nodes.push_back(WideNode());
+
+	int children[4] = {node, NULL_NODE, NULL_NODE, NULL_NODE};
+	int num_children = 1;
+	if (!nodes[node].is_leaf()) {
+		children[0] = nodes[node].child1;
+		children[1] = nodes[node].child2;
+		num_children = 2;
+	}
+	while (num_children < 4) {
+		int expand = -1;
+		float expand_area = -1.f;
+		for (int i = 0; i < num_children; i++) {
+			const Node& c = nodes[children[i]];
+			if (!c.is_leaf() && c.aabb.surface_area() > expand_area) {
+				expand = i;
+				expand_area = c.aabb.surface_area();
+			}
+		}
+		if (expand == -1)
+			break;
+		const int c = children[expand];
+		children[expand] = nodes[c].child1;
+		children[num_children++] = nodes[c].child2;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		int child = EMPTY_SLOT;
+		Bounds b(glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX));
+		if (i < num_children) {
+			const Node& c = nodes[children[i]];
+			b = c.aabb;
+			child = c.is_leaf() ? ~c.user_data : build_wide_node(children[i]);
+		}
+		// wide_nodes may have grown, index again
+		WideNode& w = wide_nodes[wide];
+		w.min_x[i] = b.bmin.x;
+		w.min_y[i] = b.bmin.y;
+		w.min_z[i] = b.bmin.z;
+		w.max_x[i] = b.bmax.x;
+		w.max_y[i] = b.bmax.y;
+		w.max_z[i] = b.bmax.z;
+		w.child[i] = child;
+	}
+	return wide;
+}
+
+void DynamicAabbTree::build_wide() {
+	if (!wide_dirty)
+		return;
+	wide_nodes.clear();
+	wide_nodes.reserve(num_leaves / 2 + 1);
+	if (root != NULL_NODE)
+		build_wide_node(root);
+	wide_dirty = false;
+}
+
+void DynamicAabbTree::query_planes_wide(const glm::vec4* planes, int num_planes, std::vector<int>& out) const {
+	ASSERT(num_planes <= MAX_QUERY_PLANES);
+	ASSERT(!wide_dirty && "DynamicAabbTree: build_wide() after changing the tree");
+	if (wide_nodes.empty())
+		return;
+	__m128 px[MAX_QUERY_PLANES], py[MAX_QUERY_PLANES], pz[MAX_QUERY_PLANES], pw[MAX_QUERY_PLANES];
+	for (int p = 0; p < num_planes; p++) {
+		px[p] = _mm_set1_ps(planes[p].x);
+		py[p] = _mm_set1_ps(planes[p].y);
+		pz[p] = _mm_set1_ps(planes[p].z);
+		pw[p] = _mm_set1_ps(planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = 0;
+	while (count > 0) {
+		const WideNode& w = wide_nodes[stack[--count]];
+		const __m128 min_x = _mm_loadu_ps(w.min_x), max_x = _mm_loadu_ps(w.max_x);
+		const __m128 min_y = _mm_loadu_ps(w.min_y), max_y = _mm_loadu_ps(w.max_y);
+		const __m128 min_z = _mm_loadu_ps(w.min_z), max_z = _mm_loadu_ps(w.max_z);
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+		for (int p = 0; p < num_planes; p++) {
+			// distance of the corner furthest along the normal: per axis the larger of n*min and n*max
+			const __m128 dx = _mm_max_ps(_mm_mul_ps(px[p], min_x), _mm_mul_ps(px[p], max_x));
+			const __m128 dy = _mm_max_ps(_mm_mul_ps(py[p], min_y), _mm_mul_ps(py[p], max_y));
+			const __m128 dz = _mm_max_ps(_mm_mul_ps(pz[p], min_z), _mm_mul_ps(pz[p], max_z));
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(dx, dy), dz), pw[p]);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+		}
+		const int mask = _mm_movemask_ps(inside);
+		for (int i = 0; i < 4; i++) {
+			const int child = w.child[i];
+			if (!(mask & (1 << i)) || child == EMPTY_SLOT)
+				continue;
+			if (child >= 0) {
+				ASSERT(count < STACK_SIZE);
+				stack[count++] = child;
+			} else {
+				out.push_back(~child);
+			}
+		}
+	}
+}
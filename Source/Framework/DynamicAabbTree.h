@@ -0,0 +1,134 @@
+#pragma once
+#include "Framework/MathLib.h"
+#include "Framework/Util.h"
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+// Incrementally updated bounding volume hierarchy for things that move around, same idea as Box2D's b2DynamicTree.
+// Leaves store a fattened box so small moves don't touch the tree, inserts pick a sibling by surface area and the
+// walk back up does tree rotations to keep it balanced without a rebuild.
+//
+// A proxy id is the leaf node index, stable until remove(). user_data is what queries return (a handle id), >= 0.
+// Queries take planes as (normal, d) with dot(normal, p) + d >= 0 on the inside, like Frustum.
+class DynamicAabbTree
+{
+public:
+	static const int NULL_NODE = -1;
+	static const int MAX_QUERY_PLANES = 8;
+
+	// added to every side of a leaf box
+	void set_margin(float margin) { this->margin = margin; }
+
+	int insert(const Bounds& aabb, int user_data);
+	void remove(int proxy);
+	// returns true if the tree changed, false if aabb was still inside the fat box
+	bool move(int proxy, const Bounds& aabb);
+	void clear();
+
+	int get_user_data(int proxy) const { return nodes[proxy].user_data; }
+	const Bounds& get_fat_aabb(int proxy) const { return nodes[proxy].aabb; }
+
+	// out gets user_data of leaves touching the region appended, in no particular order
+	void query_planes(const glm::vec4* planes, int num_planes, std::vector<int>& out) const;
+	void query_sphere(const glm::vec3& center, float radius, std::vector<int>& out) const;
+	void query_aabb(const Bounds& aabb, std::vector<int>& out) const;
+	// fn(user_data, t_enter) for leaves the ray hits before max_t, nearest subtree first. fn returns the new max_t:
+	// the hit distance to clip, max_t to keep going, 0 to stop.
+	template <typename Fn> void query_ray(const Ray& ray, float max_t, const Fn& fn) const;
+
+	// 4-wide copy of the tree, children stored as x/y/z arrays so one SSE test covers a node's 4 boxes. Rebuilt by
+	// build_wide() when the tree changed since the last one, query_planes_wide() uses it.
+	void build_wide();
+	bool is_wide_current() const { return !wide_dirty; }
+	void query_planes_wide(const glm::vec4* planes, int num_planes, std::vector<int>& out) const;
+
+	int get_num_leaves() const { return num_leaves; }
+	int get_height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+	// sum of internal node areas over the root area, lower is better
+	float get_area_ratio() const;
+	// checks parent links, heights and boxes, returns false on the first broken node
+	bool validate() const;
+
+private:
+	struct Node
+	{
+		Bounds aabb; // fat box for leaves
+		int parent = NULL_NODE; // next free node when unused
+		int child1 = NULL_NODE;
+		int child2 = NULL_NODE;
+		int height = -1; // 0 for leaves, -1 when unused
+		int user_data = -1;
+		bool is_leaf() const { return child1 == NULL_NODE; }
+	};
+	struct WideNode
+	{
+		float min_x[4], min_y[4], min_z[4];
+		float max_x[4], max_y[4], max_z[4];
+		int child[4]; // >= 0 wide node, otherwise ~user_data, EMPTY_SLOT if unused
+	};
+	static const int EMPTY_SLOT = INT_MIN;
+	static const int STACK_SIZE = 1024;
+
+	int alloc_node();
+	void free_node(int node);
+	void insert_leaf(int leaf);
+	void remove_leaf(int leaf);
+	void rotate(int node);
+	void fix_upwards(int node, bool rotate_nodes);
+	void collect_leaves(int node, std::vector<int>& out) const;
+	int build_wide_node(int node);
+
+	std::vector<Node> nodes;
+	int root = NULL_NODE;
+	int free_list = NULL_NODE;
+	int num_leaves = 0;
+	float margin = 0.1f;
+
+	std::vector<WideNode> wide_nodes;
+	bool wide_dirty = true;
+};
+
+template <typename Fn> void DynamicAabbTree::query_ray(const Ray& ray, float max_t, const Fn& fn) const {
+	if (root == NULL_NODE)
+		return;
+	const glm::vec3 inv_dir = 1.f / ray.dir;
+	auto slab = [&](const Bounds& b, float& t_enter) {
+		const glm::vec3 t0 = (b.bmin - ray.pos) * inv_dir;
+		const glm::vec3 t1 = (b.bmax - ray.pos) * inv_dir;
+		const glm::vec3 tmin = glm::min(t0, t1);
+		const glm::vec3 tmax = glm::max(t0, t1);
+		t_enter = glm::max(glm::max(tmin.x, tmin.y), glm::max(tmin.z, 0.f));
+		const float t_exit = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+		return t_enter <= t_exit && t_enter <= max_t;
+	};
+
+	int stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = root;
+	while (count > 0) {
+		const Node& n = nodes[stack[--count]];
+		float t_enter = 0.f;
+		if (!slab(n.aabb, t_enter))
+			continue;
+		if (n.is_leaf()) {
+			max_t = fn(n.user_data, t_enter);
+			if (max_t <= 0.f)
+				return;
+			continue;
+		}
+		ASSERT(count + 2 <= STACK_SIZE);
+		// push the farther child first so the nearer one is popped first and can clip max_t
+		float t1 = 0.f, t2 = 0.f;
+		const bool hit1 = slab(nodes[n.child1].aabb, t1);
+		const bool hit2 = slab(nodes[n.child2].aabb, t2);
+		if (hit1 && hit2) {
+			stack[count++] = t1 <= t2 ? n.child2 : n.child1;
+			stack[count++] = t1 <= t2 ? n.child1 : n.child2;
+		} else if (hit1) {
+			stack[count++] = n.child1;
+		} else if (hit2) {
+			stack[count++] = n.child2;
+		}
+	}
+}
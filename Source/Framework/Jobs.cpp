@@ -3,81 +3,317 @@
 #include <vector>
 #include <cassert>
 #include <string>
+#include <algorithm>
+#include <unordered_map>
 #include "Framework/Profiler.h"
 
-// thread_local int osthread_id = 0;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JOB_CPU_PAUSE() _mm_pause()
+#else
+#define JOB_CPU_PAUSE() ((void)0)
+#endif
 
-void JobSystem::worker_thread_loop(int id) {
-	prof::set_current_thread_profiler_name(("JobWorker " + std::to_string(id)).c_str());
-	for (;;) {
-		JobDecl job;
-		{
-			std::unique_lock<std::mutex> lock(inst->job_mutex);
-			inst->cv.wait(lock, []() { return !inst->job_queue.empty(); });
-			job = inst->job_queue[0];
-			inst->job_queue.pop_front();
+// Chase-Lev deque with a fixed power-of-two capacity (memory orders follow Le et al.
+// "Correct and Efficient Work-Stealing for Weak Memory Models"). push()/pop() are
+// owner-only, steal() is safe from any thread. push() refuses rather than grows when
+// full; the caller falls back to the injection queue.
+// A slot is never rewritten while top still points at it (push stops at capacity), so
+// a thief that loses the CAS just discards what it read.
+class JobSystem::WorkQueue
+{
+public:
+	static const int64_t CAPACITY = 4096;
+	static const int64_t MASK = CAPACITY - 1;
+
+	bool push(const JobDecl& j) {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= CAPACITY)
+			return false;
+		slots[b & MASK] = j;
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+	bool pop(JobDecl& out) {
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		out = slots[b & MASK];
+		if (t == b) {
+			// last item, race any thieves for it
+			const bool won =
+				top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
 		}
+		return true;
+	}
+	bool steal(JobDecl& out) {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+		out = slots[t & MASK];
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
 
-		job.func(job.funcarg);
+private:
+	alignas(64) std::atomic<int64_t> top{0};
+	alignas(64) std::atomic<int64_t> bottom{0};
+	alignas(64) JobDecl slots[CAPACITY];
+};
 
-		JobCounter* c = job.counter;
-		if (c) {
-			int o = c->c.fetch_sub(1); // decrement
-			if (o == 1 /*  0 after decrement */) {
-				std::unique_lock<std::mutex> lock(inst->mt.mutex);
-				inst->mt.cv.notify_all();
-			}
+// which queue the calling thread owns, only valid when tls_owner == the system asking
+static thread_local JobSystem* tls_owner = nullptr;
+static thread_local int tls_queue_index = -1;
+
+void JobSystem::run_job(const JobDecl& job) {
+	job.func(job.funcarg);
+	if (job.counter)
+		job.counter->c.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool JobSystem::find_job(JobDecl& out) {
+	const int self = (tls_owner == this) ? tls_queue_index : -1;
+	if (self >= 0 && queues[self]->pop(out)) {
+		num_queued.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	if (inject_count.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(inject_mutex);
+		if (!inject_queue.empty()) {
+			out = inject_queue[0];
+			inject_queue.pop_front();
+			inject_count.fetch_sub(1, std::memory_order_relaxed);
+			num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	// steal, starting after ourselves so thieves spread out over victims
+	const int n = (int)queues.size();
+	const int start = (self >= 0) ? self + 1 : 0;
+	for (int i = 0; i < n; i++) {
+		const int victim = (start + i) % n;
+		if (victim == self)
+			continue;
+		if (queues[victim]->steal(out)) {
+			num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
 		}
 	}
+	return false;
+}
+
+void JobSystem::wake_workers(int count) {
+	if (num_sleeping.load(std::memory_order_seq_cst) == 0)
+		return;
+	{
+		// pairs with the predicate check in worker_thread_loop so a worker about to
+		// sleep can't miss this wakeup
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	if (count == 1)
+		sleep_cv.notify_one();
+	else
+		sleep_cv.notify_all();
+}
+
+void JobSystem::submit(JobDecl* j, int count) {
+	const int self = (tls_owner == this) ? tls_queue_index : -1;
+	int pushed = 0;
+	if (self >= 0) {
+		WorkQueue& q = *queues[self];
+		while (pushed < count && q.push(j[pushed]))
+			pushed++;
+	}
+	if (pushed < count) {
+		std::lock_guard<std::mutex> lock(inject_mutex);
+		for (int i = pushed; i < count; i++)
+			inject_queue.push_back(j[i]);
+		inject_count.fetch_add(count - pushed, std::memory_order_relaxed);
+	}
+	num_queued.fetch_add(count, std::memory_order_seq_cst);
+	wake_workers(count);
+}
+
+void JobSystem::worker_thread_loop(JobSystem* self, int id) {
+	prof::set_current_thread_profiler_name(("JobWorker " + std::to_string(id)).c_str());
+	tls_owner = self;
+	tls_queue_index = id;
+
+	const int SPIN_COUNT = 64;
+	int idle_spins = 0;
+	while (!self->stopping.load(std::memory_order_relaxed)) {
+		JobDecl job;
+		if (self->find_job(job)) {
+			run_job(job);
+			idle_spins = 0;
+			continue;
+		}
+		if (idle_spins++ < SPIN_COUNT) {
+			JOB_CPU_PAUSE();
+			continue;
+		}
+		idle_spins = 0;
+
+		std::unique_lock<std::mutex> lock(self->sleep_mutex);
+		self->num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+		self->sleep_cv.wait(lock, [self]() {
+			return self->num_queued.load(std::memory_order_seq_cst) > 0 ||
+				   self->stopping.load(std::memory_order_relaxed);
+		});
+		self->num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
 }
 
 void JobSystem::wait_and_free_counter(JobCounter*& c) {
 	if (!c)
 		return;
-	if (c->c.load() == 0) {
-		delete c;
-		c = nullptr;
-		return; // dont need to wait, continue
-	}
 
-	std::unique_lock<std::mutex> lock(mt.mutex);
-	mt.cv.wait(lock, [&]() { return c->c.load() <= 0; });
+	// help out instead of sleeping; this also makes waiting from inside a job safe
+	int idle_spins = 0;
+	while (c->c.load(std::memory_order_acquire) > 0) {
+		if (try_run_pending_job()) {
+			idle_spins = 0;
+		}
+		else if (idle_spins++ < 64) {
+			JOB_CPU_PAUSE();
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
 
-	delete c;
+	free_counter(c);
 	c = nullptr;
 }
 
+bool JobSystem::try_run_pending_job() {
+	JobDecl job;
+	if (!find_job(job))
+		return false;
+	run_job(job);
+	return true;
+}
+
+void JobSystem::parallel_for_drain(uintptr_t arg) {
+	ParallelForArgs& args = *reinterpret_cast<ParallelForArgs*>(arg);
+	for (;;) {
+		const int chunk = args.next_chunk.fetch_add(1, std::memory_order_relaxed);
+		if (chunk >= args.num_chunks)
+			break;
+		const int b = args.begin + chunk * args.grain;
+		const int e = std::min(b + args.grain, args.end);
+		args.invoke(args.fn, b, e);
+	}
+}
+
+void JobSystem::run_parallel_for(ParallelForArgs& args) {
+	if (args.end <= args.begin)
+		return;
+	if (args.grain < 1)
+		args.grain = 1;
+	args.num_chunks = (args.end - args.begin + args.grain - 1) / args.grain;
+	args.next_chunk.store(0, std::memory_order_relaxed);
+
+	// one helper job per worker that can be kept busy, chunks are handed out dynamically
+	const int MAX_HELPERS = 64;
+	const int helpers = std::min(std::min(args.num_chunks - 1, get_num_workers()), MAX_HELPERS);
+	if (helpers <= 0 || !with_threading.get_bool()) {
+		parallel_for_drain(uintptr_t(&args));
+		return;
+	}
+	JobDecl decls[MAX_HELPERS];
+	for (int i = 0; i < helpers; i++) {
+		decls[i].func = parallel_for_drain;
+		decls[i].funcarg = uintptr_t(&args);
+	}
+	JobCounter* c = nullptr;
+	add_jobs(decls, helpers, c);
+	parallel_for_drain(uintptr_t(&args));
+	wait_and_free_counter(c);
+}
+
+JobCounter* JobSystem::alloc_counter() {
+	std::lock_guard<std::mutex> lock(counter_mutex);
+	if (!counter_free_list) {
+		const int BLOCK_SIZE = 64;
+		counter_blocks.push_back(std::unique_ptr<JobCounter[]>(new JobCounter[BLOCK_SIZE]));
+		JobCounter* block = counter_blocks.back().get();
+		for (int i = 0; i < BLOCK_SIZE; i++) {
+			block[i].next_free = counter_free_list;
+			counter_free_list = &block[i];
+		}
+	}
+	JobCounter* c = counter_free_list;
+	counter_free_list = c->next_free;
+	c->next_free = nullptr;
+	c->c.store(0, std::memory_order_relaxed);
+	return c;
+}
+
+void JobSystem::free_counter(JobCounter* c) {
+	std::lock_guard<std::mutex> lock(counter_mutex);
+	c->next_free = counter_free_list;
+	counter_free_list = c;
+}
+
 JobSystem* JobSystem::inst = nullptr;
 
 ConfigVar threading_num_worker_threads("threading.num_worker_threads", "0", CVAR_INTEGER | CVAR_DEV,
 									   "number of worker threads, 0 for default", 0, 8);
 
 JobSystem::JobSystem() {
+	init(threading_num_worker_threads.get_integer());
+}
+JobSystem::JobSystem(int num_workers) {
+	init(num_workers);
+}
+void JobSystem::init(int NUM_WORKERS) {
 	inst = this;
 
-	int NUM_WORKERS = threading_num_worker_threads.get_integer();
-	if (NUM_WORKERS == 0)
+	if (NUM_WORKERS <= 0)
 		NUM_WORKERS = std::thread::hardware_concurrency() - 2;
 	if (NUM_WORKERS <= 0)
 		NUM_WORKERS = 1;
 
-	for (int i = 0; i < NUM_WORKERS; i++) {
-		threads.push_back(std::thread(worker_thread_loop, i + 1));
-		threads.back().detach();
-	}
+	// the constructing thread owns queue 0
+	for (int i = 0; i < NUM_WORKERS + 1; i++)
+		queues.push_back(std::make_unique<WorkQueue>());
+	tls_owner = this;
+	tls_queue_index = 0;
+
+	for (int i = 0; i < NUM_WORKERS; i++)
+		threads.push_back(std::thread(worker_thread_loop, this, i + 1));
 }
-void JobSystem::add_job_internal(JobDecl j) {
+JobSystem::~JobSystem() {
 	{
-		std::lock_guard<std::mutex> lock(job_mutex);
-		job_queue.push_back(j);
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping.store(true);
+	}
+	sleep_cv.notify_all();
+	for (auto& t : threads)
+		t.join();
+	if (tls_owner == this) {
+		tls_owner = nullptr;
+		tls_queue_index = -1;
 	}
-	cv.notify_one();
+	if (inst == this)
+		inst = nullptr;
 }
 void JobSystem::add_job_no_counter(void (*func)(uintptr_t), uintptr_t user) {
 	JobDecl decl;
 	decl.funcarg = user;
 	decl.func = func;
-	add_job_internal(decl);
+	submit(&decl, 1);
 }
 void JobSystem::add_job(JobDecl j, JobCounter*& c) {
 	if (!with_threading.get_bool()) {
@@ -86,12 +322,12 @@ void JobSystem::add_job(JobDecl j, JobCounter*& c) {
 	}
 
 	if (!c)
-		c = new JobCounter;
+		c = alloc_counter();
 
 	j.counter = c;
-	j.counter->c.fetch_add(1, std::memory_order::memory_order_relaxed);
+	j.counter->c.fetch_add(1, std::memory_order_relaxed);
 
-	add_job_internal(j);
+	submit(&j, 1);
 }
 void JobSystem::add_job(void (*func)(uintptr_t), uintptr_t user, JobCounter*& c) {
 	JobDecl decl;
@@ -107,15 +343,123 @@ void JobSystem::add_jobs(JobDecl* j, int count, JobCounter*& c) {
 		return;
 	}
 	if (!c)
-		c = new JobCounter;
-	c->c.fetch_add(count);
+		c = alloc_counter();
+	c->c.fetch_add(count, std::memory_order_relaxed);
 	for (int i = 0; i < count; i++) {
 		j[i].counter = c;
 	}
+	submit(j, count);
+}
+
+// profiler slots for graph node names, keyed by the name pointer (names are literals)
+static uint32_t get_graph_node_prof_slot(const char* name) {
+	static std::mutex slot_mutex;
+	static std::unordered_map<const char*, uint32_t> slots;
+	std::lock_guard<std::mutex> lock(slot_mutex);
+	auto find = slots.find(name);
+	if (find != slots.end())
+		return find->second;
+	const uint32_t slot = prof::ProfilerRegistry::register_zone(name, __FILE__, __LINE__, false);
+	slots.insert({name, slot});
+	return slot;
+}
+
+JobGraph::NodeId JobGraph::add_node(const char* name, std::function<void()> fn, Affinity affinity) {
+	Node n;
+	n.name = name;
+	n.prof_slot = get_graph_node_prof_slot(name);
+	n.fn = std::move(fn);
+	n.affinity = affinity;
+	nodes.push_back(std::move(n));
+	return (NodeId)nodes.size() - 1;
+}
+
+void JobGraph::run_after(NodeId node, NodeId dependency) {
+	ASSERT(node >= 0 && node < (int)nodes.size());
+	ASSERT(dependency >= 0 && dependency < (int)nodes.size());
+	ASSERT(node != dependency);
+	nodes[dependency].dependents.push_back(node);
+	nodes[node].num_dependencies++;
+}
+
+void JobGraph::execute_node(NodeId id) {
+	Node& n = nodes[id];
 	{
-		std::lock_guard<std::mutex> lock(job_mutex);
-		for (int i = 0; i < count; i++)
-			job_queue.push_back(j[i]);
+		prof::ProfilerCpuScope scope(n.prof_slot);
+		n.fn();
+	}
+	for (NodeId d : n.dependents) {
+		if (remaining[d].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			schedule_node(d);
+	}
+	nodes_left.fetch_sub(1, std::memory_order_release);
+}
+
+void JobGraph::node_job(uintptr_t arg) {
+	NodeJobArg* a = reinterpret_cast<NodeJobArg*>(arg);
+	a->graph->execute_node(a->id);
+}
+
+void JobGraph::schedule_node(NodeId id) {
+	if (!threaded || nodes[id].affinity == MainThread) {
+		std::lock_guard<std::mutex> lock(main_ready_mutex);
+		main_ready.push_back(id);
+	}
+	else {
+		JobSystem::inst->add_job_no_counter(node_job, uintptr_t(&job_args[id]));
+	}
+}
+
+void JobGraph::run() {
+	const int count = (int)nodes.size();
+	if (count == 0)
+		return;
+	threaded = JobSystem::inst && with_threading.get_bool();
+	remaining.reset(new std::atomic<int>[count]);
+	job_args.resize(count);
+	main_ready.clear();
+	nodes_left.store(count, std::memory_order_relaxed);
+	for (int i = 0; i < count; i++) {
+		remaining[i].store(nodes[i].num_dependencies, std::memory_order_relaxed);
+		job_args[i].graph = this;
+		job_args[i].id = i;
+	}
+	int num_roots = 0;
+	for (int i = 0; i < count; i++) {
+		if (nodes[i].num_dependencies == 0) {
+			schedule_node(i);
+			num_roots++;
+		}
+	}
+	if (num_roots == 0)
+		Fatalf("JobGraph::run: graph has a cycle, no node without dependencies\n");
+
+	int idle_spins = 0;
+	while (nodes_left.load(std::memory_order_acquire) > 0) {
+		NodeId next = -1;
+		{
+			std::lock_guard<std::mutex> lock(main_ready_mutex);
+			if (!main_ready.empty()) {
+				next = main_ready.back();
+				main_ready.pop_back();
+			}
+		}
+		if (next != -1) {
+			execute_node(next);
+			idle_spins = 0;
+		}
+		else if (threaded && JobSystem::inst->try_run_pending_job()) {
+			idle_spins = 0;
+		}
+		else if (!threaded) {
+			// single threaded and nothing is ready but nodes are left: only possible with a cycle
+			Fatalf("JobGraph::run: graph has a cycle\n");
+		}
+		else if (idle_spins++ < 64) {
+			JOB_CPU_PAUSE();
+		}
+		else {
+			std::this_thread::yield();
+		}
 	}
-	cv.notify_all();
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include "Framework/Config.h"
 #include <future>
+#include <atomic>
+#include <memory>
+#include <functional>
 #include "RingBuffer.h"
 extern ConfigVar with_threading;
 
@@ -10,7 +13,8 @@ struct JobCounter
 public:
 private:
 	JobCounter() = default;
-	std::atomic<int> c; // counts down to 0
+	std::atomic<int> c{0}; // counts down to 0
+	JobCounter* next_free = nullptr;
 	friend class JobSystem;
 };
 struct JobDecl
@@ -19,28 +23,152 @@ struct JobDecl
 	uintptr_t funcarg = 0;
 	JobCounter* counter = nullptr;
 };
+
+// Work-stealing job scheduler. Every worker (and the thread that constructed the
+// system, "main") owns a lock-free deque: jobs are pushed/popped at the bottom by
+// the owner and stolen from the top by everyone else. Threads that don't own a
+// deque submit through a mutex-protected injection queue.
+// wait_and_free_counter() runs pending jobs while the counter is non-zero instead
+// of parking the caller, so it's safe (and cheap) to wait from inside a job.
+// Counters are pooled; never hold on to one after waiting on it.
 class JobSystem
 {
 public:
 	static JobSystem* inst;
 	JobSystem();
-	~JobSystem() {}
+	explicit JobSystem(int num_workers); // num_workers <= 0 picks the default
+	~JobSystem();
 	void add_job(JobDecl j, JobCounter*& c);
 	void add_job(void (*func)(uintptr_t), uintptr_t user, JobCounter*& c);
 	void add_job_no_counter(void (*func)(uintptr_t), uintptr_t user);
 	void add_jobs(JobDecl* j, int count, JobCounter*& c);
 	void wait_and_free_counter(JobCounter*& c);
+	// runs one queued job on the calling thread if there is one, returns false if nothing was found
+	bool try_run_pending_job();
+
+	// Calls fn(i) for every i in [begin,end). The range is cut into chunks of `grain`
+	// indices that the caller and the workers pull from until it's drained. Blocks.
+	template <typename Fn> void parallel_for(int begin, int end, int grain, const Fn& fn) {
+		parallel_for_chunks(begin, end, grain, [&fn](int chunk_begin, int chunk_end) {
+			for (int i = chunk_begin; i < chunk_end; i++)
+				fn(i);
+		});
+	}
+	// Same as parallel_for, but fn(chunk_begin, chunk_end) is called once per chunk.
+	// Chunk index is (chunk_begin - begin) / grain, for callers that keep per-chunk output.
+	template <typename Fn> void parallel_for_chunks(int begin, int end, int grain, const Fn& fn) {
+		ParallelForArgs args;
+		args.invoke = [](const void* f, int b, int e) { (*static_cast<const Fn*>(f))(b, e); };
+		args.fn = &fn;
+		args.begin = begin;
+		args.end = end;
+		args.grain = grain;
+		run_parallel_for(args);
+	}
+
+	int get_num_workers() const { return (int)threads.size(); }
+	bool is_counter_done(const JobCounter* c) const { return !c || c->c.load(std::memory_order_acquire) <= 0; }
 
 private:
-	void add_job_internal(JobDecl j);
-	static void worker_thread_loop(int id);
+	class WorkQueue;
+
+	struct ParallelForArgs
+	{
+		void (*invoke)(const void* fn, int begin, int end) = nullptr;
+		const void* fn = nullptr;
+		int begin = 0;
+		int end = 0;
+		int grain = 1;
+		int num_chunks = 0;
+		std::atomic<int> next_chunk{0};
+	};
+	void run_parallel_for(ParallelForArgs& args);
+	static void parallel_for_drain(uintptr_t args);
+
+	void init(int num_workers);
+	void submit(JobDecl* j, int count);
+	bool find_job(JobDecl& out);
+	static void run_job(const JobDecl& job);
+	void wake_workers(int count);
+	static void worker_thread_loop(JobSystem* self, int id);
+
+	JobCounter* alloc_counter();
+	void free_counter(JobCounter* c);
+
 	std::vector<std::thread> threads;
-	RingBuffer<JobDecl> job_queue;
-	std::mutex job_mutex;
-	std::condition_variable cv;
-	struct mainthread_data
+	std::vector<std::unique_ptr<WorkQueue>> queues; // [0] = owning thread, [1..] = workers
+
+	// fallback for threads without a deque, and for overflow when a deque is full
+	RingBuffer<JobDecl> inject_queue;
+	std::mutex inject_mutex;
+	std::atomic<int> inject_count{0};
+
+	// sleeping workers. num_queued is the number of jobs sitting in any queue.
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cv;
+	std::atomic<int> num_queued{0};
+	std::atomic<int> num_sleeping{0};
+	std::atomic<bool> stopping{false};
+
+	std::mutex counter_mutex;
+	JobCounter* counter_free_list = nullptr;
+	std::vector<std::unique_ptr<JobCounter[]>> counter_blocks;
+};
+
+// Small per-frame dependency graph on top of JobSystem. A node becomes runnable once
+// every node it was made to run_after() has finished. Each node is wrapped in a
+// profiler zone with its name, so the graph shows up per frame in the CPU timeline.
+// Nodes flagged MainThread only ever run on the thread that called run(); use it for
+// anything touching Lua, asset loading or other main-thread-only state.
+//
+//	JobGraph g;
+//	auto physics = g.add_node("physics", [&]() { ... }, JobGraph::MainThread);
+//	auto anim = g.add_node("animation", [&]() { ... });
+//	g.run_after(anim, physics);
+//	g.run(); // blocks until every node ran
+class JobGraph
+{
+public:
+	using NodeId = int;
+	enum Affinity
 	{
-		std::mutex mutex;
-		std::condition_variable cv;
-	} mt;
+		AnyThread,
+		MainThread,
+	};
+
+	// name must outlive the graph (string literals), it's also the profiler zone name
+	NodeId add_node(const char* name, std::function<void()> fn, Affinity affinity = AnyThread);
+	void run_after(NodeId node, NodeId dependency);
+	void run();
+	void clear() { nodes.clear(); }
+	int num_nodes() const { return (int)nodes.size(); }
+
+private:
+	struct Node
+	{
+		const char* name = "";
+		uint32_t prof_slot = 0;
+		std::function<void()> fn;
+		Affinity affinity = AnyThread;
+		std::vector<NodeId> dependents;
+		int num_dependencies = 0;
+	};
+	struct NodeJobArg
+	{
+		JobGraph* graph = nullptr;
+		NodeId id = 0;
+	};
+	void execute_node(NodeId id);
+	void schedule_node(NodeId id);
+	static void node_job(uintptr_t arg);
+
+	std::vector<Node> nodes;
+
+	// only valid during run()
+	bool threaded = false;
+	std::unique_ptr<std::atomic<int>[]> remaining;
+	std::vector<NodeJobArg> job_args;
+	std::atomic<int> nodes_left{0};
+	std::mutex main_ready_mutex;
+	std::vector<NodeId> main_ready;
 };
@@ -39,8 +39,8 @@ public:
 		return out;
 	}
 
-	uintptr_t get_top_marker() { return top_pointer; }
-	uintptr_t get_bottom_marker() { return bottom_pointer; }
+	uintptr_t get_top_marker() const { return top_pointer; }
+	uintptr_t get_bottom_marker() const { return bottom_pointer; }
 	void free_top_to_marker(uintptr_t mark) { top_pointer = mark; }
 	void free_bottom_to_marker(uintptr_t mark) { bottom_pointer = mark; }
 
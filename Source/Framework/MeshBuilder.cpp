@@ -1,6 +1,7 @@
 #include "Framework/MeshBuilder.h"
 #include "MeshBuilderImpl.h"
 #include "Render/IGraphicsDevice.h"
+#include "Render/UploadRing.h"
 #include <glm/gtc/constants.hpp>
 
 static const int MIN_VERTEX_ARRAY_SIZE = 16;
@@ -9,9 +10,14 @@ const uint32_t MeshBuilderDD::TRIANGLES = (uint32_t)GraphicsPrimitiveType::Trian
 const uint32_t MeshBuilderDD::LINES     = (uint32_t)GraphicsPrimitiveType::Lines;
 
 void MeshBuilderDD::free() {
+	if (is_transient) {
+		vao = nullptr;
+		is_transient = false;
+	}
 	safe_release(vao);
 	safe_release(vbo);
 	safe_release(ebo);
+	index_byte_offset = base_vertex = 0;
 }
 
 void MeshBuilder::Begin(int reserve_verts) {
@@ -23,6 +29,8 @@ void MeshBuilder::Begin(int reserve_verts) {
 }
 
 void MeshBuilderDD::init_from(MeshBuilder& mb) {
+	if (is_transient)
+		free();
 	if (!mb.wants_new_upload)
 		return;
 	if (!vao) {
@@ -52,6 +60,18 @@ void MeshBuilderDD::init_from(MeshBuilder& mb) {
 	num_indicies = mb.indicies.size();
 }
 
+void MeshBuilderDD::init_transient(MeshBuilder& mb, TransientMeshRing& ring) {
+	if (!is_transient)
+		free();
+	is_transient = true;
+	mb.wants_new_upload = false;
+	TransientMesh mesh = ring.upload(mb);
+	vao = mesh.vao;
+	num_indicies = mesh.num_indices;
+	index_byte_offset = mesh.index_byte_offset;
+	base_vertex = mesh.base_vertex;
+}
+
 void MeshBuilder::End() {}
 
 void MeshBuilderDD::draw(uint32_t prim_type) {
@@ -60,8 +80,8 @@ void MeshBuilderDD::draw(uint32_t prim_type) {
 	// Caller is expected to have set state.vao = dd.vao on their
 	// RenderPipelineState before set_pipeline. This call only issues the draw —
 	// VAO/IBO/VBO are bound via the pipeline.
-	gfx().draw_elements(static_cast<GraphicsPrimitiveType>(prim_type),
-						num_indicies, VertexInputIndexType::uint32, 0);
+	gfx().draw_elements_base_vertex(static_cast<GraphicsPrimitiveType>(prim_type), num_indicies,
+									 VertexInputIndexType::uint32, index_byte_offset, base_vertex);
 }
 
 void MeshBuilder::PushLine(vec3 start, vec3 end, Color32 color) {
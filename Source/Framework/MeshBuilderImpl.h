@@ -3,12 +3,15 @@
 class MeshBuilder;
 class IGraphicsBuffer;
 class IGraphicsVertexInput;
+class TransientMeshRing;
 class MeshBuilderDD
 {
 public:
 	void free();
 	void draw(uint32_t type);
 	void init_from(MeshBuilder& mb);
+	// uploads into the ring every call instead of owning buffers, the geometry is valid for this frame only
+	void init_transient(MeshBuilder& mb, TransientMeshRing& ring);
 
 	// can also use these instead
 	static const uint32_t TRIANGLES;
@@ -18,4 +21,8 @@ public:
 	IGraphicsBuffer* ebo = nullptr;
 	IGraphicsVertexInput* vao = nullptr;
 	int num_indicies = 0;
+	// set by init_transient, vao belongs to the ring then
+	bool is_transient = false;
+	int index_byte_offset = 0;
+	int base_vertex = 0;
 };
\ No newline at end of file
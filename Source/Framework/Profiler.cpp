@@ -45,6 +45,65 @@ uint32_t ProfilerRegistry::zone_count() {
 	return (uint32_t)g_zone_locations.size();
 }
 
+// ---- Counters -------------------------------------------------------------
+
+static constexpr uint32_t kMaxCounters = 256;
+struct CounterSlot
+{
+	std::atomic<int64_t> current{ 0 };
+	std::atomic<int64_t> last_frame{ 0 };
+	std::atomic<int64_t> peak{ 0 };
+};
+static std::mutex g_counter_mutex;
+static std::vector<CounterInfo> g_counter_infos; // name + unit, values live in g_counter_slots
+static CounterSlot g_counter_slots[kMaxCounters];
+
+uint32_t ProfilerCounters::register_counter(const char* name, CounterUnit unit) {
+	std::lock_guard<std::mutex> lock(g_counter_mutex);
+	for (uint32_t i = 0; i < g_counter_infos.size(); i++)
+		if (g_counter_infos[i].name == name)
+			return i;
+	ASSERT(g_counter_infos.size() < kMaxCounters);
+	CounterInfo info;
+	info.name = name;
+	info.unit = unit;
+	g_counter_infos.push_back(info);
+	return (uint32_t)g_counter_infos.size() - 1;
+}
+void ProfilerCounters::add(uint32_t slot, int64_t value) {
+	g_counter_slots[slot].current.fetch_add(value, std::memory_order_relaxed);
+}
+void ProfilerCounters::report_max(uint32_t slot, int64_t value) {
+	auto& cur = g_counter_slots[slot].current;
+	int64_t prev = cur.load(std::memory_order_relaxed);
+	while (prev < value && !cur.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+	}
+}
+std::vector<CounterInfo> ProfilerCounters::snapshot() {
+	std::lock_guard<std::mutex> lock(g_counter_mutex);
+	std::vector<CounterInfo> out = g_counter_infos;
+	for (uint32_t i = 0; i < out.size(); i++) {
+		out[i].last_frame = g_counter_slots[i].last_frame.load(std::memory_order_relaxed);
+		out[i].peak       = g_counter_slots[i].peak.load(std::memory_order_relaxed);
+	}
+	return out;
+}
+
+static void publish_counters() {
+	uint32_t count = 0;
+	{
+		std::lock_guard<std::mutex> lock(g_counter_mutex);
+		count = (uint32_t)g_counter_infos.size();
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		CounterSlot& c      = g_counter_slots[i];
+		const int64_t value = c.current.exchange(0, std::memory_order_relaxed);
+		c.last_frame.store(value, std::memory_order_relaxed);
+		if (value > c.peak.load(std::memory_order_relaxed))
+			c.peak.store(value, std::memory_order_relaxed);
+	}
+}
+
 // ---- Recording capacity --------------------------------------------------
 
 // Live mode still keeps a short rolling window -- GPU zone results resolve a
@@ -188,7 +247,8 @@ static void resolve_gpu_queries() {
 }
 
 ProfilerGpuScope::ProfilerGpuScope(uint32_t slot) : slot_(slot) {
-	active_ = Profiler::enabled();
+	// timestamps can't go into a GraphicsCommandList and the GPU lane isn't thread safe, the caller times the replay
+	active_ = Profiler::enabled() && !gfx_is_recording();
 	if (!active_)
 		return;
 
@@ -266,6 +326,8 @@ void Profiler::clear_history() {
 	for (auto* t : g_threads)
 		t->ring.clear();
 	gpu_capture().ring.clear();
+	for (auto& c : g_counter_slots)
+		c.peak.store(0, std::memory_order_relaxed);
 }
 
 std::vector<ThreadCapture*> Profiler::all_threads() {
@@ -278,6 +340,7 @@ void Profiler::end_frame() {
 
 	resolve_gpu_queries();
 	rotate_into_ring(gpu_capture(), finishing_frame);
+	publish_counters();
 
 	{
 		std::lock_guard<std::mutex> lock(g_threads_mutex);
@@ -115,6 +115,32 @@ private:
 	uint32_t slot_;
 };
 
+// ---- Counters -----------------------------------------------------------
+
+// Named per-frame numbers (pool usage, cache hits, ...) listed under the
+// Overall tab. Any thread can report: add() accumulates into the current
+// frame, report_max() keeps the largest value reported this frame.
+// Profiler::end_frame() publishes the frame's value and resets it to 0.
+enum class CounterUnit : uint8_t { Count, Bytes };
+
+struct CounterInfo
+{
+	std::string name;
+	CounterUnit unit  = CounterUnit::Count;
+	int64_t last_frame = 0; // value of the last finished frame
+	int64_t peak       = 0; // largest last_frame since clear_history()
+};
+
+class ProfilerCounters
+{
+public:
+	// Same name returns the same slot, so several call sites can feed one counter.
+	static uint32_t register_counter(const char* name, CounterUnit unit);
+	static void add(uint32_t slot, int64_t value);
+	static void report_max(uint32_t slot, int64_t value);
+	static std::vector<CounterInfo> snapshot();
+};
+
 // ---- Global control / frame boundary -----------------------------------
 
 enum class RecordingState : uint8_t { Live, Recording, Paused };
@@ -193,5 +219,17 @@ void set_current_thread_profiler_name(const char* name);
 	CPU_SCOPE(name);                                                                                                   \
 	GPU_SCOPE(name)
 
+#define PROF_COUNTER_ADD(name, unit, value)                                                                           \
+	do {                                                                                                              \
+		static uint32_t _prof_counter_slot = prof::ProfilerCounters::register_counter(name, unit);                    \
+		prof::ProfilerCounters::add(_prof_counter_slot, value);                                                       \
+	} while (0)
+
+#define PROF_COUNTER_MAX(name, unit, value)                                                                           \
+	do {                                                                                                              \
+		static uint32_t _prof_counter_slot = prof::ProfilerCounters::register_counter(name, unit);                    \
+		prof::ProfilerCounters::report_max(_prof_counter_slot, value);                                                \
+	} while (0)
+
 #define CPU_FUNCTION() CPU_SCOPE(__FUNCTION__)
 #define GPU_FUNCTION() GPU_SCOPE(__FUNCTION__)
@@ -331,6 +331,43 @@ void draw_zone_table(const char* table_id, const char* time_col_label, const Fra
 	}
 }
 
+// ---- Counters ----------------------------------------------------------
+
+std::string format_counter(int64_t value, CounterUnit unit) {
+	char buf[64];
+	if (unit == CounterUnit::Bytes && value >= 1024 * 1024)
+		snprintf(buf, sizeof(buf), "%.2f MB", value / (1024.0 * 1024.0));
+	else if (unit == CounterUnit::Bytes && value >= 1024)
+		snprintf(buf, sizeof(buf), "%.1f KB", value / 1024.0);
+	else
+		snprintf(buf, sizeof(buf), "%lld", (long long)value);
+	return buf;
+}
+
+// Always the last finished frame, counters aren't kept per frame in the rings.
+void draw_counter_table() {
+	const std::vector<CounterInfo> counters = ProfilerCounters::snapshot();
+	if (counters.empty())
+		return;
+	ImGui::Separator();
+	if (ImGui::BeginTable("counter_table", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+		ImGui::TableSetupColumn("Counter", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Last frame", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("Peak", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableHeadersRow();
+		for (auto& c : counters) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(c.name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(format_counter(c.last_frame, c.unit).c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(format_counter(c.peak, c.unit).c_str());
+		}
+		ImGui::EndTable();
+	}
+}
+
 // ---- Tabs ------------------------------------------------------------
 
 void draw_overall_tab() {
@@ -360,6 +397,8 @@ void draw_overall_tab() {
 					[&](uint64_t f) { return find_zone_ms(find_frame(main_tc->ring, f), "scene_draw"); });
 	draw_sparkline("Draw Time GPU (ms)", frames,
 					[&](uint64_t f) { return find_zone_ms(find_frame(gpu_tc.ring, f), "scene_draw"); });
+
+	draw_counter_table();
 }
 
 void draw_cpu_tab() {
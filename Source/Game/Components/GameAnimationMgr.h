@@ -1,6 +1,7 @@
 #pragma once
 #include "Framework/MemArena.h"
 #include "Framework/Hashset.h"
+#include <vector>
 class MeshComponent;
 class AnimatorInstance;
 class AnimatorObject;
@@ -13,7 +14,11 @@ public:
 	GameAnimationMgr();
 	~GameAnimationMgr();
 
-	void update_animating(); // blocking
+	// blocking. Reserves palette ranges serially, evaluates animators in parallel on the job
+	// system (anim.parallel_update), then does transform invalidation/debug draw serially.
+	void update_animating();
+	// ticks the post animate set, call after update_animating()
+	void update_post_animate();
 	void add_to_animating_set(AnimatorObject& mc);
 	void remove_from_animating_set(AnimatorObject& mc);
 	// Ticked after every AnimatorObject has updated for the frame, so they can read this
@@ -29,6 +34,10 @@ public:
 private:
 	hash_set<AnimatorObject> animating_meshcomponents;
 	hash_set<SpringBoneManagerComponent> post_animate_components;
+	// rebuilt every update_animating()
+	std::vector<AnimatorObject*> parallel_update_list;
+	std::vector<AnimatorObject*> serial_update_list;
+	std::vector<SpringBoneManagerComponent*> post_animate_list;
 	glm::mat4* matricies = nullptr;
 	int matricies_allocated = 0;
 	int matricies_used = 0;
@@ -16,6 +16,11 @@
 #include "SpringBoneManagerComponent.h"
 #include "Debug.h"
 #include "Framework/Jobs.h"
+#include "Animation/PoseArena.h"
+#include "Animation/AnimationLod.h"
+#include "Animation/SharedPoseCache.h"
+#include "CameraComponent.h"
+#include "UI/ViewportSystem.h"
 #include "PhysicsComponents.h"
 
 GameAnimationMgr* GameAnimationMgr::inst = nullptr;
@@ -213,6 +218,7 @@ AnimatorObject* MeshComponent::create_animator(agBuilder* data) {
 	if (modToUse && modToUse->get_skel()) {
 		try {
 			AnimatorObject* c = new AnimatorObject(*modToUse, *data, get_owner());
+			c->set_allow_update_lod(allow_anim_update_lod);
 			animator.reset(c);
 		}
 		catch (...) {
@@ -278,6 +284,69 @@ static void draw_skeleton(const AnimatorObject* a, float line_len, const glm::ma
 	}
 }
 
+ConfigVar anim_parallel_update("anim.parallel_update", "1", CVAR_BOOL | CVAR_DEV,
+								"evaluate animators and spring bones on the job system");
+extern ConfigVar a_draw_ik_debug;
+ConfigVar anim_update_lod("anim.update_lod", "1", CVAR_BOOL | CVAR_DEV,
+						  "evaluate far, small and offscreen animators at reduced rates");
+ConfigVar anim_lod_half_rate_distance("anim.lod_half_rate_distance", "20", CVAR_FLOAT,
+									  "animators past this distance evaluate every 2nd frame", 0, 1000);
+ConfigVar anim_lod_quarter_rate_distance("anim.lod_quarter_rate_distance", "40", CVAR_FLOAT,
+										 "animators past this distance evaluate every 4th frame", 0, 1000);
+ConfigVar anim_lod_half_rate_screen("anim.lod_half_rate_screen", "0.15", CVAR_FLOAT,
+									"animators smaller than this fraction of the screen height evaluate every 2nd frame", 0,
+									1);
+ConfigVar anim_lod_quarter_rate_screen("anim.lod_quarter_rate_screen", "0.06", CVAR_FLOAT,
+									   "animators smaller than this fraction of the screen height evaluate every 4th frame",
+									   0, 1);
+ConfigVar anim_lod_offscreen_interval("anim.lod_offscreen_interval", "8", CVAR_INTEGER,
+									  "frames between graph updates of animators outside the view", 1, 60);
+
+ConfigVar anim_pose_cache("anim.pose_cache", "1", CVAR_BOOL | CVAR_DEV,
+						  "animators that share poses reuse clip samples taken by others this frame");
+ConfigVar anim_pose_cache_step("anim.pose_cache_step", "0.0333", CVAR_FLOAT,
+							   "seconds, shared clip samples are taken at multiples of this", 0.001f, 0.5f);
+ConfigVar anim_pose_cache_phases("anim.pose_cache_phases", "32", CVAR_INTEGER,
+								 "phases per clip that sync groups of phase snapping animators start on, 0 to disable",
+								 0, 1024);
+
+// The scene camera's view this frame. False in the editor and when there's no camera, animators run at full rate.
+static bool get_anim_lod_view(AnimUpdateLodView& out) {
+	if (eng->is_editor_level())
+		return false;
+	CameraComponent* cam = CameraComponent::get_scene_camera();
+	const glm::ivec2 size = ViewportSystem::get_vp_rect().get_size();
+	if (!cam || size.x <= 0 || size.y <= 0)
+		return false;
+	glm::mat4 view;
+	float fov = 60.f;
+	cam->get_view(view, fov);
+	const View_Setup vs(view, glm::radians(fov), 0.01f, 100.f, size.x, size.y);
+	out.origin = vs.origin;
+	out.viewproj = vs.viewproj;
+	out.tan_half_fov = std::tan(vs.fov * 0.5f);
+	return true;
+}
+
+static AnimUpdateLodSettings get_anim_lod_settings() {
+	AnimUpdateLodSettings s;
+	s.half_rate_distance = anim_lod_half_rate_distance.get_float();
+	s.quarter_rate_distance = anim_lod_quarter_rate_distance.get_float();
+	s.half_rate_screen_size = anim_lod_half_rate_screen.get_float();
+	s.quarter_rate_screen_size = anim_lod_quarter_rate_screen.get_float();
+	s.offscreen_interval = anim_lod_offscreen_interval.get_integer();
+	return s;
+}
+
+// children on bones follow the animated pose every frame, and gameplay reads it through them (attachments, the
+// hit boxes of ragdoll-ready characters). Reduced rates would leave them lagging or interpolated.
+static bool has_bone_attachments(const Entity* e) {
+	for (const Entity* c : e->get_children())
+		if (c->has_parent_bone())
+			return true;
+	return false;
+}
+
 void GameAnimationMgr::update_animating() {
 	CPU_FUNCTION();
 
@@ -285,30 +354,115 @@ void GameAnimationMgr::update_animating() {
 
 	const float dt = eng->get_dt();
 
+	AnimUpdateLodView lod_view;
+	const bool use_lod = anim_update_lod.get_bool() && get_anim_lod_view(lod_view);
+	const AnimUpdateLodSettings lod_settings = get_anim_lod_settings();
+	int num_reduced_rate = 0;
+	int num_offscreen = 0;
+
+	SharedPoseCacheSettings cache_settings;
+	cache_settings.enabled = anim_pose_cache.get_bool();
+	cache_settings.time_step = anim_pose_cache_step.get_float();
+	cache_settings.num_phases = anim_pose_cache_phases.get_integer();
+	SharedPoseCache& pose_cache = SharedPoseCache::get();
+	pose_cache.begin_frame(dt, cache_settings);
+
+	// Pre-pass: reserve matrix palette ranges, resolve each owner's lazily cached world transform
+	// so evaluation below only ever reads entity state, and pick each animator's update rate.
+	parallel_update_list.clear();
+	serial_update_list.clear();
 	for (AnimatorObject* ai : animating_meshcomponents) {
-		if (ai) {
-			if (matricies_used + ai->num_bones() > matricies_allocated)
-				Fatalf("animator out of memory\n");
-			ai->set_matrix_palette_offset(matricies_used);
+		if (!ai)
+			continue;
+		if (matricies_used + ai->num_bones() > matricies_allocated)
+			Fatalf("animator out of memory\n");
+		ai->set_matrix_palette_offset(matricies_used);
+		matricies_used += ai->num_bones();
+
+		if (ai->get_owner())
+			ai->get_owner()->get_ws_transform();
+
+		AnimUpdateLod lod;
+		if (use_lod && ai->get_owner() && ai->get_allow_update_lod() && !ai->needs_serial_update() &&
+			!has_bone_attachments(ai->get_owner())) {
+			const glm::mat4& world = ai->get_owner()->get_ws_transform();
+			const glm::vec4& sphere = ai->get_model().get_bounding_sphere();
+			const float scale = std::max(glm::length(glm::vec3(world[0])),
+										 std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+			lod = compute_anim_update_lod(lod_settings, lod_view, glm::vec3(world * glm::vec4(glm::vec3(sphere), 1.f)),
+										  sphere.w * scale);
+			num_reduced_rate += (lod.interval > 1 && !lod.offscreen) ? 1 : 0;
+			num_offscreen += lod.offscreen ? 1 : 0;
+		}
+		ai->set_update_lod(lod);
 
-			ai->update(dt);
-			matricies_used += ai->num_bones();
+		if (ai->needs_serial_update())
+			serial_update_list.push_back(ai);
+		else
+			parallel_update_list.push_back(ai);
+	}
+
+	// ik debug draws from inside the graph, Debug:: isn't thread safe
+	const bool parallel = anim_parallel_update.get_bool() && !a_draw_ik_debug.get_bool() && JobSystem::inst;
+	if (parallel) {
+		CPU_SCOPE("evaluate_animators_parallel");
+		JobSystem::inst->parallel_for(0, (int)parallel_update_list.size(), 1, [&](int i) {
+			parallel_update_list[i]->evaluate(dt, PoseArena::get_thread_arena());
+		});
+	} else {
+		for (AnimatorObject* ai : parallel_update_list)
+			ai->evaluate(dt, PoseArena::get_thread_arena());
+	}
+	for (AnimatorObject* ai : serial_update_list)
+		ai->evaluate(dt, PoseArena::get_thread_arena());
 
-			if (ai->get_owner())
-				ai->get_owner()->invalidate_transform(nullptr);
+	// Serial tail: anything that calls back into game code or touches other entities.
+	auto finish_animator = [&](AnimatorObject* ai) {
+		ai->run_deferred_callbacks();
+		if (ai->get_owner())
+			ai->get_owner()->invalidate_transform(nullptr);
 
-			if (g_debug_skeletons.get_bool()) {
-				draw_skeleton(ai, 0.05, ai->get_owner()->get_ws_transform());
-			}
+		if (g_debug_skeletons.get_bool()) {
+			draw_skeleton(ai, 0.05, ai->get_owner()->get_ws_transform());
 		}
-	}
+	};
+	for (AnimatorObject* ai : parallel_update_list)
+		finish_animator(ai);
+	for (AnimatorObject* ai : serial_update_list)
+		finish_animator(ai);
+
+	const int64_t num_animators = (int64_t)(parallel_update_list.size() + serial_update_list.size());
+	PROF_COUNTER_ADD("anim animators", prof::CounterUnit::Count, num_animators);
+	PROF_COUNTER_ADD("anim animators reduced rate", prof::CounterUnit::Count, num_reduced_rate);
+	PROF_COUNTER_ADD("anim animators offscreen", prof::CounterUnit::Count, num_offscreen);
+	PROF_COUNTER_ADD("anim pose cache hits", prof::CounterUnit::Count, pose_cache.get_num_hits());
+	PROF_COUNTER_ADD("anim pose cache misses", prof::CounterUnit::Count, pose_cache.get_num_misses());
+	PROF_COUNTER_ADD("anim pose cache distinct poses", prof::CounterUnit::Count, pose_cache.get_num_poses());
+}
+
+void GameAnimationMgr::update_post_animate() {
+	CPU_FUNCTION();
 
-	// Runs after every AnimatorObject above has produced this frame's pose, so components here
-	// can read fresh bone matrices instead of lagging a frame behind.
+	const float dt = eng->get_dt();
+
+	// Runs after every AnimatorObject has produced this frame's pose (update_animating), so components
+	// here can read fresh bone matrices instead of lagging a frame behind.
+	post_animate_list.clear();
 	for (SpringBoneManagerComponent* c : post_animate_components) {
 		if (c)
-			c->late_update(dt);
+			post_animate_list.push_back(c);
+	}
+	for (SpringBoneManagerComponent* c : post_animate_list)
+		c->pre_simulate();
+	if (anim_parallel_update.get_bool() && JobSystem::inst) {
+		JobSystem::inst->parallel_for(0, (int)post_animate_list.size(), 4,
+									  [&](int i) { post_animate_list[i]->simulate(dt); });
+	} else {
+		for (SpringBoneManagerComponent* c : post_animate_list)
+			c->simulate(dt);
 	}
+	for (SpringBoneManagerComponent* c : post_animate_list)
+		c->apply_attachments();
 }
 #include "LevelEditor/EditorDocLocal.h"
 #include "GameEngineLocal.h"
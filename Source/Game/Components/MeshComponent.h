@@ -98,6 +98,8 @@ public:
 	// the owner's components immediately via update_physics_mesh().
 	REF void set_add_collision(bool add_col) { this->add_collision_if_available = add_col; }
 	REF bool get_add_collision() const { return add_collision_if_available; }
+	// Must be called before create_animator(), or set it on the animator directly.
+	REF void set_allow_anim_update_lod(bool b) { allow_anim_update_lod = b; }
 
 	// public so the static-prop bake (free function below) can call it without becoming a friend.
 	void populate_render_object(struct Render_Object& out, const glm::mat4& ws_transform) const;
@@ -117,6 +119,9 @@ private:
 	REF bool ignore_in_cubemap = false;
 	// Include this mesh's triangles when baking the navmesh. Defaults true for static level geometry.
 	REF bool nav_static = true;
+	// Let the animator run at reduced rates when far, small or offscreen (anim.update_lod). Turn off for meshes whose
+	// bones gameplay reads every frame without attaching entities to them.
+	REF bool allow_anim_update_lod = true;
 	REFLECT(hide);
 	bool lightmapped = false;
 	REFLECT(hide);
@@ -430,22 +430,16 @@ void PhysicsBody::add_box_shape_to_actor(const glm::mat4& localTransform, const
 // Mirrors the slice of (PhysicsBody::on_actor_type_change + add_model_shape_to_actor)
 // needed for a static mesh prop. Default physics layer = PL::Default; not configurable
 // because eligibility intentionally excludes anything that would care.
-physx::PxRigidActor* bake_static_meshcomponent_physics(const Model* model, const glm::mat4& ws_transform) {
-	ASSERT(model);
-	if (!model->get_physics_body())
-		return nullptr; // no usable collision; matches MeshColliderComponent's "skip if no body"
-
+// creates the model's collision shapes on actor, placed at ws_transform. materials and filter data are per prop
+static void add_static_prop_shapes(PxRigidActor& actor, const Model* model, const glm::mat4& ws_transform) {
 	glm::vec3 p, s; glm::quat q;
 	decompose_transform(ws_transform, p, q, s);
 	PxTransform t;
 	t.p = glm_to_physx(p);
 	t.q = glm_to_physx(q);
 	t.q.normalize();
-
-	auto* factory = physics_local_impl->physics_factory;
-	PxRigidStatic* actor = factory->createRigidStatic(t);
-	actor->userData = nullptr;          // see header comment — null on purpose
-	actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, false);
+	const PxTransform actor_pose = actor.getGlobalPose();
+	const PxTransform local_pose = actor_pose == t ? PxTransform(PxIdentity) : actor_pose.transformInv(t);
 
 	PxMaterial* material_to_use = physics_local_impl->default_material;
 	if (auto* wrapper = model->get_physics_material_to_use())
@@ -463,29 +457,168 @@ physx::PxRigidActor* bake_static_meshcomponent_physics(const Model* model, const
 		scale.scale = glm_to_physx(s);
 		if (shape.shape == ShapeType_e::ConvexShape) {
 			px_shape = PxRigidActorExt::createExclusiveShape(
-				*actor, PxConvexMeshGeometry(shape.convex_mesh, scale), *material_to_use);
+				actor, PxConvexMeshGeometry(shape.convex_mesh, scale), *material_to_use);
 		} else if (shape.shape == ShapeType_e::MeshShape) {
 			px_shape = PxRigidActorExt::createExclusiveShape(
-				*actor, PxTriangleMeshGeometry(shape.tri_mesh, scale), *material_to_use);
+				actor, PxTriangleMeshGeometry(shape.tri_mesh, scale), *material_to_use);
 		}
 		if (px_shape) {
 			px_shape->setFlags(PxShapeFlag::eSCENE_QUERY_SHAPE | PxShapeFlag::eSIMULATION_SHAPE | PxShapeFlag::eVISUALIZATION);
 			px_shape->setQueryFilterData(filter);
 			px_shape->setSimulationFilterData(filter);
+			px_shape->setLocalPose(local_pose);
 		}
 	}
+}
+
+physx::PxRigidActor* bake_static_meshcomponent_physics(const Model* model, const glm::mat4& ws_transform,
+													   bool add_to_scene) {
+	ASSERT(model);
+	if (!model->get_physics_body())
+		return nullptr; // no usable collision; matches MeshColliderComponent's "skip if no body"
+
+	glm::vec3 p, s; glm::quat q;
+	decompose_transform(ws_transform, p, q, s);
+	PxTransform t;
+	t.p = glm_to_physx(p);
+	t.q = glm_to_physx(q);
+	t.q.normalize();
+
+	auto* factory = physics_local_impl->physics_factory;
+	PxRigidStatic* actor = factory->createRigidStatic(t);
+	actor->userData = nullptr;          // see header comment — null on purpose
+	actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, false);
+	add_static_prop_shapes(*actor, model, ws_transform);
 
-	physics_local_impl->scene->addActor(*actor);
+	if (add_to_scene)
+		physics_local_impl->scene->addActor(*actor);
 	return actor;
 }
 
 void release_static_meshcomponent_physics(physx::PxRigidActor* actor) {
 	if (!actor)
 		return;
-	physics_local_impl->scene->removeActor(*(physx::PxActor*)actor);
+	// aggregated actors already left the scene with their aggregate
+	if (actor->getScene())
+		physics_local_impl->scene->removeActor(*(physx::PxActor*)actor);
 	actor->release();
 }
 
+// physx caps aggregates at 128 actors and 128 shapes
+static const uint32_t MAX_STATIC_PROP_AGGREGATE = 128;
+
+static PxVec3 static_prop_cell_min(const PxVec3& p, float cell_size) {
+	return PxVec3(std::floor(p.x / cell_size), std::floor(p.y / cell_size), std::floor(p.z / cell_size)) * cell_size;
+}
+
+static uint64_t static_prop_cell_key(const PxVec3& p, float cell_size) {
+	// 21 bits per axis, wraps far outside any level
+	const uint64_t x = uint64_t(int64_t(std::floor(p.x / cell_size))) & 0x1fffff;
+	const uint64_t y = uint64_t(int64_t(std::floor(p.y / cell_size))) & 0x1fffff;
+	const uint64_t z = uint64_t(int64_t(std::floor(p.z / cell_size))) & 0x1fffff;
+	return x | (y << 21) | (z << 42);
+}
+
+void aggregate_static_meshcomponent_physics(const std::vector<physx::PxRigidActor*>& actors, float cell_size,
+											std::vector<physx::PxAggregate*>& out_aggregates) {
+	ASSERT(cell_size > 0.f);
+	auto* scene = physics_local_impl->scene;
+	std::unordered_map<uint64_t, std::vector<PxRigidActor*>> cells;
+	for (PxRigidActor* actor : actors) {
+		ASSERT(actor && !actor->getScene());
+		cells[static_prop_cell_key(actor->getGlobalPose().p, cell_size)].push_back(actor);
+	}
+
+	int num_alone = 0;
+	const PxAggregateFilterHint hint = PxGetAggregateFilterHint(PxAggregateType::eSTATIC, false);
+	for (auto& [key, cell] : cells) {
+		// a lone prop gains nothing from an aggregate
+		if (cell.size() == 1) {
+			scene->addActor(*cell[0]);
+			num_alone += 1;
+			continue;
+		}
+		PxAggregate* aggregate = nullptr;
+		uint32_t num_shapes = 0;
+		for (PxRigidActor* actor : cell) {
+			const uint32_t actor_shapes = actor->getNbShapes();
+			if (actor_shapes > MAX_STATIC_PROP_AGGREGATE) {
+				scene->addActor(*actor);
+				num_alone += 1;
+				continue;
+			}
+			if (aggregate && (aggregate->getNbActors() == MAX_STATIC_PROP_AGGREGATE ||
+							  num_shapes + actor_shapes > MAX_STATIC_PROP_AGGREGATE)) {
+				scene->addAggregate(*aggregate);
+				aggregate = nullptr;
+			}
+			if (!aggregate) {
+				aggregate = physics_local_impl->physics_factory->createAggregate(MAX_STATIC_PROP_AGGREGATE,
+																				 MAX_STATIC_PROP_AGGREGATE, hint);
+				out_aggregates.push_back(aggregate);
+				num_shapes = 0;
+			}
+			aggregate->addActor(*actor);
+			num_shapes += actor_shapes;
+		}
+		if (aggregate)
+			scene->addAggregate(*aggregate);
+	}
+	sys_print(Debug, "aggregate_static_meshcomponent_physics: %d props in %d cells, %d aggregates, %d alone\n",
+			  (int)actors.size(), (int)cells.size(), (int)out_aggregates.size(), num_alone);
+}
+
+void merge_static_meshcomponent_physics(const std::vector<StaticPropCollision>& props, float cell_size,
+										std::vector<physx::PxRigidActor*>& out_actors) {
+	ASSERT(cell_size > 0.f);
+	auto* scene = physics_local_impl->scene;
+	std::unordered_map<uint64_t, std::vector<const StaticPropCollision*>> cells;
+	for (auto& prop : props) {
+		ASSERT(prop.model && prop.model->get_physics_body());
+		const PxVec3 p = glm_to_physx(glm::vec3(prop.ws_transform[3]));
+		cells[static_prop_cell_key(p, cell_size)].push_back(&prop);
+	}
+
+	int num_shapes = 0;
+	for (auto& [key, cell] : cells) {
+		const PxVec3 origin = static_prop_cell_min(glm_to_physx(glm::vec3(cell[0]->ws_transform[3])), cell_size);
+		PxRigidStatic* actor = physics_local_impl->physics_factory->createRigidStatic(PxTransform(origin));
+		actor->userData = nullptr; // same as bake_static_meshcomponent_physics
+		for (auto* prop : cell)
+			add_static_prop_shapes(*actor, prop->model, prop->ws_transform);
+		num_shapes += (int)actor->getNbShapes();
+
+		// with a bvh over its shapes the actor is one compound entry in the scene query trees, queries that reach
+		// it walk the bvh instead of testing every shape
+		PxU32 num_bounds = 0;
+		PxBounds3* bounds = PxRigidActorExt::getRigidActorShapeLocalBoundsList(*actor, num_bounds);
+		PxBVH* bvh = nullptr;
+		if (bounds && num_bounds > 1) {
+			PxBVHDesc desc;
+			desc.bounds.count = num_bounds;
+			desc.bounds.data = bounds;
+			desc.bounds.stride = sizeof(PxBounds3);
+			bvh = PxCreateBVH(desc);
+		}
+		scene->addActor(*actor, bvh);
+		if (bvh)
+			bvh->release(); // the scene keeps its own copy
+		if (bounds)
+			PX_FREE(bounds);
+		out_actors.push_back(actor);
+	}
+	sys_print(Debug, "merge_static_meshcomponent_physics: %d props in %d cells, %d shapes\n", (int)props.size(),
+			  (int)cells.size(), num_shapes);
+}
+
+void release_static_prop_aggregate(physx::PxAggregate* aggregate) {
+	if (!aggregate)
+		return;
+	// removes the member actors from the scene too, they're released by release_static_meshcomponent_physics
+	physics_local_impl->scene->removeAggregate(*aggregate);
+	aggregate->release();
+}
+
 void PhysicsBody::set_body_type(BodyType t) {
 	ASSERT(get_owner());
 	if (t == body_type)
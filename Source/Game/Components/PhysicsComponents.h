@@ -19,6 +19,7 @@ class PxJoint;
 class PxRevoluteJoint;
 class PxSphericalJoint;
 class PxD6Joint;
+class PxAggregate;
 } // namespace physx
 class PhysicsMaterialWrapper;
 
@@ -291,8 +292,29 @@ public:
 // userData on the returned actor is set to nullptr — world_query_result::component will be
 // null for raycasts that hit a stripped prop.
 // Caller owns the actor and must release via release_static_meshcomponent_physics().
-physx::PxRigidActor* bake_static_meshcomponent_physics(const Model* model, const glm::mat4& ws_transform);
+// add_to_scene=false leaves the actor out of the scene for aggregate_static_meshcomponent_physics.
+physx::PxRigidActor* bake_static_meshcomponent_physics(const Model* model, const glm::mat4& ws_transform,
+													   bool add_to_scene = true);
 void release_static_meshcomponent_physics(physx::PxRigidActor* actor);
+// Groups baked props (add_to_scene=false) by their position in a cell_size grid and adds each cell to the scene as
+// a static PxAggregate, so the broadphase tracks one volume per cell instead of one per prop shape. The actors
+// and their shapes are untouched, materials and filter data stay per prop. Actors that don't fit an aggregate are
+// added on their own. Caller owns the returned aggregates and must release via release_static_prop_aggregate()
+// before releasing the actors.
+void aggregate_static_meshcomponent_physics(const std::vector<physx::PxRigidActor*>& actors, float cell_size,
+											std::vector<physx::PxAggregate*>& out_aggregates);
+void release_static_prop_aggregate(physx::PxAggregate* aggregate);
+// The other grouping: one PxRigidStatic per non-empty cell carrying the shapes of every prop in it (materials and
+// filter data still per prop), added to the scene with a bvh over those shapes. Unlike aggregates this also shrinks
+// the scene query trees, to one entry per cell, but the props have no actor of their own anymore. Caller owns the
+// returned actors and must release via release_static_meshcomponent_physics().
+struct StaticPropCollision
+{
+	const Model* model = nullptr; // must have a physics body
+	glm::mat4 ws_transform;
+};
+void merge_static_meshcomponent_physics(const std::vector<StaticPropCollision>& props, float cell_size,
+										std::vector<physx::PxRigidActor*>& out_actors);
 
 struct JointAnchor
 {
@@ -10,6 +10,8 @@ void RagdollComponent::start() {
 		return;
 	}
 	this->meshComponent = c;
+	// enable()/disable() start the bodies from the current and last bone matrices, those must be real poses
+	c->get_animator()->set_allow_update_lod(false);
 }
 #include "Animation/SkeletonData.h"
 void RagdollComponent::enable() {
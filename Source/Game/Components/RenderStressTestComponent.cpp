@@ -11,6 +11,7 @@
 
 #ifdef EDITOR_BUILD
 #include "imgui.h"
+#include "Framework/Config.h"
 #endif
 
 // Rotating-wave yaw: turn each instance about its Y axis proportional to its wave height,
@@ -178,6 +179,9 @@ void RenderStressTestComponent::editor_on_change_property() {
 
 void RenderStressTestComponent::on_inspector_imgui() {
 	ImGui::Text("Instances: %zu", instances.size());
+	// times the renderer's per frame proxy walk over the whole scene, a big static grid is the 50k+ proxy case
+	if (!instances.empty() && ImGui::Button("Benchmark proxy culling"))
+		Cmd_Manager::inst->execute(Cmd_Execute_Mode::APPEND, "bench_fastpath_cull 100");
 
 	if (state == RenderStressTestState::Disabled) {
 		if (ImGui::Button("Enable (Animated)")) {
@@ -30,7 +30,8 @@ NEWENUM(RenderStressTestState, uint8_t){
 // sibling Components/Entities, to keep per-instance overhead to the renderer only) centered
 // on the owner, and displaces each instance's height every frame with a 2D wave so the whole
 // grid animates. Use grid_length to dial up instance count (grid_length^2 total meshes) to
-// stress the renderer/scene submission path.
+// stress the renderer/scene submission path. A large static grid is also the scene for the bench_fastpath_cull
+// benchmark of the fast path's per frame proxy walk (button in the inspector).
 class RenderStressTestComponent : public Component
 {
 public:
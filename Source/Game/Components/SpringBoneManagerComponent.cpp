@@ -32,10 +32,10 @@ glm::mat4 SpringBoneManagerComponent::get_bone_parent_world_transform(const Spri
 	if (def.parent_is_skeleton_bone) {
 		MeshComponent* mc = meshComponent.get();
 		ASSERT(mc && "spring bone parented to a skeleton bone requires set_mesh_component() first");
-		return mc->get_owner()->get_ws_transform() * mc->get_ls_transform_of_bone(def.parentName);
+		return meshOwnerWorld * mc->get_ls_transform_of_bone(def.parentName);
 	}
 	if (def.parentName == StringName())
-		return get_owner()->get_ws_transform();
+		return ownerWorld;
 
 	const int parentIdx = find_def_index(def.parentName);
 	ASSERT(parentIdx >= 0 && "spring bone parent not found -- parents must be added before their children");
@@ -89,9 +89,20 @@ void SpringBoneManagerComponent::unparent_entity(Entity* child) {
 }
 
 void SpringBoneManagerComponent::late_update(float dt) {
+	pre_simulate();
+	simulate(dt);
+	apply_attachments();
+}
+
+void SpringBoneManagerComponent::pre_simulate() {
 	Entity* owner = get_owner();
 	ASSERT(owner);
+	ownerWorld = owner->get_ws_transform();
+	MeshComponent* mc = meshComponent.get();
+	meshOwnerWorld = mc ? mc->get_owner()->get_ws_transform() : glm::mat4(1.f);
+}
 
+void SpringBoneManagerComponent::simulate(float dt) {
 	for (int i = 0; i < (int)defs.size(); i++) {
 		const SpringBoneManualDef& def = defs[i];
 		SpringBoneManualState& state = states[i];
@@ -103,7 +114,9 @@ void SpringBoneManagerComponent::late_update(float dt) {
 
 		state.worldTransform = integrate_spring_bone(dt, def.params, worldRestMat, worldParentPos, state.sim);
 	}
+}
 
+void SpringBoneManagerComponent::apply_attachments() {
 	for (auto& att : attachments) {
 		Entity* child = att.child.get();
 		if (!child)
@@ -64,7 +64,14 @@ public:
 
 	// Invoked by GameAnimationMgr after all AnimatorObjects have updated this frame -- must run
 	// after animation so parent_is_skeleton_bone lookups see this frame's pose, not last frame's.
+	// Same as pre_simulate() + simulate() + apply_attachments().
 	void late_update(float dt);
+	// Split form of late_update for GameAnimationMgr's parallel stage. pre_simulate and
+	// apply_attachments touch entity transforms and run on the main thread; simulate only
+	// reads the transforms resolved by pre_simulate and is safe to run on a worker.
+	void pre_simulate();
+	void simulate(float dt);
+	void apply_attachments();
 
 private:
 	int find_def_index(StringName name) const;
@@ -74,4 +81,7 @@ private:
 	std::vector<SpringBoneManualDef> defs;
 	std::vector<SpringBoneManualState> states;
 	std::vector<SpringBoneAttachment> attachments;
+	// world transforms resolved in pre_simulate
+	glm::mat4 ownerWorld = glm::mat4(1.f);
+	glm::mat4 meshOwnerWorld = glm::mat4(1.f);
 };
@@ -2,6 +2,7 @@
 #include "Physics/Physics2.h"
 #include "Debug.h"
 #include "Physics/ChannelsAndPresets.h"
+#include "Framework/Profiler.h"
 
 // movement code taken from physx character controller and quake
 
@@ -38,70 +39,175 @@ static glm::vec3 collision_response(const glm::vec3& current_direction, const gl
 
 void CharacterController::move(const glm::vec3& disp, float dt, float min_dist, int& out_ccfg_flags,
 							   glm::vec3& out_velocity) {
-	const float actual_half_height = capsule_height * 0.5 - capsule_radius;
-	vertical_capsule_def_t shape_def;
-	shape_def.half_height = actual_half_height;
-	shape_def.radius = capsule_radius;
+	CharacterMove m;
+	m.controller = this;
+	m.displacement = disp;
+	m.dt = dt;
+	m.min_dist = min_dist;
+	move_batch(std::span<CharacterMove>(&m, 1));
+	out_ccfg_flags = m.out_ccfg_flags;
+	out_velocity = m.out_velocity;
+}
 
-	glm::vec3 current_velocity = disp / dt;
-	glm::vec3 current_pos = position;
-	glm::vec3 target_pos = position + disp;
+namespace {
+struct MoveState
+{
+	glm::vec3 current_velocity{};
+	glm::vec3 current_pos{};
+	glm::vec3 target_pos{};
+	glm::vec3 current_direction{};
+	TraceIgnoreVec ignore;
+	bool moving = true;
+};
+// scratch for move_batch, kept between calls so a move doesn't allocate
+struct MoveBatchScratch
+{
+	std::vector<MoveState> state;
+	std::vector<scene_query_def> queries;
+	std::vector<scene_query_result> results;
+	std::vector<int> query_to_move;
+};
+thread_local MoveBatchScratch move_scratch;
 
-	int max_iter = 5;
-	out_ccfg_flags = 0;
+struct QueuedMoves
+{
+	std::vector<CharacterMove> moves;
+	std::vector<std::function<void(const CharacterMove&)>> on_done;
+};
+QueuedMoves queued_moves;
+QueuedMoves flushing_moves; // swapped with queued_moves so callbacks can queue the next moves
+} // namespace
 
-	TraceIgnoreVec ignore;
-	ignore.push_back(self);
+CharacterController::~CharacterController() {
+	for (int i = 0; i < (int)queued_moves.moves.size(); i++) {
+		if (queued_moves.moves[i].controller == this) {
+			queued_moves.moves.erase(queued_moves.moves.begin() + i);
+			queued_moves.on_done.erase(queued_moves.on_done.begin() + i);
+			i--;
+		}
+	}
+	// destroyed by an earlier move's callback during the flush
+	for (int i = 0; i < (int)flushing_moves.moves.size(); i++) {
+		if (flushing_moves.moves[i].controller == this)
+			flushing_moves.on_done[i] = nullptr;
+	}
+}
 
-	for (; max_iter >= 0; max_iter--) {
-		auto current_direction = target_pos - current_pos;
-		float length = glm::length(current_direction);
-		if (length <= min_dist) {
-			break;
+void CharacterController::queue_move(const glm::vec3& displacement, float dt, float min_dist,
+									 std::function<void(const CharacterMove&)> on_done) {
+	CharacterMove m;
+	m.controller = this;
+	m.displacement = displacement;
+	m.dt = dt;
+	m.min_dist = min_dist;
+	queued_moves.moves.push_back(m);
+	queued_moves.on_done.push_back(std::move(on_done));
+}
+
+void CharacterController::flush_queued_moves() {
+	if (queued_moves.moves.empty())
+		return;
+	CPU_FUNCTION();
+	std::swap(queued_moves.moves, flushing_moves.moves);
+	std::swap(queued_moves.on_done, flushing_moves.on_done);
+	move_batch(flushing_moves.moves);
+	for (int i = 0; i < (int)flushing_moves.moves.size(); i++) {
+		if (flushing_moves.on_done[i])
+			flushing_moves.on_done[i](flushing_moves.moves[i]);
+	}
+	flushing_moves.moves.clear();
+	flushing_moves.on_done.clear();
+}
+
+void CharacterController::move_batch(std::span<CharacterMove> moves) {
+	auto& state = move_scratch.state;
+	auto& queries = move_scratch.queries;
+	auto& results = move_scratch.results;
+	auto& query_to_move = move_scratch.query_to_move;
+	state.resize(moves.size());
+	for (int i = 0; i < (int)moves.size(); i++) {
+		const CharacterMove& m = moves[i];
+		MoveState& st = state[i];
+		st.current_velocity = m.displacement / m.dt;
+		st.current_pos = m.controller->position;
+		st.target_pos = m.controller->position + m.displacement;
+		st.ignore.clear();
+		st.ignore.push_back(m.controller->self);
+		st.moving = true;
+		moves[i].out_ccfg_flags = 0;
+	}
+
+	const uint32_t flags = (1 << (int)PL::Default) | (1 << (int)PL::Character);
+	for (int max_iter = 5; max_iter >= 0; max_iter--) {
+		queries.clear();
+		query_to_move.clear();
+		for (int i = 0; i < (int)moves.size(); i++) {
+			MoveState& st = state[i];
+			if (!st.moving)
+				continue;
+			const CharacterController& cc = *moves[i].controller;
+			auto current_direction = st.target_pos - st.current_pos;
+			float length = glm::length(current_direction);
+			if (length <= moves[i].min_dist) {
+				st.moving = false;
+				continue;
+			}
+			current_direction /= length;
+			if (dot(current_direction, moves[i].displacement) <= 0) {
+				st.moving = false;
+				continue;
+			}
+			st.current_direction = current_direction;
+
+			vertical_capsule_def_t shape_def;
+			shape_def.half_height = cc.capsule_height * 0.5 - cc.capsule_radius;
+			shape_def.radius = cc.capsule_radius;
+			glm::vec3 actual_capsule_pos = st.current_pos + glm::vec3(0, cc.capsule_height * 0.5, 0);
+			queries.push_back(scene_query_def::sweep_capsule(shape_def, actual_capsule_pos, current_direction,
+															 length + cc.skin_size, flags, &st.ignore));
+			query_to_move.push_back(i);
 		}
-		current_direction /= length;
-		if (dot(current_direction, disp) <= 0)
+		if (queries.empty())
 			break;
-		world_query_result wqr;
-		{
-			// do collision test
-			glm::vec3 actual_capsule_pos = current_pos + glm::vec3(0, capsule_height * 0.5, 0);
-
-			uint32_t flags = (1 << (int)PL::Default) | (1 << (int)PL::Character);
-
-			bool has_hit = g_physics.sweep_capsule(wqr, shape_def, actual_capsule_pos, current_direction,
-												   length + skin_size, flags, &ignore);
-			if (!has_hit) {
-				current_pos = target_pos;
-				break;
+		results.resize(queries.size());
+		g_physics.run_query_batch(queries, results);
+
+		for (int q = 0; q < (int)queries.size(); q++) {
+			const int i = query_to_move[q];
+			MoveState& st = state[i];
+			const CharacterController& cc = *moves[i].controller;
+			const world_query_result& wqr = results[q].hit;
+			if (!results[q].has_hit) {
+				st.current_pos = st.target_pos;
+				st.moving = false;
+				continue;
 			} else if (wqr.had_initial_overlap) {
-				current_pos -= wqr.hit_normal * (wqr.distance - 0.0001f /* epsilon */);
-				// Debug::add_sphere(wqr.hit_pos, 0.5, COLOR_GREEN, 0.05);
+				st.current_pos -= wqr.hit_normal * (wqr.distance - 0.0001f /* epsilon */);
 				continue;
 			}
-			// else
-			// Debug::add_sphere(wqr.hit_pos, 0.5, COLOR_BLUE, 0.0);
-		}
 
-		if (wqr.hit_normal.y >= 0.85)
-			out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_BELOW;
-		else if (wqr.hit_normal.y <= -0.85)
-			out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_ABOVE;
-		else
-			out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_SIDES;
+			int& out_ccfg_flags = moves[i].out_ccfg_flags;
+			if (wqr.hit_normal.y >= 0.85)
+				out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_BELOW;
+			else if (wqr.hit_normal.y <= -0.85)
+				out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_ABOVE;
+			else
+				out_ccfg_flags |= CharacterControllerCollisionFlags::CCCF_SIDES;
 
-		if (wqr.distance >= skin_size)
-			current_pos = current_pos + current_direction * (wqr.distance - skin_size);
+			if (wqr.distance >= cc.skin_size)
+				st.current_pos = st.current_pos + st.current_direction * (wqr.distance - cc.skin_size);
 
-		target_pos =
-			collision_response(current_direction, wqr.hit_normal, current_pos, target_pos, 1.0, 0.0, current_velocity);
+			st.target_pos = collision_response(st.current_direction, wqr.hit_normal, st.current_pos, st.target_pos,
+											   1.0, 0.0, st.current_velocity);
+		}
 	}
-	cached_flags = out_ccfg_flags;
-	out_velocity = current_velocity;
-	position = current_pos;
 
-	// Debug::add_sphere(current_pos + glm::vec3(0, capsule_radius, 0), capsule_radius, COLOR_PINK, 0);
-	// Debug::add_sphere(current_pos + glm::vec3(0, capsule_height - capsule_radius, 0), capsule_radius, COLOR_PINK, 0);
+	for (int i = 0; i < (int)moves.size(); i++) {
+		CharacterController& cc = *moves[i].controller;
+		cc.cached_flags = moves[i].out_ccfg_flags;
+		cc.position = state[i].current_pos;
+		moves[i].out_velocity = state[i].current_velocity;
+	}
 }
 
 void SpringPogoController::move(const glm::vec3& velocity_in, float dt, glm::vec3& out_velocity,
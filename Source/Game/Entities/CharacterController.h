@@ -1,6 +1,8 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <span>
+#include <functional>
 #include "Game/EntityComponent.h"
 #include "Game/Components/PhysicsComponents.h"
 
@@ -14,10 +16,24 @@ enum CharacterControllerCollisionFlags
 	CCCF_SIDES = 4
 };
 class PhysicsBody;
+class CharacterController;
+// one controller's part of CharacterController::move_batch
+struct CharacterMove
+{
+	CharacterController* controller = nullptr;
+	glm::vec3 displacement{};
+	float dt = 0.f;
+	float min_dist = 0.f;
+
+	// outputs, see CharacterController::move
+	int out_ccfg_flags = 0;
+	glm::vec3 out_velocity{};
+};
 class CharacterController
 {
 public:
 	CharacterController(PhysicsBody* self) : self(self) {}
+	~CharacterController(); // drops any queued move
 
 	// continuous move
 	void move(const glm::vec3& displacement, // how far to move the character this time step (velocity*dt)
@@ -30,6 +46,20 @@ public:
 									  // then out_velocity = in_velocity the caller can use this value how they want
 	);
 
+	// move() for several controllers, each collide+slide iteration sweeps all the controllers that are still moving
+	// with one PhysicsManager::run_query_batch. Same results as calling move() on each in turn.
+	static void move_batch(std::span<CharacterMove> moves);
+
+	// move() deferred to flush_queued_moves, which runs every queued move in one move_batch after the level's
+	// components update. on_done gets the finished move, get_character_pos() is already the new position.
+	// The batch needs every move before it can sweep any of them, so the results land after all components
+	// updated: anything reading the owner's transform during the update sees last frame's position. Use move()
+	// where that one frame matters (players), queue_move for crowds where it doesn't.
+	// One queued move per controller per update, a destroyed controller drops its queued move.
+	void queue_move(const glm::vec3& displacement, float dt, float min_dist,
+					std::function<void(const CharacterMove&)> on_done);
+	static void flush_queued_moves();
+
 	// teleport move
 	void set_position(const glm::vec3& v) { position = v; }
 
@@ -64,6 +64,7 @@ void TopDownPlayer::start() {
 		factory->create(mesh->get_model(), &tree);
 	}
 	auto animator = mesh->create_animator(&tree);
+	animator->set_allow_update_lod(false); // the ragdoll toggle reads the hips bone, and it's always on screen anyway
 
 	animator->set_float_variable("flLean", GetTime());
 	animator->set_int_variable("iState", 0);
@@ -267,6 +267,18 @@ public:
 			return;
 		}
 
+		// enemies are a crowd of one model on one graph: share clip samples and start their sync groups on shared
+		// phases. The animator comes from the prefab's script, so opt in on the first update it exists, before its
+		// first evaluation.
+		if (!shares_anim_poses) {
+			auto m = get_owner()->get_cached_mesh_component();
+			if (m && m->get_animator()) {
+				m->get_animator()->set_share_poses(true);
+				m->get_animator()->set_allow_phase_snap(true);
+				shares_anim_poses = true;
+			}
+		}
+
 		auto the_player = TopDownGameManager::instance->the_player;
 
 		auto to_dir = the_player->get_ws_position() - get_ws_position();
@@ -277,12 +289,17 @@ public:
 		facing_dir = to_dir;
 
 		float dt = eng->get_dt();
-		int flags = 0;
-		glm::vec3 outvel;
 		float move_speed = 3.0;
-		ccontroller->move(glm::vec3(to_dir.x, 0, to_dir.z) * move_speed * dt, dt, 0.005f, flags, outvel);
-
-		float angle = -atan2(-to_dir.x, to_dir.z);
+		// every enemy's move runs in one batch after the update, see CharacterController::queue_move.
+		// Until then the entity stays at last frame's position for everything else ticking this update,
+		// projectiles and the player only need enemies to within a frame.
+		ccontroller->queue_move(glm::vec3(to_dir.x, 0, to_dir.z) * move_speed * dt, dt, 0.005f,
+								[this](const CharacterMove&) { on_move_done(); });
+	}
+	void on_move_done() {
+		if (is_dead) // killed after queueing, the ragdoll owns the transform now
+			return;
+		float angle = -atan2(-facing_dir.x, facing_dir.z);
 		auto q = glm::angleAxis(angle, glm::vec3(0, 1, 0));
 
 		last_ws = get_ws_transform();
@@ -294,6 +311,7 @@ public:
 	std::unique_ptr<CharacterController> ccontroller;
 	glm::mat4 last_ws = glm::mat4(1.f);
 	bool is_dead = false;
+	bool shares_anim_poses = false;
 	float death_time = 0.0;
 };
 
@@ -11,16 +11,30 @@
 #include "Game/Components/LightComponents.h"
 #include "Game/Components/MeshComponent.h"
 #include "Game/Components/PhysicsComponents.h"
+#include "Game/Entities/CharacterController.h"
 #include "Render/DrawPublic.h"
-namespace physx { class PxRigidActor; }
+namespace physx { class PxRigidActor; class PxAggregate; }
 #include "Navigation/LevelNavUtil.h"
 #include "Navigation/NavMeshDebugDraw.h"
 #include "Scripting/ScriptManager.h"
 
 ConfigVar r_disable_static_strip("r_disable_static_strip", "0", CVAR_BOOL | CVAR_DEV,
 								  "If true, skip the runtime static-prop strip pass — every Entity stays in all_world_ents.");
+// off until physics_stats/physics_query_bench numbers on the demo levels pick a cell size
+ConfigVar physics_static_prop_cell("physics.static_prop_cell", "0", CVAR_FLOAT | CVAR_DEV,
+									"Grid size for grouping stripped static props into physics aggregates, 0 = off",
+									0.f, 1000.f);
+ConfigVar physics_static_prop_merge("physics.static_prop_merge", "0", CVAR_BOOL | CVAR_DEV,
+									 "With physics.static_prop_cell > 0, merge each cell into one static actor instead of an aggregate");
 
 void StaticPropPool::clear_and_release() {
+	// aggregates first, they take their actors out of the scene with them
+	for (void* a : physics_aggregates)
+		release_static_prop_aggregate((physx::PxAggregate*)a);
+	physics_aggregates.clear();
+	for (void* a : physics_actors)
+		release_static_meshcomponent_physics((physx::PxRigidActor*)a);
+	physics_actors.clear();
 	for (auto& p : props) {
 		if (p.render.is_valid())
 			idraw->get_scene()->remove_obj(p.render);
@@ -58,6 +72,8 @@ void Level::update_level() {
 
 		for (auto updater : tick_list)
 			updater->update();
+		// the moves components queued this update, in one batch
+		CharacterController::flush_queued_moves();
 	}
 
 	for (auto want : wantsToAddToUpdate) {
@@ -377,6 +393,10 @@ void Level::insert_unserialized_entities_into_level_internal(UnserializedSceneFi
 	// also live in objs but get freed via their owner here, so iterating objs and calling
 	// cast_to on a Component pointer that we've already freed would touch a dangling vtable.
 	if (!strip_entities.empty()) {
+		const float cell_size = physics_static_prop_cell.get_float();
+		const bool merge_cells = cell_size > 0.f && physics_static_prop_merge.get_bool();
+		std::vector<physx::PxRigidActor*> aggregate_actors;
+		std::vector<StaticPropCollision> merge_props;
 		for (Entity* e : strip_entities) {
 			ASSERT(e->get_components().size() == 1);
 			auto* mc = (MeshComponent*)e->get_components().front();
@@ -385,8 +405,18 @@ void Level::insert_unserialized_entities_into_level_internal(UnserializedSceneFi
 			StaticProp prop;
 			if (mc->get_model()) {
 				prop.render = bake_static_meshcomponent_render(*mc, e->get_ws_transform());
-				if (mc->get_add_collision())
-					prop.physics_actor = bake_static_meshcomponent_physics(mc->get_model(), e->get_ws_transform());
+				if (mc->get_add_collision() && merge_cells) {
+					// no actor per prop, physics_actor stays null
+					if (mc->get_model()->get_physics_body())
+						merge_props.push_back({mc->get_model(), e->get_ws_transform()});
+				} else if (mc->get_add_collision()) {
+					const bool add_to_scene = cell_size <= 0.f;
+					auto* actor =
+						bake_static_meshcomponent_physics(mc->get_model(), e->get_ws_transform(), add_to_scene);
+					if (actor && cell_size > 0.f)
+						aggregate_actors.push_back(actor);
+					prop.physics_actor = actor;
+				}
 			}
 			static_pool.add(prop);
 
@@ -396,6 +426,18 @@ void Level::insert_unserialized_entities_into_level_internal(UnserializedSceneFi
 			delete mc;
 			delete e;
 		}
+		if (!aggregate_actors.empty()) {
+			std::vector<physx::PxAggregate*> aggregates;
+			aggregate_static_meshcomponent_physics(aggregate_actors, cell_size, aggregates);
+			for (auto* a : aggregates)
+				static_pool.add_physics_aggregate(a);
+		}
+		if (!merge_props.empty()) {
+			std::vector<physx::PxRigidActor*> actors;
+			merge_static_meshcomponent_physics(merge_props, cell_size, actors);
+			for (auto* a : actors)
+				static_pool.add_physics_actor(a);
+		}
 		// Null out stripped entries so the ownership-transfer path doesn't touch dangling pointers.
 		// strip_set contains the (now-deleted) Entity AND Component pointers; comparing the dangling
 		// pointer values is fine (we never dereference them).
@@ -22,7 +22,8 @@ using std::string;
 
 // One stripped static prop. Render handle is owned; physics_actor is an opaque
 // physx::PxRigidActor* (void* to keep PhysX out of Level.h). Either field may be unset:
-// physics is null when the source model had no collision body.
+// physics is null when the source model had no collision body, or when the prop's shapes were merged into a
+// pool-owned cell actor.
 struct StaticProp
 {
 	handle<Render_Object> render;
@@ -35,10 +36,17 @@ class StaticPropPool
 {
 public:
 	void add(const StaticProp& p) { props.push_back(p); }
+	// opaque physx::PxAggregate*, grouping some of the props' actors (see aggregate_static_meshcomponent_physics)
+	void add_physics_aggregate(void* aggregate) { physics_aggregates.push_back(aggregate); }
+	// opaque physx::PxRigidActor* holding the shapes of several props (see merge_static_meshcomponent_physics)
+	void add_physics_actor(void* actor) { physics_actors.push_back(actor); }
 	int size() const { return (int)props.size(); }
-	void clear_and_release(); // unregisters render objects and releases physics actors
+	int get_num_physics_aggregates() const { return (int)physics_aggregates.size(); }
+	void clear_and_release(); // unregisters render objects and releases physics aggregates and actors
 private:
 	std::vector<StaticProp> props;
+	std::vector<void*> physics_aggregates;
+	std::vector<void*> physics_actors;
 };
 class Level
 {
@@ -7,6 +7,7 @@
 #include "Game/Components/DecalComponent.h"
 #include "Game/Components/PhysicsComponents.h"
 #include "Game/Entities/CharacterController.h"
+#include "Physics/Physics2.h"
 #include "Input/InputSystem.h"
 #include "GameEnginePublic.h"
 #include "Framework/MathLib.h"
@@ -235,6 +236,7 @@ void BikeGameApplication::update()
 	GameplayStatic::reset_debug_text_height();
 
 	g_bike_app = this;
+	update_terrain_probes();
 	if (course.is_built) {
 		sort_riders();
 		update_groups();
@@ -247,6 +249,44 @@ void BikeGameApplication::update()
 	ai_debug_update(this, eng->get_dt());
 }
 
+// Kept between frames so the pack's probes don't allocate every tick.
+static std::vector<scene_query_def>    s_probe_queries;
+static std::vector<scene_query_result> s_probe_results;
+static std::vector<BikeObject*>        s_probe_riders;
+
+// Every rider's front + rear terrain probe from this tick's tick_transform, in
+// one PhysicsManager::run_query_batch, then each rider finishes its transform.
+// Latency: the batch can only go out once every rider has placed its probes,
+// so during the level update every AI rider sees the other riders' entity
+// transforms from last frame. Before, that depended on tick order (riders that
+// happened to tick earlier were already moved), so the pack now at least sees
+// one consistent frame. Rail state (course_dist_m, lateral_pos, speed) is set
+// in tick_transform before the probes and is still current for later riders.
+// Runs after the level update, so all riders have moved and are waiting here.
+void BikeGameApplication::update_terrain_probes()
+{
+	s_probe_queries.clear();
+	s_probe_riders.clear();
+	for (BikeObject* bo : all_riders) {
+		if (!bo->has_pending_probes())
+			continue;
+		scene_query_def front, rear;
+		bo->get_terrain_probes(front, rear);
+		s_probe_queries.push_back(front);
+		s_probe_queries.push_back(rear);
+		s_probe_riders.push_back(bo);
+	}
+	if (s_probe_riders.empty())
+		return;
+	s_probe_results.resize(s_probe_queries.size());
+	g_physics.run_query_batch(s_probe_queries, s_probe_results);
+	for (int i = 0; i < (int)s_probe_riders.size(); ++i) {
+		const scene_query_result& front = s_probe_results[i * 2];
+		const scene_query_result& rear  = s_probe_results[i * 2 + 1];
+		s_probe_riders[i]->finish_transform(front.has_hit ? &front.hit : nullptr, rear.has_hit ? &rear.hit : nullptr);
+	}
+}
+
 void BikeGameApplication::on_imgui()
 {
 	debugger.on_imgui();
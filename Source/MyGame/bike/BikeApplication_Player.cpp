@@ -219,6 +219,10 @@ void BikePlayer::evaluate(BikeObject* my_bike)
 
 	current_power = ci.power;
 	my_bike->update_tick(ci);
+	// the camera below follows this tick's position, so don't wait for the
+	// pack's batched terrain probes (BikeGameApplication::update_terrain_probes)
+	if (my_bike->has_pending_probes())
+		my_bike->trace_pending_probes();
 
 	// --- Wind ---
 	g_wind.update(my_bike, cam.camera_pos);
@@ -43,6 +43,8 @@ public:
 
 // feeds into bikecharacter
 class BikeObject;
+struct world_query_result;
+struct scene_query_def;
 class IBikeInput {
 public:
 	virtual ~IBikeInput() {}
@@ -535,6 +537,14 @@ public:
 	void tick_steer(const ControlInput& ci, float dt);
 	void tick_gears(float dt);
 	void tick_transform(const ControlInput& ci, float dt);
+	// The rest of tick_transform once the terrain probes are back, null = no hit.
+	// BikeGameApplication::update_terrain_probes traces every rider's probes in
+	// one batch and calls this; tick_transform leaves pending_transform for it.
+	// The entity transform lags a frame until then, see update_terrain_probes.
+	void finish_transform(const world_query_result* front, const world_query_result* rear);
+	void get_terrain_probes(scene_query_def& front, scene_query_def& rear) const;
+	void trace_pending_probes();  // finish_transform with the probes traced here, one by one
+	bool has_pending_probes() const { return pending_transform.pending; }
 	float get_wind_along_bike() const;
 	glm::vec3 get_wind_along_bike_vector() const;
 
@@ -659,6 +669,23 @@ public:
 	glm::vec3 prev_front_wheel_pos{};
 	glm::vec3 prev_rear_wheel_pos{};
 	bool wheel_history_initialized = false;
+
+	// tick_transform's state carried over to finish_transform while the
+	// terrain probes are out.
+	struct PendingTransform {
+		bool      pending  = false;
+		bool      coasting = false;  // ci.is_coasting() of the tick
+		float     dt       = 0.f;
+		glm::vec3 prev_ws_pos{};
+		glm::vec3 pos{};             // new position, y comes from the probes
+		glm::vec3 hinge_pos{};
+		glm::vec3 steered_front_dir{};
+		float     steer_angle_t = 0.f;
+		glm::vec3 front_org{};
+		glm::vec3 rear_org{};
+		float     probe_len = 0.f;   // straight down from front_org/rear_org
+	};
+	PendingTransform pending_transform;
 };
 
 
@@ -730,6 +757,7 @@ private:
 	void sort_riders();
 	void update_groups();
 	void update_drafting();
+	void update_terrain_probes();
 	void update_crack_triggers();
 	void debug_draw_course() const;
 
@@ -57,6 +57,14 @@ float bike_heading_turn_rate_dps   = 43.f;  // max angular velocity the heading
 float bike_heading_turn_accel_dps2 =670.f;  // max angular acceleration — also the heading PID's output clamp
 float bike_min_turn_radius_m       = 4.5f;   // physical curvature limit — max turn rate is also capped at speed/this
 
+// The fork rotates around the head-tube hinge, not the bike origin.
+// Fork entity local position is (0, 0.747, -0.349). The local Z column of
+// the bike's orientation matrix is -bike_direction, so local z=-0.349 maps
+// to +0.349 along bike_direction in world space.
+// The fork leg length (hinge to front axle) is BIKE_FRONT_Z - hinge_forward.
+static constexpr float FORK_HINGE_FWD = 0.349f;
+static constexpr float FORK_LEG       = BIKE_FRONT_Z - FORK_HINGE_FWD; // ~0.63884
+
 static BikeObject* s_bike_debug = nullptr;  // set each tick for debug menu
 
 // ============================================================
@@ -247,6 +255,10 @@ void BikeObject::tick_transform(const ControlInput& ci, float dt)
 	ASSERT(dt > 0.f);
 	ASSERT(course != nullptr);
 
+	// the last tick's probes never came back (no app update in between)
+	if (pending_transform.pending)
+		trace_pending_probes();
+
 	// Captured before any of this tick's movement, so the real displacement
 	// below reflects actual worldspace motion (rail advance + lateral shift +
 	// terrain height change), not a reconstruction from rail-space components.
@@ -342,14 +354,7 @@ void BikeObject::tick_transform(const ControlInput& ci, float dt)
 	lateral_vel    = (dt > 1e-6f) ? (lateral_pos - lateral_pos_before) / dt : 0.f;
 
 	// Terrain raycasts
-	// The fork rotates around the head-tube hinge, not the bike origin.
-	// Fork entity local position is (0, 0.747, -0.349). The local Z column of
-	// the bike's orientation matrix is -bike_direction, so local z=-0.349 maps
-	// to +0.349 along bike_direction in world space.
-	// The fork leg length (hinge to front axle) is BIKE_FRONT_Z - hinge_forward.
 	// When steered, the front contact patch rotates around the hinge, not origin.
-	static constexpr float FORK_HINGE_FWD = 0.349f;
-	static constexpr float FORK_LEG       = BIKE_FRONT_Z - FORK_HINGE_FWD; // ~0.63884
 	const float ray_up    = 1.5f;
 	const float ray_reach = 4.0f;
 	const float steer_max_rad_t = compute_max_steer_rad(speed);
@@ -359,25 +364,92 @@ void BikeObject::tick_transform(const ControlInput& ci, float dt)
 	const glm::vec3 hinge_pos = pos + bike_direction * FORK_HINGE_FWD;
 	const glm::vec3 front_org = hinge_pos + steered_front_dir * FORK_LEG + glm::vec3(0, ray_up, 0);
 	const glm::vec3 rear_org  = pos + bike_direction * BIKE_REAR_Z  + glm::vec3(0, ray_up, 0);
-	const glm::vec3 down      = glm::vec3(0, -(ray_up + ray_reach), 0);
 
-	// Excludes PL::Character so this never hits a rider's own pick-sphere (or any
-	// other rider) instead of the ground — was causing riders to bounce vertically.
-	const uint32_t terrain_mask = ~(uint32_t)(1 << (int)PL::Character);
-	world_query_result front_res, rear_res;
-	bool front_hit, rear_hit;
+	PendingTransform& pt = pending_transform;
+	pt.dt                = dt;
+	pt.coasting          = ci.is_coasting();
+	pt.prev_ws_pos       = prev_ws_pos;
+	pt.pos               = pos;
+	pt.hinge_pos         = hinge_pos;
+	pt.steered_front_dir = steered_front_dir;
+	pt.steer_angle_t     = steer_angle_t;
+	pt.front_org         = front_org;
+	pt.rear_org          = rear_org;
+	pt.probe_len         = ray_up + ray_reach;
+
 	// Hilly terrain is a procedural mesh with no physics collision (see
 	// BikeCourseHilly.h) -- query the exact analytic height function it was
 	// built from directly instead of raycasting, which is both simpler and
 	// perfectly exact (no mesh-resolution error).
 	if (g_bike_app && g_bike_app->course_variant == BikeHardcodedCourseKind::Hilly) {
+		world_query_result front_res, rear_res;
 		front_res.hit_pos = glm::vec3(front_org.x, bike_hilly_terrain_height(front_org.x, front_org.z), front_org.z);
 		rear_res.hit_pos  = glm::vec3(rear_org.x,  bike_hilly_terrain_height(rear_org.x,  rear_org.z),  rear_org.z);
-		front_hit = rear_hit = true;
-	} else {
-		front_hit = g_physics.trace_ray(front_res, front_org, front_org + down, nullptr, terrain_mask);
-		rear_hit  = g_physics.trace_ray(rear_res,  rear_org,  rear_org  + down, nullptr, terrain_mask);
+		finish_transform(&front_res, &rear_res);
+		return;
 	}
+	// Every rider's probes are traced in one batch by
+	// BikeGameApplication::update_terrain_probes, which then calls
+	// finish_transform. Outside the bike app nothing will, so trace now.
+	// Until then the entity keeps last frame's transform (see the note there).
+	pt.pending = true;
+	if (!g_bike_app)
+		trace_pending_probes();
+}
+
+// Excludes PL::Character so this never hits a rider's own pick-sphere (or any
+// other rider) instead of the ground — was causing riders to bounce vertically.
+static const uint32_t BIKE_TERRAIN_MASK = ~(uint32_t)(1 << (int)PL::Character);
+
+void BikeObject::get_terrain_probes(scene_query_def& front, scene_query_def& rear) const
+{
+	ASSERT(pending_transform.pending);
+	const PendingTransform& pt = pending_transform;
+	front = scene_query_def::ray(pt.front_org, glm::vec3(0, -1, 0), pt.probe_len, BIKE_TERRAIN_MASK);
+	rear  = scene_query_def::ray(pt.rear_org,  glm::vec3(0, -1, 0), pt.probe_len, BIKE_TERRAIN_MASK);
+}
+
+void BikeObject::trace_pending_probes()
+{
+	ASSERT(pending_transform.pending);
+	const PendingTransform& pt = pending_transform;
+	world_query_result front_res, rear_res;
+	const glm::vec3 down(0, -1, 0);
+	const bool front_hit = g_physics.trace_ray(front_res, pt.front_org, down, pt.probe_len, nullptr, BIKE_TERRAIN_MASK);
+	const bool rear_hit  = g_physics.trace_ray(rear_res,  pt.rear_org,  down, pt.probe_len, nullptr, BIKE_TERRAIN_MASK);
+	finish_transform(front_hit ? &front_res : nullptr, rear_hit ? &rear_res : nullptr);
+}
+
+BikeTerrainFit fit_bike_to_terrain(const glm::vec3* front_hit, const glm::vec3* rear_hit, float front_fwd, float y)
+{
+	BikeTerrainFit fit;
+	fit.y = y;
+	if (front_hit && rear_hit) {
+		fit.rise     = front_hit->y - rear_hit->y;
+		fit.horiz    = front_fwd - BIKE_REAR_Z; // forward span along bike axis
+		fit.gradient = atan2f(fit.rise, fit.horiz);
+		const float orig_t = -BIKE_REAR_Z / fit.horiz;
+		fit.y = rear_hit->y + fit.rise * orig_t;
+	} else if (rear_hit) {
+		fit.y = rear_hit->y;
+	} else if (front_hit) {
+		fit.y = front_hit->y;
+	}
+	return fit;
+}
+
+void BikeObject::finish_transform(const world_query_result* front_res, const world_query_result* rear_res)
+{
+	PendingTransform& pt = pending_transform;
+	pt.pending = false;
+	const float dt                    = pt.dt;
+	const glm::vec3 prev_ws_pos       = pt.prev_ws_pos;
+	const glm::vec3 hinge_pos         = pt.hinge_pos;
+	const glm::vec3 steered_front_dir = pt.steered_front_dir;
+	const float steer_angle_t         = pt.steer_angle_t;
+	const bool front_hit              = front_res != nullptr;
+	const bool rear_hit               = rear_res != nullptr;
+	glm::vec3 pos                     = pt.pos;
 
 	// When steered, the front contact is laterally displaced from bike_direction.
 	// slope_vec (front - rear) therefore has a lateral component that would corrupt:
@@ -386,25 +458,20 @@ void BikeObject::tick_transform(const ControlInput& ci, float dt)
 	//   - orig_t for pos.y (was hardcoded to unsteered BIKE_FRONT_Z)
 	// Fix: measure gradient and height interpolation along the bike's forward axis only.
 	const float front_fwd = FORK_HINGE_FWD + glm::cos(steer_angle_t) * FORK_LEG;
-	terrain_forward_dir = bike_direction;
-	float pitch_rise = 0.f, pitch_horiz = 1.f;  // captured for the visual_terrain_forward blend below
-	if (front_hit && rear_hit) {
-		const float rise    = front_res.hit_pos.y - rear_res.hit_pos.y;
-		const float horiz   = front_fwd - BIKE_REAR_Z; // forward span along bike axis
-		terrain_gradient    = atan2f(rise, horiz);
-		terrain_forward_dir = glm::normalize(bike_direction * horiz + glm::vec3(0, rise, 0));
-		pitch_rise = rise; pitch_horiz = horiz;
-		const float orig_t  = -BIKE_REAR_Z / horiz;
-		pos.y = rear_res.hit_pos.y + rise * orig_t;
-	} else if (rear_hit)  { pos.y = rear_res.hit_pos.y;  terrain_gradient = 0.f; }
-	else if (front_hit)   { pos.y = front_res.hit_pos.y; terrain_gradient = 0.f; }
-	else                  { terrain_gradient = 0.f; }
+	const BikeTerrainFit fit = fit_bike_to_terrain(front_hit ? &front_res->hit_pos : nullptr,
+	                                               rear_hit  ? &rear_res->hit_pos  : nullptr, front_fwd, pos.y);
+	pos.y            = fit.y;
+	terrain_gradient = fit.gradient;
+	terrain_forward_dir = (front_hit && rear_hit)
+	    ? glm::normalize(bike_direction * fit.horiz + glm::vec3(0, fit.rise, 0))
+	    : bike_direction;
+	const float pitch_rise = fit.rise, pitch_horiz = fit.horiz;  // for the visual_terrain_forward blend below
 
 	// Wheel trail debug lines
 	{
-		const glm::vec3 fc = front_hit ? front_res.hit_pos
+		const glm::vec3 fc = front_hit ? front_res->hit_pos
 		                               : (hinge_pos + steered_front_dir * FORK_LEG);
-		const glm::vec3 rc = rear_hit  ? rear_res.hit_pos  : (pos + bike_direction * BIKE_REAR_Z);
+		const glm::vec3 rc = rear_hit  ? rear_res->hit_pos  : (pos + bike_direction * BIKE_REAR_Z);
 		if (wheel_history_initialized) {
 			//Debug::add_line(prev_front_wheel_pos, fc, COLOR_CYAN,  3.f, false);
 			//Debug::add_line(prev_rear_wheel_pos,  rc, COLOR_GREEN, 3.f, false);
@@ -463,7 +530,7 @@ void BikeObject::tick_transform(const ControlInput& ci, float dt)
 	// freewheel has decoupled the drivetrain from the wheel, so cadence must
 	// not visually advance even though the bike is still rolling.
 	if (crank_entity) {
-		if (!ci.is_coasting())
+		if (!pt.coasting)
 			crank_phase -= cadence * glm::two_pi<float>() * dt;
 		crank_phase = glm::mod(crank_phase, glm::two_pi<float>());
 		crank_entity->set_ls_rotation(crank_rest_rot * glm::angleAxis(crank_phase, glm::vec3(0.f, 0.f, 1.f)));
@@ -1,4 +1,5 @@
 #pragma once
+#include <glm/glm.hpp>
 #include "Framework/PidTuner.h"
 // Shared constants and declarations for BikeObject split translation units.
 // inline constexpr avoids ODR violations in unity builds.
@@ -35,3 +36,15 @@ extern float lean_max_deg;
 
 // Defined in BikeObject_Steer.cpp — used by tick_transform in BikeObject.cpp.
 float compute_max_steer_rad(float speed);
+
+// Bike height and pitch from the front/rear terrain probe hits (null = no
+// hit), measured along the bike's forward axis. front_fwd is how far ahead of
+// the origin the front contact is (less than BIKE_FRONT_Z when steered). y is
+// kept when neither wheel hit. Used by BikeObject::finish_transform.
+struct BikeTerrainFit {
+	float y        = 0.f;
+	float gradient = 0.f;  // rad, 0 unless both wheels hit
+	float rise     = 0.f;  // front - rear height
+	float horiz    = 1.f;  // rear to front contact along the bike axis
+};
+BikeTerrainFit fit_bike_to_terrain(const glm::vec3* front_hit, const glm::vec3* rear_hit, float front_fwd, float y);
@@ -8,6 +8,8 @@
 #include "Game/GameplayStatic.h"
 #include "Animation/Runtime/Animation.h"
 #include "Animation/Runtime/RuntimeNodesNew2.h"
+#include "Animation/Runtime/AnimGraphProgram.h"
+#include "Animation/PoseArena.h"
 #include "Animation/SkeletonData.h"
 #include "GameEnginePublic.h"
 #include "Framework/Util.h"
@@ -541,6 +543,56 @@ void AnimGraphTester::start_ik_dump() {
     sys_print(Debug, "=== IK dump started (3 sec) ===\n");
 }
 
+// -----------------------------------------------------------------------
+void AnimGraphTester::run_graph_benchmark(int iterations) {
+    if (!mesh || !mesh->get_model()) {
+        sys_print(Warning, "anim_graph_bench: no model\n");
+        return;
+    }
+    const AnimGraphTestMode saved_mode = mode;
+    PoseArena& arena = PoseArena::get_thread_arena();
+    // dt 0 holds clip times and statemachines still, so both paths see the same graph state
+    auto time_path = [&](AnimatorObject* anim, bool use_program, std::vector<glm::mat4>& bones) {
+        anim->set_use_graph_program(use_program);
+        anim->evaluate(0.f, arena);
+        bones = anim->get_global_bonemats();
+        const double start = GetTime();
+        for (int i = 0; i < iterations; i++)
+            anim->evaluate(0.f, arena);
+        return (GetTime() - start) * 1000.0;
+    };
+
+    for (int m = 0; m <= (int)AnimGraphTestMode::CachedPoseTest; m++) {
+        mode = (AnimGraphTestMode)m;
+        rebuild_graph();
+        last_mode = mode;
+        AnimatorObject* anim = mesh->get_animator();
+        if (!anim)
+            continue;
+        update(); // graph variables for this mode
+        if (!anim->get_graph_program()) {
+            sys_print(Warning, "anim_graph_bench: anim.graph_program is off\n");
+            break;
+        }
+        const agGraphProgram& program = *anim->get_graph_program();
+        std::vector<glm::mat4> tree_bones, program_bones;
+        const double tree_ms = time_path(anim, false, tree_bones);
+        const double program_ms = time_path(anim, true, program_bones);
+        float max_diff = 0.f;
+        for (int i = 0; i < (int)tree_bones.size(); i++) {
+            for (int c = 0; c < 4; c++)
+                max_diff = glm::max(max_diff, glm::length(tree_bones[i][c] - program_bones[i][c]));
+        }
+        sys_print(Info, "anim_graph_bench: mode %d, %d functions %d ops: get_pose %.2f us, program %.2f us (%.2fx), max bone diff %f\n",
+                  m, program.get_num_functions(), program.get_num_ops(), tree_ms * 1000.0 / iterations,
+                  program_ms * 1000.0 / iterations, tree_ms / glm::max(program_ms, 0.0001), max_diff);
+    }
+
+    mode = saved_mode;
+    rebuild_graph();
+    last_mode = mode;
+}
+
 // -----------------------------------------------------------------------
 void AnimGraphTester::dump_ik_frame(int frame_num) {
     AnimatorObject* anim = mesh ? mesh->get_animator() : nullptr;
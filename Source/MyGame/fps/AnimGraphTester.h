@@ -148,6 +148,9 @@ public:
     REF bool cached_use_meshspace = false; // final toggle: false = local-space masked blend, true = mesh-space
 
 	void start_ik_dump(); // called externally (console command)
+	// anim_graph_bench console command: runs every test mode's graph through the op program and the recursive
+	// get_pose path, prints the timings and checks both produce the same bones
+	void run_graph_benchmark(int iterations);
 
 #ifdef EDITOR_BUILD
     std::unique_ptr<IComponentEditorUi> create_editor_ui() final;
@@ -128,6 +128,55 @@ public:
 
 using TraceIgnoreVec = InlineVec<PhysicsBody*, 4>;
 
+enum class SceneQueryType : uint8_t
+{
+	Ray,
+	SweepSphere,
+	SweepCapsule, // vertical capsule, like sweep_capsule
+	OverlapSphere,
+	OverlapCapsule,
+};
+
+// one query of a PhysicsManager::run_query_batch call
+struct scene_query_def
+{
+	SceneQueryType type = SceneQueryType::Ray;
+	glm::vec3 start = glm::vec3(0.f);
+	glm::vec3 dir = glm::vec3(0.f, -1.f, 0.f); // normalized, unused for overlaps
+	float length = 0.f;						   // unused for overlaps
+	float radius = 0.f;						   // spheres and capsules
+	float half_height = 0.f;				   // capsules
+	uint32_t channel_mask = UINT32_MAX;
+	const TraceIgnoreVec* ignore = nullptr; // rays and sweeps, must stay alive until the batch returns
+
+	static scene_query_def ray(const glm::vec3& start, const glm::vec3& dir, float length, uint32_t channel_mask,
+							   const TraceIgnoreVec* ignore = nullptr) {
+		scene_query_def q;
+		q.start = start;
+		q.dir = dir;
+		q.length = length;
+		q.channel_mask = channel_mask;
+		q.ignore = ignore;
+		return q;
+	}
+	static scene_query_def sweep_capsule(const vertical_capsule_def_t& capsule, const glm::vec3& start,
+										 const glm::vec3& dir, float length, uint32_t channel_mask,
+										 const TraceIgnoreVec* ignore = nullptr) {
+		scene_query_def q = ray(start, dir, length, channel_mask, ignore);
+		q.type = SceneQueryType::SweepCapsule;
+		q.radius = capsule.radius;
+		q.half_height = capsule.half_height;
+		return q;
+	}
+};
+
+struct scene_query_result
+{
+	bool has_hit = false;		  // what the single query function would have returned
+	world_query_result hit;		  // rays and sweeps
+	overlap_query_result overlap; // overlaps
+};
+
 class BinaryReader;
 class PhysicsManImpl;
 class PhysicsManager
@@ -148,9 +197,19 @@ public:
 	bool capsule_is_overlapped(overlap_query_result& out, const vertical_capsule_def_t& capsule, const glm::vec3& start,
 							   uint32_t channel_mask);
 	bool sphere_is_overlapped(overlap_query_result& out, float radius, const glm::vec3& start, uint32_t channel_mask);
+	// Runs every query and writes out[i] for queries[i], out must be as large as queries. Large batches are split
+	// across the JobSystem workers, the call blocks until all are done. Same results as calling the single query
+	// functions one by one.
+	void run_query_batch(std::span<const scene_query_def> queries, std::span<scene_query_result> out);
 
 	// simulate scene and fetch the results, thus a blocking update
 	void simulate_and_fetch(float dt);
+	// same as simulate_and_fetch split in two, work can run between them while the workers simulate. PhysX buffers
+	// writes to actors made in between and queries see the state from before the step. end_simulate fetches,
+	// runs the contact/trigger callbacks and copies transforms, does nothing if no step was started.
+	void begin_simulate(float dt);
+	void end_simulate();
+	bool is_simulating() const;
 
 	// used only by model loader
 	bool load_physics_into_shape(BinaryReader& reader, physics_shape_def& def);
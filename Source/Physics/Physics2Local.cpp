@@ -43,6 +43,7 @@
 #include "Game/Entity.h"
 
 #include "Framework/Config.h"
+#include "Framework/Jobs.h"
 
 #define WARN_ONCE(a, ...)                                                                                              \
 	{                                                                                                                  \
@@ -91,9 +92,66 @@ bool PhysicsManager::sphere_is_overlapped(overlap_query_result& out, float radiu
 	auto geom = physx::PxSphereGeometry(radius);
 	return impl->overlap_shared(out, geom, start, mask);
 }
+
+static bool run_scene_query(PhysicsManager& physics, const scene_query_def& q, scene_query_result& out) {
+	switch (q.type) {
+	case SceneQueryType::Ray:
+		return physics.trace_ray(out.hit, q.start, q.dir, q.length, q.ignore, q.channel_mask);
+	case SceneQueryType::SweepSphere:
+		return physics.sweep_sphere(out.hit, q.radius, q.start, q.dir, q.length, q.channel_mask, q.ignore);
+	case SceneQueryType::SweepCapsule: {
+		vertical_capsule_def_t capsule;
+		capsule.radius = q.radius;
+		capsule.half_height = q.half_height;
+		return physics.sweep_capsule(out.hit, capsule, q.start, q.dir, q.length, q.channel_mask, q.ignore);
+	}
+	case SceneQueryType::OverlapSphere:
+		return physics.sphere_is_overlapped(out.overlap, q.radius, q.start, q.channel_mask);
+	case SceneQueryType::OverlapCapsule: {
+		vertical_capsule_def_t capsule;
+		capsule.radius = q.radius;
+		capsule.half_height = q.half_height;
+		return physics.capsule_is_overlapped(out.overlap, capsule, q.start, q.channel_mask);
+	}
+	}
+	return false;
+}
+
+ConfigVar physics_query_batch_grain("physics.query_batch_grain", "64", CVAR_INTEGER | CVAR_DEV,
+									"queries per job in run_query_batch, smaller batches run on the calling thread",
+									1, 4096);
+
+void PhysicsManager::run_query_batch(std::span<const scene_query_def> queries, std::span<scene_query_result> out) {
+	CPU_FUNCTION();
+	ASSERT(out.size() >= queries.size());
+	const int count = (int)queries.size();
+	const int grain = physics_query_batch_grain.get_integer();
+	PROF_COUNTER_ADD("physics batched queries", prof::CounterUnit::Count, count);
+	// scene queries only read the scene, any number of threads can run them at once
+	auto run_range = [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			out[i] = scene_query_result();
+			out[i].has_hit = run_scene_query(*this, queries[i], out[i]);
+		}
+	};
+	if (count > grain && JobSystem::inst && with_threading.get_bool())
+		JobSystem::inst->parallel_for_chunks(0, count, grain, run_range);
+	else
+		run_range(0, count);
+}
+
 void PhysicsManager::simulate_and_fetch(float dt) {
 	impl->simulate_and_fetch(dt);
 }
+void PhysicsManager::begin_simulate(float dt) {
+	impl->begin_simulate(dt);
+}
+void PhysicsManager::end_simulate() {
+	impl->end_simulate();
+}
+bool PhysicsManager::is_simulating() const {
+	return impl->simulating;
+}
 
 bool PhysicsManager::load_physics_into_shape(BinaryReader& reader, physics_shape_def& def) {
 	return impl->load_physics_into_shape(reader, def);
@@ -111,6 +169,8 @@ uint32_t PhysicsManager::get_collision_mask_for_layer(int layer) {
 #include "Render/RenderObj.h"
 #include "Physics2Local.h"
 #include <unordered_set>
+#include <unordered_map>
+#include <cstring>
 class MyPhysicsQueryFilter : public physx::PxQueryFilterCallback
 {
 public:
@@ -360,26 +420,47 @@ static PxFilterFlags my_filter_shader(PxFilterObjectAttributes attributes0, PxFi
 		pairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_CONTACT_POINTS;
 	return PxFilterFlag::eDEFAULT;
 }
-#include "Framework/Jobs.h"
-void physx_run_job(uintptr_t p) {
-	CPU_SCOPE("physx_run_job");
-	auto task = (PxBaseTask*)p;
-	task->run();
-	task->release();
+// profiler slots for physx task names, keyed by the name pointer (physx returns literals)
+static uint32_t get_physx_task_prof_slot(const char* name) {
+	static std::mutex slot_mutex;
+	static std::unordered_map<const char*, uint32_t> slots;
+	std::lock_guard<std::mutex> lock(slot_mutex);
+	auto find = slots.find(name);
+	if (find != slots.end())
+		return find->second;
+	const uint32_t slot = prof::ProfilerRegistry::register_zone(name, __FILE__, __LINE__, false);
+	slots.insert({name, slot});
+	return slot;
 }
 
-class MyDispatcher : public physx::PxCpuDispatcher
-{
-	// Inherited via PxCpuDispatcher
-	virtual void submitTask(physx::PxBaseTask& task) {
-		task.run();
-		task.release();
+static void physx_run_task(PxBaseTask& task) {
+	const char* name = task.getName();
+	prof::ProfilerCpuScope scope(get_physx_task_prof_slot(name ? name : "physx task"));
+	task.run();
+	task.release();
+}
 
-		// JobSystem::inst->add_job_no_counter(physx_run_job, uintptr_t(&task));
+static void physx_run_job(uintptr_t p) {
+	physx_run_task(*(PxBaseTask*)p);
+}
+
+// Hands physx tasks (broadphase, narrowphase, solver islands) to the JobSystem workers. Tasks submitted from a
+// worker go on that worker's own deque. Runs tasks inline when threading is off.
+class JobSystemDispatcher : public physx::PxCpuDispatcher
+{
+public:
+	void submitTask(physx::PxBaseTask& task) override {
+		if (!JobSystem::inst || !with_threading.get_bool()) {
+			physx_run_task(task);
+			return;
+		}
+		JobSystem::inst->add_job_no_counter(physx_run_job, uintptr_t(&task));
 	}
-	virtual uint32_t getWorkerCount() const {
-		// fixme
-		return 4;
+	// physx sizes its task splitting by this, follows threading.num_worker_threads through the JobSystem
+	uint32_t getWorkerCount() const override {
+		if (!JobSystem::inst || !with_threading.get_bool())
+			return 0;
+		return (uint32_t)JobSystem::inst->get_num_workers();
 	}
 };
 
@@ -393,10 +474,7 @@ void PhysicsManImpl::init() {
 	physx::PxSceneDesc sceneDesc(physics_factory->getTolerancesScale());
 	sceneDesc.gravity = physx::PxVec3(0.0f, -9.81f, 0.0f);
 	sceneDesc.filterShader = my_filter_shader; // physx::PxDefaultSimulationFilterShader;
-	dispatcher = new MyDispatcher;
-
-	if (!dispatcher)
-		Fatalf("PxDefaultCpuDispatcherCreate failed!");
+	dispatcher = new JobSystemDispatcher;
 
 	sceneDesc.cpuDispatcher = dispatcher;
 	scene = physics_factory->createScene(sceneDesc);
@@ -417,6 +495,93 @@ void PhysicsManImpl::init() {
 	scene->setSimulationEventCallback(mycallback.get());
 
 	set_physics_layer_collisions(get_default_layer_collision_matrix());
+
+	commands = ConsoleCmdGroup::create("");
+	commands->add("physics_query_bench", [this](const Cmd_Args& args) {
+		run_query_benchmark(args.size() >= 2 ? std::max(atoi(args.at(1)), 1) : 10000);
+	});
+	commands->add("physics_stats", [this](const Cmd_Args& args) { print_stats(); });
+}
+
+void PhysicsManImpl::run_query_benchmark(int num_rays) {
+	if (simulating) {
+		sys_print(Warning, "physics_query_bench: a physics step is in flight, try again\n");
+		return;
+	}
+	// rays start anywhere inside the static geometry's bounds and point in random directions
+	PxBounds3 bounds = PxBounds3::empty();
+	const PxU32 num_static = scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC);
+	std::vector<PxActor*> actors(num_static);
+	scene->getActors(PxActorTypeFlag::eRIGID_STATIC, actors.data(), num_static);
+	for (PxActor* a : actors)
+		bounds.include(a->getWorldBounds());
+	if (bounds.isEmpty()) {
+		sys_print(Warning, "physics_query_bench: no static geometry, load a level first\n");
+		return;
+	}
+	const glm::vec3 bmin = physx_to_glm(bounds.minimum);
+	const glm::vec3 bmax = physx_to_glm(bounds.maximum);
+	const float length = glm::length(bmax - bmin);
+
+	Random rand(1234);
+	std::vector<scene_query_def> queries(num_rays);
+	for (auto& q : queries) {
+		const glm::vec3 start(rand.RandF(bmin.x, bmax.x), rand.RandF(bmin.y, bmax.y), rand.RandF(bmin.z, bmax.z));
+		glm::vec3 dir(rand.RandF(-1.f, 1.f), rand.RandF(-1.f, 1.f), rand.RandF(-1.f, 1.f));
+		if (glm::dot(dir, dir) < 0.0001f)
+			dir = glm::vec3(0.f, -1.f, 0.f);
+		q = scene_query_def::ray(start, glm::normalize(dir), length, UINT32_MAX);
+	}
+	std::vector<scene_query_result> results(num_rays);
+
+	double start = GetTime();
+	int single_hits = 0;
+	for (int i = 0; i < num_rays; i++) {
+		world_query_result out;
+		single_hits += g_physics.trace_ray(out, queries[i].start, queries[i].dir, queries[i].length, nullptr,
+										   queries[i].channel_mask);
+	}
+	const double single_ms = (GetTime() - start) * 1000.0;
+
+	start = GetTime();
+	g_physics.run_query_batch(queries, results);
+	const double batch_ms = (GetTime() - start) * 1000.0;
+	int batch_hits = 0;
+	for (const auto& r : results)
+		batch_hits += r.has_hit;
+
+	sys_print(Info, "physics_query_bench: %d rays against %d static actors\n", num_rays, (int)num_static);
+	sys_print(Info, "    one by one: %.2f ms (%d hits)\n", single_ms, single_hits);
+	sys_print(Info, "    batched:    %.2f ms (%d hits, %d workers)\n", batch_ms, batch_hits,
+			  JobSystem::inst ? JobSystem::inst->get_num_workers() : 0);
+	if (single_hits != batch_hits)
+		sys_print(Warning, "physics_query_bench: batched hit count differs\n");
+}
+
+void PhysicsManImpl::print_stats() {
+	if (simulating) {
+		sys_print(Warning, "physics_stats: a physics step is in flight, try again\n");
+		return;
+	}
+	// every shape of a free actor is its own broadphase volume, an aggregate is one for all of its actors
+	const PxU32 num_actors = scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC);
+	std::vector<PxActor*> actors(num_actors);
+	scene->getActors(PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC, actors.data(), num_actors);
+	int num_shapes = 0;
+	int num_volumes = scene->getNbAggregates();
+	for (PxActor* a : actors) {
+		const int shapes = ((PxRigidActor*)a)->getNbShapes();
+		num_shapes += shapes;
+		if (!a->getAggregate())
+			num_volumes += shapes;
+	}
+	PxSimulationStatistics stats;
+	scene->getSimulationStatistics(stats);
+	sys_print(Info, "physics_stats: %d actors, %d shapes, %d aggregates\n", (int)num_actors, num_shapes,
+			  (int)scene->getNbAggregates());
+	sys_print(Info, "    broadphase volumes: %d\n", num_volumes);
+	sys_print(Info, "    last step: %d contact pairs, %d new pairs, %d lost pairs\n",
+			  (int)stats.nbDiscreteContactPairsTotal, (int)stats.nbNewPairs, (int)stats.nbLostPairs);
 }
 
 void PhysicsManImpl::set_physics_layer_collisions(std::span<const bool> triangular_matrix) {
@@ -453,11 +618,32 @@ void PhysicsManImpl::set_physics_layer_collisions(std::span<const bool> triangul
 
 void PhysicsManImpl::simulate_and_fetch(float dt) {
 	CPU_FUNCTION();
+	begin_simulate(dt);
+	end_simulate();
+}
+
+void PhysicsManImpl::begin_simulate(float dt) {
+	CPU_SCOPE("physx simulate");
+	ASSERT(!simulating);
+	scene->simulate(dt);
+	simulating = true;
+}
+
+void PhysicsManImpl::end_simulate() {
+	if (!simulating)
+		return;
+	CPU_FUNCTION();
 	{
-		CPU_SCOPE("physx simulate/fetchresults");
-		scene->simulate(dt);
+		// whatever shows up here is the part of the step that wasn't hidden behind other work
+		CPU_SCOPE("physx fetchresults wait");
+		// help with the queued physx tasks instead of sleeping in fetchResults
+		while (JobSystem::inst && !scene->checkResults(false)) {
+			if (!JobSystem::inst->try_run_pending_job())
+				std::this_thread::yield();
+		}
 		scene->fetchResults(true /* block */);
 	}
+	simulating = false;
 	mycallback->call_all_triggered();
 	mycallback->call_all_hits();
 
@@ -487,10 +673,10 @@ void PhysicsBodyDefinition::uninstall_shapes() {
 	for (auto& s : shapes) {
 		if (s.shape == ShapeType_e::ConvexShape) {
 			if (s.convex_mesh)
-				s.convex_mesh->release();
+				physics_local_impl->release_cooked_mesh(s.convex_mesh);
 		} else if (s.shape == ShapeType_e::MeshShape) {
 			if (s.tri_mesh)
-				s.tri_mesh->release();
+				physics_local_impl->release_cooked_mesh(s.tri_mesh);
 		}
 	}
 	shapes.clear();
@@ -498,23 +684,95 @@ void PhysicsBodyDefinition::uninstall_shapes() {
 PhysicsBodyDefinition::~PhysicsBodyDefinition() {
 	uninstall_shapes();
 }
+// fnv-1a over the cooked bytes, seeded with the shape type so a convex and a tri mesh never share
+static uint64_t hash_cooked_mesh(const uint8_t* data, uint32_t size, ShapeType_e shape) {
+	uint64_t h = 14695981039346656037ull ^ uint64_t(shape);
+	for (uint32_t i = 0; i < size; i++)
+		h = (h ^ data[i]) * 1099511628211ull;
+	return h;
+}
+
 bool PhysicsManImpl::load_physics_into_shape(BinaryReader& reader, physics_shape_def& def) {
 	if (def.shape != ShapeType_e::ConvexShape && def.shape != ShapeType_e::MeshShape)
 		return true;
-	uint32_t count = reader.read_int32();
-	std::vector<uint8_t> data(count);
-	reader.read_bytes_ptr(data.data(), count);
-	physx::PxDefaultMemoryInputData inp(data.data(), count);
-
-	if (def.shape == ShapeType_e::ConvexShape) {
-		def.convex_mesh = physics_factory->createConvexMesh(inp);
-	} else if (def.shape == ShapeType_e::MeshShape) {
-		def.tri_mesh = physics_factory->createTriangleMesh(inp);
+	def.convex_mesh = nullptr;
+	const uint32_t count = reader.read_int32();
+	// the reader holds the whole model file, physx reads the cooked data from it in place
+	const uint8_t* data = reader.read_bytes_view(count);
+	if (!data) {
+		sys_print(Error, "load_physics_into_shape: cooked mesh runs past the end of the file\n");
+		return false;
+	}
+	const uint64_t key = hash_cooked_mesh(data, count, def.shape);
+
+	physx::PxBase* mesh = acquire_cooked_mesh(key, data, count);
+	if (mesh) {
+		PROF_COUNTER_ADD("physics cooked meshes shared", prof::CounterUnit::Count, 1);
+		PROF_COUNTER_ADD("physics cooked bytes shared", prof::CounterUnit::Bytes, count);
+	} else {
+		// unlocked, loader threads deserialize their meshes in parallel
+		physx::PxDefaultMemoryInputData inp(const_cast<uint8_t*>(data), count);
+		if (def.shape == ShapeType_e::ConvexShape)
+			mesh = physics_factory->createConvexMesh(inp);
+		else
+			mesh = physics_factory->createTriangleMesh(inp);
+		if (!mesh)
+			return true;
+
+		std::lock_guard<std::mutex> lock(cooked_mesh_mutex);
+		auto find = cooked_meshes.find(key);
+		if (find == cooked_meshes.end()) {
+			CookedMesh entry;
+			entry.mesh = mesh;
+			entry.cooked.assign(data, data + count);
+			entry.refs = 1;
+			cooked_meshes.insert({key, std::move(entry)});
+			cooked_mesh_keys.insert({mesh, key});
+		} else if (find->second.cooked.size() == count && memcmp(find->second.cooked.data(), data, count) == 0) {
+			// another load made the same mesh while this one was being created, use theirs
+			mesh->release();
+			mesh = find->second.mesh;
+			find->second.refs += 1;
+		}
+		// else a hash collision, this mesh stays out of the cache and is released on its own
 	}
+	if (def.shape == ShapeType_e::ConvexShape)
+		def.convex_mesh = static_cast<physx::PxConvexMesh*>(mesh);
+	else
+		def.tri_mesh = static_cast<physx::PxTriangleMesh*>(mesh);
 
 	return true;
 }
 
+physx::PxBase* PhysicsManImpl::acquire_cooked_mesh(uint64_t key, const uint8_t* data, uint32_t size) {
+	std::lock_guard<std::mutex> lock(cooked_mesh_mutex);
+	auto find = cooked_meshes.find(key);
+	if (find == cooked_meshes.end())
+		return nullptr;
+	// the hash only finds the candidate, the bytes decide
+	const std::vector<uint8_t>& cooked = find->second.cooked;
+	if (cooked.size() != size || memcmp(cooked.data(), data, size) != 0)
+		return nullptr;
+	find->second.refs += 1;
+	return find->second.mesh;
+}
+
+void PhysicsManImpl::release_cooked_mesh(physx::PxBase* mesh) {
+	std::lock_guard<std::mutex> lock(cooked_mesh_mutex);
+	auto key = cooked_mesh_keys.find(mesh);
+	if (key == cooked_mesh_keys.end()) {
+		mesh->release();
+		return;
+	}
+	auto find = cooked_meshes.find(key->second);
+	ASSERT(find != cooked_meshes.end() && find->second.refs > 0);
+	if (--find->second.refs == 0) {
+		cooked_meshes.erase(find);
+		cooked_mesh_keys.erase(key);
+		mesh->release();
+	}
+}
+
 void PhysicsManager::sync_render_data() {
 	MeshBuilder_Object o;
 	o.visible = g_draw_physx_scene.get_integer() != 0;
@@ -25,9 +25,13 @@
 #include "Physics2.h"
 #include "Framework/MeshBuilder.h"
 #include "Render/RenderObj.h"
+#include "Framework/ConsoleCmdGroup.h"
 
 #include <memory>
 #include <array>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
 
 using namespace physx;
 
@@ -73,9 +77,27 @@ public:
 
 	void init();
 	void simulate_and_fetch(float dt);
+	void begin_simulate(float dt);
+	void end_simulate();
+	bool simulating = false;
 
 	// used only by model loader
 	bool load_physics_into_shape(BinaryReader& reader, physics_shape_def& def);
+	// drops one use of a mesh made by load_physics_into_shape, the physx object goes when the last one does
+	void release_cooked_mesh(physx::PxBase* mesh);
+
+	// convex/triangle meshes shared by every shape loaded from the same cooked bytes
+	struct CookedMesh
+	{
+		physx::PxBase* mesh = nullptr;
+		std::vector<uint8_t> cooked; // compared before sharing, equal hashes don't mean equal meshes
+		int refs = 0;
+	};
+	// the cached mesh for these cooked bytes with one more use, null if there isn't one
+	physx::PxBase* acquire_cooked_mesh(uint64_t key, const uint8_t* data, uint32_t size);
+	std::mutex cooked_mesh_mutex;
+	std::unordered_map<uint64_t, CookedMesh> cooked_meshes; // by content hash
+	std::unordered_map<const physx::PxBase*, uint64_t> cooked_mesh_keys;
 
 	physx::PxMaterial* default_material = nullptr;
 	physx::PxCpuDispatcher* dispatcher = nullptr;
@@ -90,6 +112,12 @@ public:
 	MeshBuilder debug_mesh;
 	handle<MeshBuilder_Object> debug_mesh_handle;
 	void update_debug_physics_shapes();
+
+	uptr<ConsoleCmdGroup> commands;
+	// physics_query_bench: random rays through the loaded level, one by one and through run_query_batch
+	void run_query_benchmark(int num_rays);
+	// physics_stats: broadphase volumes and pair counts of the last step
+	void print_stats();
 };
 
 extern PhysicsManImpl* physics_local_impl;
\ No newline at end of file
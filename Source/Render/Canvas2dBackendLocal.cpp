@@ -122,7 +122,8 @@ void Canvas2dBackendLocal::render() {
 			}
 
 			gfx().draw_elements_base_vertex(GraphicsPrimitiveType::Triangles, b.index_count, VertexInputIndexType::uint32,
-											 b.index_start * (int)sizeof(uint32_t), b.base_vertex);
+											 b.source->index_byte_offset + b.index_start * (int)sizeof(uint32_t),
+											 b.source->base_vertex + b.base_vertex);
 			draw.stats.total_draw_calls++;
 		}
 
@@ -1,17 +1,36 @@
 #include "Render/Canvas2dGpuMesh.h"
 #include "Framework/MeshBuilder.h"
 #include "Render/IGraphicsDevice.h"
+#include "Render/UploadRing.h"
 
 void Canvas2dGpuMesh::release() {
+	if (is_transient) {
+		vao = nullptr;
+		is_transient = false;
+	}
 	safe_release(vao);
 	safe_release(vbo);
 	safe_release(ebo);
 	num_indices = 0;
 	vbo_capacity_bytes = 0;
 	ebo_capacity_bytes = 0;
+	index_byte_offset = 0;
+	base_vertex = 0;
+}
+
+void Canvas2dGpuMesh::upload_transient(MeshBuilder& mb, TransientMeshRing& ring) {
+	if (!is_transient)
+		release();
+	is_transient = true;
+	TransientMesh mesh = ring.upload(mb);
+	vao = mesh.vao;
+	num_indices = mesh.num_indices;
+	index_byte_offset = mesh.index_byte_offset;
+	base_vertex = mesh.base_vertex;
 }
 
 void Canvas2dGpuMesh::upload_from(MeshBuilder& mb) {
+	ASSERT(!is_transient);
 	const int vb_size = (int)(mb.get_v().size() * sizeof(MbVertex));
 	const int ib_size = (int)(mb.get_i().size() * sizeof(uint32_t));
 
@@ -2,6 +2,7 @@
 class MeshBuilder;
 class IGraphicsBuffer;
 class IGraphicsVertexInput;
+class TransientMeshRing;
 
 // GPU-upload wrapper for 2d geometry (transient per-frame arena, or one
 // Canvas2dVertexArray's persistent buffer). Deliberately separate from MeshBuilderDD
@@ -13,11 +14,15 @@ class IGraphicsVertexInput;
 // every call -- matters for a persistent VertexArray that's re-uploaded after a small
 // edit, not for the transient per-frame arena (which is 100% new data every frame
 // anyway, so it always takes the full-upload path).
+//
+// The transient arena goes through upload_transient() instead: the frame's geometry lands in the renderer's
+// TransientMeshRing and draws offset their ranges by index_byte_offset/base_vertex.
 class Canvas2dGpuMesh
 {
 public:
 	void release();
 	void upload_from(MeshBuilder& mb);
+	void upload_transient(MeshBuilder& mb, TransientMeshRing& ring);
 
 	IGraphicsBuffer* vbo = nullptr;
 	IGraphicsBuffer* ebo = nullptr;
@@ -25,4 +30,8 @@ public:
 	int num_indices = 0;
 	int vbo_capacity_bytes = 0;
 	int ebo_capacity_bytes = 0;
+	// added to every batch's range, nonzero only for upload_transient
+	int index_byte_offset = 0;
+	int base_vertex = 0;
+	bool is_transient = false; // vao belongs to the ring
 };
@@ -0,0 +1,65 @@
+#include "DrawKeySort.h"
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+// submesh bytes are the least significant digits, then the key's
+static const int NUM_DIGITS = 4 + 8;
+
+static inline uint32_t get_digit(const DrawKeySortItem& item, int digit) {
+	if (digit < 4)
+		return (item.submesh >> (digit * 8)) & 0xff;
+	return (uint32_t)(item.key >> ((digit - 4) * 8)) & 0xff;
+}
+
+int radix_sort_draw_keys(std::span<DrawKeySortItem> items, std::span<DrawKeySortItem> scratch) {
+	assert(scratch.size() >= items.size());
+	const int count = (int)items.size();
+	if (count < 2)
+		return 0;
+
+	// all histograms in one read of the items
+	uint32_t histogram[NUM_DIGITS][256] = {};
+	for (const DrawKeySortItem& item : items)
+		for (int d = 0; d < NUM_DIGITS; d++)
+			histogram[d][get_digit(item, d)]++;
+
+	DrawKeySortItem* src = items.data();
+	DrawKeySortItem* dst = scratch.data();
+	int passes = 0;
+	for (int d = 0; d < NUM_DIGITS; d++) {
+		uint32_t* h = histogram[d];
+		if (h[get_digit(src[0], d)] == (uint32_t)count)
+			continue; // every item has this byte, the pass wouldn't move anything
+		uint32_t ofs = 0;
+		for (int b = 0; b < 256; b++) {
+			const uint32_t n = h[b];
+			h[b] = ofs;
+			ofs += n;
+		}
+		for (int i = 0; i < count; i++)
+			dst[h[get_digit(src[i], d)]++] = src[i];
+		std::swap(src, dst);
+		passes++;
+	}
+	if (src != items.data())
+		memcpy(items.data(), src, sizeof(DrawKeySortItem) * count);
+	return passes;
+}
+
+void merge_sorted_draw_keys(std::span<const DrawKeySortItem> existing, std::span<const DrawKeySortItem> added,
+							int* existing_to_merged, int* added_to_merged) {
+	size_t e = 0;
+	size_t a = 0;
+	int out = 0;
+	while (e < existing.size() && a < added.size()) {
+		if (draw_key_less(added[a], existing[e]))
+			added_to_merged[a++] = out++;
+		else
+			existing_to_merged[e++] = out++;
+	}
+	while (e < existing.size())
+		existing_to_merged[e++] = out++;
+	while (a < added.size())
+		added_to_merged[a++] = out++;
+}
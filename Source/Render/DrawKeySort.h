@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+// Sorting helpers for the draw batch builders. Items order by (key, submesh), the order Render_Pass::make_batches and
+// the fast path's command list use. BuildSceneData_CpuFast keeps its sorted commands between frames and only sorts
+// the commands of new model/material slots, then merges them in.
+struct DrawKeySortItem
+{
+	uint64_t key = 0;
+	uint32_t submesh = 0;
+	uint32_t index = 0; // caller's payload, usually the position before sorting
+};
+
+inline bool draw_key_less(const DrawKeySortItem& a, const DrawKeySortItem& b) {
+	if (a.key != b.key)
+		return a.key < b.key;
+	return a.submesh < b.submesh;
+}
+
+// Stable LSD radix sort, 8 bits a pass. Passes where every item has the same byte are skipped, keys built from a few
+// distinct fields cost a few passes. scratch needs items.size() entries. Returns the number of passes run.
+int radix_sort_draw_keys(std::span<DrawKeySortItem> items, std::span<DrawKeySortItem> scratch);
+
+// Merges two sorted lists without moving them: existing_to_merged[i] and added_to_merged[i] get the merged position
+// of existing[i] and added[i]. Equal items keep the existing one first.
+void merge_sorted_draw_keys(std::span<const DrawKeySortItem> existing, std::span<const DrawKeySortItem> added,
+							int* existing_to_merged, int* added_to_merged);
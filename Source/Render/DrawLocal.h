@@ -31,6 +31,8 @@
 #include "Framework/ConsoleCmdGroup.h"
 #include "Render/PPManager.h"
 #include "Render/Canvas2dBackendLocal.h"
+#include "Render/GraphicsCommandList.h"
+#include "Render/UploadRing.h"
 #include <array>
 #include "IGraphicsDevice.h"
 
@@ -62,6 +64,7 @@ class Model;
 class Animator;
 class Texture;
 class Entity;
+struct JobCounter;
 
 // ---------------------------------------------------------------------------
 // Renderer — main render pipeline
@@ -113,7 +116,11 @@ public:
 	void editor_clear_debug_overlay() final;
 	EditorDebugOverlayState editor_get_debug_overlay_state() const final;
 #endif
-	void pre_sync_update() final { matman.pre_render_update(); }
+	void pre_sync_update() final {
+		// the scene draw reading the last sync's transient geometry was issued, fence it before the next sync writes
+		transient_meshes.next_frame();
+		matman.pre_render_update();
+	}
 
 	// ###################
 	// # local interface #
@@ -140,6 +147,28 @@ public:
 							  float poly_offset_factor = 0.f, bool wireframe_overlay = false);
 
 	void scene_draw_internal(SceneDrawParamsEx params, View_Setup view);
+
+	// CSM cascades and spot light shadows, one GraphicsCommandList each (DrawLocal_CommandLists.cpp).
+	// begin_shadow_recording() picks the passes and, with r.parallel_shadow_recording, kicks a recording job per pass
+	// while the caller keeps issuing the main view; submit_shadow_passes() waits and replays them in pass order, or
+	// draws them directly when nothing was recorded.
+	struct ShadowPassTask
+	{
+		int cascade = -1; // else a spot light
+		handle<Render_Light> light;
+		GraphicsCommandList* list = nullptr;
+		bool use_static_layer = false;	  // r.shadow_cache: static casters come from the pass's cached layer
+		bool redraw_static_layer = false; // which has to be redrawn first
+	};
+	void begin_shadow_recording();
+	void submit_shadow_passes();
+	void draw_shadow_pass(const ShadowPassTask& task);
+	std::vector<ShadowPassTask> shadow_tasks;
+	std::vector<handle<Render_Light>> shadow_spot_lights;
+	std::vector<std::unique_ptr<GraphicsCommandList>> shadow_cmd_lists;
+	JobCounter* shadow_record_counter = nullptr;
+	bool shadow_passes_begun = false;
+	bool shadow_passes_recorded = false;
 	IGraphicsTexture* do_post_process_stack(const std::vector<MaterialInstance*>& stack);
 	void check_cubemaps_dirty(); // render any cubemaps
 	void update_cubemap_specular_irradiance(glm::vec3 ambientCube[6], Texture* cubemap, glm::vec3 position,
@@ -335,6 +364,11 @@ public:
 	Render_Scene scene;
 
 	Render_Stats stats;
+	// draws issued on a recording thread are counted when their list is replayed
+	void count_draw_call() {
+		if (!gfx_is_recording())
+			stats.total_draw_calls++;
+	}
 
 	// Canvas2d's notion of "the main window" render target/size -- used both to resolve
 	// Canvas2d::set_target_window() and to decide whether a depth-tested Canvas2d batch
@@ -342,6 +376,8 @@ public:
 	IGraphicsTexture* get_ui_composite_target() const { return tex.output_composite; }
 	glm::ivec2 get_ui_composite_size() const { return {cur_w, cur_h}; }
 	Canvas2dBackendLocal* get_canvas2d_drawer() const { return canvas2dDrawer; }
+	// one-frame MeshBuilder geometry (particles, Canvas2d arena, debug quads), see UploadRing.h
+	TransientMeshRing& get_transient_meshes() { return transient_meshes; }
 
 	Program_Manager& get_prog_man() { return prog_man; }
 	// Transitional shim — the OpenGL state cache used to live on a separate
@@ -359,6 +395,7 @@ public:
 
 private:
 	Canvas2dBackendLocal* canvas2dDrawer = nullptr;
+	TransientMeshRing transient_meshes;
 #ifdef EDITOR_BUILD
 	std::unique_ptr<ThumbnailRenderer> thumbnailRenderer;
 #endif
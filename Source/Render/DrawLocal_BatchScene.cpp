@@ -13,72 +13,66 @@
 #include "IGraphicsDevice.h"
 #include "GpuCullingTest.h"
 #include "Framework/ArenaStd.h"
+#include "DrawKeySort.h"
 
 // -----------------------------------------------------------------------
 // BuildSceneData_CpuFast – batch rebuilding, GPU upload, and draw dispatch
 // -----------------------------------------------------------------------
 
-void BuildSceneData_CpuFast::rebuild_batches() {
-	ASSERT(!out_cmds.empty() || true); // invariant: arrays are consistently sized
-
-	auto make_batches = [&](std::vector<Multidraw_Batch>& batches, const bool is_depth_pass) {
-		batches.clear();
-
-		if (out_cmds.empty())
-			return;
-
-		Multidraw_Batch batch;
-		batch.first = 0;
-		batch.count = 1;
-
-		const Model* batch_model = cmd_to_extra.at(0).model;
-		auto batch_sort_key = cmd_to_extra.at(0).key;
-
-		for (int i = 1; i < (int)out_cmds.size(); i++) {
-
-			const Model* this_model = cmd_to_extra.at(i).model;
-			auto this_sort_key = cmd_to_extra.at(i).key;
-
-			bool batch_this = false;
+// the batch builders compare a command to its batch's first, since every test is an equality of key fields that's
+// the same as comparing neighbours, which is what lets patch_batches() keep boundaries between untouched commands
+static bool can_batch_cmds(const draw_call_key& batch_key, const draw_call_key& this_key, const bool is_depth_pass) {
+	const bool same_layer = batch_key.layer == this_key.layer;
+	const bool same_vao = batch_key.vao == this_key.vao;
+	const bool same_material = batch_key.texture == this_key.texture;
+	const bool same_shader = batch_key.shader == this_key.shader;
+	const bool same_other_state = batch_key.blending == this_key.blending && batch_key.backface == this_key.backface;
+
+	if (!is_depth_pass)
+		return same_vao && same_material && same_other_state && same_shader && same_layer;
+	// pass==DEPTH
+	// can batch across texture changes as long as its not alpha tested
+	return same_shader && same_vao && same_other_state;
+}
 
-			bool same_layer = batch_sort_key.layer == this_sort_key.layer;
-			bool same_vao = batch_sort_key.vao == this_sort_key.vao;
-			bool same_material = batch_sort_key.texture == this_sort_key.texture;
-			bool same_shader = batch_sort_key.shader == this_sort_key.shader;
-			bool same_other_state =
-				batch_sort_key.blending == this_sort_key.blending && batch_sort_key.backface == this_sort_key.backface;
+void BuildSceneData_CpuFast::patch_batches(std::span<const int> merged_to_old, int old_count) {
+	ASSERT((int)merged_to_old.size() == (int)out_cmds.size());
+	ArenaScope scope(draw.mem_arena);
 
-			if (!is_depth_pass) {
-				if (same_vao && same_material && same_other_state && same_shader && same_layer)
-					batch_this = true;
-				else
-					batch_this = false;
+	auto patch = [&](std::vector<Multidraw_Batch>& batches, const bool is_depth_pass) {
+		arena_vec<uint8_t> old_batch_start(old_count, 0, scope);
+		for (const Multidraw_Batch& b : batches) {
+			if (b.first < old_count)
+				old_batch_start[b.first] = 1;
+		}
+		batches.clear();
 
-			} else { // pass==DEPTH
-				// can batch across texture changes as long as its not alpha tested
-				if (same_shader && same_vao && same_other_state)
-					batch_this = true;
-				else
-					batch_this = false;
+		for (int i = 0; i < (int)out_cmds.size(); i++) {
+			bool starts_batch = true;
+			if (i > 0) {
+				const int prev_old = merged_to_old[i - 1];
+				const int this_old = merged_to_old[i];
+				if (prev_old >= 0 && this_old == prev_old + 1) {
+					// same neighbour as last time, keep the boundary
+					starts_batch = old_batch_start[this_old];
+				} else {
+					starts_batch = !can_batch_cmds(cmd_to_extra.at(i - 1).key, cmd_to_extra.at(i).key, is_depth_pass);
+					batch_stats.boundaries_tested++;
+				}
 			}
-
-			if (batch_this) {
-				batch.count += 1;
-			} else {
-				batches.push_back(batch);
-				batch.count = 1;
+			if (starts_batch) {
+				Multidraw_Batch batch;
 				batch.first = i;
-
-				batch_model = this_model;
-				batch_sort_key = this_sort_key;
+				batch.count = 1;
+				batches.push_back(batch);
+			} else {
+				batches.back().count += 1;
 			}
 		}
-
-		batches.push_back(batch);
 	};
 
-	make_batches(gbuffer_pass.batches, false);
-	make_batches(shadow_pass.batches, true);
+	patch(gbuffer_pass.batches, false);
+	patch(shadow_pass.batches, true);
 }
 
 void BuildSceneData_CpuFast::upload_gpu_cmds(int sum_count) {
@@ -240,7 +234,7 @@ void BuildSceneData_CpuFast::do_draw_shared(int flags, float poly_factor) {
 						count, sizeof(gpu::DrawElementsIndirectCommand));
 				}
 
-				draw.stats.total_draw_calls += 1;
+				draw.count_draw_call();
 			}
 			offset += incr;
 		}
@@ -307,18 +301,26 @@ void BuildSceneData_CpuFast::do_gbuffer_draw(bool overdraw_visualization_2nd_pas
 	do_draw_shared(flags, 0);
 }
 
-void BuildSceneData_CpuFast::rebuild_mod_data() {
+void BuildSceneData_CpuFast::rebuild_mod_data(bool full_rebuild) {
 	CPU_SCOPE("BuildSceneData_CpuFast::rebuild_mod_data");
 	ASSERT(BuildSceneData_CpuFast::inst != nullptr);
 
 	ArenaScope scope(draw.mem_arena);
 
-	out_cmds.clear();
-	cmd_to_mod_data_ptr.clear();
-	cmd_to_extra.clear();
-
-	gbuffer_pass.batches.clear();
-	shadow_pass.batches.clear();
+	// out_cmds stays sorted between calls. An update drops the commands of removed slots, sorts just the commands of
+	// slots that don't have any yet and merges them in. A full rebuild is the same with nothing kept.
+	if (full_rebuild) {
+		out_cmds.clear();
+		cmd_to_mod_data_ptr.clear();
+		cmd_to_extra.clear();
+		gbuffer_pass.batches.clear();
+		shadow_pass.batches.clear();
+		for (auto& [key, md] : mod_data)
+			md.has_draw_cmds = false;
+		batch_stats.full_rebuilds++;
+	} else {
+		batch_stats.incremental_rebuilds++;
+	}
 
 	auto make_key = [&](MaterialInstance* this_mat, Model* this_model, bool is_compact) -> draw_call_key {
 		draw_call_key k{};
@@ -343,28 +345,14 @@ void BuildSceneData_CpuFast::rebuild_mod_data() {
 		return k;
 	};
 
-	arena_vec<int> mod_data_gpu_buf(scope);
-	mod_data_gpu_buf.reserve(10'000);
-
+	// commands of new slots go on the end for now, part_to_draw_cmd points at that unsorted position
+	const int old_count = (int)out_cmds.size();
 	for (auto& [key, md] : mod_data) {
+		if (md.has_draw_cmds)
+			continue;
+		md.has_draw_cmds = true;
 		auto m = key.m;
 
-		const int bufstart = (int)mod_data_gpu_buf.size();
-		md.gpu_buf_ofs = bufstart;
-
-		mod_data_gpu_buf.push_back(m->get_num_lods());
-		{
-			const float cull_f = m->get_cull_distance();
-			mod_data_gpu_buf.push_back(*((int*)&cull_f));
-		}
-		for (int lodi = 0; lodi < m->get_num_lods(); lodi++) {
-			auto& lod = m->get_lod(lodi);
-			mod_data_gpu_buf.push_back(lod.part_ofs);
-			mod_data_gpu_buf.push_back(lod.part_count);
-			const float f = lod.end_percentage;
-			mod_data_gpu_buf.push_back(*((int*)&f));
-		}
-
 		const int num_parts = key.m->get_num_parts();
 		md.part_to_draw_cmd.clear();
 		for (int parti = 0; parti < num_parts; parti++) {
@@ -393,72 +381,96 @@ void BuildSceneData_CpuFast::rebuild_mod_data() {
 
 			md.part_to_draw_cmd.push_back(cmd_index);
 			md.part_to_draw_cmd.push_back(data);
-
-			mod_data_gpu_buf.push_back(cmd_index);
-			mod_data_gpu_buf.push_back(data);
 		}
 	}
-
-	// sort the commands
-	struct IntAndKey
+	const int total_count = (int)out_cmds.size();
+
+	// kept commands are already in order, removed slots were nulled by on_model_removed/on_fastpath_material_removed
+	arena_vec<DrawKeySortItem> kept(scope);
+	kept.reserve(old_count);
+	for (int i = 0; i < old_count; i++) {
+		if (mod_data_ptrs.at(cmd_to_mod_data_ptr[i]) != nullptr)
+			kept.push_back({cmd_to_extra[i].key.as_uint64(), (uint32_t)cmd_to_extra[i].submesh, (uint32_t)i});
+	}
+	arena_vec<DrawKeySortItem> added(scope);
+	added.reserve(total_count - old_count);
+	for (int i = old_count; i < total_count; i++)
+		added.push_back({cmd_to_extra[i].key.as_uint64(), (uint32_t)cmd_to_extra[i].submesh, (uint32_t)i});
 	{
-		int i = 0;
-		draw_call_key key{};
-		int submesh_idx = 0;
-	};
-
-	std::vector<IntAndKey> sorted;
+		arena_vec<DrawKeySortItem> scratch(added.size(), scope);
+		radix_sort_draw_keys(added, scratch);
+		batch_stats.keys_sorted += (int64_t)added.size();
+	}
 
-	for (int i = 0; i < (int)out_cmds.size(); i++) {
-		sorted.push_back({i, cmd_to_extra[i].key, cmd_to_extra[i].submesh});
+	// remap[unsorted index] = sorted index, -1 for dropped commands
+	arena_vec<int> kept_to_merged(kept.size(), scope);
+	arena_vec<int> added_to_merged(added.size(), scope);
+	merge_sorted_draw_keys(kept, added, kept_to_merged.data(), added_to_merged.data());
+	const int merged_count = (int)(kept.size() + added.size());
+	arena_vec<int> remap(total_count, -1, scope);
+	arena_vec<int> merged_to_old(merged_count, -1, scope);
+	for (int i = 0; i < (int)kept.size(); i++) {
+		remap[kept[i].index] = kept_to_merged[i];
+		merged_to_old[kept_to_merged[i]] = kept[i].index;
 	}
-	const auto& merge_functor = [](const IntAndKey& a, const IntAndKey& b) {
-		if (a.key.as_uint64() < b.key.as_uint64())
-			return true;
-		else if (a.key.as_uint64() == b.key.as_uint64())
-			return a.submesh_idx < b.submesh_idx;
-		else
-			return false;
-	};
+	for (int i = 0; i < (int)added.size(); i++)
+		remap[added[i].index] = added_to_merged[i];
 
-	std::sort(sorted.begin(), sorted.end(), merge_functor);
-
-	const arena_vec<gpu::DrawElementsIndirectCommand> copied_cmds(out_cmds.begin(), out_cmds.end(), scope);
-	for (int i = 0; i < (int)sorted.size(); i++)
-		out_cmds[i] = copied_cmds[sorted[i].i];
-	const arena_vec<CmdExtraData> copied_extra(cmd_to_extra.begin(), cmd_to_extra.end(), scope);
-	for (int i = 0; i < (int)sorted.size(); i++)
-		cmd_to_extra[i] = copied_extra[sorted[i].i];
-	const arena_vec<int16_t> copied_ptr_i(cmd_to_mod_data_ptr.begin(), cmd_to_mod_data_ptr.end(), scope);
-	for (int i = 0; i < (int)sorted.size(); i++)
-		cmd_to_mod_data_ptr[i] = copied_ptr_i[sorted[i].i];
-
-	arena_vec<int> inv_sorted((int)sorted.size(), scope);
-	for (int i = 0; i < (int)sorted.size(); i++) {
-		inv_sorted[sorted[i].i] = i;
+	{
+		const arena_vec<gpu::DrawElementsIndirectCommand> copied_cmds(out_cmds.begin(), out_cmds.end(), scope);
+		const arena_vec<CmdExtraData> copied_extra(cmd_to_extra.begin(), cmd_to_extra.end(), scope);
+		const arena_vec<int16_t> copied_ptr_i(cmd_to_mod_data_ptr.begin(), cmd_to_mod_data_ptr.end(), scope);
+		out_cmds.resize(merged_count);
+		cmd_to_extra.resize(merged_count);
+		cmd_to_mod_data_ptr.resize(merged_count);
+		for (int i = 0; i < total_count; i++) {
+			const int to = remap[i];
+			if (to < 0)
+				continue;
+			out_cmds[to] = copied_cmds[i];
+			cmd_to_extra[to] = copied_extra[i];
+			cmd_to_mod_data_ptr[to] = copied_ptr_i[i];
+		}
 	}
 
-	// must adjust model index
+	// must adjust model index, and the gpu copy is rewritten with it (cheap, no sorting)
+	arena_vec<int> mod_data_gpu_buf(scope);
+	mod_data_gpu_buf.reserve(10'000);
 	for (auto& [key, md] : mod_data) {
+		auto m = key.m;
+
+		const int bufstart = (int)mod_data_gpu_buf.size();
+		md.gpu_buf_ofs = bufstart;
+
+		mod_data_gpu_buf.push_back(m->get_num_lods());
+		{
+			const float cull_f = m->get_cull_distance();
+			mod_data_gpu_buf.push_back(*((int*)&cull_f));
+		}
+		for (int lodi = 0; lodi < m->get_num_lods(); lodi++) {
+			auto& lod = m->get_lod(lodi);
+			mod_data_gpu_buf.push_back(lod.part_ofs);
+			mod_data_gpu_buf.push_back(lod.part_count);
+			const float f = lod.end_percentage;
+			mod_data_gpu_buf.push_back(*((int*)&f));
+		}
+
 		const int num_parts = (int)md.part_to_draw_cmd.size() / 2;
 		for (int parti = 0; parti < num_parts; parti++) {
+			const int remapped = remap.at(md.part_to_draw_cmd.at(parti * 2));
+			ASSERT(remapped >= 0);
+			md.part_to_draw_cmd.at(parti * 2) = remapped;
 
-			{
-				const int index = parti * 2;
-				const int cmd_ofs_prev = md.part_to_draw_cmd.at(index);
-				const int remapped = inv_sorted.at(cmd_ofs_prev);
-				md.part_to_draw_cmd.at(index) = remapped;
-			}
-			{
-				const int index = md.gpu_buf_ofs + 2 + 3 * md.m->get_num_lods() + parti * 2;
-				const int cmd_ofs_prev = mod_data_gpu_buf.at(index);
-				const int remapped = inv_sorted.at(cmd_ofs_prev);
-				mod_data_gpu_buf.at(index) = remapped;
-			}
+			mod_data_gpu_buf.push_back(remapped);
+			mod_data_gpu_buf.push_back(md.part_to_draw_cmd.at(parti * 2 + 1));
 		}
 	}
 
-	rebuild_batches();
+	patch_batches(merged_to_old, old_count);
+
+	PROF_COUNTER_ADD("fastpath batch full rebuilds", prof::CounterUnit::Count, full_rebuild ? 1 : 0);
+	PROF_COUNTER_ADD("fastpath batch incremental rebuilds", prof::CounterUnit::Count, full_rebuild ? 0 : 1);
+	PROF_COUNTER_ADD("fastpath draw keys resorted", prof::CounterUnit::Count, (int)added.size());
 
 	// ##############
 	// # GPU UPLOAD #
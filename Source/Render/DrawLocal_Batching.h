@@ -4,6 +4,8 @@
 #include "Render/DrawTypedefs.h"
 #include "Render/MaterialLocal.h"
 #include "Render/RenderLevelParams.h" // Render_lists_cpufast, Render_Level_Params
+#include "Render/OcclusionBuffer.h"
+#include "Render/StaticShadowCache.h"
 
 // shared GPU types
 #include "../Shaders/SharedGpuTypes.txt"
@@ -23,6 +25,7 @@ class MaterialInstance;
 class MasterMaterialImpl;
 class IGraphicsBuffer;
 struct Frustum;
+struct CullObject;
 
 // ---------------------------------------------------------------------------
 // Utility
@@ -68,6 +71,7 @@ struct ModelAndMatTData
 	int instance_alloced = 0;          // capacity, drives baseInstance layout (must be pow2 for classic)
 	int16_t ptr_ofs = 0;
 	int gpu_buf_ofs = 0;
+	bool has_draw_cmds = false; // parts are in out_cmds, set by rebuild_mod_data
 
 	// --- Compact instance path (opt-in, GPU-driven) ---------------------------
 	// When is_compact, this slot's instances are NOT discovered by the per-frame
@@ -134,8 +138,12 @@ public:
 	void build_scene_data(bool cubemap_view, bool skybox_only);
 
 	// e2e func, fixme
-	void cull_and_draw_shadow_cascade(int idx);
-	void cull_and_draw_shadow_spot(const Frustum& f);
+	void cull_and_draw_shadow_cascade(int idx, ShadowCasters casters);
+	void cull_and_draw_shadow_spot(const Frustum& f, ShadowCasters casters);
+	// fast path shadow casters of the last main view build, before any culling. Static ones are what the cached
+	// shadow layers hold (ROP_Internal::is_static_caster and static compact batches).
+	int get_num_static_casters() const { return num_static_casters; }
+	int get_num_dynamic_casters() const { return num_dynamic_casters; }
 
 	void make_shadow_object_data_threadsafe(std::span<uint8_t> vis, std::span<int> glinst,
 											std::span<gpu::DrawElementsIndirectCommand> outcmds,
@@ -147,6 +155,8 @@ public:
 		sys_print(Warning, "force rebuild models flag set\n");
 		force_rebuild = true;
 	}
+	// merged vertex/index offsets moved (ModelMan::tick_compaction), the cached commands hold the old ones
+	void on_models_relocated() { force_rebuild = true; }
 
 	int16_t get_index(Model* m, MaterialInstance* mat, bool is_compact = false) {
 		if (!m)
@@ -230,8 +240,27 @@ public:
 	int get_num_cached_cmds() { return out_cmds.size(); }
 	int get_num_cached_mod_mats() { return mod_data_ptrs.size(); }
 
+	// totals since startup, rebuild_mod_data also adds them to the profiler counters each time it runs
+	struct BatchRebuildStats
+	{
+		int full_rebuilds = 0;		   // every command re-sorted
+		int incremental_rebuilds = 0;  // only new slots sorted and merged into the kept order
+		int64_t keys_sorted = 0;	   // commands that went through the radix sort
+		int64_t boundaries_tested = 0; // batch boundaries re-tested instead of kept from the last build
+	};
+	const BatchRebuildStats& get_batch_rebuild_stats() const { return batch_stats; }
+
+	// times build_scene_data's proxy walks (instance counts, frustum test, cull object gather) on the current scene,
+	// serial and scalar against chunked on the job system and SIMD, and the frustum test through the scene tree.
+	// Fill the scene with a RenderStressTestComponent.
+	void benchmark_proxy_walk(int iterations);
+
 private:
 	bool force_rebuild = false;
+	int num_static_casters = 0;
+	int num_dynamic_casters = 0;
+	bool slots_changed = false; // slots added or removed outside the proxy scan, update out_cmds without a full re-sort
+	BatchRebuildStats batch_stats;
 	enum DoDrawFlags
 	{
 		IS_SHADOW = 1,
@@ -241,8 +270,38 @@ private:
 	};
 
 	void do_draw_shared(int flags, float polyfac);
-	void rebuild_mod_data();
-	void rebuild_batches();
+	// The proxy list walks of build_scene_data, in chunks of proxies that run as jobs when parallel. Chunks write to
+	// their own piece of the arena memory passed in, merged after.
+	// counts[slot] = proxies using that fast path slot, chunk_counts holds counts.size() ints per chunk
+	void count_instances(std::span<int> counts, int* chunk_counts, bool parallel) const;
+	// in_view[handle] = main view frustum test of draw.scene.proxy_bounds, or of draw.scene.proxy_tree when
+	// r.scene_tree_cull is set (then only visible proxies are visited)
+	void cull_proxy_bounds(uint8_t* in_view, bool parallel, bool simd) const;
+	mutable std::vector<int> tree_cull_scratch; // cull_proxy_bounds tree query output, kept for its capacity
+	// r.sw_occlusion: draws the largest opaque proxies on screen into occlusion_buffer and clears in_view[handle]
+	// for the proxies hidden behind them
+	void occlusion_cull(uint8_t* in_view, bool parallel);
+	// positions and triangles an occluder draws, empty when the model has nothing usable
+	struct OccluderMesh
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<uint16_t> indices;
+	};
+	// built from the most detailed lod under r.sw_occlusion_max_tris on first use, dropped in on_model_removed
+	const OccluderMesh& get_occluder_mesh(Model* m);
+	std::unordered_map<const Model*, OccluderMesh> occluder_meshes;
+	OcclusionBuffer occlusion_buffer;
+	// fills out with this frame's CullObjects, returns the count. in_view (optional) drops objects outside the view
+	// that don't cast shadows, casters outside it are flagged so only the shadow culls draw them. out and chunk_sizes
+	// hold one entry per proxy and per chunk.
+	int gather_cull_objects(CullObject* out, int* chunk_sizes, const uint8_t* in_view, bool cubemap_view,
+							bool parallel) const;
+	// full_rebuild re-sorts every command, otherwise only slots without commands get sorted and merged in, and
+	// commands of removed slots are dropped
+	void rebuild_mod_data(bool full_rebuild);
+	// rebuilds the pass batches after rebuild_mod_data, merged_to_old[i] is command i's index before it (-1 when new).
+	// Only boundaries next to new or dropped commands are tested again.
+	void patch_batches(std::span<const int> merged_to_old, int old_count);
 	void upload_gpu_cmds(int sum_count);
 
 	// Rebuild the dense compact-instance regions + per-batch descriptor table from
@@ -0,0 +1,164 @@
+// Shadow passes recorded into GraphicsCommandLists on the job system, see Renderer::begin_shadow_recording.
+//
+// Each CSM cascade and each spot light that redraws this frame is one task with its own list. The recording jobs only
+// read renderer/scene state that is final by the time the second gbuffer pass starts (fast path batches, cull input,
+// cascade matrices, light list), write constants through gfx().upload_buffer so the writes replay in order, and count
+// their draws in the list. Replay happens on the submission thread in the same order the passes used to be drawn, so
+// the GPU sees the same command stream with recording on or off.
+
+#include "DrawLocal.h"
+#include "Framework/ArenaAllocator.h"
+#include "Framework/Jobs.h"
+#include "Framework/Profiler.h"
+
+ConfigVar r_parallel_shadow_recording("r.parallel_shadow_recording", "1", CVAR_BOOL | CVAR_DEV,
+									  "record shadow cascades and spot shadows into command lists on worker jobs "
+									  "while the main view is issued, replayed in order afterwards");
+ConfigVar r_shadow_cache("r.shadow_cache", "1", CVAR_BOOL,
+						 "keep the depth of static shadow casters per cascade and spot light, redrawn only when the "
+						 "light or a static caster in it changes");
+ConfigVar r_shadow_cache_first_cascade("r.shadow_cache_first_cascade", "1", CVAR_INTEGER | CVAR_DEV,
+									   "cascades before this one always redraw everything, the near ones move with "
+									   "the camera too often to be worth caching",
+									   0, 4);
+
+static void record_shadow_pass_job(uintptr_t arg) {
+	CPU_SCOPE("record_shadow_pass_job");
+	auto task = (const Renderer::ShadowPassTask*)arg;
+	ASSERT(task->list != nullptr);
+	gfx_begin_recording(task->list);
+	draw.draw_shadow_pass(*task);
+	gfx_end_recording();
+}
+
+void Renderer::draw_shadow_pass(const ShadowPassTask& task) {
+	if (task.cascade >= 0)
+		shadowmap.render_cascade(task.cascade, task.use_static_layer, task.redraw_static_layer);
+	else
+		spotShadows->do_render(scene.spotLightShadowList, task.light, false, task.use_static_layer,
+							   task.redraw_static_layer);
+}
+
+void Renderer::begin_shadow_recording() {
+	CPU_SCOPE("begin_shadow_recording");
+	ASSERT(!shadow_passes_begun);
+	ASSERT(shadow_record_counter == nullptr);
+	shadow_passes_begun = true;
+	shadow_passes_recorded = false;
+
+	// casters that settled, moved or went away since last frame redraw the cached layers they touch. Before
+	// prepare_spot_shadows, static spot lights redraw when their layer was invalidated.
+	const bool use_cache = r_shadow_cache.get_bool();
+	StaticShadowCache& spot_cache = spotShadows->get_static_cache();
+	if (!use_cache || scene.static_shadow_dirty_all) {
+		shadowmap.static_cache.invalidate_all();
+		spot_cache.invalidate_all();
+	} else if (!scene.static_shadow_dirty.empty()) {
+		shadowmap.static_cache.invalidate(scene.static_shadow_dirty);
+		spot_cache.invalidate(scene.static_shadow_dirty);
+	}
+	scene.clear_static_shadow_dirty();
+
+	// spot list build uploads directly, so it stays on this thread
+	scene.prepare_spot_shadows(shadow_spot_lights);
+
+	// the layers are picked here, the recording jobs only read the tasks
+	const int num_static = BuildSceneData_CpuFast::inst->get_num_static_casters();
+	const int num_dynamic = BuildSceneData_CpuFast::inst->get_num_dynamic_casters();
+	int64_t casters_cached = 0;
+	int64_t casters_redrawn = 0;
+	int layers_cached = 0;
+	int layers_redrawn = 0;
+	auto pick_static_layer = [&](ShadowPassTask& task, bool redraw) {
+		task.use_static_layer = true;
+		task.redraw_static_layer = redraw;
+		(redraw ? layers_redrawn : layers_cached) += 1;
+		(redraw ? casters_redrawn : casters_cached) += num_static;
+		casters_redrawn += num_dynamic;
+	};
+
+	shadow_tasks.clear();
+	for (int i = 0; i < CascadeShadowMapSystem::CASCADES_USED; i++) {
+		ShadowPassTask task;
+		task.cascade = i;
+		if (use_cache && i >= r_shadow_cache_first_cascade.get_integer())
+			pick_static_layer(task, shadowmap.begin_static_layer(i));
+		else
+			casters_redrawn += num_static + num_dynamic;
+		shadow_tasks.push_back(task);
+	}
+	for (auto light : shadow_spot_lights) {
+		ShadowPassTask task;
+		task.light = light;
+		if (use_cache)
+			pick_static_layer(task, spotShadows->begin_static_layer(light));
+		else
+			casters_redrawn += num_static + num_dynamic;
+		shadow_tasks.push_back(task);
+	}
+	// fast path casters each pass starts with, before its frustum cull
+	PROF_COUNTER_ADD("shadow casters cached", prof::CounterUnit::Count, casters_cached);
+	PROF_COUNTER_ADD("shadow casters redrawn", prof::CounterUnit::Count, casters_redrawn);
+	PROF_COUNTER_ADD("shadow layers cached", prof::CounterUnit::Count, layers_cached);
+	PROF_COUNTER_ADD("shadow layers redrawn", prof::CounterUnit::Count, layers_redrawn);
+
+	if (!r_parallel_shadow_recording.get_bool() || !JobSystem::inst)
+		return;
+
+	while (shadow_cmd_lists.size() < shadow_tasks.size())
+		shadow_cmd_lists.push_back(std::make_unique<GraphicsCommandList>());
+	ArenaScope scope(mem_arena);
+	JobDecl* decls = mem_arena.alloc_bottom_type<JobDecl>(shadow_tasks.size());
+	for (int i = 0; i < (int)shadow_tasks.size(); i++) {
+		shadow_tasks[i].list = shadow_cmd_lists[i].get();
+		shadow_tasks[i].list->clear();
+		decls[i] = JobDecl();
+		decls[i].func = record_shadow_pass_job;
+		decls[i].funcarg = uintptr_t(&shadow_tasks[i]);
+	}
+	JobSystem::inst->add_jobs(decls, (int)shadow_tasks.size(), shadow_record_counter);
+	shadow_passes_recorded = true;
+}
+
+void Renderer::submit_shadow_passes() {
+	if (!shadow_passes_begun)
+		begin_shadow_recording(); // wireframe mode has no second gbuffer pass to overlap with
+	shadow_passes_begun = false;
+
+	if (shadow_record_counter) {
+		CPU_SCOPE("wait_shadow_recording");
+		JobSystem::inst->wait_and_free_counter(shadow_record_counter);
+	}
+
+	int recorded_commands = 0;
+	int recorded_bytes = 0;
+	auto submit = [&](const ShadowPassTask& task) {
+		if (!shadow_passes_recorded) {
+			draw_shadow_pass(task);
+			return;
+		}
+		gfx().execute_command_list(*task.list);
+		stats.total_draw_calls += task.list->get_num_draws();
+		recorded_commands += task.list->get_num_commands();
+		recorded_bytes += task.list->get_payload_bytes();
+	};
+	{
+		GPU_SCOPE("render_csm");
+		for (auto& task : shadow_tasks)
+			if (task.cascade >= 0)
+				submit(task);
+	}
+	{
+		RENDER_SCOPE("render_spot_shadows");
+		for (auto& task : shadow_tasks)
+			if (task.cascade < 0)
+				submit(task);
+	}
+
+	if (shadow_passes_recorded) {
+		PROF_COUNTER_ADD("shadow passes recorded", prof::CounterUnit::Count, (int64_t)shadow_tasks.size());
+		PROF_COUNTER_ADD("shadow list commands", prof::CounterUnit::Count, recorded_commands);
+		PROF_COUNTER_ADD("shadow list payload", prof::CounterUnit::Bytes, recorded_bytes);
+	}
+	shadow_passes_recorded = false;
+}
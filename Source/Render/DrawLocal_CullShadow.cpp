@@ -14,7 +14,12 @@
 #include "Framework/ArenaStd.h"
 #include "IGraphicsDevice.h"
 #include "GpuCullingTest.h"
+#include "Frustum.h"
+#include "FrustumCullSimd.h"
+#include "Framework/Jobs.h"
+#include <atomic>
 #include <bit>
+#include <chrono>
 #include <cstring>
 // -----------------------------------------------------------------------
 // BuildSceneData_CpuFast – LOD helpers, constructor, build_scene_data,
@@ -28,6 +33,41 @@ inline int next_pow2(uint32_t x) {
 	return std::bit_ceil(x);
 }
 
+ConfigVar r_fastpath_parallel("r.fastpath_parallel", "1", CVAR_BOOL | CVAR_DEV,
+							  "walk the proxy list for the fast path in chunks on the job system");
+ConfigVar r_fastpath_cpu_cull("r.fastpath_cpu_cull", "1", CVAR_BOOL | CVAR_DEV,
+							  "leave fast path objects outside the view that don't cast shadows out of the gpu cull input");
+ConfigVar r_scene_tree_cull("r.scene_tree_cull", "1", CVAR_INTEGER | CVAR_DEV,
+							 "frustum cull the fast path and bin lights through the scene's dynamic aabb trees: 0 tests "
+							 "every proxy (SIMD), 1 walks the tree, 2 walks its 4-wide SSE copy",
+							 0, 2);
+ConfigVar r_sw_occlusion("r.sw_occlusion", "1", CVAR_BOOL | CVAR_DEV,
+						  "rasterize the largest opaque fast path objects on the cpu and drop what they hide from the main view");
+ConfigVar r_sw_occlusion_width("r.sw_occlusion_width", "320", CVAR_INTEGER | CVAR_DEV,
+								"width of the cpu occlusion buffer, height follows the view's aspect", 64, 2048);
+ConfigVar r_sw_occlusion_max_occluders("r.sw_occlusion_max_occluders", "64", CVAR_INTEGER | CVAR_DEV,
+										"most objects drawn into the cpu occlusion buffer per frame", 0, 1024);
+ConfigVar r_sw_occlusion_min_size("r.sw_occlusion_min_size", "0.1", CVAR_FLOAT | CVAR_DEV,
+								  "smallest bounding radius over distance an object needs to be an occluder", 0.0, 10.0);
+ConfigVar r_sw_occlusion_max_tris("r.sw_occlusion_max_tris", "2000", CVAR_INTEGER | CVAR_DEV,
+								  "occluders use their most detailed lod with at most this many triangles", 12, 65536);
+ConfigVar r_incremental_batches("r.incremental_batches", "1", CVAR_BOOL | CVAR_DEV,
+								"merge new fast path draw commands into the sorted list instead of re-sorting all of them");
+
+// proxies per job, each chunk writes its own slice of arena memory
+static const int PROXY_CHUNK_SIZE = 2048;
+
+// fn(chunk, begin, end) for every PROXY_CHUNK_SIZE piece of [0,count), on the job system when parallel
+template <typename Fn> static void for_each_proxy_chunk(int count, bool parallel, const Fn& fn) {
+	if (parallel && count > PROXY_CHUNK_SIZE) {
+		JobSystem::inst->parallel_for_chunks(0, count, PROXY_CHUNK_SIZE,
+											 [&fn](int begin, int end) { fn(begin / PROXY_CHUNK_SIZE, begin, end); });
+	} else {
+		for (int begin = 0; begin < count; begin += PROXY_CHUNK_SIZE)
+			fn(begin / PROXY_CHUNK_SIZE, begin, std::min(begin + PROXY_CHUNK_SIZE, count));
+	}
+}
+
 BuildSceneData_CpuFast::BuildSceneData_CpuFast() {
 	ASSERT(gfx_is_initialized());
 
@@ -60,18 +100,18 @@ void BuildSceneData_CpuFast::build_scene_data(bool cubemap_view, bool skybox_onl
 
 	ArenaScope scope(arena);
 
+	const bool parallel = r_fastpath_parallel.get_bool() && JobSystem::inst;
+	const int num_proxies = (int)proxies.size();
+	const int num_chunks = (num_proxies + PROXY_CHUNK_SIZE - 1) / PROXY_CHUNK_SIZE;
+
 	// step 1.1 — count instances per fast-path slot
-	auto mmt_counts = arena.alloc_bottom_span<uint16>(mod_data_ptrs.size());
-	std::fill(mmt_counts.begin(), mmt_counts.end(), 0);
-	for (auto& [_, obj] : proxies) {
-		if (obj.fastcpu_index >= 0)
-			mmt_counts[obj.fastcpu_index] += 1;
-	}
+	auto mmt_counts = arena.alloc_bottom_span<int>(mod_data_ptrs.size());
+	count_instances(mmt_counts, arena.alloc_bottom_type<int>(num_chunks * mmt_counts.size()), parallel);
 
 	// step 1.2 — decide whether a rebuild is needed
 	const int thresh = 1;
 	bool wants_rebuild_counts = false;
-	bool needs_new_model = force_rebuild;
+	bool needs_new_model = force_rebuild || slots_changed;
 	for (int c = 0; c < (int)mmt_counts.size(); c++) {
 		const int count = mmt_counts[c];
 		auto ptr = mod_data_ptrs.at(c);
@@ -92,13 +132,15 @@ void BuildSceneData_CpuFast::build_scene_data(bool cubemap_view, bool skybox_onl
 			}
 		}
 	}
+	const bool full_rebuild = force_rebuild || !r_incremental_batches.get_bool();
 	force_rebuild = false;
+	slots_changed = false;
 
-	// step 1.3 — expensive rebuild if a new model/material combo appeared
+	// step 1.3 — rebuild if a new model/material combo appeared, only the new commands are sorted unless forced
 	if (needs_new_model) {
 		CPU_SCOPE("rebuild_model");
-		sys_print(Debug, "rebuilding fast path model data\n");
-		rebuild_mod_data();
+		sys_print(Debug, "%s fast path model data\n", full_rebuild ? "rebuilding" : "updating");
+		rebuild_mod_data(full_rebuild);
 	}
 
 	if (needs_new_model || wants_rebuild_counts) {
@@ -127,20 +169,234 @@ void BuildSceneData_CpuFast::build_scene_data(bool cubemap_view, bool skybox_onl
 		if (skybox_only)
 			return; // no opaque objects in this pass
 
-		arena_vec<CullObject> cull_obj_gpu_buf(scope);
-		cull_obj_gpu_buf.reserve(proxies.size());
+		const uint8_t* in_view = nullptr;
+		if (r_fastpath_cpu_cull.get_bool()) {
+			uint8_t* vis = arena.alloc_bottom_type<uint8_t>(draw.scene.proxy_bounds.size());
+			cull_proxy_bounds(vis, parallel, true);
+			if (r_sw_occlusion.get_bool() && !cubemap_view)
+				occlusion_cull(vis, parallel);
+			in_view = vis;
+		}
+		CullObject* cull_objs = arena.alloc_bottom_type<CullObject>(num_proxies);
+		int* chunk_sizes = arena.alloc_bottom_type<int>(num_chunks);
+		const int num_cull_objs = gather_cull_objects(cull_objs, chunk_sizes, in_view, cubemap_view, parallel);
+
+		gpu.cullobj_buf->upload(cull_objs, num_cull_objs * (int)sizeof(CullObject));
+		gpu.num_cullobjs = num_cull_objs;
+		PROF_COUNTER_ADD("fastpath cull objects", prof::CounterUnit::Count, num_cull_objs);
+
+		if (!cubemap_view) {
+			num_static_casters = num_dynamic_casters = 0;
+			for (int i = 0; i < num_cull_objs; i++) {
+				const int flags = cull_objs[i].model_ofs.w;
+				if (flags & 1)
+					((flags & 4) ? num_dynamic_casters : num_static_casters) += 1;
+			}
+		}
+	}
+
+	build_compact_data();
+	if (!cubemap_view) {
+		for (const ModelAndMatTData* ptr : mod_data_ptrs)
+			if (ptr && ptr->is_compact && ptr->compact_casts_shadow)
+				(ptr->compact_is_dynamic ? num_dynamic_casters : num_static_casters) += ptr->instance_count;
+	}
+
+	GpuCullingTest::inst->build_data(get_cull_input());
+}
+
+void BuildSceneData_CpuFast::count_instances(std::span<int> counts, int* chunk_counts, bool parallel) const {
+	CPU_SCOPE("bsd_fast_count");
+	const auto& proxies = draw.scene.proxy_list.objects;
+	const int num_proxies = (int)proxies.size();
+	const int num_slots = (int)counts.size();
+	const int num_chunks = (num_proxies + PROXY_CHUNK_SIZE - 1) / PROXY_CHUNK_SIZE;
+
+	std::fill(counts.begin(), counts.end(), 0);
+	std::fill(chunk_counts, chunk_counts + num_chunks * num_slots, 0);
+	for_each_proxy_chunk(num_proxies, parallel, [&](int chunk, int begin, int end) {
+		int* my_counts = chunk_counts + chunk * num_slots;
+		for (int i = begin; i < end; i++) {
+			const int fast_idx = proxies[i].type_.fastcpu_index;
+			if (fast_idx >= 0)
+				my_counts[fast_idx] += 1;
+		}
+	});
+	for (int chunk = 0; chunk < num_chunks; chunk++) {
+		const int* my_counts = chunk_counts + chunk * num_slots;
+		for (int slot = 0; slot < num_slots; slot++)
+			counts[slot] += my_counts[slot];
+	}
+}
+
+void BuildSceneData_CpuFast::cull_proxy_bounds(uint8_t* in_view, bool parallel, bool simd) const {
+	CPU_SCOPE("bsd_fast_frustum");
+	Frustum frustum;
+	build_a_frustum_for_perspective(frustum, draw.get_current_frame_vs());
+	const SphereBoundsSoA& bounds = draw.scene.proxy_bounds;
+
+	// the tree only visits what is in view, everything else stays 0
+	const int tree_mode = r_scene_tree_cull.get_integer();
+	if (tree_mode != 0) {
+		auto& tree = draw.scene.proxy_tree;
+		glm::vec4 planes[4];
+		get_frustum_side_planes(frustum, planes);
+		std::vector<int>& visible = tree_cull_scratch;
+		visible.clear();
+		if (tree_mode == 2) {
+			tree.build_wide();
+			tree.query_planes_wide(planes, 4, visible);
+		} else {
+			tree.query_planes(planes, 4, visible);
+		}
+		memset(in_view, 0, bounds.size());
+		for (int handle : visible)
+			in_view[handle] = 1;
+		PROF_COUNTER_ADD("scene tree visible", prof::CounterUnit::Count, (int64_t)visible.size());
+		return;
+	}
+	for_each_proxy_chunk(bounds.size(), parallel, [&](int, int begin, int end) {
+		if (simd)
+			cull_spheres_frustum_simd(frustum, bounds, begin, end, in_view);
+		else
+			cull_spheres_frustum_reference(frustum, bounds, begin, end, in_view);
+	});
+}
+
+void BuildSceneData_CpuFast::occlusion_cull(uint8_t* in_view, bool parallel) {
+	CPU_SCOPE("bsd_fast_occlusion");
+	const View_Setup& vs = draw.get_current_frame_vs();
+	const auto& proxies = draw.scene.proxy_list.objects;
+	const int num_proxies = (int)proxies.size();
+	auto& arena = draw.get_arena();
+	ArenaScope scope(arena);
+
+	// occluders: opaque, not skinned, biggest on screen first
+	struct Occluder
+	{
+		float size;
+		int index;
+	};
+	Occluder* occluders = arena.alloc_bottom_type<Occluder>(num_proxies);
+	int num_occluders = 0;
+	const float min_size = r_sw_occlusion_min_size.get_float();
+	for (int index = 0; index < num_proxies; index++) {
+		const auto& [handle, obj] = proxies[index];
+		const Render_Object& p = obj.proxy;
+		if (!in_view[handle] || obj.fastcpu_index < 0 || !p.model || !p.visible || p.is_skybox || p.viewmodel_layer ||
+			p.animator_bone_ofs >= 0 || obj.has_transparents)
+			continue;
+		if (p.mat_override && p.mat_override->impl && p.mat_override->impl->get_master_impl()->is_alphatested())
+			continue;
+		const glm::vec4& sphere = obj.bounding_sphere_and_radius;
+		const float dist = glm::length(glm::vec3(sphere) - vs.origin);
+		const float size = sphere.w / std::max(dist, vs.near);
+		if (size >= min_size)
+			occluders[num_occluders++] = {size, index};
+	}
+	const int max_occluders = r_sw_occlusion_max_occluders.get_integer();
+	if (num_occluders > max_occluders) {
+		std::nth_element(occluders, occluders + max_occluders, occluders + num_occluders,
+						 [](const Occluder& a, const Occluder& b) { return a.size > b.size; });
+		num_occluders = max_occluders;
+	}
 
-		int index = -1;
-		for (auto& [_, obj] : proxies) {
-			index += 1;
+	const int width = r_sw_occlusion_width.get_integer();
+	occlusion_buffer.init(width, std::max(1, width * vs.height / std::max(vs.width, 1)));
+	occlusion_buffer.begin(vs.viewproj, vs.near);
+	for (int i = 0; i < num_occluders; i++) {
+		const ROP_Internal& obj = proxies[occluders[i].index].type_;
+		const OccluderMesh& mesh = get_occluder_mesh(obj.proxy.model);
+		if (!mesh.indices.empty())
+			occlusion_buffer.add_triangles(mesh.positions.data(), mesh.indices.data(), (int)mesh.indices.size(),
+										   obj.proxy.transform);
+	}
+	if (occlusion_buffer.get_num_triangles() == 0)
+		return;
+	occlusion_buffer.rasterize(parallel);
+
+	// an occluder's own box is never behind what it drew, so occluders stay visible
+	const auto& tree = draw.scene.proxy_tree;
+	std::atomic<int> num_hidden = 0;
+	for_each_proxy_chunk(num_proxies, parallel, [&](int, int begin, int end) {
+		int hidden = 0;
+		for (int index = begin; index < end; index++) {
+			const auto& [handle, obj] = proxies[index];
+			if (!in_view[handle] || obj.tree_proxy < 0)
+				continue;
+			if (!occlusion_buffer.is_visible(tree.get_fat_aabb(obj.tree_proxy))) {
+				in_view[handle] = 0;
+				hidden++;
+			}
+		}
+		num_hidden += hidden;
+	});
+	PROF_COUNTER_ADD("sw occlusion triangles", prof::CounterUnit::Count, occlusion_buffer.get_num_triangles());
+	PROF_COUNTER_ADD("sw occlusion hidden", prof::CounterUnit::Count, num_hidden.load());
+}
+
+const BuildSceneData_CpuFast::OccluderMesh& BuildSceneData_CpuFast::get_occluder_mesh(Model* m) {
+	auto find = occluder_meshes.find(m);
+	if (find != occluder_meshes.end())
+		return find->second;
+	OccluderMesh& mesh = occluder_meshes[m];
+	// dynamic models get refreshed in place, the copy would go stale
+	const RawMeshData* data = m->get_raw_mesh_data();
+	if (m->is_dynamic() || data->get_num_verticies(0) == 0)
+		return mesh;
+
+	const int max_tris = r_sw_occlusion_max_tris.get_integer();
+	for (int lod_index = 0; lod_index < m->get_num_lods(); lod_index++) {
+		const MeshLod& lod = m->get_lod(lod_index);
+		int num_tris = 0;
+		for (int p = lod.part_ofs; p < lod.part_ofs + lod.part_count; p++)
+			num_tris += m->get_part(p).element_count / 3;
+		if (num_tris > max_tris)
+			continue;
+		// alpha tested and translucent parts don't hide anything
+		for (int p = lod.part_ofs; p < lod.part_ofs + lod.part_count; p++) {
+			const Submesh& part = m->get_part(p);
+			const MaterialInstance* mat = m->get_material_for_part(part);
+			if (part.is_material_transparent() || !mat || !mat->impl || !mat->impl->get_master_impl() ||
+				mat->impl->get_master_impl()->is_alphatested())
+				continue;
+			const int base = (int)mesh.positions.size();
+			if (base + part.vertex_count > UINT16_MAX)
+				break;
+			for (int v = 0; v < part.vertex_count; v++)
+				mesh.positions.push_back(data->get_vertex_at_index(part.base_vertex + v).pos);
+			const int first_index = part.element_offset / 2;
+			for (int i = 0; i < part.element_count; i++)
+				mesh.indices.push_back(uint16_t(base + data->get_index_at_index(first_index + i)));
+		}
+		break;
+	}
+	return mesh;
+}
+
+int BuildSceneData_CpuFast::gather_cull_objects(CullObject* out, int* chunk_sizes, const uint8_t* in_view,
+												 bool cubemap_view, bool parallel) const {
+	CPU_SCOPE("bsd_fast_gather");
+	const auto& proxies = draw.scene.proxy_list.objects;
+	const int num_proxies = (int)proxies.size();
+	const int num_chunks = (num_proxies + PROXY_CHUNK_SIZE - 1) / PROXY_CHUNK_SIZE;
+
+	// chunk c writes from out[c*PROXY_CHUNK_SIZE]
+	for_each_proxy_chunk(num_proxies, parallel, [&](int chunk, int begin, int end) {
+		CullObject* my_out = out + begin;
+		int count = 0;
+		for (int index = begin; index < end; index++) {
+			const auto& [handle, obj] = proxies[index];
 
 			const int fast_idx = obj.fastcpu_index;
 			const bool wants_skip = (fast_idx < 0) || (!obj.proxy.visible) || (obj.proxy.is_skybox) ||
 									(cubemap_view && obj.proxy.ignore_in_cubemap);
-
 			if (wants_skip)
 				continue;
-			ModelAndMatTData* ptr = mod_data_ptrs.at(fast_idx);
+			// shadow casters stay in, the shadow culls read the same list
+			if (in_view && !in_view[handle] && !obj.proxy.shadow_caster)
+				continue;
+			const ModelAndMatTData* ptr = mod_data_ptrs[fast_idx];
 			if (ptr->instance_alloced > 0) {
 				CullObject co;
 				co.bounds_sphere = obj.bounding_sphere_and_radius;
@@ -150,17 +406,66 @@ void BuildSceneData_CpuFast::build_scene_data(bool cubemap_view, bool skybox_onl
 				co.model_ofs = glm::ivec4(ptr->gpu_buf_ofs, index, mat_ofs, 0);
 				if (obj.proxy.shadow_caster)
 					co.model_ofs.w |= 1;
-
-				cull_obj_gpu_buf.push_back(co);
+				// moving and skinned casters are drawn over the cached static shadow layers every frame
+				if (obj.proxy.shadow_caster && !obj.is_static_caster())
+					co.model_ofs.w |= 4;
+				// outside the view or occluded, the main view cull skips it
+				if (in_view && !in_view[handle])
+					co.model_ofs.w |= 2;
+				my_out[count++] = co;
 			}
 		}
-		gpu.cullobj_buf->upload(cull_obj_gpu_buf.data(), (int)cull_obj_gpu_buf.size() * sizeof(CullObject));
-		gpu.num_cullobjs = (int)cull_obj_gpu_buf.size();
+		chunk_sizes[chunk] = count;
+	});
+
+	// merge: close the gaps between the chunk outputs, keeps proxy order
+	int total = 0;
+	for (int chunk = 0; chunk < num_chunks; chunk++) {
+		const int begin = chunk * PROXY_CHUNK_SIZE;
+		if (total != begin && chunk_sizes[chunk] > 0)
+			memmove(out + total, out + begin, chunk_sizes[chunk] * sizeof(CullObject));
+		total += chunk_sizes[chunk];
 	}
+	return total;
+}
 
-	build_compact_data();
+void BuildSceneData_CpuFast::benchmark_proxy_walk(int iterations) {
+	using clock = std::chrono::high_resolution_clock;
+	auto& arena = draw.get_arena();
+	ArenaScope scope(arena);
 
-	GpuCullingTest::inst->build_data(get_cull_input());
+	const int num_proxies = (int)draw.scene.proxy_list.objects.size();
+	const int num_chunks = (num_proxies + PROXY_CHUNK_SIZE - 1) / PROXY_CHUNK_SIZE;
+	auto counts = arena.alloc_bottom_span<int>(mod_data_ptrs.size());
+	int* chunk_counts = arena.alloc_bottom_type<int>(num_chunks * counts.size());
+	uint8_t* in_view = arena.alloc_bottom_type<uint8_t>(draw.scene.proxy_bounds.size());
+	CullObject* cull_objs = arena.alloc_bottom_type<CullObject>(num_proxies);
+	int* chunk_sizes = arena.alloc_bottom_type<int>(num_chunks);
+
+	int num_cull_objs = 0;
+	auto time_ms = [&](bool parallel, bool simd) {
+		auto start = clock::now();
+		for (int i = 0; i < iterations; i++) {
+			count_instances(counts, chunk_counts, parallel);
+			cull_proxy_bounds(in_view, parallel, simd);
+			num_cull_objs = gather_cull_objects(cull_objs, chunk_sizes, in_view, false, parallel);
+		}
+		return std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+	};
+	// the brute force variants are the reference, the tree ones run with whatever r.scene_tree_cull is set to
+	const int tree_mode = r_scene_tree_cull.get_integer();
+	r_scene_tree_cull.set_integer(0);
+	const double serial = time_ms(false, false);
+	const double parallel = JobSystem::inst ? time_ms(true, true) : time_ms(false, true);
+	r_scene_tree_cull.set_integer(tree_mode != 0 ? tree_mode : 1);
+	const double tree = time_ms(JobSystem::inst != nullptr, true);
+	r_scene_tree_cull.set_integer(tree_mode);
+	sys_print(Info, "bench_fastpath_cull: %d proxies, %d cull objects: serial scalar %.3f ms, %s simd %.3f ms (%.2fx)\n",
+			  num_proxies, num_cull_objs, serial, JobSystem::inst ? "parallel" : "serial", parallel,
+			  parallel > 0.0 ? serial / parallel : 0.0);
+	sys_print(Info, "bench_fastpath_cull: scene tree (%s) %.3f ms, %d leaves, height %d\n",
+			  tree_mode == 2 ? "wide" : "binary", tree, draw.scene.proxy_tree.get_num_leaves(),
+			  draw.scene.proxy_tree.get_height());
 }
 
 // ---------------------------------------------------------------------------
@@ -199,6 +504,9 @@ void BuildSceneData_CpuFast::build_compact_data() {
 		compact_static_dirty = true;
 	}
 
+	// static instances are drawn into the cached shadow layers
+	if (compact_static_dirty)
+		draw.scene.invalidate_static_shadows();
 	const bool rebuild_static = compact_static_dirty && static_count > 0;
 	if (rebuild_static)
 		compact_static_dense.clear();
@@ -216,6 +524,8 @@ void BuildSceneData_CpuFast::build_compact_data() {
 		d.model_ofs = ptr->gpu_buf_ofs;
 		d.mat_ofs = -1; // per-part material already baked into model_info for this slot
 		d.flags = ptr->compact_casts_shadow ? COMPACT_FLAG_SHADOW_CASTER : 0;
+		if (ptr->compact_is_dynamic)
+			d.flags |= COMPACT_FLAG_DYNAMIC_CASTER;
 		descs[i] = d;
 
 		const int live = ptr->instance_count;
@@ -292,10 +602,10 @@ int16_t BuildSceneData_CpuFast::register_compact_batch(Model* m, MaterialInstanc
 	ptr->local_bounds_center = glm::vec3(sphere);
 	ptr->local_bounds_radius = sphere.w;
 
-	// Trigger the baseInstance-layout + mod_data rebuild so this slot's draw
+	// Trigger the baseInstance-layout + mod_data update so this slot's draw
 	// commands get correct baseInstance ranges. Same path the classic scan would
 	// eventually trigger; invoked directly instead of waiting for mmt_counts.
-	force_rebuild = true;
+	slots_changed = true;
 	// Registration can add/remove a batch to/from the static set (including a
 	// static<->dynamic switch on re-register), which shifts the static region -- so
 	// always re-send it once. Cheap: registration is rare.
@@ -314,7 +624,7 @@ void BuildSceneData_CpuFast::resize_compact_batch(int16_t batch_id, int new_capa
 	ptr->compact_staging.resize((size_t)new_capacity);
 	if (ptr->instance_count > new_capacity)
 		ptr->instance_count = new_capacity;
-	force_rebuild = true;
+	slots_changed = true;
 	compact_static_dirty = true; // may shift the static region layout
 }
 
@@ -325,7 +635,11 @@ void BuildSceneData_CpuFast::set_compact_casts_shadow(int16_t batch_id, bool cas
 		return;
 	// CompactBatchDesc.flags is rebuilt from this every frame in build_compact_data,
 	// so no dirty flag to set here -- next frame's descriptor upload picks it up.
-	mod_data_ptrs.at(batch_id)->compact_casts_shadow = casts_shadow;
+	// The cached shadow layers hold the static batches though.
+	ModelAndMatTData* ptr = mod_data_ptrs.at(batch_id);
+	if (!ptr->compact_is_dynamic && ptr->compact_casts_shadow != casts_shadow)
+		draw.scene.invalidate_static_shadows();
+	ptr->compact_casts_shadow = casts_shadow;
 }
 
 void BuildSceneData_CpuFast::set_instance_count(int16_t batch_id, int live_count) {
@@ -360,31 +674,31 @@ void BuildSceneData_CpuFast::set_instance(int16_t batch_id, int index, const gpu
 }
 
 // Free function wrappers used by the shadow system.
-void cull_and_draw_cascade_fucker(int idx) {
+void cull_and_draw_cascade_fucker(int idx, ShadowCasters casters) {
 	ASSERT(BuildSceneData_CpuFast::inst != nullptr);
-	BuildSceneData_CpuFast::inst->cull_and_draw_shadow_cascade(idx);
+	BuildSceneData_CpuFast::inst->cull_and_draw_shadow_cascade(idx, casters);
 }
-void cull_and_draw_spot(Frustum f) {
+void cull_and_draw_spot(Frustum f, ShadowCasters casters) {
 	ASSERT(BuildSceneData_CpuFast::inst != nullptr);
-	BuildSceneData_CpuFast::inst->cull_and_draw_shadow_spot(f);
+	BuildSceneData_CpuFast::inst->cull_and_draw_shadow_spot(f, casters);
 }
 
 extern void build_frustum_for_cascade(Frustum& f, int index);
 
-void BuildSceneData_CpuFast::cull_and_draw_shadow_cascade(int idx) {
+void BuildSceneData_CpuFast::cull_and_draw_shadow_cascade(int idx, ShadowCasters casters) {
 	ASSERT(idx >= 0);
 
 	Frustum f;
 	build_frustum_for_cascade(f, idx);
 	ASSERT(f.is_ortho);
-	GpuCullingTest::inst->do_shadow_cull(get_cull_input_shadow(), f);
+	GpuCullingTest::inst->do_shadow_cull(get_cull_input_shadow(), f, casters);
 	do_shadow_draw(1.0, true);
 }
 
-void BuildSceneData_CpuFast::cull_and_draw_shadow_spot(const Frustum& f) {
+void BuildSceneData_CpuFast::cull_and_draw_shadow_spot(const Frustum& f, ShadowCasters casters) {
 	ASSERT(GpuCullingTest::inst != nullptr);
 
-	GpuCullingTest::inst->do_shadow_cull(get_cull_input_shadow(), f);
+	GpuCullingTest::inst->do_shadow_cull(get_cull_input_shadow(), f, casters);
 	do_shadow_draw(-3, false);
 }
 
@@ -475,9 +789,9 @@ void BuildSceneData_CpuFast::on_fastpath_material_removed(MaterialInstance* mat)
 		mod_data.erase(found_key.value());
 		invalidate_these(fast_index);
 		// Stale out_cmds/batches built before this removal still reference the
-		// now-null slot; force rebuild_mod_data() before the next draw or
+		// now-null slot; rebuild_mod_data() must drop them before the next draw or
 		// do_draw_shared derefs the null ModelAndMatTData*.
-		force_rebuild = true;
+		slots_changed = true;
 	} else {
 		sys_print(Warning, "on_fastpath_material_removed: couldn't find material???\n");
 	}
@@ -485,6 +799,7 @@ void BuildSceneData_CpuFast::on_fastpath_material_removed(MaterialInstance* mat)
 
 void BuildSceneData_CpuFast::on_model_removed(Model* m) {
 	ASSERT(m != nullptr);
+	occluder_meshes.erase(m);
 
 	// Collect all fast-path cache entries keyed on this model (one per material combo).
 	std::vector<int> removed_indices;
@@ -503,12 +818,13 @@ void BuildSceneData_CpuFast::on_model_removed(Model* m) {
 
 	for (int idx : removed_indices)
 		mod_data_ptrs.at(idx) = nullptr;
+	draw.scene.invalidate_static_shadows();
 	for (const auto& key : keys_to_erase)
 		mod_data.erase(key);
 	// Stale out_cmds/batches built before this removal still reference the
-	// now-null slot(s); force rebuild_mod_data() before the next draw or
+	// now-null slot(s); rebuild_mod_data() must drop them before the next draw or
 	// do_draw_shared derefs a null ModelAndMatTData*.
-	force_rebuild = true;
+	slots_changed = true;
 
 	// Invalidate all proxy objects that referenced this model.
 	// Set fastcpu_index to -1 (not in fast path) and clear proxy.model rather
@@ -126,7 +126,7 @@ void DebuggingTextureOutput::draw_out() {
 	mb.Begin();
 	mb.Push2dQuad(glm::vec2(0, 0), glm::vec2(w * scale, h * scale), upper_left, size, {});
 	mb.End();
-	dd.init_from(mb);
+	dd.init_transient(mb, draw.get_transient_meshes());
 
 	// Re-bind pipeline with dd's vao so the draw consumes MeshBuilder geometry.
 	state.vao = dd.vao;
@@ -140,6 +140,7 @@ public:
 
 private:
 	std::vector<int> counts;
+	std::vector<int> tree_query_scratch; // light_tree query output
 	IGraphicsBuffer* tiled_uniforms = nullptr;
 	IGraphicsBuffer* light_count_buffer = nullptr;
 	IGraphicsBuffer* light_indirection = nullptr;
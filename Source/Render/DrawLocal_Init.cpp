@@ -152,7 +152,7 @@ void Renderer::upload_ubo_view_constants(const View_Setup& view_to_use, IGraphic
 	constants.editor_grid_snap = get_editor_grid_snap();
 
 	ASSERT(ubo != nullptr);
-	ubo->sub_upload(&constants, sizeof(gpu::Ubo_View_Constants_Struct), 0);
+	gfx().sub_upload_buffer(ubo, &constants, sizeof(gpu::Ubo_View_Constants_Struct), 0);
 }
 
 Renderer::Renderer() {}
@@ -175,6 +175,11 @@ void imgui_stat_hook() {
 	ImGui::Text("opaque batches: %d", (int)cf->get_num_opaque_batches());
 	ImGui::Text("cached model cmds: %d", (int)cf->get_num_cached_cmds());
 	ImGui::Text("cached model/mats: %d", (int)cf->get_num_cached_mod_mats());
+	{
+		auto& rs = cf->get_batch_rebuild_stats();
+		ImGui::Text("batch rebuilds: %d full, %d incremental", rs.full_rebuilds, rs.incremental_rebuilds);
+		ImGui::Text("draw keys resorted: %lld", (long long)rs.keys_sorted);
+	}
 	ImGui::Text("transparent batches: %d", (int)scene.transparent_pass.batches.size());
 
 	ImGui::Separator();
@@ -182,6 +187,9 @@ void imgui_stat_hook() {
 	ImGui::Text("total lights: %d", (int)scene.light_list.objects.size());
 	ImGui::Text("total decals: %d", (int)scene.decal_list.objects.size());
 	ImGui::Text("total meshbuilders: %d", (int)scene.meshbuilder_objs.objects.size());
+	ImGui::Text("proxy tree: %d leaves, height %d, area ratio %.2f", scene.proxy_tree.get_num_leaves(),
+				scene.proxy_tree.get_height(), scene.proxy_tree.get_area_ratio());
+	ImGui::Text("light tree: %d leaves, height %d", scene.light_tree.get_num_leaves(), scene.light_tree.get_height());
 	ImGui::Separator();
 }
 
@@ -267,6 +275,8 @@ void Renderer::init() {
 
 	print_time("draw:device");
 
+	transient_meshes.init();
+
 	// Check hardware settings like extension availibility
 	check_hardware_options();
 
@@ -377,6 +387,10 @@ void Renderer::init() {
 	// FIXME
 	consoleCommands = ConsoleCmdGroup::create("");
 	consoleCommands->add("print_gfx_mem", [](const Cmd_Args&) { sys_print(Info, "%d\n", total_gfx_mem_usage); });
+	consoleCommands->add("bench_fastpath_cull", [](const Cmd_Args& args) {
+		const int iterations = args.size() >= 2 ? std::max(std::atoi(args.at(1)), 1) : 100;
+		BuildSceneData_CpuFast::inst->benchmark_proxy_walk(iterations);
+	});
 	consoleCommands->add("cot", [this](const Cmd_Args& args) { debug_tex_out.output_tex = nullptr; });
 	consoleCommands->add("ot", [this](const Cmd_Args& args) {
 		static const char* usage_str = "Usage: ot <scale:float> <alpha:float> <mip/slice:float> <texture_name>\n";
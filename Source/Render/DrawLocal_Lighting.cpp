@@ -20,6 +20,8 @@
 #include "RenderGiManager.h"
 #include "GpuCullingTest.h"
 #include "Framework/ArenaStd.h"
+#include "Frustum.h"
+#include "FrustumCullSimd.h"
 #include <algorithm>
 void Renderer::draw_meshbuilders() {
 	if (r_no_meshbuilders.get_bool())
@@ -164,6 +166,7 @@ LightListCuller::LightListCuller() {
 	tiled_uniforms = create_buffer();
 }
 ConfigVar r_light_use_tiled("r.light_use_tiled", "2", CVAR_INTEGER, "", 0, 2);
+extern ConfigVar r_scene_tree_cull;
 
 void LightListCuller::draw_lights() {
 	GPU_FUNCTION();
@@ -267,6 +270,29 @@ void LightListCuller::cull(const View_Setup& setup) {
 	int* light_index_buffer = memArena.alloc_bottom_type<int>(total_tiles * max_lights_in_tile);
 	int* tile_light_count = memArena.alloc_bottom_type<int>(total_tiles);
 
+	// lights touching the view, as indices into light_list.objects. the tree narrows it down to what the camera can
+	// see, sorted so tiles still list lights in the same order as the brute force walk.
+	auto& scene_lights = draw.scene.light_list.objects;
+	const int num_scene_lights = (int)scene_lights.size();
+	int* candidates = memArena.alloc_bottom_type<int>(num_scene_lights);
+	int num_candidates = 0;
+	if (r_scene_tree_cull.get_integer() != 0) {
+		Frustum frustum;
+		build_a_frustum_for_perspective(frustum, setup);
+		glm::vec4 planes[4];
+		get_frustum_side_planes(frustum, planes);
+		std::vector<int>& visible = tree_query_scratch;
+		visible.clear();
+		draw.scene.light_tree.query_planes(planes, 4, visible);
+		for (int handle : visible)
+			candidates[num_candidates++] = draw.scene.light_list.handle_to_obj[handle];
+		std::sort(candidates, candidates + num_candidates);
+	} else {
+		for (int i = 0; i < num_scene_lights; i++)
+			candidates[num_candidates++] = i;
+	}
+	PROF_COUNTER_ADD("light bin candidates", prof::CounterUnit::Count, (int64_t)num_candidates);
+
 	auto cull_volume = [&](int index_x, int index_y) {
 		const int my_tile_index = index_y * light_frustum_size_x + index_x;
 		const int my_light_index_index = my_tile_index * max_lights_in_tile;
@@ -275,11 +301,9 @@ void LightListCuller::cull(const View_Setup& setup) {
 		auto furstum_planes = get_tile_frustum_planes(setup.origin, forward, right, up, setup.fov, aspect, setup.width,
 													  setup.height, index_x, index_y, tile_size_x, tile_size_y);
 
-		auto& scene_lights = draw.scene.light_list.objects;
-		int light_index = -1;
-		for (auto& light_type : scene_lights) {
-			light_index += 1;
-			RL_Internal& light = light_type.type_;
+		for (int c = 0; c < num_candidates; c++) {
+			const int light_index = candidates[c];
+			RL_Internal& light = scene_lights[light_index].type_;
 			glm::vec4 sphere(light.light.position, light.light.radius);
 			const bool in_frustum = cull_sphere_by_frustum(furstum_planes, sphere);
 			if (in_frustum) {
@@ -367,7 +367,7 @@ void Renderer::execute_render_lists(Render_Lists& list, Render_Pass& pass, bool
 					list.gpu_command_list, offset_buffer_start + offset * DEIcmdSz,
 					count, sizeof(gpu::DrawElementsIndirectCommand));
 			}
-			stats.total_draw_calls++;
+			count_draw_call();
 		}
 		offset += incr;
 	}
@@ -392,7 +392,7 @@ void Renderer::render_lists_old_way(Render_Lists& list, Render_Pass& pass, bool
 				cmd.firstIndex * MODEL_BUFFER_INDEX_TYPE_SIZE,
 				cmd.primCount, cmd.baseVertex, cmd.baseInstance);
 
-			stats.total_draw_calls++;
+			count_draw_call();
 		}
 
 		offset += count;
@@ -500,8 +500,7 @@ void Renderer::render_particles() {
 			bind_texture_ptr(i, gfx_tex);
 		}
 
-		gfx().draw_elements(GraphicsPrimitiveType::Triangles, p.dd.num_indicies,
-							VertexInputIndexType::uint32, 0);
+		p.dd.draw(MeshBuilderDD::TRIANGLES);
 	}
 }
 
@@ -195,26 +195,20 @@ ConfigVar r_dont_use_camera_depth_build_scene("r.dont_use_camera_depth_build_sce
 ConfigVar r_skip_depth_prepass("r.skip_depth_prepass", "0", CVAR_BOOL | CVAR_DEV, "");
 ConfigVar r_depth_prepass_all_objects("r.depth_prepass_all_objects", "0", CVAR_BOOL | CVAR_DEV, "");
 ConfigVar r_skip_add_to_passes("r.skip_add_to_passes", "0", CVAR_BOOL | CVAR_DEV, "");
+ConfigVar r_shadow_cache_settle_frames("r.shadow_cache_settle_frames", "30", CVAR_INTEGER | CVAR_DEV,
+									   "frames a caster stays still before it's drawn into the cached shadow layers",
+									   1, 1000);
 
-void Render_Scene::update_spotlight_data() {
-	RENDER_SCOPE("update_spotlight_data");
+void Render_Scene::prepare_spot_shadows(std::vector<handle<Render_Light>>& lights) {
+	CPU_SCOPE("prepare_spot_shadows");
 
-	std::vector<handle<Render_Light>> lightsToCalcShadow;
-	draw.spotShadows->get_lights_to_render(lightsToCalcShadow);
-	draw.stats.shadow_lights += lightsToCalcShadow.size();
-	// tbh just do it here whatev
+	lights.clear();
+	draw.spotShadows->get_lights_to_render(lights);
+	draw.stats.shadow_lights += lights.size();
 
-	const int visible_count = draw.scene.proxy_list.objects.size();
-	auto& memArena = draw.get_arena();
-	if (!lightsToCalcShadow.empty()) {
-		// parallelize this
-
-		for (int i = 0; i < lightsToCalcShadow.size(); i++) {
-			bool any_dynamic_found = false;
-			build_cascade_cpu(spotLightShadowList, draw.scene.shadow_pass, draw.scene.proxy_list, nullptr);
-			draw.spotShadows->do_render(spotLightShadowList, lightsToCalcShadow[i], any_dynamic_found);
-		}
-	}
+	// visibility isn't used for spot lights yet, so every light draws the same list and it's built once
+	if (!lights.empty())
+		build_cascade_cpu(spotLightShadowList, draw.scene.shadow_pass, draw.scene.proxy_list, nullptr);
 }
 
 void Render_Scene::sync_gpu_object_transforms() {
@@ -296,6 +290,9 @@ void Render_Scene::build_scene_data(bool skybox_only, bool build_for_editor, boo
 	if (add_to_passes)
 		set_gpu_objects_data_job(uintptr_t(gpu_objects));
 
+	// before the fast path flags its dynamic casters
+	if (!cubemap_view && !skybox_only)
+		update_shadow_casters(r_shadow_cache_settle_frames.get_integer());
 	BuildSceneData_CpuFast::inst->build_scene_data(cubemap_view, skybox_only);
 
 	auto add_objects_to_passes = [&]() {
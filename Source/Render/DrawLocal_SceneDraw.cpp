@@ -108,6 +108,7 @@ void Renderer::sync_update() {
 
 	scene.execute_deferred_deletes();
 	g_modelMgr.execute_deferred_model_frees();
+	g_modelMgr.tick_compaction();
 
 	update_debug_grid(); // makes it visible/hidden
 
@@ -119,7 +120,7 @@ void Renderer::sync_update() {
 	}
 	for (auto& po_ : scene.particle_objs.objects) {
 		auto& po = po_.type_;
-		po.dd.init_from(*po.obj.meshbuilder);
+		po.dd.init_transient(*po.obj.meshbuilder, transient_meshes);
 	}
 
 	// For TAA, double buffer bones
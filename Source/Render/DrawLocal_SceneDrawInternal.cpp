@@ -250,17 +250,18 @@ void Renderer::scene_draw_internal(SceneDrawParamsEx params, View_Setup view) {
 		if (r_debug_mode.get_integer() == gpu::DEBUG_OVERDRAW) {
 			gbuffer_pass(GPRF_OVERDRAWVIS);
 		}
-		if (!params.skybox_only)
+		if (!params.skybox_only) {
 			GpuCullingTest::inst->build_data_2(BuildSceneData_CpuFast::inst->get_cull_input());
+			// shadow passes record on the job system while the second gbuffer pass is issued
+			begin_shadow_recording();
+		}
 		if (r_debug_mode.get_integer() != gpu::DEBUG_OVERDRAW) {
 			GPU_SCOPE("gbuffer_pass_2");
 			gbuffer_pass(GPRF_GBUFFER_2); // second gbuffer pass
 		}
 	}
 	if (!params.skybox_only) {
-		shadowmap.render_cascades();
-
-		scene.update_spotlight_data();
+		submit_shadow_passes();
 	}
 	// device.reset_states();
 
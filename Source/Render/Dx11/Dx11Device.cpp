@@ -394,6 +394,7 @@ public:
 		BOOL data = FALSE;
 		while (context->GetData(query.Get(), &data, sizeof(data), 0) != S_OK) {}
 	}
+	IGraphicsFence* insert_fence() override;
 
 	// ---- Binds (D3) -----------------------------------------------------------
 	void bind_texture(int slot, IGraphicsTexture* tex) override {
@@ -531,6 +532,19 @@ public:
 		box.front = 0; box.back = 1;
 		context->CopySubresourceRegion(d->resource.Get(), dst_sub, 0, 0, 0, s->resource.Get(), src_sub, &box);
 	}
+	void copy_texture_rect(const GraphicsBlitInfo& info) override {
+		ASSERT(info.src.texture && info.dest.texture);
+		Dx11Texture* s = (Dx11Texture*)info.src.texture;
+		Dx11Texture* d = (Dx11Texture*)info.dest.texture;
+		UINT src_sub = D3D11CalcSubresource(info.src.mip, std::max(info.src.layer, 0), s->mips);
+		UINT dst_sub = D3D11CalcSubresource(info.dest.mip, std::max(info.dest.layer, 0), d->mips);
+		D3D11_BOX box{};
+		box.left = (UINT)info.src.x; box.right = (UINT)(info.src.x + info.src.w);
+		box.top = (UINT)info.src.y; box.bottom = (UINT)(info.src.y + info.src.h);
+		box.front = 0; box.back = 1;
+		context->CopySubresourceRegion(d->resource.Get(), dst_sub, (UINT)info.dest.x, (UINT)info.dest.y, 0,
+									   s->resource.Get(), src_sub, &box);
+	}
 
 	// ---- Debug groups + timer queries (D5) -----------------------------------------
 	void push_debug_group(const char* name) override {
@@ -646,6 +660,42 @@ IGraphicsTimerQuery* Dx11DeviceImpl::create_timer_query() {
 	return new Dx11TimerQueryImpl();
 }
 
+// D3D11_QUERY_EVENT, same wait as wait_for_gpu_idle but issued once and polled later.
+class Dx11FenceImpl : public IGraphicsFence
+{
+public:
+	Dx11FenceImpl() {
+		D3D11_QUERY_DESC desc{};
+		desc.Query = D3D11_QUERY_EVENT;
+		HRESULT hr = g_dx11_device->CreateQuery(&desc, query.GetAddressOf());
+		ASSERT(SUCCEEDED(hr) && "Dx11: CreateQuery(EVENT) failed");
+		g_dx11_context->End(query.Get());
+	}
+	void release() override { delete this; }
+
+	bool is_signaled() override {
+		if (!signaled) {
+			BOOL data = FALSE;
+			signaled = g_dx11_context->GetData(query.Get(), &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+		}
+		return signaled;
+	}
+
+	void wait() override {
+		BOOL data = FALSE;
+		while (!signaled && g_dx11_context->GetData(query.Get(), &data, sizeof(data), 0) != S_OK) {}
+		signaled = true;
+	}
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Query> query;
+	bool signaled = false;
+};
+
+IGraphicsFence* Dx11DeviceImpl::insert_fence() {
+	return new Dx11FenceImpl();
+}
+
 #undef DX11_STUB
 
 } // namespace
@@ -238,7 +238,7 @@ void BRDFIntegration::run() {
 	mb.Begin();
 	mb.Push2dQuad(vec2(-1, 1), vec2(2, -2));
 	mb.End();
-	dd.init_from(mb);
+	dd.init_transient(mb, draw.get_transient_meshes());
 
 	RenderPassState pass;
 	ColorTargetInfo color(lut_tex);
@@ -0,0 +1,98 @@
+#include "FrustumCullSimd.h"
+#include "Frustum.h"
+#include <immintrin.h>
+#include <cfloat>
+
+void SphereBoundsSoA::set(int index, const glm::vec4& sphere_and_radius) {
+	if (index >= size()) {
+		x.resize(index + 1, 0.f);
+		y.resize(index + 1, 0.f);
+		z.resize(index + 1, 0.f);
+		r.resize(index + 1, -FLT_MAX);
+	}
+	x[index] = sphere_and_radius.x;
+	y[index] = sphere_and_radius.y;
+	z[index] = sphere_and_radius.z;
+	r[index] = sphere_and_radius.w;
+}
+
+void SphereBoundsSoA::clear(int index) {
+	// d >= FLT_MAX never holds for a finite plane distance
+	set(index, glm::vec4(0.f, 0.f, 0.f, -FLT_MAX));
+}
+
+void get_frustum_side_planes(const Frustum& f, glm::vec4* planes) {
+	planes[0] = f.top_plane;
+	planes[1] = f.bot_plane;
+	planes[2] = f.left_plane;
+	planes[3] = f.right_plane;
+}
+
+void cull_spheres_frustum_reference(const Frustum& frustum, const SphereBoundsSoA& bounds, int begin, int end,
+									uint8_t* out) {
+	glm::vec4 planes[4];
+	get_frustum_side_planes(frustum, planes);
+	for (int i = begin; i < end; i++) {
+		const glm::vec3 center(bounds.x[i], bounds.y[i], bounds.z[i]);
+		bool inside = true;
+		for (int p = 0; p < 4; p++)
+			inside &= glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -bounds.r[i];
+		out[i] = inside ? 1 : 0;
+	}
+}
+
+// same vfloat split as PoseSimd.cpp: 8 wide in AVX builds, 4 wide otherwise
+#ifdef __AVX__
+typedef __m256 vfloat;
+static const int LANES = 8;
+static inline vfloat v_set1(float f) { return _mm256_set1_ps(f); }
+static inline vfloat v_load(const float* p) { return _mm256_loadu_ps(p); }
+static inline vfloat v_add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat v_mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat v_neg(vfloat a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.f)); }
+static inline vfloat v_and(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+static inline vfloat v_cmpge(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline int v_movemask(vfloat a) { return _mm256_movemask_ps(a); }
+#else
+typedef __m128 vfloat;
+static const int LANES = 4;
+static inline vfloat v_set1(float f) { return _mm_set1_ps(f); }
+static inline vfloat v_load(const float* p) { return _mm_loadu_ps(p); }
+static inline vfloat v_add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat v_mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat v_neg(vfloat a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+static inline vfloat v_and(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+static inline vfloat v_cmpge(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+static inline int v_movemask(vfloat a) { return _mm_movemask_ps(a); }
+#endif
+
+void cull_spheres_frustum_simd(const Frustum& frustum, const SphereBoundsSoA& bounds, int begin, int end,
+							   uint8_t* out) {
+	glm::vec4 planes[4];
+	get_frustum_side_planes(frustum, planes);
+	vfloat px[4], py[4], pz[4], pw[4];
+	for (int p = 0; p < 4; p++) {
+		px[p] = v_set1(planes[p].x);
+		py[p] = v_set1(planes[p].y);
+		pz[p] = v_set1(planes[p].z);
+		pw[p] = v_set1(planes[p].w);
+	}
+
+	int i = begin;
+	for (; i + LANES <= end; i += LANES) {
+		const vfloat x = v_load(bounds.x.data() + i);
+		const vfloat y = v_load(bounds.y.data() + i);
+		const vfloat z = v_load(bounds.z.data() + i);
+		const vfloat neg_r = v_neg(v_load(bounds.r.data() + i));
+		vfloat inside = v_cmpge(v_set1(0.f), v_set1(0.f)); // all ones
+		for (int p = 0; p < 4; p++) {
+			// summed in the same order as the reference's glm::dot
+			const vfloat d = v_add(v_add(v_add(v_mul(px[p], x), v_mul(py[p], y)), v_mul(pz[p], z)), pw[p]);
+			inside = v_and(inside, v_cmpge(d, neg_r));
+		}
+		const int mask = v_movemask(inside);
+		for (int lane = 0; lane < LANES; lane++)
+			out[i + lane] = (mask >> lane) & 1;
+	}
+	cull_spheres_frustum_reference(frustum, bounds, i, end, out);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+
+struct Frustum;
+
+// Bounding spheres as separate x/y/z/radius arrays, so the frustum test loads 8 spheres per register (AVX builds,
+// 4 with SSE) instead of gathering them out of ROP_Internal. Render_Scene keeps one indexed by proxy handle id,
+// updated from register_obj/update_obj/remove_obj. Unused slots get a radius that never passes the test.
+struct SphereBoundsSoA
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> r;
+
+	int size() const { return (int)x.size(); }
+	void set(int index, const glm::vec4& sphere_and_radius);
+	void clear(int index);
+};
+
+// top, bottom, left, right: the planes the fast path culls against, also used for the scene tree queries
+void get_frustum_side_planes(const Frustum& frustum, glm::vec4* planes);
+
+// out[i] = 1 for spheres in [begin,end) that touch the inside of all 4 side planes, else 0. Same test as
+// cull_objects(), no near/far plane. The _reference version is the scalar loop the test checks against.
+void cull_spheres_frustum_simd(const Frustum& frustum, const SphereBoundsSoA& bounds, int begin, int end,
+							   uint8_t* out);
+void cull_spheres_frustum_reference(const Frustum& frustum, const SphereBoundsSoA& bounds, int begin, int end,
+									uint8_t* out);
@@ -1,16 +1,34 @@
 #include "GpuAllocator.h"
 #include <algorithm>
+#include <bit>
 #include "Framework/Util.h"
 void gpuSpanAllocator::init_clear(int bytes) {
 	if (initialized_size != 0) {
 		sys_print(Warning, "gpuSpanAllocator free spans being cleared...\n");
 	}
-	gpuAllocSpan main_;
-	main_.start = 0;
-	main_.size = bytes;
-	freeSpans.clear();
-	freeSpans.push_back({main_});
+	blocks.clear();
+	unused_blocks.clear();
+	fl_bitmap = 0;
+	for (int i = 0; i < FL_COUNT; i++) {
+		sl_bitmap[i] = 0;
+		for (int j = 0; j < SL_COUNT; j++)
+			free_heads[i][j] = -1;
+	}
+	used_bytes = 0;
+	num_used = 0;
+	num_free = 0;
+	last_block = -1;
 	this->initialized_size = bytes;
+	if (bytes <= 0)
+		return;
+
+	// block 0 always starts at 0, it can only grow by merging, allocate_below() walks from it
+	const int b = new_block();
+	ASSERT(b == 0);
+	blocks[b].start = 0;
+	blocks[b].size = bytes;
+	last_block = b;
+	insert_free(b);
 }
 
 static inline size_t round_up(size_t size, size_t align) {
@@ -26,59 +44,204 @@ static inline size_t normalize_alloc_size(size_t size) {
 	return round_up(size, PAGE);
 }
 
+// first level is the power of two, second level splits it linearly. small sizes share fl 0.
+void gpuSpanAllocator::mapping(int size, int& fl, int& sl) {
+	if (size < SL_COUNT) {
+		fl = 0;
+		sl = size;
+		return;
+	}
+	const int f = std::bit_width((uint32_t)size) - 1;
+	sl = (size >> (f - SL_LOG2)) - SL_COUNT;
+	fl = f - SL_LOG2 + 1;
+}
+
+int gpuSpanAllocator::new_block() {
+	if (!unused_blocks.empty()) {
+		const int b = unused_blocks.back();
+		unused_blocks.pop_back();
+		blocks[b] = Block();
+		return b;
+	}
+	blocks.push_back(Block());
+	return (int)blocks.size() - 1;
+}
+
+void gpuSpanAllocator::release_block(int b) {
+	blocks[b] = Block();
+	unused_blocks.push_back(b);
+}
+
+void gpuSpanAllocator::insert_free(int b) {
+	int fl{}, sl{};
+	mapping(blocks[b].size, fl, sl);
+	Block& blk = blocks[b];
+	blk.is_free = true;
+	blk.prev_free = -1;
+	blk.next_free = free_heads[fl][sl];
+	if (blk.next_free != -1)
+		blocks[blk.next_free].prev_free = b;
+	free_heads[fl][sl] = b;
+	fl_bitmap |= 1u << fl;
+	sl_bitmap[fl] |= 1u << sl;
+	num_free++;
+}
+
+void gpuSpanAllocator::remove_free(int b) {
+	int fl{}, sl{};
+	mapping(blocks[b].size, fl, sl);
+	Block& blk = blocks[b];
+	ASSERT(blk.is_free);
+	if (blk.prev_free != -1)
+		blocks[blk.prev_free].next_free = blk.next_free;
+	else
+		free_heads[fl][sl] = blk.next_free;
+	if (blk.next_free != -1)
+		blocks[blk.next_free].prev_free = blk.prev_free;
+	if (free_heads[fl][sl] == -1) {
+		sl_bitmap[fl] &= ~(1u << sl);
+		if (sl_bitmap[fl] == 0)
+			fl_bitmap &= ~(1u << fl);
+	}
+	blk.is_free = false;
+	blk.prev_free = blk.next_free = -1;
+	num_free--;
+}
+
+// any block in the returned list fits: the size is rounded up to the next class first
+int gpuSpanAllocator::find_free(int size) const {
+	int64_t rounded = size;
+	if (size >= SL_COUNT)
+		rounded += (int64_t(1) << (std::bit_width((uint32_t)size) - 1 - SL_LOG2)) - 1;
+	if (rounded > INT32_MAX)
+		return -1;
+	int fl{}, sl{};
+	mapping((int)rounded, fl, sl);
+	if (fl >= FL_COUNT)
+		return -1;
+
+	uint32_t sl_map = sl_bitmap[fl] & (~0u << sl);
+	if (sl_map == 0) {
+		const uint32_t fl_map = (fl + 1 < 32) ? fl_bitmap & (~0u << (fl + 1)) : 0;
+		if (fl_map == 0)
+			return -1;
+		fl = std::countr_zero(fl_map);
+		sl_map = sl_bitmap[fl];
+	}
+	ASSERT(sl_map != 0);
+	return free_heads[fl][std::countr_zero(sl_map)];
+}
+
+gpuAllocSpan gpuSpanAllocator::use_block(int b, int bytes, int align_to_size) {
+	ASSERT(!blocks[b].is_free && blocks[b].size >= bytes);
+	if (blocks[b].size > bytes) {
+		const int r = new_block(); // before taking references, can grow the vector
+		Block& blk = blocks[b];
+		Block& rest = blocks[r];
+		rest.start = blk.start + bytes;
+		rest.size = blk.size - bytes;
+		rest.prev_phys = b;
+		rest.next_phys = blk.next_phys;
+		if (rest.next_phys != -1)
+			blocks[rest.next_phys].prev_phys = r;
+		else
+			last_block = r;
+		blk.next_phys = r;
+		blk.size = bytes;
+		insert_free(r);
+	}
+	used_bytes += bytes;
+	num_used++;
+
+	gpuAllocSpan result;
+	result.start = blocks[b].start;
+	result.size = bytes;
+	result.block = b;
+	result.aligned_start = result.start;
+	const int modulo = result.start % align_to_size;
+	if (modulo != 0)
+		result.aligned_start += align_to_size - modulo;
+	return result;
+}
+
 gpuAllocSpan gpuSpanAllocator::allocate(int bytes, int align_to_size) {
 	bytes += align_to_size; // slightly wasteful
 	// normalize to big stuff
 	bytes = (int)normalize_alloc_size(bytes);
 
-	for (auto it = freeSpans.begin(); it != freeSpans.end(); ++it) {
-		if (it->s.size >= bytes) {
-			gpuAllocSpan result = {it->s.start, bytes};
-
-			if (it->s.size > bytes) {
-				it->s.start += bytes;
-				it->s.size -= bytes;
-			} else {
-				freeSpans.erase(it);
-			}
-			result.aligned_start = result.start;
-			const int modulo = result.start % align_to_size;
-			if (modulo != 0)
-				result.aligned_start += align_to_size - modulo;
-
-			return result;
+	const int b = find_free(bytes);
+	if (b == -1)
+		return {}; // size==0, out of mem
+	remove_free(b);
+	return use_block(b, bytes, align_to_size);
+}
+
+gpuAllocSpan gpuSpanAllocator::allocate_below(int bytes, int align_to_size, int below_start) {
+	bytes += align_to_size;
+	bytes = (int)normalize_alloc_size(bytes);
+	if (blocks.empty())
+		return {};
+	for (int b = 0; b != -1 && blocks[b].start < below_start; b = blocks[b].next_phys) {
+		if (blocks[b].is_free && blocks[b].size >= bytes) {
+			remove_free(b);
+			return use_block(b, bytes, align_to_size);
 		}
 	}
-
-	return {}; // size==0, out of mem
+	return {};
 }
-#include <cassert>
+
 void gpuSpanAllocator::free(gpuAllocSpan span) {
-	if (span.start == 0)
+	if (span.size == 0)
 		return;
-	assert(span.size != 0);
-
-	SpanAndFree newSpan{span};
-
-	auto it = std::lower_bound(freeSpans.begin(), freeSpans.end(), newSpan,
-							   [](const SpanAndFree& a, const SpanAndFree& b) { return a.s.start < b.s.start; });
-
-	it = freeSpans.insert(it, newSpan);
+	int b = span.block;
+	ASSERT(b >= 0 && b < (int)blocks.size());
+	ASSERT(!blocks[b].is_free && blocks[b].start == span.start && blocks[b].size == span.size);
+	used_bytes -= span.size;
+	num_used--;
 
-	merge_with_neighbors(it);
+	// merge with the address neighbours, the survivor is the lower block
+	const int prev = blocks[b].prev_phys;
+	if (prev != -1 && blocks[prev].is_free) {
+		remove_free(prev);
+		blocks[prev].size += blocks[b].size;
+		blocks[prev].next_phys = blocks[b].next_phys;
+		if (blocks[b].next_phys != -1)
+			blocks[blocks[b].next_phys].prev_phys = prev;
+		else
+			last_block = prev;
+		release_block(b);
+		b = prev;
+	}
+	const int next = blocks[b].next_phys;
+	if (next != -1 && blocks[next].is_free) {
+		remove_free(next);
+		blocks[b].size += blocks[next].size;
+		blocks[b].next_phys = blocks[next].next_phys;
+		if (blocks[next].next_phys != -1)
+			blocks[blocks[next].next_phys].prev_phys = b;
+		else
+			last_block = b;
+		release_block(next);
+	}
+	insert_free(b);
 }
 
-void gpuSpanAllocator::merge_with_neighbors(std::vector<SpanAndFree>::iterator it) {
-	if (it != freeSpans.begin()) {
-		auto prev = std::prev(it);
-		if (prev->s.start + prev->s.size == it->s.start) {
-			prev->s.size += it->s.size;
-			it = freeSpans.erase(it);
-		}
-	}
-	auto next = std::next(it);
-	if (next != freeSpans.end() && it->s.start + it->s.size == next->s.start) {
-		it->s.size += next->s.size;
-		freeSpans.erase(next);
+gpuAllocStats gpuSpanAllocator::get_stats() const {
+	gpuAllocStats s;
+	s.total = initialized_size;
+	s.used = used_bytes;
+	s.free_bytes = initialized_size - used_bytes;
+	s.num_used_blocks = num_used;
+	s.num_free_blocks = num_free;
+	s.used_end = initialized_size;
+	if (last_block != -1 && blocks[last_block].is_free)
+		s.used_end = blocks[last_block].start;
+	if (fl_bitmap != 0) {
+		// the largest block is in the highest non-empty list, the list itself is unsorted
+		const int fl = 31 - std::countl_zero(fl_bitmap);
+		const int sl = 31 - std::countl_zero(sl_bitmap[fl]);
+		for (int b = free_heads[fl][sl]; b != -1; b = blocks[b].next_free)
+			s.largest_free = std::max(s.largest_free, blocks[b].size);
 	}
+	return s;
 }
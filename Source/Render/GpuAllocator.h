@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 // [static vertex]
 // [streaming vertex]
@@ -11,8 +12,25 @@ struct gpuAllocSpan
 	int start = 0;
 	int size = 0;
 	int aligned_start = 0;
+	int block = -1; // allocator internal, free() finds the span with it
 };
 
+struct gpuAllocStats
+{
+	int total = 0;
+	int used = 0;
+	int free_bytes = 0;
+	int largest_free = 0;
+	int num_used_blocks = 0;
+	int num_free_blocks = 0;
+	int used_end = 0; // end of the highest used block
+
+	// 0 when the free memory is one block, towards 1 as it splinters into blocks nothing fits in
+	float get_fragmentation() const { return free_bytes > 0 ? 1.f - (float)largest_free / (float)free_bytes : 0.f; }
+};
+
+// Two-level segregated fit: free blocks are binned by size class (power of two, split linearly into SL_COUNT) with
+// a bitmap per level, so allocate() and free() are O(1). Blocks keep their address neighbours for merging on free.
 class gpuSpanAllocator
 {
 public:
@@ -21,12 +39,43 @@ public:
 	void free(gpuAllocSpan span);
 	int get_init_sized() const { return initialized_size; }
 
+	// for compaction: allocate() from the lowest free block that fits and starts below below_start, size==0 if there
+	// is none. Walks the blocks in address order, so O(n).
+	gpuAllocSpan allocate_below(int bytes, int align_to_size, int below_start);
+	gpuAllocStats get_stats() const;
+
 private:
-	struct SpanAndFree
+	static const int SL_LOG2 = 4;
+	static const int SL_COUNT = 1 << SL_LOG2;
+	static const int FL_COUNT = 32 - SL_LOG2;
+
+	struct Block
 	{
-		gpuAllocSpan s;
+		int start = 0;
+		int size = 0;
+		int prev_phys = -1;
+		int next_phys = -1;
+		int prev_free = -1;
+		int next_free = -1;
+		bool is_free = false;
 	};
-	void merge_with_neighbors(std::vector<SpanAndFree>::iterator it);
+
+	static void mapping(int size, int& fl, int& sl);
+	int new_block();
+	void release_block(int b);
+	void insert_free(int b);
+	void remove_free(int b);
+	int find_free(int size) const;
+	gpuAllocSpan use_block(int b, int bytes, int align_to_size);
+
 	int initialized_size = 0;
-	std::vector<SpanAndFree> freeSpans;
+	int used_bytes = 0;
+	int num_used = 0;
+	int num_free = 0;
+	int last_block = -1;
+	std::vector<Block> blocks;
+	std::vector<int> unused_blocks;
+	uint32_t fl_bitmap = 0;
+	uint32_t sl_bitmap[FL_COUNT] = {};
+	int free_heads[FL_COUNT][SL_COUNT] = {};
 };
@@ -97,7 +97,7 @@ void GpuCullingTest::debug_overlay() {
 		cp.lod_bias = lod_bias;
 		cp.output_depth = output_depth;
 		cp.debug_pos = glm::vec4(debug_pos, debug_radius);
-		draw.ubo.cull_params->upload(&cp, sizeof(cp));
+		gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 		gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 	}
 
@@ -117,7 +117,8 @@ void GpuCullingTest::do_cull_for_scene(const GpuCullInput& input, Phase pass) {
 	do_cull(input, pass, false, frustum);
 }
 extern ConfigVar r_force_lod;
-void GpuCullingTest::do_cull(const GpuCullInput& input, Phase pass, bool is_for_shadow, Frustum frustum) {
+void GpuCullingTest::do_cull(const GpuCullInput& input, Phase pass, bool is_for_shadow, Frustum frustum,
+							 ShadowCasters casters) {
 	GPU_FUNCTION();
 
 	if (cull.num_objects <= 0)
@@ -129,6 +130,9 @@ void GpuCullingTest::do_cull(const GpuCullInput& input, Phase pass, bool is_for_
 	// pass2: testing against cur frame
 
 	if (update_depth_pyramid) {
+		// shadow culls fill a copy: cascades and spot lights can be recorded from several jobs at once
+		CullData shadow_cull;
+		CullData& cd = is_for_shadow ? (shadow_cull = cull) : cull;
 		glm::vec3 origin{};
 		float fov{};
 		if (is_for_shadow) {
@@ -140,44 +144,44 @@ void GpuCullingTest::do_cull(const GpuCullInput& input, Phase pass, bool is_for_
 		}
 		const float inv_two_times_tanfov = 1.0 / (tan(fov * 0.5));
 		const float inv_two_times_tanfov_2 = inv_two_times_tanfov * inv_two_times_tanfov;
-		cull.inv_two_times_tanfov_2 = inv_two_times_tanfov_2;
+		cd.inv_two_times_tanfov_2 = inv_two_times_tanfov_2;
 		auto& vs = draw.current_frame_view;
-		cull.camera_origin = glm::vec4(origin, 1);
+		cd.camera_origin = glm::vec4(origin, 1);
 		// Real camera position regardless of pass -- see CullData::main_view_origin.
-		cull.main_view_origin = glm::vec4(draw.current_frame_view.origin, 1);
+		cd.main_view_origin = glm::vec4(draw.current_frame_view.origin, 1);
 		// Real main camera fov regardless of pass, so cascade LOD selection matches the
 		// main view's LOD (not the light frustum's fov, which is meaningless for a
 		// directional light) -- see CullData::main_view_inv_two_times_tanfov_2.
 		{
 			const float main_inv_two_times_tanfov = 1.0f / tan(draw.get_current_frame_vs().fov * 0.5f);
-			cull.main_view_inv_two_times_tanfov_2 = main_inv_two_times_tanfov * main_inv_two_times_tanfov;
+			cd.main_view_inv_two_times_tanfov_2 = main_inv_two_times_tanfov * main_inv_two_times_tanfov;
 		}
 
-		cull.frustum_up = frustum.top_plane;
-		cull.frustum_down = frustum.bot_plane;
-		cull.frustum_l = frustum.left_plane;
-		cull.frustum_r = frustum.right_plane;
-		cull.backplane = frustum.back_plane;
+		cd.frustum_up = frustum.top_plane;
+		cd.frustum_down = frustum.bot_plane;
+		cd.frustum_l = frustum.left_plane;
+		cd.frustum_r = frustum.right_plane;
+		cd.backplane = frustum.back_plane;
 
 		// unused for shadow
-		cull.near = vs.near;
-		cull.pyramid_width = actual_depth_size.x;
-		cull.pyramid_height = actual_depth_size.y;
+		cd.near = vs.near;
+		cd.pyramid_width = actual_depth_size.x;
+		cd.pyramid_height = actual_depth_size.y;
 		const float aratio = vs.width / (float)vs.height;
 		const float halfVSide = tanf(vs.fov * .5f);
 		const float halfHSide = halfVSide * aratio;
-		cull.p00 = 1 / halfHSide;
-		cull.p11 = 1 / halfVSide;
+		cd.p00 = 1 / halfHSide;
+		cd.p11 = 1 / halfVSide;
 
 		if (!is_for_shadow) {
 			if (pass == Phase::Pass1) {
-				cull.view = prev_view;
+				cd.view = prev_view;
 				prev_view = vs.view; // pass 1, use last view
 			} else {
-				cull.view = vs.view; // in pass 2, use current view
+				cd.view = vs.view; // in pass 2, use current view
 			}
 		}
-		cull_data->upload(&cull, sizeof(CullData));
+		gfx().upload_buffer(cull_data, &cd, sizeof(CullData));
 	}
 
 	// zero_instances_in_this(multidraw_buffer->get_internal_handle(), cmd_mats.size());	// clear instances to 0, so
@@ -208,7 +212,8 @@ void GpuCullingTest::do_cull(const GpuCullInput& input, Phase pass, bool is_for_
 		cp.force_lod = r_force_lod.get_integer();
 		cp.radius_bias = radius_bias;
 		cp.compact_count = input.num_compact; // bounds the COMPACT_INST dispatch
-		draw.ubo.cull_params->upload(&cp, sizeof(cp));
+		cp.shadow_casters = is_for_shadow ? (int)casters : 0;
+		gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 		gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 	}
 
@@ -393,7 +398,7 @@ void GpuCullingTest::downsample_depth() {
 			cp.pyr_width = (float)width;
 			cp.pyr_height = (float)height;
 			cp.pyr_level = level_to_sample;
-			draw.ubo.cull_params->upload(&cp, sizeof(cp));
+			gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 			gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 		}
 
@@ -443,7 +448,7 @@ void GpuCullingTest::compact_draws(const GpuCullInput& input) {
 		gpu::CullParams cp{};
 		cp.num_draws = input.num_batches;
 		cp.command_count = input.num_cmds;
-		draw.ubo.cull_params->upload(&cp, sizeof(cp));
+		gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 		gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 	}
 
@@ -459,7 +464,7 @@ void GpuCullingTest::zero_instances_in_this(IGraphicsBuffer* mdi_buf, int count)
 	{
 		gpu::CullParams cp{};
 		cp.draw_count = count;
-		draw.ubo.cull_params->upload(&cp, sizeof(cp));
+		gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 		gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 	}
 	gfx().dispatch_compute(groups_x, 1, 1);
@@ -475,7 +480,7 @@ void GpuCullingTest::zero_command_primcounts(IGraphicsBuffer* mdi_buf, int cmd_o
 		gpu::CullParams cp{};
 		cp.draw_count = count;
 		cp.cmd_offset = cmd_offset;
-		draw.ubo.cull_params->upload(&cp, sizeof(cp));
+		gfx().upload_buffer(draw.ubo.cull_params, &cp, sizeof(cp));
 		gfx().bind_uniform_buffer_base(7, draw.ubo.cull_params);
 	}
 	gfx().dispatch_compute(groups_x, 1, 1);
@@ -483,6 +488,6 @@ void GpuCullingTest::zero_command_primcounts(IGraphicsBuffer* mdi_buf, int cmd_o
 	gfx().memory_barrier(BARRIER_SHADER_STORAGE | BARRIER_COMMAND);
 }
 
-void GpuCullingTest::do_shadow_cull(const GpuCullInput& input, Frustum f) {
-	do_cull(input, {}, true, f);
+void GpuCullingTest::do_shadow_cull(const GpuCullInput& input, Frustum f, ShadowCasters casters) {
+	do_cull(input, {}, true, f, casters);
 }
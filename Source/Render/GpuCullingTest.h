@@ -1,6 +1,7 @@
 #pragma once
 #include "DrawLocal.h"
 #include "Render/Frustum.h"
+#include "Render/StaticShadowCache.h"
 /*
 ###########
 # OUTLINE #
@@ -46,7 +47,8 @@ struct CullObject
 	// x component is model
 	// y component is object index
 	// z component is material ofs
-	// w component is flags
+	// w component is flags: 1 shadow caster, 2 skipped by the main view (cpu culled, still drawn in shadows),
+	// 4 dynamic caster (not in the cached static shadow layers)
 };
 struct CullData
 {
@@ -152,7 +154,8 @@ public:
 	// on primCount == 0 being a no-op for unused trailing slots.
 	void zero_command_primcounts(IGraphicsBuffer* mdi_buf, int cmd_offset, int count);
 
-	void do_shadow_cull(const GpuCullInput& input, Frustum f);
+	// casters picks the static or dynamic fast path casters for cached shadow layers (StaticShadowCache)
+	void do_shadow_cull(const GpuCullInput& input, Frustum f, ShadowCasters casters = ShadowCasters::All);
 
 private:
 	enum class Phase
@@ -161,5 +164,6 @@ private:
 		Pass2
 	};
 	void do_cull_for_scene(const GpuCullInput& input, Phase pass);
-	void do_cull(const GpuCullInput& input, Phase pass, bool is_for_shadow, Frustum in_frustum);
+	void do_cull(const GpuCullInput& input, Phase pass, bool is_for_shadow, Frustum in_frustum,
+				 ShadowCasters casters = ShadowCasters::All);
 };
\ No newline at end of file
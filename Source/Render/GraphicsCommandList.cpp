@@ -0,0 +1,535 @@
+// Deferred command list, see GraphicsCommandList.h.
+
+#include "GraphicsCommandList.h"
+#include "Framework/Util.h"
+
+#include <cstring>
+
+void IGraphicsDevice::execute_command_list(GraphicsCommandList& list) {
+	list.replay(*this);
+}
+
+void GraphicsCommandList::clear() {
+	cmds.clear();
+	payload.clear();
+	pipelines.clear();
+	passes.clear();
+	pass_targets.clear();
+	blits.clear();
+	current_shader = nullptr;
+	num_draws = 0;
+	num_dispatches = 0;
+}
+
+GraphicsCommandList::Command& GraphicsCommandList::add(GfxListOp op) {
+	cmds.emplace_back();
+	cmds.back().op = op;
+	return cmds.back();
+}
+
+int GraphicsCommandList::add_payload(const void* data, int size) {
+	if (!data || size <= 0)
+		return -1;
+	// 16 byte aligned so a client MDI array or constant block reads the same as from the caller's memory
+	const int ofs = ((int)payload.size() + 15) & ~15;
+	payload.resize(ofs + size);
+	memcpy(payload.data() + ofs, data, size);
+	return ofs;
+}
+
+IGraphicsDevice& GraphicsCommandList::device() {
+	ASSERT(g_gfx_instance != nullptr);
+	return *g_gfx_instance;
+}
+
+GraphicsDeviceType GraphicsCommandList::get_device_type() {
+	return device().get_device_type();
+}
+
+// ---- Not recordable, only legal while recording on the submission thread ------
+
+void GraphicsCommandList::begin_frame() {
+	ASSERT(0 && "GraphicsCommandList: begin_frame while recording");
+}
+IGraphicsTexture* GraphicsCommandList::acquire_swapchain_texture() {
+	ASSERT(0 && "GraphicsCommandList: acquire_swapchain_texture while recording");
+	return device().acquire_swapchain_texture();
+}
+void GraphicsCommandList::submit_and_present() {
+	ASSERT(0 && "GraphicsCommandList: submit_and_present while recording");
+}
+IGraphicsTexture* GraphicsCommandList::create_texture(const CreateTextureArgs& args) {
+	ASSERT(0 && "GraphicsCommandList: create resources before recording");
+	return device().create_texture(args);
+}
+IGraphicsBuffer* GraphicsCommandList::create_buffer(const CreateBufferArgs& args) {
+	ASSERT(0 && "GraphicsCommandList: create resources before recording");
+	return device().create_buffer(args);
+}
+IGraphicsVertexInput* GraphicsCommandList::create_vertex_input(const CreateVertexInputArgs& args) {
+	ASSERT(0 && "GraphicsCommandList: create resources before recording");
+	return device().create_vertex_input(args);
+}
+IGraphicsSampler* GraphicsCommandList::create_sampler(const CreateSamplerArgs& args) {
+	ASSERT(0 && "GraphicsCommandList: create resources before recording");
+	return device().create_sampler(args);
+}
+void GraphicsCommandList::wait_for_gpu_idle() {
+	ASSERT(0 && "GraphicsCommandList: wait_for_gpu_idle while recording");
+}
+IGraphicsFence* GraphicsCommandList::insert_fence() {
+	ASSERT(0 && "GraphicsCommandList: fences go on the submission thread");
+	return device().insert_fence();
+}
+void GraphicsCommandList::download_buffer(IGraphicsBuffer* buf, int offset, int size, void* dest) {
+	ASSERT(0 && "GraphicsCommandList: readback while recording");
+	device().download_buffer(buf, offset, size, dest);
+}
+IGraphicsTimerQuery* GraphicsCommandList::create_timer_query() {
+	ASSERT(0 && "GraphicsCommandList: create resources before recording");
+	return device().create_timer_query();
+}
+void GraphicsCommandList::set_vsync(bool enable) {
+	ASSERT(0 && "GraphicsCommandList: set_vsync while recording");
+}
+void GraphicsCommandList::imgui_init() {
+	ASSERT(0 && "GraphicsCommandList: imgui while recording");
+}
+void GraphicsCommandList::imgui_shutdown() {
+	ASSERT(0 && "GraphicsCommandList: imgui while recording");
+}
+void GraphicsCommandList::imgui_new_frame() {
+	ASSERT(0 && "GraphicsCommandList: imgui while recording");
+}
+void GraphicsCommandList::imgui_render_draw_data() {
+	ASSERT(0 && "GraphicsCommandList: imgui while recording");
+}
+bool GraphicsCommandList::imgui_process_event(const SDL_Event* event) {
+	ASSERT(0 && "GraphicsCommandList: imgui while recording");
+	return false;
+}
+void GraphicsCommandList::rmlui_init() {
+	ASSERT(0 && "GraphicsCommandList: rmlui while recording");
+}
+void GraphicsCommandList::rmlui_shutdown() {
+	ASSERT(0 && "GraphicsCommandList: rmlui while recording");
+}
+void GraphicsCommandList::rmlui_render(int viewport_w, int viewport_h, IGraphicsTexture* target) {
+	ASSERT(0 && "GraphicsCommandList: rmlui while recording");
+}
+IGraphicsShader* GraphicsCommandList::create_shader_vert_frag(const std::string& vert_path,
+															   const std::string& frag_path,
+															   const std::string& defines) {
+	ASSERT(0 && "GraphicsCommandList: shader compile while recording");
+	return device().create_shader_vert_frag(vert_path, frag_path, defines);
+}
+IGraphicsShader* GraphicsCommandList::create_shader_vert_frag_geo(const std::string& vert_path,
+																   const std::string& frag_path,
+																   const std::string& geo_path,
+																   const std::string& defines) {
+	ASSERT(0 && "GraphicsCommandList: shader compile while recording");
+	return device().create_shader_vert_frag_geo(vert_path, frag_path, geo_path, defines);
+}
+IGraphicsShader* GraphicsCommandList::create_shader_compute(const std::string& compute_path,
+															 const std::string& defines) {
+	ASSERT(0 && "GraphicsCommandList: shader compile while recording");
+	return device().create_shader_compute(compute_path, defines);
+}
+IGraphicsShader* GraphicsCommandList::create_shader_single_file(const std::string& shared_path,
+																 const std::string& defines) {
+	ASSERT(0 && "GraphicsCommandList: shader compile while recording");
+	return device().create_shader_single_file(shared_path, defines);
+}
+IGraphicsShader* GraphicsCommandList::create_shader_single_file_tess(const std::string& shared_path,
+																	  const std::string& defines) {
+	ASSERT(0 && "GraphicsCommandList: shader compile while recording");
+	return device().create_shader_single_file_tess(shared_path, defines);
+}
+
+// ---- Recording -----------------------------------------------------------------
+
+void GraphicsCommandList::set_pipeline(const RenderPipelineState& state) {
+	Command& c = add(GfxListOp::SetPipeline);
+	c.args[0] = (int)pipelines.size();
+	pipelines.push_back(state);
+	current_shader = state.program;
+}
+void GraphicsCommandList::set_depth_write_enabled(bool enabled) {
+	add(GfxListOp::SetDepthWrite).args[0] = enabled;
+}
+void GraphicsCommandList::reset_state_cache() {
+	add(GfxListOp::ResetStateCache);
+}
+void GraphicsCommandList::set_viewport(int x, int y, int w, int h) {
+	Command& c = add(GfxListOp::SetViewport);
+	c.args[0] = x;
+	c.args[1] = y;
+	c.args[2] = w;
+	c.args[3] = h;
+}
+void GraphicsCommandList::clear_framebuffer(bool clear_depth, bool clear_color, float depth_value) {
+	Command& c = add(GfxListOp::ClearFramebuffer);
+	c.args[0] = clear_depth;
+	c.args[1] = clear_color;
+	c.f = depth_value;
+}
+void GraphicsCommandList::set_render_pass(const RenderPassState& state) {
+	RecordedPass pass;
+	pass.state = state;
+	pass.state.color_infos = {};
+	pass.first_target = (int)pass_targets.size();
+	pass.num_targets = (int)state.color_infos.size();
+	pass_targets.insert(pass_targets.end(), state.color_infos.begin(), state.color_infos.end());
+	add(GfxListOp::SetRenderPass).args[0] = (int)passes.size();
+	passes.push_back(pass);
+}
+void GraphicsCommandList::blit_textures(const GraphicsBlitInfo& info) {
+	add(GfxListOp::Blit).args[0] = (int)blits.size();
+	blits.push_back(info);
+}
+void GraphicsCommandList::set_scissor(int x, int y, int w, int h) {
+	Command& c = add(GfxListOp::SetScissor);
+	c.args[0] = x;
+	c.args[1] = y;
+	c.args[2] = w;
+	c.args[3] = h;
+}
+void GraphicsCommandList::disable_scissor() {
+	add(GfxListOp::DisableScissor);
+}
+
+void GraphicsCommandList::draw_elements_base_vertex(GraphicsPrimitiveType mode, int count,
+													VertexInputIndexType index_type, int byte_offset, int base_vertex) {
+	Command& c = add(GfxListOp::DrawElementsBaseVertex);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.args[0] = count;
+	c.args[1] = byte_offset;
+	c.args[2] = base_vertex;
+	num_draws++;
+}
+void GraphicsCommandList::draw_arrays(GraphicsPrimitiveType mode, int first, int count) {
+	Command& c = add(GfxListOp::DrawArrays);
+	c.e0 = (uint8_t)mode;
+	c.args[0] = first;
+	c.args[1] = count;
+	num_draws++;
+}
+void GraphicsCommandList::draw_elements(GraphicsPrimitiveType mode, int count, VertexInputIndexType index_type,
+										int byte_offset) {
+	Command& c = add(GfxListOp::DrawElements);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.args[0] = count;
+	c.args[1] = byte_offset;
+	num_draws++;
+}
+void GraphicsCommandList::draw_elements_instanced_base_vertex_base_instance(GraphicsPrimitiveType mode, int count,
+																			VertexInputIndexType index_type,
+																			int byte_offset, int instance_count,
+																			int base_vertex, uint32_t base_instance) {
+	Command& c = add(GfxListOp::DrawElementsInstanced);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.args[0] = count;
+	c.args[1] = byte_offset;
+	c.args[2] = instance_count;
+	c.args[3] = base_vertex;
+	c.args[4] = (int)base_instance;
+	num_draws++;
+}
+void GraphicsCommandList::draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+												 IGraphicsBuffer* indirect, int byte_offset) {
+	Command& c = add(GfxListOp::DrawElementsIndirect);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.ptr0 = indirect;
+	c.args[0] = byte_offset;
+	num_draws++;
+}
+void GraphicsCommandList::multi_draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+													   IGraphicsBuffer* indirect, int byte_offset, int draw_count,
+													   int stride, const void* client_ptr) {
+	Command& c = add(GfxListOp::MultiDrawIndirect);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.ptr0 = indirect;
+	c.args[0] = byte_offset;
+	c.args[1] = draw_count;
+	c.args[2] = stride;
+	// client side commands only live as long as the caller's array
+	c.args[3] = indirect ? -1 : add_payload(client_ptr, draw_count * stride);
+	num_draws++;
+}
+void GraphicsCommandList::multi_draw_elements_indirect_count(GraphicsPrimitiveType mode,
+															 VertexInputIndexType index_type,
+															 IGraphicsBuffer* indirect, int indirect_byte_offset,
+															 IGraphicsBuffer* count, int count_byte_offset,
+															 int max_draw_count, int stride) {
+	Command& c = add(GfxListOp::MultiDrawIndirectCount);
+	c.e0 = (uint8_t)mode;
+	c.e1 = (uint8_t)index_type;
+	c.ptr0 = indirect;
+	c.ptr1 = count;
+	c.args[0] = indirect_byte_offset;
+	c.args[1] = count_byte_offset;
+	c.args[2] = max_draw_count;
+	c.args[3] = stride;
+	num_draws++;
+}
+
+void GraphicsCommandList::bind_texture(int slot, IGraphicsTexture* tex) {
+	Command& c = add(GfxListOp::BindTexture);
+	c.ptr0 = tex;
+	c.args[0] = slot;
+}
+void GraphicsCommandList::bind_uniform_buffer_base(int slot, IGraphicsBuffer* buf) {
+	Command& c = add(GfxListOp::BindUniformBuffer);
+	c.ptr0 = buf;
+	c.args[0] = slot;
+}
+void GraphicsCommandList::bind_sampler(int slot, IGraphicsSampler* sampler) {
+	Command& c = add(GfxListOp::BindSampler);
+	c.ptr0 = sampler;
+	c.args[0] = slot;
+}
+void GraphicsCommandList::bind_storage_buffer_base(int slot, IGraphicsBuffer* buf) {
+	Command& c = add(GfxListOp::BindStorageBuffer);
+	c.ptr0 = buf;
+	c.args[0] = slot;
+}
+void GraphicsCommandList::bind_storage_buffer_range(int slot, IGraphicsBuffer* buf, int offset, int size) {
+	Command& c = add(GfxListOp::BindStorageBufferRange);
+	c.ptr0 = buf;
+	c.args[0] = slot;
+	c.args[1] = offset;
+	c.args[2] = size;
+}
+void GraphicsCommandList::bind_image_for_compute(int slot, IGraphicsTexture* tex, int mip, int layer,
+												 GraphicsImageAccess access) {
+	Command& c = add(GfxListOp::BindImage);
+	c.e0 = (uint8_t)access;
+	c.ptr0 = tex;
+	c.args[0] = slot;
+	c.args[1] = mip;
+	c.args[2] = layer;
+}
+
+void GraphicsCommandList::push_constants(int stage, int slot, const void* data, int size) {
+	ASSERT(slot >= 0 && slot < kGfxMaxPushConstSlotsPerStage);
+	ASSERT(data != nullptr && size > 0 && size <= kGfxPushConstMaxBytes);
+	Command& c = add(GfxListOp::PushConstants);
+	c.e0 = (uint8_t)stage;
+	c.args[0] = slot;
+	c.args[1] = size;
+	c.args[2] = add_payload(data, size);
+}
+void GraphicsCommandList::push_vertex_constants(int slot, const void* data, int size) {
+	push_constants(0, slot, data, size);
+}
+void GraphicsCommandList::push_fragment_constants(int slot, const void* data, int size) {
+	push_constants(1, slot, data, size);
+}
+void GraphicsCommandList::push_compute_constants(int slot, const void* data, int size) {
+	push_constants(2, slot, data, size);
+}
+
+void GraphicsCommandList::begin_compute_pass() {
+	add(GfxListOp::BeginComputePass);
+}
+void GraphicsCommandList::dispatch_compute(int groups_x, int groups_y, int groups_z) {
+	Command& c = add(GfxListOp::DispatchCompute);
+	c.args[0] = groups_x;
+	c.args[1] = groups_y;
+	c.args[2] = groups_z;
+	num_dispatches++;
+}
+void GraphicsCommandList::memory_barrier(uint32_t bits) {
+	add(GfxListOp::MemoryBarrier).args[0] = (int)bits;
+}
+void GraphicsCommandList::clear_buffer_uint32(IGraphicsBuffer* buf, uint32_t value) {
+	Command& c = add(GfxListOp::ClearBufferUint32);
+	c.ptr0 = buf;
+	c.args[0] = (int)value;
+}
+
+void GraphicsCommandList::set_line_width(float width) {
+	add(GfxListOp::SetLineWidth).f = width;
+}
+void GraphicsCommandList::set_polygon_fill_mode(GraphicsFillMode mode) {
+	add(GfxListOp::SetPolygonFillMode).e0 = (uint8_t)mode;
+}
+void GraphicsCommandList::copy_texture(IGraphicsTexture* src, int src_mip, int src_layer, IGraphicsTexture* dst,
+									   int dst_mip, int dst_layer, int w, int h) {
+	Command& c = add(GfxListOp::CopyTexture);
+	c.ptr0 = src;
+	c.ptr1 = dst;
+	c.args[0] = src_mip;
+	c.args[1] = src_layer;
+	c.args[2] = dst_mip;
+	c.args[3] = dst_layer;
+	c.args[4] = w;
+	c.args[5] = h;
+}
+void GraphicsCommandList::copy_texture_rect(const GraphicsBlitInfo& info) {
+	add(GfxListOp::CopyTextureRect).args[0] = (int)blits.size();
+	blits.push_back(info);
+}
+
+void GraphicsCommandList::push_debug_group(const char* name) {
+	ASSERT(name != nullptr);
+	add(GfxListOp::PushDebugGroup).args[0] = add_payload(name, (int)strlen(name) + 1);
+}
+void GraphicsCommandList::pop_debug_group() {
+	add(GfxListOp::PopDebugGroup);
+}
+
+void GraphicsCommandList::upload_buffer(IGraphicsBuffer* buf, const void* data, int size) {
+	ASSERT(buf != nullptr && size >= 0);
+	Command& c = add(GfxListOp::UploadBuffer);
+	c.ptr0 = buf;
+	c.args[0] = size;
+	c.args[1] = add_payload(data, size); // nullptr data is a resize, same as IGraphicsBuffer::upload
+}
+void GraphicsCommandList::sub_upload_buffer(IGraphicsBuffer* buf, const void* data, int size, int offset) {
+	ASSERT(buf != nullptr && data != nullptr && size >= 0 && offset >= 0);
+	Command& c = add(GfxListOp::SubUploadBuffer);
+	c.ptr0 = buf;
+	c.args[0] = size;
+	c.args[1] = add_payload(data, size);
+	c.args[2] = offset;
+}
+
+// ---- Replay ----------------------------------------------------------------------
+
+void GraphicsCommandList::replay(IGraphicsDevice& target) const {
+	ASSERT(&target != this);
+	for (const Command& c : cmds) {
+		const auto mode = (GraphicsPrimitiveType)c.e0;
+		const auto index_type = (VertexInputIndexType)c.e1;
+		auto buf0 = (IGraphicsBuffer*)c.ptr0;
+		auto tex0 = (IGraphicsTexture*)c.ptr0;
+		switch (c.op) {
+		case GfxListOp::SetPipeline:
+			target.set_pipeline(pipelines[c.args[0]]);
+			break;
+		case GfxListOp::SetDepthWrite:
+			target.set_depth_write_enabled(c.args[0] != 0);
+			break;
+		case GfxListOp::ResetStateCache:
+			target.reset_state_cache();
+			break;
+		case GfxListOp::SetViewport:
+			target.set_viewport(c.args[0], c.args[1], c.args[2], c.args[3]);
+			break;
+		case GfxListOp::ClearFramebuffer:
+			target.clear_framebuffer(c.args[0] != 0, c.args[1] != 0, c.f);
+			break;
+		case GfxListOp::SetRenderPass: {
+			const RecordedPass& pass = passes[c.args[0]];
+			RenderPassState state = pass.state;
+			state.color_infos = std::span<const ColorTargetInfo>(pass_targets.data() + pass.first_target,
+																 pass.num_targets);
+			target.set_render_pass(state);
+		} break;
+		case GfxListOp::Blit:
+			target.blit_textures(blits[c.args[0]]);
+			break;
+		case GfxListOp::SetScissor:
+			target.set_scissor(c.args[0], c.args[1], c.args[2], c.args[3]);
+			break;
+		case GfxListOp::DisableScissor:
+			target.disable_scissor();
+			break;
+		case GfxListOp::DrawElementsBaseVertex:
+			target.draw_elements_base_vertex(mode, c.args[0], index_type, c.args[1], c.args[2]);
+			break;
+		case GfxListOp::DrawArrays:
+			target.draw_arrays(mode, c.args[0], c.args[1]);
+			break;
+		case GfxListOp::DrawElements:
+			target.draw_elements(mode, c.args[0], index_type, c.args[1]);
+			break;
+		case GfxListOp::DrawElementsInstanced:
+			target.draw_elements_instanced_base_vertex_base_instance(mode, c.args[0], index_type, c.args[1],
+																	 c.args[2], c.args[3], (uint32_t)c.args[4]);
+			break;
+		case GfxListOp::DrawElementsIndirect:
+			target.draw_elements_indirect(mode, index_type, buf0, c.args[0]);
+			break;
+		case GfxListOp::MultiDrawIndirect:
+			target.multi_draw_elements_indirect(mode, index_type, buf0, c.args[0], c.args[1], c.args[2],
+												get_payload(c.args[3]));
+			break;
+		case GfxListOp::MultiDrawIndirectCount:
+			target.multi_draw_elements_indirect_count(mode, index_type, buf0, c.args[0], (IGraphicsBuffer*)c.ptr1,
+													  c.args[1], c.args[2], c.args[3]);
+			break;
+		case GfxListOp::BindTexture:
+			target.bind_texture(c.args[0], tex0);
+			break;
+		case GfxListOp::BindUniformBuffer:
+			target.bind_uniform_buffer_base(c.args[0], buf0);
+			break;
+		case GfxListOp::BindSampler:
+			target.bind_sampler(c.args[0], (IGraphicsSampler*)c.ptr0);
+			break;
+		case GfxListOp::BindStorageBuffer:
+			target.bind_storage_buffer_base(c.args[0], buf0);
+			break;
+		case GfxListOp::BindStorageBufferRange:
+			target.bind_storage_buffer_range(c.args[0], buf0, c.args[1], c.args[2]);
+			break;
+		case GfxListOp::BindImage:
+			target.bind_image_for_compute(c.args[0], tex0, c.args[1], c.args[2], (GraphicsImageAccess)c.e0);
+			break;
+		case GfxListOp::PushConstants: {
+			const void* data = get_payload(c.args[2]);
+			if (c.e0 == 0)
+				target.push_vertex_constants(c.args[0], data, c.args[1]);
+			else if (c.e0 == 1)
+				target.push_fragment_constants(c.args[0], data, c.args[1]);
+			else
+				target.push_compute_constants(c.args[0], data, c.args[1]);
+		} break;
+		case GfxListOp::BeginComputePass:
+			target.begin_compute_pass();
+			break;
+		case GfxListOp::DispatchCompute:
+			target.dispatch_compute(c.args[0], c.args[1], c.args[2]);
+			break;
+		case GfxListOp::MemoryBarrier:
+			target.memory_barrier((uint32_t)c.args[0]);
+			break;
+		case GfxListOp::ClearBufferUint32:
+			target.clear_buffer_uint32(buf0, (uint32_t)c.args[0]);
+			break;
+		case GfxListOp::SetLineWidth:
+			target.set_line_width(c.f);
+			break;
+		case GfxListOp::SetPolygonFillMode:
+			target.set_polygon_fill_mode((GraphicsFillMode)c.e0);
+			break;
+		case GfxListOp::CopyTexture:
+			target.copy_texture(tex0, c.args[0], c.args[1], (IGraphicsTexture*)c.ptr1, c.args[2], c.args[3], c.args[4],
+								c.args[5]);
+			break;
+		case GfxListOp::CopyTextureRect:
+			target.copy_texture_rect(blits[c.args[0]]);
+			break;
+		case GfxListOp::PushDebugGroup:
+			target.push_debug_group((const char*)get_payload(c.args[0]));
+			break;
+		case GfxListOp::PopDebugGroup:
+			target.pop_debug_group();
+			break;
+		case GfxListOp::UploadBuffer:
+			target.upload_buffer(buf0, get_payload(c.args[1]), c.args[0]);
+			break;
+		case GfxListOp::SubUploadBuffer:
+			if (c.args[0] > 0)
+				target.sub_upload_buffer(buf0, get_payload(c.args[1]), c.args[0], c.args[2]);
+			break;
+		}
+	}
+}
@@ -0,0 +1,204 @@
+#pragma once
+// Deferred command list. Records pipeline state, binds, push constants, draws, dispatches and ordered buffer writes
+// on any thread, replays them through the real device on the submission thread (IGraphicsDevice::execute_command_list).
+//
+// It is an IGraphicsDevice itself: bind one with gfx_begin_recording() and the existing pass code, which all goes
+// through gfx(), records into it unchanged. Only commands can be recorded. Creating resources, readbacks, frame
+// lifecycle, imgui/rmlui and shader compiles assert and fall through to the device (legal only on the submission
+// thread). Timer queries aren't recorded, so GPU profiler zones opened while recording are skipped
+// (see ProfilerGpuScope).
+//
+// Pointers (shaders, buffers, textures) are stored as-is and must stay alive until the list is replayed. Data behind
+// pointers (push constants, uploads, client MDI commands, render pass targets, debug group names) is copied, so the
+// caller's memory can be reused right after the call returns.
+
+#include "Render/IGraphicsDevice.h"
+#include <cstdint>
+#include <vector>
+
+enum class GfxListOp : uint8_t
+{
+	SetPipeline,
+	SetDepthWrite,
+	ResetStateCache,
+	SetViewport,
+	ClearFramebuffer,
+	SetRenderPass,
+	Blit,
+	SetScissor,
+	DisableScissor,
+	DrawElementsBaseVertex,
+	DrawArrays,
+	DrawElements,
+	DrawElementsInstanced,
+	DrawElementsIndirect,
+	MultiDrawIndirect,
+	MultiDrawIndirectCount,
+	BindTexture,
+	BindUniformBuffer,
+	BindSampler,
+	BindStorageBuffer,
+	BindStorageBufferRange,
+	BindImage,
+	PushConstants,
+	BeginComputePass,
+	DispatchCompute,
+	MemoryBarrier,
+	ClearBufferUint32,
+	SetLineWidth,
+	SetPolygonFillMode,
+	CopyTexture,
+	CopyTextureRect,
+	PushDebugGroup,
+	PopDebugGroup,
+	UploadBuffer,
+	SubUploadBuffer,
+};
+
+class GraphicsCommandList : public IGraphicsDevice
+{
+public:
+	// drops recorded commands, keeps the allocations
+	void clear();
+	bool is_empty() const { return cmds.empty(); }
+	int get_num_commands() const { return (int)cmds.size(); }
+	int get_num_draws() const { return num_draws; }
+	int get_num_dispatches() const { return num_dispatches; }
+	// bytes copied into the list (uploads, push constants, client MDI commands)
+	int get_payload_bytes() const { return (int)payload.size(); }
+
+	// Issues every recorded command on target, in order. Prefer target.execute_command_list(list).
+	void replay(IGraphicsDevice& target) const;
+
+	GraphicsDeviceType get_device_type() override;
+
+	void begin_frame() override;
+	IGraphicsTexture* acquire_swapchain_texture() override;
+	void submit_and_present() override;
+
+	void set_pipeline(const RenderPipelineState& state) override;
+	void set_depth_write_enabled(bool enabled) override;
+	IGraphicsShader* get_active_shader() override { return current_shader; }
+	void reset_state_cache() override;
+	void set_viewport(int x, int y, int w, int h) override;
+	void clear_framebuffer(bool clear_depth, bool clear_color, float depth_value = 0.f) override;
+	void set_render_pass(const RenderPassState& state) override;
+	void blit_textures(const GraphicsBlitInfo& info) override;
+
+	IGraphicsTexture* create_texture(const CreateTextureArgs& args) override;
+	IGraphicsBuffer* create_buffer(const CreateBufferArgs& args) override;
+	IGraphicsVertexInput* create_vertex_input(const CreateVertexInputArgs& args) override;
+	IGraphicsSampler* create_sampler(const CreateSamplerArgs& args) override;
+
+	void set_scissor(int x, int y, int w, int h) override;
+	void disable_scissor() override;
+
+	void draw_elements_base_vertex(GraphicsPrimitiveType mode, int count, VertexInputIndexType index_type,
+								   int byte_offset, int base_vertex) override;
+	void draw_arrays(GraphicsPrimitiveType mode, int first, int count) override;
+	void draw_elements(GraphicsPrimitiveType mode, int count, VertexInputIndexType index_type,
+					   int byte_offset) override;
+	void draw_elements_instanced_base_vertex_base_instance(GraphicsPrimitiveType mode, int count,
+														   VertexInputIndexType index_type, int byte_offset,
+														   int instance_count, int base_vertex,
+														   uint32_t base_instance) override;
+	void draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type, IGraphicsBuffer* indirect,
+								int byte_offset) override;
+	void multi_draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+									  IGraphicsBuffer* indirect, int byte_offset, int draw_count, int stride,
+									  const void* client_ptr = nullptr) override;
+	void multi_draw_elements_indirect_count(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+											IGraphicsBuffer* indirect, int indirect_byte_offset,
+											IGraphicsBuffer* count, int count_byte_offset, int max_draw_count,
+											int stride) override;
+	void wait_for_gpu_idle() override;
+	IGraphicsFence* insert_fence() override;
+
+	void bind_texture(int slot, IGraphicsTexture* tex) override;
+	void bind_uniform_buffer_base(int slot, IGraphicsBuffer* buf) override;
+	void bind_sampler(int slot, IGraphicsSampler* sampler) override;
+	void bind_storage_buffer_base(int slot, IGraphicsBuffer* buf) override;
+	void bind_storage_buffer_range(int slot, IGraphicsBuffer* buf, int offset, int size) override;
+	void bind_image_for_compute(int slot, IGraphicsTexture* tex, int mip, int layer,
+								GraphicsImageAccess access) override;
+
+	void push_vertex_constants(int slot, const void* data, int size) override;
+	void push_fragment_constants(int slot, const void* data, int size) override;
+	void push_compute_constants(int slot, const void* data, int size) override;
+
+	void begin_compute_pass() override;
+	void dispatch_compute(int groups_x, int groups_y, int groups_z) override;
+	void memory_barrier(uint32_t bits) override;
+	void clear_buffer_uint32(IGraphicsBuffer* buf, uint32_t value) override;
+	void download_buffer(IGraphicsBuffer* buf, int offset, int size, void* dest) override;
+
+	void set_line_width(float width) override;
+	void set_polygon_fill_mode(GraphicsFillMode mode) override;
+	void copy_texture(IGraphicsTexture* src, int src_mip, int src_layer, IGraphicsTexture* dst, int dst_mip,
+					  int dst_layer, int w, int h) override;
+	void copy_texture_rect(const GraphicsBlitInfo& info) override;
+
+	void push_debug_group(const char* name) override;
+	void pop_debug_group() override;
+	IGraphicsTimerQuery* create_timer_query() override;
+
+	void set_vsync(bool enable) override;
+	void imgui_init() override;
+	void imgui_shutdown() override;
+	void imgui_new_frame() override;
+	void imgui_render_draw_data() override;
+	bool imgui_process_event(const union SDL_Event* event) override;
+	void rmlui_init() override;
+	void rmlui_shutdown() override;
+	void rmlui_render(int viewport_w, int viewport_h, IGraphicsTexture* target) override;
+
+	IGraphicsShader* create_shader_vert_frag(const std::string& vert_path, const std::string& frag_path,
+											 const std::string& defines = {}) override;
+	IGraphicsShader* create_shader_vert_frag_geo(const std::string& vert_path, const std::string& frag_path,
+												 const std::string& geo_path, const std::string& defines = {}) override;
+	IGraphicsShader* create_shader_compute(const std::string& compute_path, const std::string& defines = {}) override;
+	IGraphicsShader* create_shader_single_file(const std::string& shared_path,
+											   const std::string& defines = {}) override;
+	IGraphicsShader* create_shader_single_file_tess(const std::string& shared_path,
+													const std::string& defines = {}) override;
+
+	void upload_buffer(IGraphicsBuffer* buf, const void* data, int size) override;
+	void sub_upload_buffer(IGraphicsBuffer* buf, const void* data, int size, int offset) override;
+
+private:
+	// ptr/args meaning depends on op, see the recording functions
+	struct Command
+	{
+		GfxListOp op{};
+		uint8_t e0 = 0; // enum args: primitive mode, push constant stage, image access, fill mode
+		uint8_t e1 = 0; // index type
+		void* ptr0 = nullptr;
+		void* ptr1 = nullptr;
+		int args[6] = {};
+		float f = 0.f;
+	};
+	// render pass with its color targets as an index range into pass_targets
+	struct RecordedPass
+	{
+		RenderPassState state;
+		int first_target = 0;
+		int num_targets = 0;
+	};
+
+	Command& add(GfxListOp op);
+	// copies size bytes into the payload, returns the offset (-1 for no data)
+	int add_payload(const void* data, int size);
+	const void* get_payload(int ofs) const { return ofs >= 0 ? payload.data() + ofs : nullptr; }
+	void push_constants(int stage, int slot, const void* data, int size);
+	IGraphicsDevice& device();
+
+	std::vector<Command> cmds;
+	std::vector<uint8_t> payload;
+	std::vector<RenderPipelineState> pipelines;
+	std::vector<RecordedPass> passes;
+	std::vector<ColorTargetInfo> pass_targets;
+	std::vector<GraphicsBlitInfo> blits; // blit_textures and copy_texture_rect arguments
+	IGraphicsShader* current_shader = nullptr;
+	int num_draws = 0;
+	int num_dispatches = 0;
+};
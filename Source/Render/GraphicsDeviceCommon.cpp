@@ -4,6 +4,7 @@
 // to link against the OpenGL TU to reach these.
 
 #include "IGraphicsDevice.h"
+#include "GraphicsCommandList.h"
 
 IGraphicsDevice* g_gfx_instance = nullptr;
 
@@ -12,9 +13,14 @@ IGraphicsDevice* g_gfx_instance = nullptr;
 // "opengl" default. Read once at startup before window creation; setting it
 // afterward has no effect (documented, not enforced).
 ConfigVar g_render_backend("r.render_backend", "opengl", CVAR_DEV,
-							"Render backend selected at startup: \"opengl\" or \"dx11\". Read before window creation; changing it afterward has no effect.");
+							"Render backend selected at startup: \"opengl\", \"dx11\" or \"null\" (headless, draws nothing). Read before window creation; changing it afterward has no effect.");
+
+// list the calling thread is recording into, see gfx_begin_recording()
+static thread_local IGraphicsDevice* t_recording_list = nullptr;
 
 IGraphicsDevice& gfx() {
+	if (t_recording_list)
+		return *t_recording_list;
 	ASSERT(g_gfx_instance != nullptr);
 	return *g_gfx_instance;
 }
@@ -27,3 +33,14 @@ void gfx_shutdown() {
 		g_gfx_instance = nullptr;
 	}
 }
+
+void gfx_begin_recording(GraphicsCommandList* list) {
+	ASSERT(list != nullptr);
+	ASSERT(t_recording_list == nullptr);
+	t_recording_list = list;
+}
+void gfx_end_recording() {
+	ASSERT(t_recording_list != nullptr);
+	t_recording_list = nullptr;
+}
+bool gfx_is_recording() { return t_recording_list != nullptr; }
@@ -38,6 +38,7 @@ enum class GraphicsDeviceType
 	Unknown,
 	OpenGl,
 	Dx11,
+	Null,
 };
 
 enum GraphicsBufferUseFlags
@@ -47,6 +48,8 @@ enum GraphicsBufferUseFlags
 	BUFFER_USE_AS_STORAGE_READ = 4,
 	BUFFER_USE_AS_INDIRECT = 8,
 	BUFFER_USE_DYNAMIC = 16,
+	// immutable storage mapped for the buffer's lifetime, see IGraphicsBuffer::get_mapped_ptr. upload() isn't legal.
+	BUFFER_USE_PERSISTENT_MAP = 32,
 };
 enum class VertexInputIndexType : int8_t
 {
@@ -207,6 +210,11 @@ public:
 
 	// Returns the current buffer size in bytes (for stats / diagnostics).
 	virtual int get_buf_size() const { return 0; }
+
+	// CPU pointer to the whole buffer for BUFFER_USE_PERSISTENT_MAP buffers, nullptr if the backend can't map
+	// persistently (callers fall back to sub_upload). Writes are coherent: visible to commands issued after them,
+	// no flush needed. The CPU must not overwrite a range the GPU may still read, fence it (insert_fence).
+	virtual uint8_t* get_mapped_ptr() { return nullptr; }
 };
 
 // like a VAO in opengl.
@@ -274,6 +282,19 @@ public:
 	virtual uint64_t read_timestamp_ns() = 0;
 };
 
+// GPU progress marker. Created via gfx().insert_fence(), signals once every command issued before it completed.
+class IGraphicsFence
+{
+public:
+	virtual ~IGraphicsFence() {}
+	virtual void release() = 0;
+
+	// Non-blocking.
+	virtual bool is_signaled() = 0;
+	// Blocks the CPU until signaled.
+	virtual void wait() = 0;
+};
+
 // Standalone sampler object. Bound to a texture slot via gfx().bind_sampler;
 // when bound, it overrides the sampler params baked into the texture itself.
 class IGraphicsSampler
@@ -442,6 +463,8 @@ struct RenderPipelineState
 	ColorWriteMask color_write_masks[MAX_COLOR_ATTACHMENTS]{};
 };
 
+class GraphicsCommandList;
+
 class IGraphicsDevice
 {
 public:
@@ -526,6 +549,10 @@ public:
 	// only; do NOT call on hot paths. Wraps glFlush + glFinish.
 	virtual void wait_for_gpu_idle() = 0;
 
+	// Fence after everything issued so far (glFenceSync / D3D11_QUERY_EVENT). Caller owns it, release() when done.
+	// Used to reuse persistently mapped memory without stalling (GpuUploadRing).
+	virtual IGraphicsFence* insert_fence() = 0;
+
 	// Non-indexed draw. mode + count follow glDrawArrays semantics.
 	virtual void draw_arrays(GraphicsPrimitiveType mode, int first, int count) = 0;
 
@@ -747,6 +774,10 @@ public:
 	virtual void copy_texture(IGraphicsTexture* src, int src_mip, int src_layer,
 							  IGraphicsTexture* dst, int dst_mip, int dst_layer,
 							  int w, int h) = 0;
+	// Same copy for a sub-rect: info.src's rect lands at info.dest.x/y, unscaled
+	// (info.dest.w/h and filter are ignored). Unlike blit_textures this works on
+	// depth formats. A layer of -1 means 0.
+	virtual void copy_texture_rect(const GraphicsBlitInfo& info) = 0;
 
 	// ---- Phase 1.4c wrap surface (orchestration) ---------------------------
 
@@ -787,6 +818,23 @@ public:
 										IGraphicsBuffer* indirect,
 										int byte_offset) = 0;
 
+	// ---- Deferred command lists --------------------------------------------
+	//
+	// Buffer writes that have to land in order with the surrounding commands
+	// (a constant block re-uploaded between dispatches/draws). A device writes
+	// straight into the buffer; a GraphicsCommandList copies the data and does
+	// the write when it's replayed. Code that can run on a recording thread
+	// uses these instead of IGraphicsBuffer::upload/sub_upload.
+	virtual void upload_buffer(IGraphicsBuffer* buf, const void* data, int size) { buf->upload(data, size); }
+	virtual void sub_upload_buffer(IGraphicsBuffer* buf, const void* data, int size, int offset) {
+		buf->sub_upload(data, size, offset);
+	}
+
+	// Replay a list recorded on another thread. Submission thread only, lists
+	// replay in the order they are passed here. Default goes through this
+	// device's own entry points; a backend with native deferred contexts can
+	// override. Defined in GraphicsCommandList.cpp.
+	virtual void execute_command_list(GraphicsCommandList& list);
 };
 
 struct SDL_Window;
@@ -805,6 +853,13 @@ struct SDL_Window;
 // gfx() asserts initialization.
 IGraphicsDevice& gfx();
 bool gfx_is_initialized();
+
+// Deferred recording (Render/GraphicsCommandList.h). While a list is bound on a
+// thread, gfx() on that thread returns the list so unchanged pass code records
+// into it; every other thread still sees the device. Begin/end pair per thread.
+void gfx_begin_recording(GraphicsCommandList* list);
+void gfx_end_recording();
+bool gfx_is_recording();
 void gfx_opengl_pre_window_setup();
 void gfx_init_opengl(SDL_Window* window);
 void gfx_shutdown();
@@ -819,7 +874,7 @@ void gfx_opengl_enable_debug_output();
 // GraphicsDeviceCommon.cpp.
 extern IGraphicsDevice* g_gfx_instance;
 
-// Selects the render backend ("opengl" or "dx11"). Read once at startup
+// Selects the render backend ("opengl", "dx11" or "null"). Read once at startup
 // before window creation (EngineMain_Init.cpp loads EngineVars.ini before
 // init_sdl_window for this reason) — CVAR_READONLY, not changeable at
 // runtime. Defined in GraphicsDeviceCommon.cpp.
@@ -830,4 +885,10 @@ extern ConfigVar g_render_backend;
 // Creates the D3D11 device/context/swapchain (feature level 11_1) and the
 // backbuffer RTV. Tear down via gfx_shutdown().
 void gfx_init_dx11(SDL_Window* window);
-#endif
\ No newline at end of file
+
+// Null backend init (Render/Null/NullDevice.h): no GPU, resources in system
+// memory, every command goes to an inspectable log. The window only supplies
+// the backbuffer size; the engine creates it on SDL's offscreen video driver so
+// nothing needs a display.
+void gfx_init_null(SDL_Window* window);
+#endif
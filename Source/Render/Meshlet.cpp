@@ -1,3 +1,50 @@
-// Meshlet/chunked-mesh prototype is currently disabled (was #if 0). The
-// previous implementation used raw glGenVertexArrays/glBufferData; if/when
-// revived it must build through gfx().create_vertex_input/create_buffer.
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+uint32_t pack_chunk_cone(const int8_t axis[3], int8_t cutoff) {
+	return uint32_t(uint8_t(axis[0])) | (uint32_t(uint8_t(axis[1])) << 8) | (uint32_t(uint8_t(axis[2])) << 16) |
+		   (uint32_t(uint8_t(cutoff)) << 24);
+}
+
+glm::vec3 get_chunk_cone_axis(uint32_t cone) {
+	return glm::vec3(float(int8_t(cone & 0xff)), float(int8_t((cone >> 8) & 0xff)),
+					 float(int8_t((cone >> 16) & 0xff))) /
+		   127.f;
+}
+
+float get_chunk_cone_cutoff(uint32_t cone) {
+	return float(int8_t(cone >> 24)) / 127.f;
+}
+
+int cull_chunks(const Chunk* chunks, int num_chunks, const glm::mat4& transform, const glm::vec4* planes,
+				int num_planes, const glm::vec3* camera_pos, uint32_t* out) {
+	const float max_scale = std::sqrt(std::max(std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+														 glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1]))),
+												glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+	// backfacing is the same in model space for any affine transform, so the cone test uses a model space eye
+	glm::vec3 local_eye(0.f);
+	if (camera_pos)
+		local_eye = glm::vec3(glm::inverse(transform) * glm::vec4(*camera_pos, 1.f));
+
+	int count = 0;
+	for (int i = 0; i < num_chunks; i++) {
+		const Chunk& c = chunks[i];
+		const glm::vec3 center(c.bounding_sphere);
+		const glm::vec3 world_center(transform * glm::vec4(center, 1.f));
+		const float world_radius = c.bounding_sphere.w * max_scale;
+		bool visible = true;
+		for (int j = 0; j < num_planes && visible; j++)
+			visible = glm::dot(glm::vec3(planes[j]), world_center) + planes[j].w >= -world_radius;
+		if (visible && camera_pos) {
+			// every triangle faces away when the eye is outside the cone widened by the sphere
+			const glm::vec3 to_center = center - local_eye;
+			const float dist = std::sqrt(glm::dot(to_center, to_center));
+			const float cutoff = get_chunk_cone_cutoff(c.cone);
+			visible = glm::dot(to_center, get_chunk_cone_axis(c.cone)) < cutoff * dist + c.bounding_sphere.w;
+		}
+		if (visible)
+			out[count++] = i;
+	}
+	return count;
+}
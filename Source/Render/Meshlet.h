@@ -1,46 +1,32 @@
 #pragma once
 #include <cstdint>
 #include "glm/glm.hpp"
-#include <vector>
-using std::vector;
-using namespace glm;
 
+// A cluster of at most MAX_VERTICES verticies and MAX_TRIANGLES triangles of one submesh. The model compiler
+// reorders each submesh's indicies so a chunk's triangles are a contiguous range of the model's index buffer, so a
+// chunk draws with the submesh's base_vertex like the whole part does. Same layout as the gpu side (32 bytes).
 struct Chunk
 {
-	vec4 bounding_sphere;
-	uint32_t cone;
-	uint32_t count;	 // number of indicies in this chunk, max = 64*3
-	uint32_t offset; // offset into model's index buffer
-	uint32_t padding;
-};
+	static const int MAX_VERTICES = 64;
+	static const int MAX_TRIANGLES = 124;
 
-// Meshlet global_meshlet_table[]
-// struct Submesh {
-//	..
-// meshlet_ofs = 0;
-// meshlet_count = 0;
-// ..
-// };
-//
-// uint global_index_buffer[]
-// Vertex global_vertex_buffer[]
-//
-
-struct Subpart_ext
-{
-	uint32_t chunk_count;
-	uint32_t chunk_start;
+	glm::vec4 bounding_sphere; // model space center, radius
+	uint32_t cone;			   // packed normal cone, see pack_chunk_cone
+	uint32_t count;			   // number of indicies in this chunk, max = MAX_TRIANGLES*3
+	uint32_t offset;		   // offset into model's index buffer, in indicies
+	uint32_t padding;
 };
+static_assert(sizeof(Chunk) == 32, "Chunk is mirrored on the gpu");
 
-struct Chunked_Model
-{
-	uint32_t vao;
-	uint32_t indicies_buffer;
-	vector<uint32_t> indicies;
-	vector<Chunk> chunks;
-	vector<Subpart_ext> parts_ext;
-
-	Model* model;
-};
+// axis xyz and cutoff as snorm8 (meshopt's cone_axis_s8/cone_cutoff_s8), cutoff in the high byte.
+// A cutoff of 127 means no triangle can be backface culled with the cone.
+uint32_t pack_chunk_cone(const int8_t axis[3], int8_t cutoff);
+glm::vec3 get_chunk_cone_axis(uint32_t cone);
+float get_chunk_cone_cutoff(uint32_t cone);
 
-// Chunked_Model* get_chunked_mod(const char* filename);
\ No newline at end of file
+// writes the index of every chunk that may be visible to out and returns how many.
+// transform is the model matrix. planes are (normal, d) with dot(normal, p) + d >= 0 on the inside, like Frustum,
+// chunk spheres are tested in world space with the largest axis scale of transform.
+// camera_pos enables the backface cone test, pass null for two sided materials or views without a single eye.
+int cull_chunks(const Chunk* chunks, int num_chunks, const glm::mat4& transform, const glm::vec4* planes,
+				int num_planes, const glm::vec3* camera_pos, uint32_t* out);
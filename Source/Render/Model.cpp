@@ -65,65 +65,6 @@ Model* Model::load(const std::string& path) {
 }
 Model::Model() {}
 
-// FIXME broke
-void ModelMan::compact_memory() {
-#if 0
-	sys_print(Debug, "ModelMan::compact_memory\n");
-	std::vector<Model*> models;
-	models.reserve(all_models.num_used);
-	for (auto m : all_models) {
-		ASSERT(m->uid != 0);
-		models.push_back(m);
-	}
-
-	// [.AA.B...CCC.D.....]
-	// pick last item (D)
-	// for item in list:
-	//		move to end
-	//		wrap ptr
-	// [CCC.........DAAB..]
-
-	// theres an edge case where no models are loaded, but that will never happen (default models)
-
-	// do indices first
-	std::sort(models.begin(), models.end(), [](Model* a, Model* b)->bool
-		{
-			return a->merged_index_pointer < b->merged_index_pointer;
-		});
-	allocator.ibuffer.used_total = models.back()->data.get_num_index_bytes();
-	for (int i = 0; i < models.size() - 1/* skip last */; i++) {
-		int index_ptr = models[i]->merged_index_pointer;
-		allocator.ibuffer.tail = index_ptr;
-		//models[i]->merged_index_pointer = allocator.move_append_i_buffer(index_ptr, models[i]->data.get_num_index_bytes());
-
-		// okay just do it this way, i guess just keep models in CPU memory
-		size_t indiciesbufsize{};
-		const uint8_t* const ibufferdata = models[i]->data.get_index_data(&indiciesbufsize);
-		models[i]->merged_index_pointer = allocator.append_to_i_buffer(ibufferdata, indiciesbufsize);	// dont divide by sizeof(uint16_2), this is an pointer
-
-	}
-
-	// then verts
-	std::sort(models.begin(), models.end(), [](Model* a, Model* b)->bool
-		{
-			return a->merged_vert_offset < b->merged_vert_offset;
-		});
-	allocator.vbuffer.used_total = models.back()->data.get_num_vertex_bytes();
-
-	for (int i = 0; i < models.size() - 1/* skip last */; i++) {
-		int vertex_ptr = models[i]->merged_vert_offset * sizeof(ModelVertex);
-		allocator.vbuffer.tail = vertex_ptr;
-		//models[i]->merged_vert_offset = allocator.move_append_v_buffer(vertex_ptr, models[i]->data.get_num_vertex_bytes());
-		//models[i]->merged_vert_offset /= sizeof(ModelVertex);
-
-		size_t vertbufsize{};
-		const uint8_t* const v_bufferdata = models[i]->data.get_vertex_data(&vertbufsize);
-		models[i]->merged_vert_offset = allocator.append_to_v_buffer(v_bufferdata, vertbufsize);
-		models[i]->merged_vert_offset /= sizeof(ModelVertex);
-	}
-#endif
-}
-
 #ifdef EDITOR_BUILD
 #include "AssetCompile/ModelAsset2.h"
 #include <fstream>
@@ -291,12 +232,14 @@ void ModelMan::add_commands(ConsoleCmdGroup& group) {
 			auto& lod = mod->get_lod(i);
 			int totalV = 0;
 			int totalI = 0;
+			int totalC = 0;
 			for (int p = 0; p < lod.part_count; p++) {
 				totalV += mod->get_part(p + lod.part_ofs).vertex_count;
 				totalI += mod->get_part(p + lod.part_ofs).element_count / MODEL_BUFFER_INDEX_TYPE_SIZE;
+				totalC += mod->get_part(p + lod.part_ofs).meshlet_count;
 			}
-			sys_print(Info, "\t[%d] verts=%d indicies=%d parts=%d fade=%f\n", i, totalV, totalI, lod.part_count,
-					  lod.end_percentage);
+			sys_print(Info, "\t[%d] verts=%d indicies=%d parts=%d chunks=%d fade=%f\n", i, totalV, totalI,
+					  lod.part_count, totalC, lod.end_percentage);
 		}
 		sys_print(Info, "]\n");
 	});
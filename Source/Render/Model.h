@@ -16,6 +16,7 @@
 #include "Framework/MulticastDelegate.h"
 #include "Framework/Reflection2.h"
 #include "GpuAllocator.h"
+#include "Meshlet.h"
 class MaterialInstance;
 using std::string;
 using std::unique_ptr;
@@ -77,6 +78,8 @@ public:
 	int element_count = 0;	// in element size
 	int material_idx = 0;
 	int vertex_count = 0; // in element size
+	int meshlet_ofs = 0;   // first Chunk of this part in the model's chunk list
+	int meshlet_count = 0; // 0 if the part wasn't split into chunks (dynamic models)
 
 	bool is_material_transparent() const { return material_idx & (1 << 30); }
 	int get_material_idx_to_use() const { return material_idx & ~(1 << 30); }
@@ -189,6 +192,9 @@ public:
 	const Bounds& get_bounds() const { return aabb; }
 	const PhysicsBodyDefinition* get_physics_body() const { return collision.get(); }
 	const RawMeshData* get_raw_mesh_data() const { return &data; }
+	// culling clusters of every part, see Submesh::meshlet_ofs
+	const Chunk* get_chunks() const { return chunks.data(); }
+	int get_num_chunks() const { return (int)chunks.size(); }
 	static MulticastDelegate<Model*> on_model_loaded;
 	enum class LightmapType
 	{
@@ -220,6 +226,7 @@ private:
 	InlineVec<MeshLod, 2> lods;
 	float cull_distance = 0.0f; // distance in meters beyond which the model stops rendering entirely; 0 = never cull
 	vector<Submesh> parts;
+	vector<Chunk> chunks;
 	Bounds aabb;
 	glm::vec4 bounding_sphere = glm::vec4(0.f);
 
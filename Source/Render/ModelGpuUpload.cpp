@@ -19,10 +19,20 @@
 #include "Render/MaterialLocal.h"
 #include "DrawLocal.h"
 #include "IGraphicsDevice.h"
+#include "Framework/Profiler.h"
 
 static const int STATIC_VERTEX_SIZE = 4'000'000;
 static const int STATIC_INDEX_SIZE  = 6'000'000;
 
+ConfigVar r_model_compaction("r.model_compaction", "0", CVAR_BOOL | CVAR_DEV,
+							 "relocate models down the shared vertex/index buffers over several frames when they "
+							 "fragment, compact_vertex_buffer runs it once regardless");
+ConfigVar r_model_compaction_threshold("r.model_compaction_threshold", "0.3", CVAR_FLOAT | CVAR_DEV,
+									   "fragmentation (1 - largest free block / free bytes) that starts compaction", 0,
+									   1.0);
+ConfigVar r_model_compaction_bytes("r.model_compaction_bytes", "4000000", CVAR_INTEGER | CVAR_DEV,
+								   "bytes re-uploaded per frame by compaction", 0, 256'000'000);
+
 void MainVbIbAllocator::init(uint32_t num_indicies, uint32_t num_verts) {
 	ASSERT(num_indicies > 0 && num_verts > 0);
 
@@ -68,7 +78,7 @@ gpuAllocSpan MainVbIbAllocator::append_buf_shared(const uint8_t* data, size_t si
 	if (target == GL_ARRAY_BUFFER)
 		align_size = sizeof(ModelVertex);
 
-	const gpuAllocSpan my_ptr = buf.alloc.allocate(size, align_size);
+	const gpuAllocSpan my_ptr = buf.alloc.allocate((int)size, align_size);
 	if (my_ptr.size == 0) // fixme
 		out_of_memory();
 
@@ -80,15 +90,14 @@ gpuAllocSpan MainVbIbAllocator::append_buf_shared(const uint8_t* data, size_t si
 void MainVbIbAllocator::print_usage() const {
 	ASSERT(true); // always callable
 	auto print_facts = [](const char* name, const buffer& b, int element_size) {
-		// float used_percentage = 1.0;
-		// if (b.allocated > 0)
-		//	used_percentage = (double)b.used_total / (double)b.allocated;
-		// used_percentage *= 100.0;
-		//
-		// int used_elements = b.used_total / element_size;
-		// int allocated_elements = b.allocated / element_size;
-		// sys_print(Info, "	%s: %d/%d (%.1f%%) (bytes:%d) (%d:%d)\n", name, used_elements, allocated_elements,
-		// use_percentage, b.used_total, b.tail, b.head);
+		const gpuAllocStats s = b.alloc.get_stats();
+		float used_percentage = 0.0;
+		if (s.total > 0)
+			used_percentage = (double)s.used / (double)s.total * 100.0;
+		sys_print(Info, "	%s: %d/%d elements (%.1f%%) (bytes:%d) (used end:%d)\n", name, s.used / element_size,
+				  s.total / element_size, used_percentage, s.used, s.used_end);
+		sys_print(Info, "	%s: %d spans, %d free blocks, largest free %d, fragmentation %.3f\n", name,
+				  s.num_used_blocks, s.num_free_blocks, s.largest_free, s.get_fragmentation());
 	};
 	sys_print(Info, "MainVbIbAllocator::print_usage\n");
 
@@ -235,6 +244,8 @@ bool ModelMan::upload_model(Model* mesh) {
 
 	// sys_print(Debug, "uploading mode: %s\n", mesh->get_name().c_str());
 
+	compaction_stalled = false;
+
 	if (mesh->parts.size() == 0) {
 		sys_print(Warning, "ModelMan::upload_model: model has not parts (%s)\n", mesh->get_name().c_str());
 		return false;
@@ -276,7 +287,90 @@ void ModelMan::remove_model_from_list(Model* m) {
 	allocator.vbuffer.alloc.free(m->vertex_alloc_ptr);
 	m->index_alloc_ptr = {};
 	m->vertex_alloc_ptr = {};
+	compaction_stalled = false;
 
 	all_models.remove(m);
 	ASSERT(!all_models.find(m));
 }
+
+void ModelMan::compact_memory() {
+	sys_print(Debug, "ModelMan::compact_memory\n");
+	compaction_requested = true;
+	compaction_stalled = false;
+}
+
+// Moves the highest spans of one buffer into the lowest hole below them, re-uploading from the CPU copy in
+// Model::data. Returns true if the budget ran out before it got through the candidates.
+bool ModelMan::compact_buffer(bool vertex, int& budget, int& moved_bytes) {
+	MainVbIbAllocator::buffer& buf = vertex ? allocator.vbuffer : allocator.ibuffer;
+	const int align_size = vertex ? (int)sizeof(ModelVertex) : MODEL_BUFFER_INDEX_TYPE_SIZE;
+	auto span_of = [vertex](Model* m) -> gpuAllocSpan& { return vertex ? m->vertex_alloc_ptr : m->index_alloc_ptr; };
+
+	std::vector<Model*> models;
+	models.reserve(all_models.num_used);
+	for (auto m : all_models)
+		if (span_of(m).size != 0)
+			models.push_back(m);
+	std::sort(models.begin(), models.end(),
+			  [&](Model* a, Model* b) -> bool { return span_of(a).start > span_of(b).start; });
+
+	// allocate_below walks the blocks, a few misses in a row means the top of the buffer is as low as it gets
+	const int MAX_MISSES = 32;
+	int misses = 0;
+	for (Model* m : models) {
+		gpuAllocSpan& span = span_of(m);
+		size_t size{};
+		const uint8_t* const data = vertex ? m->data.get_vertex_data(&size) : m->data.get_index_data(&size);
+		if (!data || size == 0)
+			continue;
+		if ((int)size > budget && moved_bytes > 0) // always move one, a model can be bigger than the budget
+			return true;
+		const gpuAllocSpan moved = buf.alloc.allocate_below((int)size, align_size, span.start);
+		if (moved.size == 0) {
+			if (++misses >= MAX_MISSES)
+				break;
+			continue;
+		}
+		misses = 0;
+		buf.ptr->sub_upload(data, (int)size, moved.aligned_start);
+		buf.alloc.free(span);
+		span = moved;
+		budget -= (int)size;
+		moved_bytes += (int)size;
+	}
+	return false;
+}
+
+void ModelMan::tick_compaction() {
+	auto wants = [&](const MainVbIbAllocator::buffer& b) {
+		if (compaction_requested)
+			return true;
+		if (!r_model_compaction.get_bool() || compaction_stalled)
+			return false;
+		return b.alloc.get_stats().get_fragmentation() > r_model_compaction_threshold.get_float();
+	};
+	const bool do_vertex = wants(allocator.vbuffer);
+	const bool do_index = wants(allocator.ibuffer);
+	if (!do_vertex && !do_index)
+		return;
+
+	CPU_SCOPE("model_compaction");
+	int budget = r_model_compaction_bytes.get_integer();
+	int moved_bytes = 0;
+	bool more_left = false;
+	if (do_vertex)
+		more_left |= compact_buffer(true, budget, moved_bytes);
+	if (do_index)
+		more_left |= compact_buffer(false, budget, moved_bytes);
+
+	if (moved_bytes > 0 && BuildSceneData_CpuFast::inst)
+		BuildSceneData_CpuFast::inst->on_models_relocated();
+	PROF_COUNTER_ADD("model compaction bytes", prof::CounterUnit::Bytes, moved_bytes);
+
+	if (!more_left && moved_bytes == 0) {
+		if (compaction_requested)
+			print_usage();
+		compaction_requested = false;
+		compaction_stalled = true;
+	}
+}
@@ -41,7 +41,7 @@
 #include "GameEnginePublic.h"
 #include "AssetCompile/ModelCompilierLocal.h"
 
-static const int MODEL_FORMAT_VERSION = 19;
+static const int MODEL_FORMAT_VERSION = 21;
 
 extern ConfigVar developer_mode;
 
@@ -86,6 +86,7 @@ void Model::uninstall() {
 	ASSERT(true); // can be called on any Model state
 	lods.resize(0);
 	parts.clear();
+	chunks.clear();
 
 	data = RawMeshData(); // so destructor gets called and memory is freed
 	// Keep the unique_ptr<MSkeleton> alive across reload so anyone caching
@@ -210,6 +211,10 @@ bool Model::load_internal() {
 		tags.push_back(tag);
 	}
 
+	int num_chunks = read.read_int32();
+	chunks.resize(num_chunks);
+	read.read_bytes_ptr(chunks.data(), num_chunks * sizeof(Chunk));
+
 	int num_indicies = read.read_int32();
 	data.indicies.resize(num_indicies);
 	read.read_bytes_ptr(data.indicies.data(), num_indicies * MODEL_BUFFER_INDEX_TYPE_SIZE);
@@ -276,11 +281,22 @@ bool Model::load_internal() {
 				? (float)aseq->num_frames / aseq->duration
 				: 30.f;
 
-			aseq->channel_offsets.resize(num_bones);
-			read.read_bytes_ptr(aseq->channel_offsets.data(), num_bones * sizeof(ChannelOffset));
-			uint32_t packed_size = read.read_int32();
-			aseq->pose_data.resize(packed_size);
-			read.read_bytes_ptr(aseq->pose_data.data(), packed_size * sizeof(float));
+			const bool is_compressed = read.read_byte();
+			if (is_compressed) {
+				CompressedAnimClip& clip = aseq->compressed;
+				clip.num_keyframes = aseq->get_num_keyframes_inclusive();
+				clip.channels.resize(num_bones);
+				read.read_bytes_ptr(clip.channels.data(), num_bones * sizeof(CompressedChannel));
+				uint32_t data_size = read.read_int32();
+				clip.data.resize(data_size);
+				read.read_bytes_ptr(clip.data.data(), data_size);
+			} else {
+				aseq->channel_offsets.resize(num_bones);
+				read.read_bytes_ptr(aseq->channel_offsets.data(), num_bones * sizeof(ChannelOffset));
+				uint32_t packed_size = read.read_int32();
+				aseq->pose_data.resize(packed_size);
+				read.read_bytes_ptr(aseq->pose_data.data(), packed_size * sizeof(float));
+			}
 
 			MSkeleton::refed_clip rc;
 			rc.ptr = aseq;
@@ -46,7 +46,11 @@ public:
 	ModelMan();
 	void init();
 	void add_commands(ConsoleCmdGroup& group);
+	// starts a compaction of the shared vertex/index buffers, tick_compaction() runs it over the next frames
 	void compact_memory();
+	// relocates a budget of model spans into lower holes when compaction was requested or r.model_compaction sees
+	// fragmentation. Same constraints as execute_deferred_model_frees(), called next to it.
+	void tick_compaction();
 	void print_usage() const;
 
 	IGraphicsVertexInput* get_vao_ptr(VaoType type) {
@@ -133,6 +137,10 @@ private:
 	void create_default_models();
 	void set_v_attributes();
 	bool upload_model(Model* m);
+	bool compact_buffer(bool vertex, int& budget, int& moved_bytes);
+
+	bool compaction_requested = false;
+	bool compaction_stalled = false; // nothing could move, retried once the allocations change
 	static void populate_model_from_builder(Model* m, const ModelBuilder& builder);
 
 	IGraphicsVertexInput* animated_vertex_input = nullptr;
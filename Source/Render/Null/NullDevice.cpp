@@ -0,0 +1,559 @@
+// Null backend, see NullDevice.h. Resources are plain heap memory so uploads/readbacks round trip, everything that
+// would reach a GPU is appended to the device's command log and returns.
+
+#include "NullDevice.h"
+#include "Framework/Config.h"
+#include "Framework/Util.h"
+#include "Framework/Profiler.h"
+
+#include <SDL3/SDL.h>
+
+#include "imgui.h"
+#include "imgui_impl_sdl3.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+class NullDeviceImpl;
+NullDeviceImpl* g_null_device = nullptr;
+
+void null_record(NullGfxCmd type, const void* object, int a0 = 0, int a1 = 0, int a2 = 0);
+void null_on_alloc(int64_t bytes);
+
+// bytes per pixel, or per 4x4 block for the compressed formats
+int null_format_bytes(GraphicsTextureFormat fmt) {
+	switch (fmt) {
+	case GraphicsTextureFormat::r8: return 1;
+	case GraphicsTextureFormat::rg8: return 2;
+	case GraphicsTextureFormat::rgb8: return 3;
+	case GraphicsTextureFormat::rgba8: return 4;
+	case GraphicsTextureFormat::r16f: return 2;
+	case GraphicsTextureFormat::rg16f: return 4;
+	case GraphicsTextureFormat::rgb16f: return 6;
+	case GraphicsTextureFormat::rgba16f: return 8;
+	case GraphicsTextureFormat::r32f: return 4;
+	case GraphicsTextureFormat::rg32f: return 8;
+	case GraphicsTextureFormat::bc1:
+	case GraphicsTextureFormat::bc1_srgb:
+	case GraphicsTextureFormat::bc4: return 8;
+	case GraphicsTextureFormat::bc3:
+	case GraphicsTextureFormat::bc5:
+	case GraphicsTextureFormat::bc6:
+	case GraphicsTextureFormat::bc7:
+	case GraphicsTextureFormat::bc7_srgb: return 16;
+	case GraphicsTextureFormat::depth16f: return 2;
+	case GraphicsTextureFormat::depth24f:
+	case GraphicsTextureFormat::depth32f:
+	case GraphicsTextureFormat::depth24stencil8:
+	case GraphicsTextureFormat::r11f_g11f_b10f: return 4;
+	case GraphicsTextureFormat::rgba16_snorm: return 8;
+	}
+	return 4;
+}
+
+class NullBuffer : public IGraphicsBuffer
+{
+public:
+	~NullBuffer() override { null_on_alloc(-(int64_t)bytes.size()); }
+	void release() override { delete this; }
+	uint32_t get_internal_handle() override { return 0; }
+	int get_buf_size() const override { return (int)bytes.size(); }
+
+	void upload(const void* data, int size) override {
+		ASSERT(size >= 0);
+		null_on_alloc((int64_t)size - (int64_t)bytes.size());
+		bytes.assign(size, 0);
+		if (data && size > 0)
+			memcpy(bytes.data(), data, size);
+		null_record(NullGfxCmd::BufferUpload, this, data ? size : 0);
+	}
+	void sub_upload(const void* data, int size, int offset) override {
+		ASSERT(data != nullptr && size >= 0 && offset >= 0);
+		ASSERT(offset + size <= (int)bytes.size());
+		memcpy(bytes.data() + offset, data, size);
+		null_record(NullGfxCmd::BufferUpload, this, size);
+	}
+	uint8_t* get_mapped_ptr() override { return persistent ? bytes.data() : nullptr; }
+
+	std::vector<uint8_t> bytes;
+	bool persistent = false;
+};
+
+class NullTexture : public IGraphicsTexture
+{
+public:
+	explicit NullTexture(const CreateTextureArgs& args) : type(args.type), format(args.format) {
+		width = std::max(args.width, 1);
+		height = std::max(args.height, 1);
+		mips = std::max(args.num_mip_maps, 1);
+		if (type == GraphicsTextureType::tCubemap)
+			layers = 6;
+		else if (type != GraphicsTextureType::t2D)
+			layers = std::max(args.depth_3d, 1); // layer-faces for cubemap arrays, like glTextureStorage3D
+		int ofs = 0;
+		for (int m = 0; m < mips; m++) {
+			mip_ofs.push_back(ofs);
+			ofs += get_layer_size(m) * layers;
+		}
+		storage.assign(ofs, 0);
+		null_on_alloc(ofs);
+	}
+	~NullTexture() override { null_on_alloc(-(int64_t)storage.size()); }
+
+	void release() override { delete this; }
+	uint32_t get_internal_handle() override { return 0; }
+
+	bool is_compressed() const override {
+		return (int)format >= (int)GraphicsTextureFormat::bc1 && (int)format <= (int)GraphicsTextureFormat::bc7_srgb;
+	}
+	int get_num_mips() const override { return mips; }
+	glm::ivec2 get_size() const override { return {width, height}; }
+	GraphicsTextureFormat get_texture_format() const override { return format; }
+	GraphicsTextureType get_texture_type() const override { return type; }
+	int get_compressed_stride() const override {
+		ASSERT(is_compressed());
+		return null_format_bytes(format);
+	}
+	int get_mem_usage() const override { return (int)storage.size(); }
+
+	// "layer" is the mip level here, same as the GL backend
+	void sub_image_upload(int level, int x, int y, int w, int h, int size, const void* data) override {
+		write_region(level, 0, x, y, w, h, size, data);
+	}
+	void sub_image_upload_3d(int z, int level, int x, int y, int w, int h, int size, const void* data) override {
+		write_region(level, z, x, y, w, h, size, data);
+	}
+	void clear_image() override { std::fill(storage.begin(), storage.end(), 0); }
+	void set_mip_range(int base, int max) override { ASSERT(base >= 0 && base <= max); }
+	void generate_mipmaps() override {}
+	void download(int mip, int layer, void* dest, int dest_size_bytes) override {
+		ASSERT(dest != nullptr && dest_size_bytes > 0);
+		ASSERT(mip >= 0 && mip < mips);
+		// callers may ask for a different pixel type than the storage (rgb16f read back as floats), only a size
+		// match copies, anything else reads back zeros
+		const int layer_size = get_layer_size(mip);
+		const int l = std::max(layer, 0);
+		if (dest_size_bytes == layer_size && l < layers)
+			memcpy(dest, storage.data() + mip_ofs[mip] + l * layer_size, layer_size);
+		else
+			memset(dest, 0, dest_size_bytes);
+	}
+
+private:
+	int mip_dim(int v, int mip) const { return std::max(v >> mip, 1); }
+	int get_row_size(int mip, int w) const {
+		if (is_compressed())
+			return ((w + 3) / 4) * null_format_bytes(format);
+		return w * null_format_bytes(format);
+	}
+	int get_rows(int h) const { return is_compressed() ? (h + 3) / 4 : h; }
+	int get_layer_size(int mip) const {
+		return get_row_size(mip, mip_dim(width, mip)) * get_rows(mip_dim(height, mip));
+	}
+
+	void write_region(int mip, int layer, int x, int y, int w, int h, int size, const void* data) {
+		ASSERT(w > 0 && h > 0);
+		null_record(NullGfxCmd::TextureUpload, this, size);
+		if (!data || mip < 0 || mip >= mips || layer < 0 || layer >= layers)
+			return;
+		const int row_size = get_row_size(mip, w);
+		const int rows = get_rows(h);
+		// input in a different pixel type than the storage (float data into a 16f texture) isn't converted
+		if (size != row_size * rows)
+			return;
+		const int layer_row_size = get_row_size(mip, mip_dim(width, mip));
+		const int x_ofs = get_row_size(mip, x);
+		const int y_ofs = is_compressed() ? y / 4 : y;
+		if (x_ofs + row_size > layer_row_size || y_ofs + rows > get_rows(mip_dim(height, mip)))
+			return;
+		uint8_t* base = storage.data() + mip_ofs[mip] + layer * get_layer_size(mip);
+		for (int r = 0; r < rows; r++)
+			memcpy(base + (y_ofs + r) * layer_row_size + x_ofs, (const uint8_t*)data + r * row_size, row_size);
+	}
+
+	GraphicsTextureType type{};
+	GraphicsTextureFormat format{};
+	int width = 1;
+	int height = 1;
+	int mips = 1;
+	int layers = 1;
+	std::vector<int> mip_ofs;
+	std::vector<uint8_t> storage;
+};
+
+class NullVertexInput : public IGraphicsVertexInput
+{
+public:
+	void release() override { delete this; }
+	uint32_t get_internal_handle() override { return 0; }
+};
+
+class NullShader : public IGraphicsShader
+{
+public:
+	void release() override { delete this; }
+	uint32_t get_internal_handle() override { return 0; }
+	Reflection reflect() override { return {}; }
+};
+
+class NullSampler : public IGraphicsSampler
+{
+public:
+	void release() override { delete this; }
+	uint32_t get_internal_handle() override { return 0; }
+};
+
+// Nothing to time: always available and 0, so GPU profiler zones read zero instead of stalling
+class NullTimerQuery : public IGraphicsTimerQuery
+{
+public:
+	void release() override { delete this; }
+	void record_timestamp() override {}
+	bool is_available() override { return true; }
+	uint64_t read_timestamp_ns() override { return 0; }
+};
+
+// Nothing runs, so everything has completed
+class NullFence : public IGraphicsFence
+{
+public:
+	void release() override { delete this; }
+	bool is_signaled() override { return true; }
+	void wait() override {}
+};
+
+class NullDeviceImpl : public NullGraphicsDevice
+{
+public:
+	SDL_Window* window = nullptr;
+	NullTexture* backbuffer = nullptr;
+	RenderPipelineState current_pipeline;
+	IGraphicsShader* current_shader = nullptr;
+
+	~NullDeviceImpl() override {
+		if (backbuffer) {
+			backbuffer->release();
+			backbuffer = nullptr;
+		}
+		// resources released after gfx_shutdown() stop reporting
+		g_null_device = nullptr;
+	}
+
+	GraphicsDeviceType get_device_type() override { return GraphicsDeviceType::Null; }
+
+	void create_backbuffer() {
+		int w = 0, h = 0;
+		SDL_GetWindowSizeInPixels(window, &w, &h);
+		CreateTextureArgs args;
+		args.width = std::max(w, 1);
+		args.height = std::max(h, 1);
+		args.format = GraphicsTextureFormat::rgba8;
+		backbuffer = new NullTexture(args);
+	}
+
+	// ---- Frame lifecycle ---------------------------------------------------
+	void begin_frame() override {}
+	IGraphicsTexture* acquire_swapchain_texture() override {
+		ASSERT(backbuffer != nullptr);
+		return backbuffer;
+	}
+	void submit_and_present() override {
+		PROF_COUNTER_ADD("null gfx draw calls", prof::CounterUnit::Count, stats.draw_calls);
+		PROF_COUNTER_ADD("null gfx dispatches", prof::CounterUnit::Count, stats.get(NullGfxCmd::DispatchCompute));
+		PROF_COUNTER_ADD("null gfx shader changes", prof::CounterUnit::Count, stats.shader_changes);
+		PROF_COUNTER_ADD("null gfx bytes uploaded", prof::CounterUnit::Bytes, stats.bytes_uploaded);
+		last_frame_commands.swap(commands);
+		commands.clear();
+		last_frame_stats = stats;
+		stats = NullGfxFrameStats();
+		frame_count++;
+	}
+
+	// ---- Pipeline state -----------------------------------------------------
+	void set_pipeline(const RenderPipelineState& state) override {
+		if (state.program != current_shader)
+			stats.shader_changes++;
+		current_pipeline = state;
+		current_shader = state.program;
+		record(NullGfxCmd::SetPipeline, state.program, (int)state.blend, state.depth_writes, state.backface_culling);
+	}
+	void set_depth_write_enabled(bool enabled) override { current_pipeline.depth_writes = enabled; }
+	IGraphicsShader* get_active_shader() override { return current_shader; }
+	void reset_state_cache() override { current_shader = nullptr; }
+	void set_viewport(int x, int y, int w, int h) override { record(NullGfxCmd::SetViewport, nullptr, w, h); }
+	void clear_framebuffer(bool clear_depth, bool clear_color, float depth_value) override {
+		record(NullGfxCmd::ClearFramebuffer, nullptr, clear_depth, clear_color);
+	}
+	void set_render_pass(const RenderPassState& state) override {
+		ASSERT(state.color_infos.size() <= RenderPipelineState::MAX_COLOR_ATTACHMENTS);
+		const void* target = state.color_infos.empty() ? (const void*)state.depth_info : state.color_infos[0].texture;
+		record(NullGfxCmd::SetRenderPass, target, (int)state.color_infos.size(), state.depth_info != nullptr);
+	}
+	void blit_textures(const GraphicsBlitInfo& info) override {
+		record(NullGfxCmd::Blit, info.dest.texture, info.dest.w, info.dest.h);
+	}
+
+	IGraphicsTexture* create_texture(const CreateTextureArgs& args) override { return new NullTexture(args); }
+	IGraphicsBuffer* create_buffer(const CreateBufferArgs& args) override {
+		auto buf = new NullBuffer();
+		if (args.size > 0)
+			buf->upload(nullptr, args.size);
+		buf->persistent = (args.flags & BUFFER_USE_PERSISTENT_MAP) != 0;
+		return buf;
+	}
+	IGraphicsVertexInput* create_vertex_input(const CreateVertexInputArgs& args) override {
+		return new NullVertexInput();
+	}
+	IGraphicsSampler* create_sampler(const CreateSamplerArgs& args) override { return new NullSampler(); }
+
+	void set_scissor(int x, int y, int w, int h) override { record(NullGfxCmd::SetScissor, nullptr, w, h); }
+	void disable_scissor() override {}
+
+	// ---- Draws ----------------------------------------------------------------
+	void draw_elements_base_vertex(GraphicsPrimitiveType mode, int count, VertexInputIndexType index_type,
+								   int byte_offset, int base_vertex) override {
+		record(NullGfxCmd::DrawElements, current_shader, count, 1);
+	}
+	void draw_arrays(GraphicsPrimitiveType mode, int first, int count) override {
+		record(NullGfxCmd::DrawArrays, current_shader, count, 1);
+	}
+	void draw_elements(GraphicsPrimitiveType mode, int count, VertexInputIndexType index_type,
+					   int byte_offset) override {
+		record(NullGfxCmd::DrawElements, current_shader, count, 1);
+	}
+	void draw_elements_instanced_base_vertex_base_instance(GraphicsPrimitiveType mode, int count,
+														   VertexInputIndexType index_type, int byte_offset,
+														   int instance_count, int base_vertex,
+														   uint32_t base_instance) override {
+		record(NullGfxCmd::DrawElementsInstanced, current_shader, count, instance_count);
+	}
+	void draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type, IGraphicsBuffer* indirect,
+								int byte_offset) override {
+		record(NullGfxCmd::DrawElementsIndirect, indirect, 1, 1);
+	}
+	void multi_draw_elements_indirect(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+									  IGraphicsBuffer* indirect, int byte_offset, int draw_count, int stride,
+									  const void* client_ptr) override {
+		record(NullGfxCmd::MultiDrawIndirect, indirect, draw_count, draw_count);
+	}
+	void multi_draw_elements_indirect_count(GraphicsPrimitiveType mode, VertexInputIndexType index_type,
+											IGraphicsBuffer* indirect, int indirect_byte_offset,
+											IGraphicsBuffer* count, int count_byte_offset, int max_draw_count,
+											int stride) override {
+		record(NullGfxCmd::MultiDrawIndirectCount, indirect, max_draw_count, max_draw_count);
+	}
+	void wait_for_gpu_idle() override {}
+	IGraphicsFence* insert_fence() override { return new NullFence(); }
+
+	// ---- Binds ------------------------------------------------------------------
+	void bind_texture(int slot, IGraphicsTexture* tex) override { record(NullGfxCmd::BindTexture, tex, slot); }
+	void bind_uniform_buffer_base(int slot, IGraphicsBuffer* buf) override {
+		record(NullGfxCmd::BindUniformBuffer, buf, slot);
+	}
+	void bind_sampler(int slot, IGraphicsSampler* sampler) override { record(NullGfxCmd::BindSampler, sampler, slot); }
+	void bind_storage_buffer_base(int slot, IGraphicsBuffer* buf) override {
+		record(NullGfxCmd::BindStorageBuffer, buf, slot);
+	}
+	void bind_storage_buffer_range(int slot, IGraphicsBuffer* buf, int offset, int size) override {
+		record(NullGfxCmd::BindStorageBuffer, buf, slot, offset, size);
+	}
+	void bind_image_for_compute(int slot, IGraphicsTexture* tex, int mip, int layer,
+								GraphicsImageAccess access) override {
+		record(NullGfxCmd::BindImage, tex, slot, mip, layer);
+	}
+
+	void push_constants_internal(int stage, int slot, const void* data, int size) {
+		ASSERT(slot >= 0 && slot < kGfxMaxPushConstSlotsPerStage);
+		ASSERT(size > 0 && size <= kGfxPushConstMaxBytes);
+		record(NullGfxCmd::PushConstants, nullptr, slot, stage, size);
+	}
+	void push_vertex_constants(int slot, const void* data, int size) override {
+		push_constants_internal(0, slot, data, size);
+	}
+	void push_fragment_constants(int slot, const void* data, int size) override {
+		push_constants_internal(1, slot, data, size);
+	}
+	void push_compute_constants(int slot, const void* data, int size) override {
+		push_constants_internal(2, slot, data, size);
+	}
+
+	// ---- Compute ----------------------------------------------------------------
+	void begin_compute_pass() override { record(NullGfxCmd::BeginComputePass); }
+	void dispatch_compute(int groups_x, int groups_y, int groups_z) override {
+		ASSERT(groups_x >= 0 && groups_y >= 0 && groups_z >= 0);
+		record(NullGfxCmd::DispatchCompute, current_shader, groups_x, groups_y, groups_z);
+	}
+	void memory_barrier(uint32_t bits) override {
+		ASSERT(bits != 0);
+		record(NullGfxCmd::MemoryBarrier, nullptr, (int)bits);
+	}
+	void clear_buffer_uint32(IGraphicsBuffer* buf, uint32_t value) override {
+		ASSERT(buf != nullptr);
+		auto& bytes = ((NullBuffer*)buf)->bytes;
+		for (size_t i = 0; i + 4 <= bytes.size(); i += 4)
+			memcpy(bytes.data() + i, &value, 4);
+		record(NullGfxCmd::ClearBuffer, buf, (int)bytes.size());
+	}
+	void download_buffer(IGraphicsBuffer* buf, int offset, int size, void* dest) override {
+		ASSERT(buf != nullptr && dest != nullptr);
+		auto& bytes = ((NullBuffer*)buf)->bytes;
+		ASSERT(offset >= 0 && offset + size <= (int)bytes.size());
+		memcpy(dest, bytes.data() + offset, size);
+	}
+
+	void set_line_width(float width) override { ASSERT(width > 0.0f); }
+	void set_polygon_fill_mode(GraphicsFillMode mode) override {}
+	void copy_texture(IGraphicsTexture* src, int src_mip, int src_layer, IGraphicsTexture* dst, int dst_mip,
+					  int dst_layer, int w, int h) override {
+		ASSERT(src != nullptr && dst != nullptr);
+		record(NullGfxCmd::CopyTexture, dst, w, h);
+	}
+	void copy_texture_rect(const GraphicsBlitInfo& info) override {
+		ASSERT(info.src.texture != nullptr && info.dest.texture != nullptr);
+		record(NullGfxCmd::CopyTexture, info.dest.texture, info.src.w, info.src.h);
+	}
+
+	void push_debug_group(const char* name) override { record(NullGfxCmd::PushDebugGroup, name); }
+	void pop_debug_group() override { record(NullGfxCmd::PopDebugGroup); }
+	IGraphicsTimerQuery* create_timer_query() override { return new NullTimerQuery(); }
+
+	// ---- Window / vsync / imgui ---------------------------------------------------
+	// ImGui still runs its frame so editor/debug code paths are exercised, the draw data is just dropped
+	void set_vsync(bool enable) override {}
+	void imgui_init() override {
+		ASSERT(window != nullptr);
+		ImGui_ImplSDL3_InitForOther(window);
+		ImGuiIO& io = ImGui::GetIO();
+		io.BackendRendererName = "imgui_impl_null";
+		unsigned char* pixels = nullptr;
+		int w = 0, h = 0;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+		io.Fonts->SetTexID((ImTextureID)0);
+	}
+	void imgui_shutdown() override { ImGui_ImplSDL3_Shutdown(); }
+	void imgui_new_frame() override { ImGui_ImplSDL3_NewFrame(); }
+	void imgui_render_draw_data() override {}
+	bool imgui_process_event(const SDL_Event* event) override {
+		ASSERT(event != nullptr);
+		return ImGui_ImplSDL3_ProcessEvent(event);
+	}
+
+	// No RmlUi renderer, same as DX11
+	void rmlui_init() override { sys_print(Warning, "RmlUi not supported on the null backend\n"); }
+	void rmlui_shutdown() override {}
+	void rmlui_render(int viewport_w, int viewport_h, IGraphicsTexture* target) override {}
+
+	// ---- Shader factory -------------------------------------------------------------
+	IGraphicsShader* create_shader_vert_frag(const std::string& vert_path, const std::string& frag_path,
+											 const std::string& defines) override {
+		return new NullShader();
+	}
+	IGraphicsShader* create_shader_vert_frag_geo(const std::string& vert_path, const std::string& frag_path,
+												 const std::string& geo_path, const std::string& defines) override {
+		return new NullShader();
+	}
+	IGraphicsShader* create_shader_compute(const std::string& compute_path, const std::string& defines) override {
+		return new NullShader();
+	}
+	IGraphicsShader* create_shader_single_file(const std::string& shared_path, const std::string& defines) override {
+		return new NullShader();
+	}
+	IGraphicsShader* create_shader_single_file_tess(const std::string& shared_path,
+													const std::string& defines) override {
+		return new NullShader();
+	}
+};
+
+void null_record(NullGfxCmd type, const void* object, int a0, int a1, int a2) {
+	if (g_null_device)
+		g_null_device->record(type, object, a0, a1, a2);
+}
+void null_on_alloc(int64_t bytes) {
+	if (g_null_device)
+		g_null_device->on_alloc(bytes);
+}
+
+} // namespace
+
+void NullGraphicsDevice::record(NullGfxCmd type, const void* object, int a0, int a1, int a2) {
+	stats.commands[(int)type]++;
+	switch (type) {
+	case NullGfxCmd::DrawArrays:
+	case NullGfxCmd::DrawElements:
+	case NullGfxCmd::DrawElementsInstanced:
+	case NullGfxCmd::DrawElementsIndirect:
+	case NullGfxCmd::MultiDrawIndirect:
+	case NullGfxCmd::MultiDrawIndirectCount:
+		stats.draw_calls++;
+		break;
+	case NullGfxCmd::BufferUpload:
+	case NullGfxCmd::TextureUpload:
+		stats.bytes_uploaded += a0;
+		break;
+	default:
+		break;
+	}
+	if (!log_enabled)
+		return;
+	NullGfxCommand cmd;
+	cmd.type = type;
+	cmd.object = object;
+	cmd.args[0] = a0;
+	cmd.args[1] = a1;
+	cmd.args[2] = a2;
+	commands.push_back(cmd);
+}
+
+const char* null_gfx_cmd_name(NullGfxCmd cmd) {
+	static const char* names[] = {
+		"SetPipeline",
+		"SetRenderPass",
+		"BeginComputePass",
+		"ClearFramebuffer",
+		"SetViewport",
+		"SetScissor",
+		"BindTexture",
+		"BindSampler",
+		"BindImage",
+		"BindUniformBuffer",
+		"BindStorageBuffer",
+		"PushConstants",
+		"DrawArrays",
+		"DrawElements",
+		"DrawElementsInstanced",
+		"DrawElementsIndirect",
+		"MultiDrawIndirect",
+		"MultiDrawIndirectCount",
+		"DispatchCompute",
+		"MemoryBarrier",
+		"BufferUpload",
+		"TextureUpload",
+		"ClearBuffer",
+		"Blit",
+		"CopyTexture",
+		"PushDebugGroup",
+		"PopDebugGroup",
+	};
+	static_assert(sizeof(names) / sizeof(names[0]) == (int)NullGfxCmd::Count, "name per command");
+	const int i = (int)cmd;
+	return (i >= 0 && i < (int)NullGfxCmd::Count) ? names[i] : "?";
+}
+
+NullGraphicsDevice* gfx_get_null_device() {
+	if (!gfx_is_initialized() || gfx().get_device_type() != GraphicsDeviceType::Null)
+		return nullptr;
+	return (NullGraphicsDevice*)g_gfx_instance;
+}
+
+void gfx_init_null(SDL_Window* window) {
+	ASSERT(g_gfx_instance == nullptr);
+	ASSERT(window != nullptr);
+	auto* impl = new NullDeviceImpl();
+	impl->window = window;
+	g_null_device = impl;
+	impl->create_backbuffer();
+	sys_print(Info, "null graphics device created, nothing will be drawn\n");
+	g_gfx_instance = impl;
+}
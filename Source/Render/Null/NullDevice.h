@@ -0,0 +1,104 @@
+#pragma once
+// Null backend (Source/Render/Null/*). Implements IGraphicsDevice without a GPU: buffers and textures live in system
+// memory, draws/dispatches/state changes return immediately after being appended to a command log. Lets the whole
+// Renderer::scene_draw path run headless (r.render_backend "null", the window uses SDL's offscreen video driver) for
+// CPU-side frame benchmarks and draw-call regression tests.
+//
+// Compute never runs, so anything the GPU would write (cull output, MDI count buffers, probe bakes) keeps whatever
+// the CPU last uploaded or cleared it to. Shaders are never compiled, create_shader_* always succeeds.
+
+#include "Render/IGraphicsDevice.h"
+#include <cstdint>
+#include <vector>
+
+enum class NullGfxCmd : uint8_t
+{
+	SetPipeline,
+	SetRenderPass,
+	BeginComputePass,
+	ClearFramebuffer,
+	SetViewport,
+	SetScissor,
+	BindTexture,
+	BindSampler,
+	BindImage,
+	BindUniformBuffer,
+	BindStorageBuffer,
+	PushConstants,
+	DrawArrays,
+	DrawElements,
+	DrawElementsInstanced,
+	DrawElementsIndirect,
+	MultiDrawIndirect,
+	MultiDrawIndirectCount,
+	DispatchCompute,
+	MemoryBarrier,
+	BufferUpload,
+	TextureUpload,
+	ClearBuffer,
+	Blit,
+	CopyTexture,
+	PushDebugGroup,
+	PopDebugGroup,
+	Count,
+};
+const char* null_gfx_cmd_name(NullGfxCmd cmd);
+
+// One log entry. object is the bound/used resource (shader for SetPipeline, buffer for binds/uploads/indirect draws,
+// texture for texture binds), args depend on the command:
+//   draws: args[0] = element/vertex count (or max_draw_count for MDI), args[1] = instance count (draw count for MDI)
+//   binds: args[0] = slot
+//   dispatch: args[0..2] = groups
+//   uploads: args[0] = bytes
+struct NullGfxCommand
+{
+	NullGfxCmd type{};
+	const void* object = nullptr;
+	int args[3] = {};
+};
+
+// Per frame totals, kept even with the log off
+struct NullGfxFrameStats
+{
+	int commands[(int)NullGfxCmd::Count] = {};
+	int draw_calls = 0;		// every draw entry point, an MDI call counts once
+	int64_t bytes_uploaded = 0;
+	int shader_changes = 0; // SetPipeline with a different program than the last one
+
+	int get(NullGfxCmd cmd) const { return commands[(int)cmd]; }
+};
+
+class NullGraphicsDevice : public IGraphicsDevice
+{
+public:
+	// commands since begin_frame()
+	const std::vector<NullGfxCommand>& get_commands() const { return commands; }
+	const NullGfxFrameStats& get_stats() const { return stats; }
+	// the last frame handed to submit_and_present()
+	const std::vector<NullGfxCommand>& get_last_frame_commands() const { return last_frame_commands; }
+	const NullGfxFrameStats& get_last_frame_stats() const { return last_frame_stats; }
+	int get_frame_count() const { return frame_count; }
+
+	// With the log off only the stats are kept, so benchmarks don't pay for the vector
+	void set_log_enabled(bool b) { log_enabled = b; }
+	bool is_log_enabled() const { return log_enabled; }
+
+	// buffer/texture bytes currently allocated
+	int64_t get_allocated_bytes() const { return allocated_bytes; }
+
+	// used by the resources too, uploads go through IGraphicsBuffer/IGraphicsTexture
+	void record(NullGfxCmd type, const void* object = nullptr, int a0 = 0, int a1 = 0, int a2 = 0);
+	void on_alloc(int64_t bytes) { allocated_bytes += bytes; }
+
+protected:
+	std::vector<NullGfxCommand> commands;
+	std::vector<NullGfxCommand> last_frame_commands;
+	NullGfxFrameStats stats;
+	NullGfxFrameStats last_frame_stats;
+	int frame_count = 0;
+	bool log_enabled = true;
+	int64_t allocated_bytes = 0;
+};
+
+// The active device if the null backend is running, else nullptr
+NullGraphicsDevice* gfx_get_null_device();
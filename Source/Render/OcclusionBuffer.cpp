@@ -0,0 +1,227 @@
+#include "OcclusionBuffer.h"
+#include "Framework/Jobs.h"
+#include "Framework/Util.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+// float to int without overflowing on the huge coordinates near clipped triangles can have
+static int to_pixel(float v, int max_value) {
+	return (int)std::clamp(v, -1.f, (float)max_value + 1.f);
+}
+
+void OcclusionBuffer::init(int width, int height) {
+	const int new_tiles_x = (std::max(width, 1) + TILE_WIDTH - 1) / TILE_WIDTH;
+	const int new_tiles_y = (std::max(height, 1) + TILE_HEIGHT - 1) / TILE_HEIGHT;
+	if (new_tiles_x == tiles_x && new_tiles_y == tiles_y)
+		return;
+	tiles_x = new_tiles_x;
+	tiles_y = new_tiles_y;
+	this->width = tiles_x * TILE_WIDTH;
+	this->height = tiles_y * TILE_HEIGHT;
+	blocks_x = this->width / BLOCK_SIZE;
+	depth.assign(this->width * this->height, 0.f);
+	block_depth.assign(blocks_x * (this->height / BLOCK_SIZE), 0.f);
+	tile_bins.resize(tiles_x * tiles_y);
+	tris.clear();
+}
+
+void OcclusionBuffer::begin(const glm::mat4& view_proj, float near) {
+	this->view_proj = view_proj;
+	near_w = near;
+	std::fill(depth.begin(), depth.end(), 0.f);
+	std::fill(block_depth.begin(), block_depth.end(), 0.f);
+	tris.clear();
+	for (auto& bin : tile_bins)
+		bin.clear();
+}
+
+void OcclusionBuffer::add_triangles(const glm::vec3* positions, const uint16_t* indices, int num_indices,
+									const glm::mat4& transform) {
+	ASSERT(num_indices % 3 == 0);
+	const glm::mat4 mvp = view_proj * transform;
+	for (int i = 0; i < num_indices; i += 3) {
+		glm::vec4 clip[3];
+		for (int v = 0; v < 3; v++)
+			clip[v] = mvp * glm::vec4(positions[indices[i + v]], 1.f);
+		add_clipped_triangle(clip);
+	}
+}
+
+// clips against w = near_w, the polygon left over is at most a quad
+void OcclusionBuffer::add_clipped_triangle(const glm::vec4* clip) {
+	float dist[3];
+	int num_inside = 0;
+	for (int i = 0; i < 3; i++) {
+		dist[i] = clip[i].w - near_w;
+		num_inside += dist[i] >= 0.f;
+	}
+	if (num_inside == 3) {
+		add_screen_triangle(clip);
+		return;
+	}
+	if (num_inside == 0)
+		return;
+	glm::vec4 poly[4];
+	int n = 0;
+	for (int i = 0; i < 3; i++) {
+		const int j = (i + 1) % 3;
+		if (dist[i] >= 0.f)
+			poly[n++] = clip[i];
+		if ((dist[i] >= 0.f) != (dist[j] >= 0.f)) {
+			const float t = dist[i] / (dist[i] - dist[j]);
+			poly[n++] = clip[i] + (clip[j] - clip[i]) * t;
+		}
+	}
+	for (int k = 1; k + 1 < n; k++) {
+		const glm::vec4 tri[3] = {poly[0], poly[k], poly[k + 1]};
+		add_screen_triangle(tri);
+	}
+}
+
+void OcclusionBuffer::add_screen_triangle(const glm::vec4* clip) {
+	float sx[3], sy[3];
+	Triangle t;
+	for (int i = 0; i < 3; i++) {
+		const float inv_w = 1.f / clip[i].w;
+		sx[i] = (clip[i].x * inv_w * 0.5f + 0.5f) * width;
+		sy[i] = (clip[i].y * inv_w * 0.5f + 0.5f) * height;
+		t.z[i] = inv_w;
+	}
+	// counter clockwise with y up is positive
+	const float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+	if (!(area > 0.f))
+		return;
+	t.min_x = std::max(0, to_pixel(std::floor(std::min({sx[0], sx[1], sx[2]})), width));
+	t.min_y = std::max(0, to_pixel(std::floor(std::min({sy[0], sy[1], sy[2]})), height));
+	t.max_x = std::min(width - 1, to_pixel(std::ceil(std::max({sx[0], sx[1], sx[2]})), width));
+	t.max_y = std::min(height - 1, to_pixel(std::ceil(std::max({sy[0], sy[1], sy[2]})), height));
+	if (t.min_x > t.max_x || t.min_y > t.max_y)
+		return;
+	// edge i is opposite vertex i, it's 'area' at that vertex and 0 on the other two
+	for (int i = 0; i < 3; i++) {
+		const int a = (i + 1) % 3;
+		const int b = (i + 2) % 3;
+		t.edge_a[i] = sy[a] - sy[b];
+		t.edge_b[i] = sx[b] - sx[a];
+		t.edge_c[i] = -(t.edge_a[i] * sx[a] + t.edge_b[i] * sy[a]);
+	}
+	t.inv_area = 1.f / area;
+
+	const int index = (int)tris.size();
+	tris.push_back(t);
+	for (int ty = t.min_y / TILE_HEIGHT; ty <= t.max_y / TILE_HEIGHT; ty++)
+		for (int tx = t.min_x / TILE_WIDTH; tx <= t.max_x / TILE_WIDTH; tx++)
+			tile_bins[ty * tiles_x + tx].push_back(index);
+}
+
+void OcclusionBuffer::rasterize_tile(int tile) {
+	const int tile_x0 = (tile % tiles_x) * TILE_WIDTH;
+	const int tile_y0 = (tile / tiles_x) * TILE_HEIGHT;
+	const __m128 lane_offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int index : tile_bins[tile]) {
+		const Triangle& t = tris[index];
+		// x starts on a multiple of 4 (tiles are too), lanes outside the triangle fail the edge test
+		const int x0 = std::max(t.min_x, tile_x0) & ~3;
+		const int x1 = std::min(t.max_x, tile_x0 + TILE_WIDTH - 1);
+		const int y0 = std::max(t.min_y, tile_y0);
+		const int y1 = std::min(t.max_y, tile_y0 + TILE_HEIGHT - 1);
+
+		__m128 a[3], step[3], z[3];
+		for (int i = 0; i < 3; i++) {
+			a[i] = _mm_set1_ps(t.edge_a[i]);
+			step[i] = _mm_set1_ps(t.edge_a[i] * 4.f);
+			z[i] = _mm_set1_ps(t.z[i] * t.inv_area);
+		}
+		const __m128 px0 = _mm_add_ps(_mm_set1_ps((float)x0), lane_offset);
+		for (int y = y0; y <= y1; y++) {
+			const float py = y + 0.5f;
+			__m128 e[3];
+			for (int i = 0; i < 3; i++)
+				e[i] = _mm_add_ps(_mm_mul_ps(a[i], px0), _mm_set1_ps(t.edge_b[i] * py + t.edge_c[i]));
+			float* row = depth.data() + y * width;
+			for (int x = x0; x <= x1; x += 4) {
+				const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)),
+												 _mm_cmpge_ps(e[2], zero));
+				if (_mm_movemask_ps(inside) != 0) {
+					// barycentric weights are the edges over the area, folded into z[]
+					const __m128 pixel_z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], z[0]), _mm_mul_ps(e[1], z[1])),
+													  _mm_mul_ps(e[2], z[2]));
+					const __m128 old_z = _mm_loadu_ps(row + x);
+					const __m128 nearer = _mm_max_ps(old_z, pixel_z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old_z)));
+				}
+				for (int i = 0; i < 3; i++)
+					e[i] = _mm_add_ps(e[i], step[i]);
+			}
+		}
+	}
+
+	// farthest depth of each block
+	for (int by = tile_y0; by < tile_y0 + TILE_HEIGHT; by += BLOCK_SIZE) {
+		for (int bx = tile_x0; bx < tile_x0 + TILE_WIDTH; bx += BLOCK_SIZE) {
+			__m128 farthest = _mm_set1_ps(INFINITY);
+			for (int y = by; y < by + BLOCK_SIZE; y++) {
+				const float* row = depth.data() + y * width + bx;
+				farthest = _mm_min_ps(farthest, _mm_min_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + 4)));
+			}
+			alignas(16) float f[4];
+			_mm_store_ps(f, farthest);
+			block_depth[(by / BLOCK_SIZE) * blocks_x + bx / BLOCK_SIZE] = std::min({f[0], f[1], f[2], f[3]});
+		}
+	}
+}
+
+void OcclusionBuffer::rasterize(bool parallel) {
+	const int num_tiles = tiles_x * tiles_y;
+	if (parallel && JobSystem::inst)
+		JobSystem::inst->parallel_for(0, num_tiles, 1, [&](int tile) { rasterize_tile(tile); });
+	else
+		for (int tile = 0; tile < num_tiles; tile++)
+			rasterize_tile(tile);
+}
+
+bool OcclusionBuffer::is_visible(const Bounds& world_aabb) const {
+	float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+	float nearest_z = 0.f;
+	for (int i = 0; i < 8; i++) {
+		const glm::vec3 corner((i & 1) ? world_aabb.bmax.x : world_aabb.bmin.x,
+							   (i & 2) ? world_aabb.bmax.y : world_aabb.bmin.y,
+							   (i & 4) ? world_aabb.bmax.z : world_aabb.bmin.z);
+		const glm::vec4 clip = view_proj * glm::vec4(corner, 1.f);
+		if (clip.w < near_w)
+			return true;
+		const float inv_w = 1.f / clip.w;
+		const float sx = (clip.x * inv_w * 0.5f + 0.5f) * width;
+		const float sy = (clip.y * inv_w * 0.5f + 0.5f) * height;
+		min_x = std::min(min_x, sx);
+		max_x = std::max(max_x, sx);
+		min_y = std::min(min_y, sy);
+		max_y = std::max(max_y, sy);
+		nearest_z = std::max(nearest_z, inv_w);
+	}
+	const int px0 = std::max(0, to_pixel(std::floor(min_x), width));
+	const int py0 = std::max(0, to_pixel(std::floor(min_y), height));
+	const int px1 = std::min(width - 1, to_pixel(std::floor(max_x), width));
+	const int py1 = std::min(height - 1, to_pixel(std::floor(max_y), height));
+	if (px0 > px1 || py0 > py1)
+		return true; // off screen, leave it to the frustum test
+
+	for (int by = py0 / BLOCK_SIZE; by <= py1 / BLOCK_SIZE; by++) {
+		for (int bx = px0 / BLOCK_SIZE; bx <= px1 / BLOCK_SIZE; bx++) {
+			if (block_depth[by * blocks_x + bx] > nearest_z)
+				continue; // everything drawn in this block is in front of the box
+			const int y_end = std::min(py1, by * BLOCK_SIZE + BLOCK_SIZE - 1);
+			const int x_end = std::min(px1, bx * BLOCK_SIZE + BLOCK_SIZE - 1);
+			for (int y = std::max(py0, by * BLOCK_SIZE); y <= y_end; y++) {
+				const float* row = depth.data() + y * width;
+				for (int x = std::max(px0, bx * BLOCK_SIZE); x <= x_end; x++)
+					if (row[x] <= nearest_z)
+						return true;
+			}
+		}
+	}
+	return false;
+}
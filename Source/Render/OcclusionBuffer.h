@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Framework/MathLib.h"
+
+// Small CPU depth buffer for occlusion culling: occluder triangles are rasterized 4 pixels at a time with SSE, then
+// boxes are tested against it. Stores 1/w per pixel (0 where nothing was drawn), which interpolates linearly in
+// screen space and is larger for nearer things.
+//
+// Triangles are clipped against the near plane, backface culled (counter clockwise is front, like the renderer)
+// and binned into TILE_WIDTH x TILE_HEIGHT tiles. rasterize() runs tiles as jobs, a tile only touches its own pixels.
+// Each tile keeps the farthest depth of every BLOCK_SIZE square so most box tests don't look at pixels.
+class OcclusionBuffer
+{
+public:
+	static const int TILE_WIDTH = 64;
+	static const int TILE_HEIGHT = 32;
+	static const int BLOCK_SIZE = 8;
+
+	// size is rounded up to whole tiles, does nothing when that didn't change
+	void init(int width, int height);
+	int get_width() const { return width; }
+	int get_height() const { return height; }
+
+	// clears depth and last frame's triangles. near is the distance the renderer clips at, occluders in front of it
+	// aren't drawn so they don't occlude either.
+	void begin(const glm::mat4& view_proj, float near);
+	// indices are triangles into positions, transform is the object's model matrix
+	void add_triangles(const glm::vec3* positions, const uint16_t* indices, int num_indices,
+					   const glm::mat4& transform);
+	// draws every binned triangle and builds the block depths, tiles run on the job system when parallel
+	void rasterize(bool parallel);
+
+	// false if the box is behind drawn depth everywhere it covers. Boxes crossing the near plane are visible.
+	bool is_visible(const Bounds& world_aabb) const;
+
+	int get_num_triangles() const { return (int)tris.size(); }
+	// width*height 1/w values, rows bottom to top
+	const float* get_depth() const { return depth.data(); }
+
+private:
+	// screen space triangle, edges are A*x + B*y + C and >= 0 inside
+	struct Triangle
+	{
+		float edge_a[3];
+		float edge_b[3];
+		float edge_c[3];
+		float z[3]; // 1/w at each vertex, weighted by the edge opposite it
+		float inv_area;
+		int min_x, min_y, max_x, max_y; // pixel bounds, inclusive
+	};
+	void add_clipped_triangle(const glm::vec4* clip);
+	void add_screen_triangle(const glm::vec4* clip);
+	void rasterize_tile(int tile);
+
+	int width = 0;
+	int height = 0;
+	int tiles_x = 0;
+	int tiles_y = 0;
+	int blocks_x = 0;
+	float near_w = 0.1f;
+	glm::mat4 view_proj = glm::mat4(1.f);
+
+	std::vector<float> depth;
+	std::vector<float> block_depth; // farthest 1/w in each BLOCK_SIZE square
+	std::vector<Triangle> tris;
+	std::vector<std::vector<int>> tile_bins; // triangle indices per tile, kept for their capacity
+};
@@ -15,12 +15,22 @@ public:
 		ASSERT(args.size >= 0);
 		glCreateBuffers(1, &id);
 		usage_type = (args.flags & BUFFER_USE_DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
-		glNamedBufferData(id, args.size, nullptr, usage_type);
+		if (args.flags & BUFFER_USE_PERSISTENT_MAP) {
+			ASSERT(args.size > 0);
+			const GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glNamedBufferStorage(id, args.size, nullptr, map_flags | GL_DYNAMIC_STORAGE_BIT);
+			mapped = (uint8_t*)glMapNamedBufferRange(id, 0, args.size, map_flags);
+			ASSERT(mapped != nullptr);
+		} else {
+			glNamedBufferData(id, args.size, nullptr, usage_type);
+		}
 		this->buffer_size = args.size;
 		opengl_stats.all_buffers.insert(static_cast<IGraphicsBuffer*>(this));
 	}
 
 	~OpenGLBufferImpl() override {
+		if (mapped)
+			glUnmapNamedBuffer(id);
 		glDeleteBuffers(1, &id);
 		opengl_stats.all_buffers.remove(static_cast<IGraphicsBuffer*>(this));
 		// Phase 2c: clear cached indirect/parameter binds so a stale pointer
@@ -32,6 +42,7 @@ public:
 
 	void upload(const void* data, int size) override {
 		ASSERT(size >= 0);
+		ASSERT(!mapped && "OpenGLBufferImpl: persistent buffers have immutable storage");
 		this->buffer_size = size;
 		glNamedBufferData(id, size, data, usage_type);
 	}
@@ -43,9 +54,11 @@ public:
 
 	uint32_t get_internal_handle() override { return id; }
 	int get_buf_size() const override { return buffer_size; }
+	uint8_t* get_mapped_ptr() override { return mapped; }
 
 	int    buffer_size = 0;
 	GLenum usage_type{};
+	uint8_t* mapped = nullptr;
 };
 
 // ---------------------------------------------------------------------------
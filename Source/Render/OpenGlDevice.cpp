@@ -630,22 +630,32 @@ public:
 					  IGraphicsTexture* dst, int dst_mip, int dst_layer,
 					  int w, int h) override {
 		ASSERT(src && dst);
-		auto to_gl_target = [](GraphicsTextureType t) -> GLenum {
-			switch (t) {
-			case GraphicsTextureType::t2D:           return GL_TEXTURE_2D;
-			case GraphicsTextureType::t2DArray:      return GL_TEXTURE_2D_ARRAY;
-			case GraphicsTextureType::t3D:           return GL_TEXTURE_3D;
-			case GraphicsTextureType::tCubemap:      return GL_TEXTURE_CUBE_MAP;
-			case GraphicsTextureType::tCubemapArray: return GL_TEXTURE_CUBE_MAP_ARRAY;
-			}
-			ASSERT(0); return GL_TEXTURE_2D;
-		};
-		glCopyImageSubData(src->get_internal_handle(), to_gl_target(src->get_texture_type()),
+		glCopyImageSubData(src->get_internal_handle(), texture_type_to_gl_target(src->get_texture_type()),
 						   src_mip, 0, 0, src_layer,
-						   dst->get_internal_handle(), to_gl_target(dst->get_texture_type()),
+						   dst->get_internal_handle(), texture_type_to_gl_target(dst->get_texture_type()),
 						   dst_mip, 0, 0, dst_layer,
 						   w, h, 1);
 	}
+	void copy_texture_rect(const GraphicsBlitInfo& info) override {
+		ASSERT(info.src.texture && info.dest.texture);
+		IGraphicsTexture* src = info.src.texture;
+		IGraphicsTexture* dst = info.dest.texture;
+		glCopyImageSubData(src->get_internal_handle(), texture_type_to_gl_target(src->get_texture_type()),
+						   info.src.mip, info.src.x, info.src.y, std::max(info.src.layer, 0),
+						   dst->get_internal_handle(), texture_type_to_gl_target(dst->get_texture_type()),
+						   info.dest.mip, info.dest.x, info.dest.y, std::max(info.dest.layer, 0),
+						   info.src.w, info.src.h, 1);
+	}
+	static GLenum texture_type_to_gl_target(GraphicsTextureType t) {
+		switch (t) {
+		case GraphicsTextureType::t2D:           return GL_TEXTURE_2D;
+		case GraphicsTextureType::t2DArray:      return GL_TEXTURE_2D_ARRAY;
+		case GraphicsTextureType::t3D:           return GL_TEXTURE_3D;
+		case GraphicsTextureType::tCubemap:      return GL_TEXTURE_CUBE_MAP;
+		case GraphicsTextureType::tCubemapArray: return GL_TEXTURE_CUBE_MAP_ARRAY;
+		}
+		ASSERT(0); return GL_TEXTURE_2D;
+	}
 
 	IGraphicsShader* create_shader_vert_frag(const std::string& vert_path,
 											 const std::string& frag_path,
@@ -699,6 +709,7 @@ public:
 		glFlush();
 		glFinish();
 	}
+	IGraphicsFence* insert_fence() override;
 
 	void draw_arrays(GraphicsPrimitiveType mode, int first, int count) override {
 		ASSERT(first >= 0 && count >= 0);
@@ -1083,6 +1094,45 @@ IGraphicsTimerQuery* OpenGLDeviceImpl::create_timer_query() {
 	return new OpenGLTimerQueryImpl();
 }
 
+class OpenGLFenceImpl : public IGraphicsFence
+{
+public:
+	OpenGLFenceImpl() { sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); }
+	~OpenGLFenceImpl() override { glDeleteSync(sync); }
+	void release() override { delete this; }
+
+	bool is_signaled() override {
+		if (signaled)
+			return true;
+		GLint status = GL_UNSIGNALED;
+		glGetSynciv(sync, GL_SYNC_STATUS, 1, nullptr, &status);
+		signaled = status == GL_SIGNALED;
+		return signaled;
+	}
+
+	void wait() override {
+		if (signaled)
+			return;
+		// flush on the first try so the fence itself is submitted, then spin on 1ms timeouts
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		for (;;) {
+			const GLenum res = glClientWaitSync(sync, flags, 1000000);
+			if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED || res == GL_WAIT_FAILED)
+				break;
+			flags = 0;
+		}
+		signaled = true;
+	}
+
+private:
+	GLsync sync = nullptr;
+	bool signaled = false;
+};
+
+IGraphicsFence* OpenGLDeviceImpl::insert_fence() {
+	return new OpenGLFenceImpl();
+}
+
 // ---- Moved from DrawLocal_Debug.cpp so glGetError stays inside the backend.
 bool CheckGlErrorInternal_(const char* file, int line) {
 	// gfx_check_gl_error() call sites are sprinkled through backend-agnostic
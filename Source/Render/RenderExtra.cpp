@@ -7,6 +7,7 @@
 
 ConfigVar shadow_map_quality("r.shadow_map_quality", "0", CVAR_INTEGER, "", 0, 1);
 ConfigVar r_shadows("r.shadows", "1", CVAR_BOOL, "");
+extern ConfigVar r_shadow_cache;
 
 ShadowMapAtlas::ShadowMapAtlas() {
 	ASSERT(gfx_is_initialized());
@@ -26,6 +27,8 @@ ShadowMapAtlas::ShadowMapAtlas() {
 	args.sampler_type = GraphicsSamplerType::AtlasShadowmap;
 	safe_release(atlas);
 	atlas = gfx().create_texture(args);
+	safe_release(static_atlas);
+	static_atlas = gfx().create_texture(args);
 
 	vtsHandle->update_specs_ptr(atlas);
 
@@ -76,6 +79,11 @@ IGraphicsTexture* ShadowMapAtlas::get_atlas_texture() {
 	return atlas;
 }
 
+IGraphicsTexture* ShadowMapAtlas::get_static_texture() {
+	ASSERT(static_atlas != nullptr);
+	return static_atlas;
+}
+
 ShadowMapManager::ShadowMapManager() {
 	ASSERT(gfx_is_initialized());
 	CreateBufferArgs args;
@@ -181,7 +189,9 @@ void ShadowMapManager::get_lights_to_render(std::vector<handle<Render_Light>>& v
 		const bool was_updated = l.updated_this_frame;
 		if (is_alloced && casts_shadow) {
 			// always update static
-			if ((l.light.casts_shadow_mode == 2 && was_updated))
+			// static lights also redraw when static casters changed in their cached layer
+			const bool static_layer_dirty = r_shadow_cache.get_bool() && !static_cache.is_valid(handle);
+			if ((l.light.casts_shadow_mode == 2 && (was_updated || static_layer_dirty)))
 				vec.push_back({handle});
 			else if (l.light.casts_shadow_mode == 1) {
 				if (is_in_frustum(l)) {
@@ -193,9 +203,10 @@ void ShadowMapManager::get_lights_to_render(std::vector<handle<Render_Light>>& v
 	}
 }
 
-void cull_and_draw_spot(Frustum f);
+void cull_and_draw_spot(Frustum f, ShadowCasters casters);
 extern ConfigVar r_spot_near;
-void ShadowMapManager::do_render(Render_Lists& list, handle<Render_Light> handle, bool any_dynamic_in_frustum) {
+void ShadowMapManager::do_render(Render_Lists& list, handle<Render_Light> handle, bool any_dynamic_in_frustum,
+								 bool use_static_layer, bool redraw_static_layer) {
 	ASSERT(gfx_is_initialized());
 
 	if (!r_shadows.get_bool())
@@ -207,16 +218,8 @@ void ShadowMapManager::do_render(Render_Lists& list, handle<Render_Light> handle
 	{
 		auto& device = draw.get_device();
 
-		RenderPassState pass_setup;
-		pass_setup.depth_info = atlas.get_atlas_texture();
-		gfx().set_render_pass(pass_setup);
-
 		assert(light.shadow_array_handle != -1);
 		Rect2d rect = atlas.get_atlas_rect(light.shadow_array_handle);
-		device.set_viewport(rect.x, rect.y, rect.w, rect.h);
-		gfx().set_scissor(rect.x, rect.y, rect.w, rect.h);
-		device.clear_framebuffer(true, true, 0.f /* depth value of 0.f to clear*/);
-		gfx().disable_scissor();
 
 		View_Setup viewSetup;
 		viewSetup.width = rect.w;
@@ -225,6 +228,42 @@ void ShadowMapManager::do_render(Render_Lists& list, handle<Render_Light> handle
 		viewSetup.far = light.light.radius;
 		viewSetup.viewproj = light.lightViewProj;
 
+		// the light's rect of target, cleared unless the static casters were copied in
+		auto begin_pass = [&](IGraphicsTexture* target, bool clear) {
+			RenderPassState pass_setup;
+			pass_setup.depth_info = target;
+			gfx().set_render_pass(pass_setup);
+
+			device.set_viewport(rect.x, rect.y, rect.w, rect.h);
+			if (clear) {
+				gfx().set_scissor(rect.x, rect.y, rect.w, rect.h);
+				device.clear_framebuffer(true, true, 0.f /* depth value of 0.f to clear*/);
+				gfx().disable_scissor();
+			}
+		};
+
+		if (use_static_layer && redraw_static_layer) {
+			// static casters of the fast path only, the regular path list is drawn every frame below
+			begin_pass(atlas.get_static_texture(), true);
+			Render_Level_Params params(viewSetup, nullptr, nullptr, Render_Level_Params::SHADOWMAP);
+			params.provied_constant_buffer = frame_view;
+			params.upload_constants = true;
+			params.offset_poly_units = -3;
+			draw.render_level_to_target(params);
+
+			cull_and_draw_spot(build_frustum_for_light(light), ShadowCasters::Static);
+		}
+		if (use_static_layer) {
+			GraphicsBlitInfo copy;
+			copy.src.texture = atlas.get_static_texture();
+			copy.dest.texture = atlas.get_atlas_texture();
+			copy.src.x = copy.dest.x = rect.x;
+			copy.src.y = copy.dest.y = rect.y;
+			copy.set_width_height_both(rect.w, rect.h);
+			gfx().copy_texture_rect(copy);
+		}
+		begin_pass(atlas.get_atlas_texture(), !use_static_layer);
+
 		Render_Level_Params params(viewSetup, &list, &draw.scene.shadow_pass, Render_Level_Params::SHADOWMAP);
 
 		params.provied_constant_buffer = frame_view;
@@ -232,12 +271,28 @@ void ShadowMapManager::do_render(Render_Lists& list, handle<Render_Light> handle
 		params.offset_poly_units = -3;
 		draw.render_level_to_target(params);
 
-		cull_and_draw_spot(build_frustum_for_light(light));
+		cull_and_draw_spot(build_frustum_for_light(light),
+						   use_static_layer ? ShadowCasters::Dynamic : ShadowCasters::All);
 	}
 }
 
+bool ShadowMapManager::begin_static_layer(handle<Render_Light> handle) {
+	if (!r_shadows.get_bool()) {
+		static_cache.remove_layer(handle.id); // do_render draws nothing, so nothing is cached
+		return true;
+	}
+	auto& light = draw.scene.light_list.get(handle.id);
+	ASSERT(light.shadow_array_handle != -1);
+	const Rect2d rect = atlas.get_atlas_rect(light.shadow_array_handle);
+	const Frustum f = build_frustum_for_light(light);
+	const glm::vec4 planes[5] = {f.top_plane, f.bot_plane, f.left_plane, f.right_plane, f.back_plane};
+	return static_cache.begin_layer(handle.id, light.lightViewProj, glm::ivec4(rect.x, rect.y, rect.w, rect.h),
+									planes, 5);
+}
+
 void ShadowMapManager::on_remove_light(handle<Render_Light> h) {
 	ASSERT(h.id >= 0);
+	static_cache.remove_layer(h.id);
 	auto& light = draw.scene.light_list.get(h.id);
 	if (light.shadow_array_handle != -1) {
 		atlas.free(light.shadow_array_handle);
@@ -6,6 +6,7 @@
 #include "../Shaders/SharedGpuTypes.txt"
 #include "DrawTypedefs.h"
 #include "IGraphicsDevice.h"
+#include "StaticShadowCache.h"
 #include <unordered_map>
 
 class Volumetric_Fog_System
@@ -66,6 +67,8 @@ public:
 	void free(int handle);
 	Rect2d get_atlas_rect(int handle);
 	IGraphicsTexture* get_atlas_texture();
+	// same size and layout as the atlas, holds the static casters of cached lights (StaticShadowCache)
+	IGraphicsTexture* get_static_texture();
 	glm::ivec2 get_size() { return atlas_size; }
 	bool has_any_free() const {
 		for (auto& r : rects) {
@@ -86,6 +89,7 @@ private:
 	std::vector<Available> rects;
 	glm::ivec2 atlas_size = {0, 0};
 	IGraphicsTexture* atlas = nullptr;
+	IGraphicsTexture* static_atlas = nullptr;
 	Texture* vtsHandle = nullptr;
 };
 #include "Render_Light.h"
@@ -97,12 +101,19 @@ public:
 	ShadowMapManager();
 	void update();
 	void get_lights_to_render(std::vector<handle<Render_Light>>& vec);
-	void do_render(Render_Lists& list, handle<Render_Light> handle, bool any_dynamic_in_frustum);
+	// use_static_layer copies the light's cached static casters in and only draws the dynamic ones, after drawing
+	// the static casters into the cache first when redraw_static_layer
+	void do_render(Render_Lists& list, handle<Render_Light> handle, bool any_dynamic_in_frustum,
+				   bool use_static_layer = false, bool redraw_static_layer = false);
+	// true if the light's static layer has to be redrawn before use, see StaticShadowCache::begin_layer
+	bool begin_static_layer(handle<Render_Light> handle);
 	void on_remove_light(handle<Render_Light> h);
 	ShadowMapAtlas& get_atlas() { return atlas; }
+	StaticShadowCache& get_static_cache() { return static_cache; }
 
 private:
 	ShadowMapAtlas atlas;
+	StaticShadowCache static_cache; // keyed by light handle
 	IGraphicsBuffer* frame_view = nullptr;
 };
 
@@ -130,7 +141,11 @@ class CascadeShadowMapSystem
 public:
 	void init();
 	void update_matricies();
-	void render_cascades();
+	// use_static_layer: copies the cascade's static casters from texture.static_array and draws only the dynamic
+	// ones, redraw_static_layer draws the static casters into it first
+	void render_cascade(int i, bool use_static_layer = false, bool redraw_static_layer = false);
+	// true if cascade i's static layer has to be redrawn before use, see StaticShadowCache::begin_layer
+	bool begin_static_layer(int i);
 
 	void make_csm_rendertargets();
 	void update_cascade(int idx, const View_Setup& vs, glm::vec3 directional_dir);
@@ -147,9 +162,12 @@ public:
 	struct textures
 	{
 		IGraphicsTexture* shadow_array = nullptr;
+		IGraphicsTexture* static_array = nullptr; // static casters of each cascade, same layout as shadow_array
 		Texture* shadow_vts_handle = nullptr;
 	} texture;
 
+	StaticShadowCache static_cache; // keyed by cascade index
+
 	struct params
 	{
 		bool cull_front_faces = false;
@@ -88,15 +88,6 @@ void Render_Pass::add_object(const Render_Object& proxy, handle<Render_Object> h
 
 #include <iterator>
 void Render_Pass::make_batches(Render_Scene& scene) {
-	const auto& merge_functor = [](const Pass_Object& a, const Pass_Object& b) {
-		if (a.sort_key.as_uint64() < b.sort_key.as_uint64())
-			return true;
-		else if (a.sort_key.as_uint64() == b.sort_key.as_uint64())
-			return a.submesh_index < b.submesh_index;
-		else
-			return false;
-	};
-
 	// objects were added correctly in back to front order, just sort by layer
 	const auto& sort_functor_transparent = [](const Pass_Object& a, const Pass_Object& b) {
 		if (a.sort_key.blending != b.sort_key.blending)
@@ -110,8 +101,19 @@ void Render_Pass::make_batches(Render_Scene& scene) {
 
 	if (type == pass_type::TRANSPARENT)
 		std::sort(objects.begin(), objects.end(), sort_functor_transparent);
-	else
-		std::sort(objects.begin(), objects.end(), merge_functor);
+	else {
+		// sort by key then submesh
+		const int count = (int)objects.size();
+		sort_items.resize(count);
+		sort_scratch.resize(count);
+		for (int i = 0; i < count; i++)
+			sort_items[i] = {objects[i].sort_key.as_uint64(), (uint32_t)objects[i].submesh_index, (uint32_t)i};
+		radix_sort_draw_keys(sort_items, sort_scratch);
+		sorted_objects.resize(count);
+		for (int i = 0; i < count; i++)
+			sorted_objects[i] = objects[sort_items[i].index];
+		objects.swap(sorted_objects);
+	}
 
 	batches.clear();
 	mesh_batches.clear();
@@ -319,6 +321,12 @@ void Render_Scene::update_obj(handle<Render_Object> handle, const Render_Object&
 	ASSERT(!eng->get_is_in_overlapped_period());
 	ROP_Internal& in = proxy_list.get(handle.id);
 
+	const bool was_static_caster = in.is_static_caster();
+	const Bounds old_caster_bounds = was_static_caster ? proxy_tree.get_fat_aabb(in.tree_proxy) : Bounds();
+	const bool changed = !in.has_init || in.proxy.transform != proxy.transform || in.proxy.model != proxy.model ||
+						 in.proxy.mat_override != proxy.mat_override || in.proxy.visible != proxy.visible ||
+						 in.proxy.shadow_caster != proxy.shadow_caster;
+
 	if (!(in.proxy.model == proxy.model && in.proxy.mat_override == proxy.mat_override)) {
 		int parts = 0;
 		if (proxy.model) {
@@ -357,7 +365,48 @@ void Render_Scene::update_obj(handle<Render_Object> handle, const Render_Object&
 								   glm::max(glm::length(proxy.transform[1]), glm::length(proxy.transform[2])));
 		float radius = sphere.w * max_scale;
 		in.bounding_sphere_and_radius = glm::vec4(glm::vec3(center), radius);
+		proxy_bounds.set(handle.id, in.bounding_sphere_and_radius);
+
+		const Bounds world_aabb = transform_bounds(proxy.transform, proxy.model->get_bounds());
+		if (in.tree_proxy == -1)
+			in.tree_proxy = proxy_tree.insert(world_aabb, handle.id);
+		else
+			proxy_tree.move(in.tree_proxy, world_aabb);
+	} else if (in.tree_proxy != -1) {
+		proxy_tree.remove(in.tree_proxy);
+		in.tree_proxy = -1;
+	}
+
+	if (changed) {
+		in.moved_frame = shadow_frame;
+		if (!in.dynamic_caster) {
+			in.dynamic_caster = true;
+			settling_casters.push_back(handle.id);
+		}
 	}
+	// its depth is in the static layers where it used to be
+	if (was_static_caster && !in.is_static_caster())
+		add_static_shadow_dirty(old_caster_bounds);
+}
+
+void Render_Scene::update_shadow_casters(int settle_frames) {
+	shadow_frame += 1;
+	int kept = 0;
+	for (int h : settling_casters) {
+		if (!proxy_list.check_handle(h))
+			continue;
+		ROP_Internal& in = proxy_list.get(h);
+		if (!in.dynamic_caster)
+			continue;
+		if (shadow_frame - in.moved_frame < settle_frames) {
+			settling_casters[kept++] = h;
+			continue;
+		}
+		in.dynamic_caster = false;
+		if (in.is_static_caster())
+			add_static_shadow_dirty(proxy_tree.get_fat_aabb(in.tree_proxy));
+	}
+	settling_casters.resize(kept);
 }
 uint16_t Render_Scene::register_compact_batch(Model* m, MaterialInstance* mat, int capacity, bool is_dynamic,
 											   bool casts_shadow) {
@@ -385,6 +434,12 @@ void Render_Scene::update_light(handle<Render_Light> handle, const Render_Light&
 	l.light = proxy;
 	l.updated_this_frame = true;
 
+	const Bounds light_aabb(proxy.position - glm::vec3(proxy.radius), proxy.position + glm::vec3(proxy.radius));
+	if (l.tree_proxy == -1)
+		l.tree_proxy = light_tree.insert(light_aabb, handle.id);
+	else
+		light_tree.move(l.tree_proxy, light_aabb);
+
 	if (l.light.casts_shadow_mode != 0 && l.light.is_spotlight) {
 		auto& p = l.light.position;
 		auto& n = l.light.normal;
@@ -410,6 +465,9 @@ void Render_Scene::remove_light(handle<Render_Light>& handle) {
 	if (!handle.is_valid())
 		return;
 	draw.spotShadows->on_remove_light(handle);
+	auto& l = light_list.get(handle.id);
+	if (l.tree_proxy != -1)
+		light_tree.remove(l.tree_proxy);
 	light_list.free(handle.id);
 	handle = {-1};
 }
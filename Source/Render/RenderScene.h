@@ -11,6 +11,9 @@
 #include "Render/MaterialLocal.h"
 
 #include "Framework/FreeList.h"
+#include "Framework/DynamicAabbTree.h"
+#include "Render/FrustumCullSimd.h"
+#include "Render/DrawKeySort.h"
 
 #include "../Shaders/SharedGpuTypes.txt"
 
@@ -111,6 +114,12 @@ public:
 	std::vector<Pass_Object> objects;	  // geometry + material id + object id
 	std::vector<Mesh_Batch> mesh_batches; // glDrawElementsIndirect()
 	std::vector<Multidraw_Batch> batches; // glMultiDrawElementsIndirect()
+
+private:
+	// radix sort buffers, kept between frames so the per frame sort doesn't allocate
+	std::vector<DrawKeySortItem> sort_items;
+	std::vector<DrawKeySortItem> sort_scratch;
+	std::vector<Pass_Object> sorted_objects;
 };
 // RenderObject internal data
 struct ROP_Internal
@@ -119,9 +128,20 @@ struct ROP_Internal
 	glm::mat4 prev_transform{};
 	int prev_bone_ofs = 0;
 	glm::vec4 bounding_sphere_and_radius;
+	int tree_proxy = -1; // Render_Scene::proxy_tree leaf, -1 without a model
 	int16_t fastcpu_index = -1;
 	bool has_init = false;
 	bool has_transparents = false;
+	// moved (or changed model/visibility) in the last r.shadow_cache_settle_frames, its shadow is redrawn every frame
+	// instead of cached, see Render_Scene::update_shadow_casters
+	bool dynamic_caster = false;
+	int moved_frame = 0;
+
+	// drawn into the cached static shadow layers (StaticShadowCache), only fast path casters are
+	bool is_static_caster() const {
+		return proxy.model && proxy.visible && proxy.shadow_caster && fastcpu_index >= 0 && tree_proxy != -1 &&
+			   !dynamic_caster && proxy.animator_bone_ofs < 0;
+	}
 };
 
 // RenderLight internal data
@@ -133,6 +153,7 @@ struct RL_Internal
 	bool updated_this_frame = false;
 	glm::mat4 lightViewProj = glm::mat4(1.f);
 	glm::vec4 cookie_atlas{};
+	int tree_proxy = -1; // Render_Scene::light_tree leaf
 };
 struct RDecal_Internal
 {
@@ -257,6 +278,7 @@ public:
 	handle<Render_Object> register_obj() override {
 		ASSERT(!eng->get_is_in_overlapped_period());
 		handle<Render_Object> handle = {proxy_list.make_new()};
+		proxy_bounds.clear(handle.id);
 		return handle;
 	}
 	void update_obj(handle<Render_Object> handle, const Render_Object& proxy) override;
@@ -275,7 +297,13 @@ public:
 			return;
 		}
 		if (handle.is_valid()) {
+			ROP_Internal& in = proxy_list.get(handle.id);
+			if (in.is_static_caster())
+				add_static_shadow_dirty(proxy_tree.get_fat_aabb(in.tree_proxy));
+			if (in.tree_proxy != -1)
+				proxy_tree.remove(in.tree_proxy);
 			proxy_list.free(handle.id);
+			proxy_bounds.clear(handle.id);
 		}
 		handle = {-1};
 	}
@@ -551,7 +579,9 @@ public:
 	}
 
 	void build_scene_data(bool skybox_only, bool is_for_editor, bool cubemap_view);
-	void update_spotlight_data();
+	// Picks the spot lights that redraw their shadow this frame and builds spotLightShadowList for them. The passes
+	// themselves are ShadowMapManager::do_render, one per light (see Renderer::begin_shadow_recording).
+	void prepare_spot_shadows(std::vector<handle<Render_Light>>& lights);
 
 	// Rebuilds and re-uploads gpu_instance_buffer (every proxy's current/previous transform
 	// and bone offset) from the current proxy_list state, without touching the gbuffer/shadow/
@@ -562,6 +592,31 @@ public:
 	// until next frame's build_scene_data() happens to run.
 	void sync_gpu_object_transforms();
 
+	// Static shadow caster tracking for the cached shadow layers. Casters that changed are dynamic until they have
+	// been still for settle_frames, then they move back into the static layers. Every static caster that appears,
+	// disappears or starts moving adds its box to static_shadow_dirty, Renderer::begin_shadow_recording redraws the
+	// layers those touch and clears it. Called once per frame before the fast path gathers its cull objects.
+	void update_shadow_casters(int settle_frames);
+	void add_static_shadow_dirty(const Bounds& b) {
+		if ((int)static_shadow_dirty.size() >= MAX_STATIC_SHADOW_DIRTY) {
+			static_shadow_dirty.clear();
+			static_shadow_dirty_all = true;
+		}
+		if (!static_shadow_dirty_all)
+			static_shadow_dirty.push_back(b);
+	}
+	// for changes without a box, like the fast path's static compact instances
+	void invalidate_static_shadows() { static_shadow_dirty_all = true; }
+	void clear_static_shadow_dirty() {
+		static_shadow_dirty.clear();
+		static_shadow_dirty_all = false;
+	}
+	static const int MAX_STATIC_SHADOW_DIRTY = 1024;
+	std::vector<Bounds> static_shadow_dirty;
+	bool static_shadow_dirty_all = false;
+	std::vector<int> settling_casters; // handles of dynamic casters, can hold freed or repeated ones
+	int shadow_frame = 0;
+
 	void refresh_static_mesh_data(bool is_for_editor);
 	RSunInternal* get_main_directional_light();
 
@@ -606,6 +661,12 @@ public:
 	Lightmap_Object lightmapObj;
 
 	Free_List<ROP_Internal> proxy_list;
+	// ROP_Internal::bounding_sphere_and_radius by handle id, for the SIMD frustum test in the fast path
+	SphereBoundsSoA proxy_bounds;
+	// world boxes of proxies with a model and of lights, user data is the handle id. Kept up to date by
+	// update_obj/remove_obj and update_light/remove_light, culling queries these instead of walking the lists.
+	DynamicAabbTree proxy_tree;
+	DynamicAabbTree light_tree;
 	Free_List<MeshbuilderObj_Internal> meshbuilder_objs;
 	Free_List<RL_Internal> light_list;
 	Free_List<RDecal_Internal> decal_list;
@@ -57,6 +57,9 @@ void CascadeShadowMapSystem::make_csm_rendertargets() {
 	args.sampler_type = GraphicsSamplerType::CsmShadowmap;
 	safe_release(texture.shadow_array);
 	texture.shadow_array = gfx().create_texture(args);
+	safe_release(texture.static_array);
+	texture.static_array = gfx().create_texture(args);
+	static_cache.invalidate_all();
 
 	// glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture.shadow_array);
 	// glTextureStorage3D(texture.shadow_array, 1, GL_DEPTH_COMPONENT32F, csm_resolution, csm_resolution, 4);
@@ -81,53 +84,67 @@ static glm::vec4 CalcPlaneSplits(float near, float far, float log_lin_lerp) {
 	return planedistances;
 }
 #include "Render/Render_Sun.h"
-extern void cull_and_draw_cascade_fucker(int idx);
-void CascadeShadowMapSystem::render_cascades() {
-	// now setup scene for rendering
-	// glBindFramebuffer(GL_FRAMEBUFFER, fbo.shadow);
-	{
-		GPU_SCOPE("render_csm");
-
-		auto& device = draw.get_device();
-		// RenderPassSetup setup("shadowmap", fbo.shadow, false, false /* clear it below */, 0, 0, csm_resolution,
-		// csm_resolution); auto scope = device.start_render_pass(setup);
-		const int CASCADES_USED = CascadeShadowMapSystem::CASCADES_USED;
-
-		for (int i = 0; i < CASCADES_USED; i++) {
-
-			RenderPassState state;
-			state.depth_info = texture.shadow_array;
-			state.depth_layer = i;
-			state.clear_depth_val = 1.f;
-			state.wants_depth_clear = true;
-			gfx().set_render_pass(state);
-
-			// glNamedFramebufferTextureLayer(fbo.shadow, GL_DEPTH_ATTACHMENT,
-			// texture.shadow_array->get_internal_handle(), 0, i);
-
-			device.set_viewport(0, 0, csm_resolution, csm_resolution);
+#include "Render/Frustum.h"
+extern void cull_and_draw_cascade_fucker(int idx, ShadowCasters casters);
+// One cascade, issued through gfx() so it can be recorded into a command list (Renderer::begin_shadow_recording)
+void CascadeShadowMapSystem::render_cascade(int i, bool use_static_layer, bool redraw_static_layer) {
+	ASSERT(i >= 0 && i < CASCADES_USED);
+	auto& device = draw.get_device();
+	// RenderPassSetup setup("shadowmap", fbo.shadow, false, false /* clear it below */, 0, 0, csm_resolution,
+	// csm_resolution); auto scope = device.start_render_pass(setup);
+
+	auto draw_casters = [&](IGraphicsTexture* target, bool clear, ShadowCasters casters) {
+		RenderPassState state;
+		state.depth_info = target;
+		state.depth_layer = i;
+		state.clear_depth_val = 1.f;
+		state.wants_depth_clear = clear;
+		gfx().set_render_pass(state);
+
+		// glNamedFramebufferTextureLayer(fbo.shadow, GL_DEPTH_ATTACHMENT,
+		// texture.shadow_array->get_internal_handle(), 0, i);
+
+		device.set_viewport(0, 0, csm_resolution, csm_resolution);
+		if (clear)
 			device.clear_framebuffer(true, true, 1.f /* depth value of 1.f to clear*/);
 
-			View_Setup setup;
-			setup.width = csm_resolution;
-			setup.height = csm_resolution;
-			setup.near = nearplanes[i];
-			setup.far = farplanes[i];
-			setup.viewproj = matricies[i];
-			setup.view = setup.proj = mat4(1); // unused
+		View_Setup setup;
+		setup.width = csm_resolution;
+		setup.height = csm_resolution;
+		setup.near = nearplanes[i];
+		setup.far = farplanes[i];
+		setup.viewproj = matricies[i];
+		setup.view = setup.proj = mat4(1); // unused
 
-			Render_Level_Params params(setup, nullptr, nullptr, Render_Level_Params::SHADOWMAP);
-			// params.rl_cpufast =
+		Render_Level_Params params(setup, nullptr, nullptr, Render_Level_Params::SHADOWMAP);
+		// params.rl_cpufast =
 
-			params.provied_constant_buffer = ubo.frame_view[i];
-			params.upload_constants = true;
-			params.wants_non_reverse_z = true;
-			params.offset_poly_units = 1;
-			draw.render_level_to_target(params);
+		params.provied_constant_buffer = ubo.frame_view[i];
+		params.upload_constants = true;
+		params.wants_non_reverse_z = true;
+		params.offset_poly_units = 1;
+		draw.render_level_to_target(params);
 
-			cull_and_draw_cascade_fucker(i);
-		}
+		cull_and_draw_cascade_fucker(i, casters);
+	};
+
+	if (!use_static_layer) {
+		draw_casters(texture.shadow_array, true, ShadowCasters::All);
+		return;
 	}
+	if (redraw_static_layer)
+		draw_casters(texture.static_array, true, ShadowCasters::Static);
+	gfx().copy_texture(texture.static_array, 0, i, texture.shadow_array, 0, i, csm_resolution, csm_resolution);
+	draw_casters(texture.shadow_array, false, ShadowCasters::Dynamic);
+}
+
+bool CascadeShadowMapSystem::begin_static_layer(int i) {
+	ASSERT(i >= 0 && i < CASCADES_USED);
+	// only the sides bound a cascade, casters above or below it still shadow it
+	Frustum f;
+	build_frustum_for_cascade(f, i);
+	const glm::vec4 planes[4] = {f.top_plane, f.bot_plane, f.left_plane, f.right_plane};
+	return static_cache.begin_layer(i, matricies[i], glm::ivec4(0, 0, csm_resolution, csm_resolution), planes, 4);
 }
 
 void CascadeShadowMapSystem::update_matricies() {
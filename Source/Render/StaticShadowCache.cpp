@@ -0,0 +1,50 @@
+#include "StaticShadowCache.h"
+#include "Framework/Util.h"
+#include <algorithm>
+
+static bool box_touches_planes(const Bounds& b, const glm::vec4* planes, int num_planes) {
+	for (int i = 0; i < num_planes; i++) {
+		const glm::vec3 n(planes[i]);
+		const glm::vec3 far_corner(n.x >= 0.f ? b.bmax.x : b.bmin.x, n.y >= 0.f ? b.bmax.y : b.bmin.y,
+								   n.z >= 0.f ? b.bmax.z : b.bmin.z);
+		if (glm::dot(n, far_corner) + planes[i].w < 0.f)
+			return false;
+	}
+	return true;
+}
+
+bool StaticShadowCache::begin_layer(int key, const glm::mat4& view_proj, const glm::ivec4& rect,
+									const glm::vec4* planes, int num_planes) {
+	ASSERT(num_planes >= 0 && num_planes <= MAX_PLANES);
+	Layer& l = layers[key];
+	const bool redraw = !l.valid || l.view_proj != view_proj || l.rect != rect;
+	l.view_proj = view_proj;
+	l.rect = rect;
+	std::copy(planes, planes + num_planes, l.planes);
+	l.num_planes = num_planes;
+	l.valid = true;
+	return redraw;
+}
+
+void StaticShadowCache::invalidate(std::span<const Bounds> dirty) {
+	for (auto& [_, l] : layers) {
+		if (!l.valid)
+			continue;
+		for (const Bounds& b : dirty) {
+			if (box_touches_planes(b, l.planes, l.num_planes)) {
+				l.valid = false;
+				break;
+			}
+		}
+	}
+}
+
+void StaticShadowCache::invalidate_all() {
+	for (auto& [_, l] : layers)
+		l.valid = false;
+}
+
+bool StaticShadowCache::is_valid(int key) const {
+	auto find = layers.find(key);
+	return find != layers.end() && find->second.valid;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <unordered_map>
+#include <span>
+#include "glm/glm.hpp"
+#include "Framework/MathLib.h"
+
+// which fast path casters a shadow cull draws, matches CullParams::shadow_casters
+enum class ShadowCasters
+{
+	All = 0,
+	Static = 1,  // only casters that haven't moved for a while (Render_Scene::update_shadow_casters)
+	Dynamic = 2, // everything else, drawn on top of the cached static depth each frame
+};
+
+// Bookkeeping for shadow layers that keep the static casters' depth between frames. A layer is one cascade or one
+// spot light, its depth lives in a separate texture owned by the caller. The layer has to be redrawn when its matrix
+// or rect changes, or when a static caster inside its planes was added, removed or started moving.
+class StaticShadowCache
+{
+public:
+	static const int MAX_PLANES = 6;
+
+	// true if the static layer for key has to be redrawn this frame, the layer counts as valid afterwards.
+	// planes are (normal, d) with dot(normal, p) + d >= 0 on the inside, like Frustum.
+	bool begin_layer(int key, const glm::mat4& view_proj, const glm::ivec4& rect, const glm::vec4* planes,
+					 int num_planes);
+	// dirty boxes are world bounds of static casters that changed, every layer they touch is redrawn next time
+	void invalidate(std::span<const Bounds> dirty);
+	void invalidate_all();
+	void remove_layer(int key) { layers.erase(key); }
+	bool is_valid(int key) const;
+	int get_num_layers() const { return (int)layers.size(); }
+
+private:
+	struct Layer
+	{
+		glm::mat4 view_proj = glm::mat4(1.f);
+		glm::ivec4 rect{};
+		glm::vec4 planes[MAX_PLANES];
+		int num_planes = 0;
+		bool valid = false;
+	};
+	std::unordered_map<int, Layer> layers;
+};
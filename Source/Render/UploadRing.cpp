@@ -0,0 +1,239 @@
+// Frame-fenced upload rings, see UploadRing.h.
+
+#include "UploadRing.h"
+#include "Framework/Util.h"
+#include "Framework/Config.h"
+#include "Framework/Profiler.h"
+#include "Framework/MeshBuilder.h"
+#include <algorithm>
+#include <cstring>
+
+ConfigVar r_upload_ring_frames("r.upload_ring_frames", "3", CVAR_INTEGER | CVAR_DEV,
+							   "frames an upload ring keeps in flight before next_frame() waits on the oldest fence", 1,
+							   8);
+ConfigVar r_upload_ring_persistent("r.upload_ring_persistent", "1", CVAR_BOOL | CVAR_DEV,
+								   "map upload rings persistently, 0 writes a CPU copy and sub_uploads it (read when a "
+								   "ring buffer is created)");
+
+void UploadRingRange::init(int capacity) {
+	ASSERT(capacity > 0);
+	this->capacity = capacity;
+	head = tail = 0;
+	frame_ends.clear();
+}
+
+int UploadRingRange::alloc(int size, int align) {
+	ASSERT(size > 0 && align > 0);
+	if (size > capacity)
+		return -1;
+	const int64_t phys = head % capacity;
+	const int64_t aligned = (phys + align - 1) / align * align;
+	int64_t start = head + (aligned - phys);
+	if (aligned + size > capacity)
+		start = head + (capacity - phys); // skip the tail, offset 0 is aligned for anything
+	if (start + size - tail > capacity)
+		return -1;
+	head = start + size;
+	return (int)(start % capacity);
+}
+
+void UploadRingRange::end_frame() {
+	frame_ends.push_back(head);
+}
+
+void UploadRingRange::retire_frame() {
+	ASSERT(!frame_ends.empty());
+	tail = frame_ends.front();
+	frame_ends.erase(frame_ends.begin());
+}
+
+void GpuUploadRing::init(GraphicsBufferUseFlags use, int initial_size) {
+	ASSERT(!buffer);
+	ASSERT(initial_size > 0);
+	use_flags = use;
+	create_buffer(initial_size);
+}
+
+void GpuUploadRing::create_buffer(int size) {
+	const bool want_persistent = r_upload_ring_persistent.get_bool();
+	CreateBufferArgs args;
+	args.size = size;
+	args.flags = (GraphicsBufferUseFlags)(use_flags | BUFFER_USE_DYNAMIC |
+										  (want_persistent ? BUFFER_USE_PERSISTENT_MAP : 0));
+	buffer = gfx().create_buffer(args);
+	mapped = want_persistent ? buffer->get_mapped_ptr() : nullptr;
+	staging.clear();
+	if (!mapped)
+		staging.resize(size);
+	range.init(size);
+}
+
+void GpuUploadRing::grow(int min_size) {
+	int new_size = std::max(range.get_capacity() * 2, min_size * 2);
+	new_size = (new_size + 0xffff) & ~0xffff;
+	sys_print(Debug, "GpuUploadRing: growing %d -> %d bytes\n", range.get_capacity(), new_size);
+
+	// the open frame may have written to the old buffer already, it dies with that frame
+	RetiredBuffer old;
+	old.buffer = buffer;
+	old.last_serial = frame_serial;
+	retired.push_back(old);
+	for (auto& p : pending)
+		p.in_range = false;
+
+	create_buffer(new_size);
+	generation++;
+	PROF_COUNTER_ADD("upload ring grows", prof::CounterUnit::Count, 1);
+}
+
+void GpuUploadRing::retire_finished(bool block_on_oldest) {
+	if (block_on_oldest && !pending.empty()) {
+		CPU_SCOPE("upload_ring_wait");
+		pending.front().fence->wait();
+	}
+	int num_done = 0;
+	for (auto& p : pending) {
+		if (!p.fence->is_signaled())
+			break;
+		p.fence->release();
+		if (p.in_range)
+			range.retire_frame();
+		completed_serial = p.serial;
+		num_done++;
+	}
+	pending.erase(pending.begin(), pending.begin() + num_done);
+
+	for (int i = 0; i < (int)retired.size(); i++) {
+		if (retired[i].last_serial <= completed_serial) {
+			retired[i].buffer->release();
+			retired.erase(retired.begin() + i);
+			i--;
+		}
+	}
+}
+
+void GpuUploadRing::next_frame() {
+	if (!buffer)
+		return;
+
+	PendingFrame frame;
+	frame.serial = frame_serial++;
+	frame.fence = gfx().insert_fence();
+	pending.push_back(frame);
+	range.end_frame();
+
+	retire_finished((int)pending.size() > r_upload_ring_frames.get_integer());
+
+	PROF_COUNTER_ADD("upload ring bytes", prof::CounterUnit::Bytes, bytes_this_frame);
+	PROF_COUNTER_ADD("upload ring allocs", prof::CounterUnit::Count, allocs_this_frame);
+	PROF_COUNTER_ADD("upload ring capacity", prof::CounterUnit::Bytes, range.get_capacity());
+	PROF_COUNTER_MAX("upload ring high water", prof::CounterUnit::Bytes, high_water);
+	bytes_this_frame = 0;
+	allocs_this_frame = 0;
+}
+
+UploadRingAlloc GpuUploadRing::alloc(int size, int align) {
+	ASSERT(buffer);
+	ASSERT(!gfx_is_recording());
+	UploadRingAlloc a;
+	if (size <= 0)
+		return a;
+	int ofs = range.alloc(size, align);
+	if (ofs < 0) {
+		retire_finished(false);
+		ofs = range.alloc(size, align);
+	}
+	if (ofs < 0) {
+		grow(size);
+		ofs = range.alloc(size, align);
+	}
+	ASSERT(ofs >= 0);
+
+	bytes_this_frame += size;
+	allocs_this_frame++;
+	high_water = std::max(high_water, range.get_used());
+
+	a.buffer = buffer;
+	a.offset = ofs;
+	a.size = size;
+	a.ptr = (mapped ? mapped : staging.data()) + ofs;
+	return a;
+}
+
+UploadRingAlloc GpuUploadRing::upload(const void* data, int size, int align) {
+	UploadRingAlloc a = alloc(size, align);
+	if (a.ptr) {
+		memcpy(a.ptr, data, size);
+		flush(a);
+	}
+	return a;
+}
+
+void GpuUploadRing::flush(const UploadRingAlloc& a) {
+	if (mapped || !a.buffer)
+		return;
+	ASSERT(a.buffer == buffer && "GpuUploadRing: flush before the next alloc");
+	gfx().sub_upload_buffer(a.buffer, a.ptr, a.size, a.offset);
+}
+
+void TransientMeshRing::init() {
+	vertices.init(BUFFER_USE_AS_VB, 1 << 20);
+	indices.init(BUFFER_USE_AS_IB, 1 << 19);
+	rebuild_vertex_input();
+}
+
+void TransientMeshRing::rebuild_vertex_input() {
+	if (vao) {
+		// pipelines recorded this frame still point at it
+		RetiredVertexInput old;
+		old.vao = vao;
+		old.last_serial = vertices.get_frame_serial();
+		retired_vaos.push_back(old);
+	}
+	const VertexLayout layout[] = {
+		VertexLayout(0, 3, GraphicsVertexAttribType::float32, sizeof(MbVertex), 0),
+		VertexLayout(1, 4, GraphicsVertexAttribType::u8_normalized, sizeof(MbVertex), 3 * sizeof(float)),
+		VertexLayout(2, 2, GraphicsVertexAttribType::float32, sizeof(MbVertex), 3 * sizeof(float) + sizeof(Color32)),
+	};
+	CreateVertexInputArgs vargs;
+	vargs.vertex = vertices.get_buffer();
+	vargs.index = indices.get_buffer();
+	vargs.layout = layout;
+	vargs.index_type = VertexInputIndexType::uint32;
+	vao = gfx().create_vertex_input(vargs);
+	vao_vertex_generation = vertices.get_generation();
+	vao_index_generation = indices.get_generation();
+}
+
+void TransientMeshRing::next_frame() {
+	vertices.next_frame();
+	indices.next_frame();
+	const uint64_t completed = std::min(vertices.get_completed_serial(), indices.get_completed_serial());
+	for (int i = 0; i < (int)retired_vaos.size(); i++) {
+		if (retired_vaos[i].last_serial <= completed) {
+			retired_vaos[i].vao->release();
+			retired_vaos.erase(retired_vaos.begin() + i);
+			i--;
+		}
+	}
+}
+
+TransientMesh TransientMeshRing::upload(MeshBuilder& mb) {
+	TransientMesh out;
+	const int vb_size = (int)(mb.get_v().size() * sizeof(MbVertex));
+	const int ib_size = (int)(mb.get_i().size() * sizeof(uint32_t));
+	if (vb_size == 0 || ib_size == 0)
+		return out;
+	ASSERT(vao && "TransientMeshRing: init() first");
+
+	UploadRingAlloc v = vertices.upload(mb.get_v().data(), vb_size, sizeof(MbVertex));
+	UploadRingAlloc i = indices.upload(mb.get_i().data(), ib_size, sizeof(uint32_t));
+	if (vertices.get_generation() != vao_vertex_generation || indices.get_generation() != vao_index_generation)
+		rebuild_vertex_input();
+
+	out.vao = vao;
+	out.base_vertex = v.offset / (int)sizeof(MbVertex);
+	out.index_byte_offset = i.offset;
+	out.num_indices = (int)mb.get_i().size();
+	return out;
+}
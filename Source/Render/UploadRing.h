@@ -0,0 +1,141 @@
+#pragma once
+// Per-frame streaming uploads: one persistently mapped buffer per ring, sub-allocated linearly and reclaimed a frame
+// at a time once that frame's fence passed. Replaces orphaning upload()/sub_upload() for data that lives one frame.
+//
+// A "frame" is everything allocated between two next_frame() calls. The renderer calls it at the start of the sync
+// period (Renderer::pre_sync_update), after the scene draw consuming the last sync's data was issued, so the fence
+// covers every reader. Allocations are only valid until the frame is retired: write them every frame.
+//
+// If the ring runs into memory still in flight it grows instead of stalling; the old buffer is released once the
+// frames using it retire. Backends that can't map persistently (Dx11) get a CPU staging copy and flush() uploads it.
+
+#include "Render/IGraphicsDevice.h"
+#include <cstdint>
+#include <vector>
+
+// Offsets into a ring of `capacity` bytes, freed oldest frame first. No GPU state, GpuUploadRing adds that.
+class UploadRingRange
+{
+public:
+	void init(int capacity);
+	// Offset of size bytes aligned to align (any value, not just pow2), or -1 if it would overwrite a frame in flight.
+	// An allocation never wraps: the tail of the ring is skipped instead.
+	int alloc(int size, int align);
+	// closes the frame of everything allocated since the last call
+	void end_frame();
+	// frees the oldest closed frame
+	void retire_frame();
+
+	int get_capacity() const { return capacity; }
+	int get_num_frames() const { return (int)frame_ends.size(); }
+	// bytes between the oldest live frame and the write head, including skipped tails
+	int get_used() const { return (int)(head - tail); }
+
+private:
+	int capacity = 0;
+	// monotonic, physical offset is value % capacity
+	int64_t head = 0;
+	int64_t tail = 0;
+	std::vector<int64_t> frame_ends;
+};
+
+struct UploadRingAlloc
+{
+	IGraphicsBuffer* buffer = nullptr;
+	int offset = 0;
+	int size = 0;
+	uint8_t* ptr = nullptr; // write size bytes here, then flush()
+};
+
+class GpuUploadRing
+{
+public:
+	void init(GraphicsBufferUseFlags use, int initial_size);
+	// fences the current frame and retires finished ones, see above
+	void next_frame();
+
+	// ptr stays valid until the next alloc() on this ring: write it and flush() before allocating again
+	UploadRingAlloc alloc(int size, int align);
+	// alloc + memcpy + flush
+	UploadRingAlloc upload(const void* data, int size, int align);
+	// makes a written allocation visible to the GPU. No-op when persistently mapped.
+	void flush(const UploadRingAlloc& a);
+
+	IGraphicsBuffer* get_buffer() const { return buffer; }
+	// bumped when growth replaced the buffer, anything built over it (vertex inputs) must be rebuilt
+	int get_generation() const { return generation; }
+	bool is_persistent() const { return staging.empty(); }
+	// frame_serial is the open frame, everything up to completed_serial retired
+	uint64_t get_frame_serial() const { return frame_serial; }
+	uint64_t get_completed_serial() const { return completed_serial; }
+	int get_capacity() const { return range.get_capacity(); }
+	int get_bytes_this_frame() const { return bytes_this_frame; }
+	int get_high_water() const { return high_water; }
+
+private:
+	void create_buffer(int size);
+	void grow(int min_size);
+	void retire_finished(bool block_on_oldest);
+
+	struct PendingFrame
+	{
+		uint64_t serial = 0;
+		IGraphicsFence* fence = nullptr;
+		bool in_range = true; // false once growth moved on to a new buffer
+	};
+	struct RetiredBuffer
+	{
+		IGraphicsBuffer* buffer = nullptr;
+		uint64_t last_serial = 0;
+	};
+
+	GraphicsBufferUseFlags use_flags = {};
+	IGraphicsBuffer* buffer = nullptr;
+	uint8_t* mapped = nullptr;
+	std::vector<uint8_t> staging;
+	UploadRingRange range;
+	std::vector<PendingFrame> pending;
+	std::vector<RetiredBuffer> retired;
+	uint64_t frame_serial = 1;
+	uint64_t completed_serial = 0;
+	int generation = 0;
+	int bytes_this_frame = 0;
+	int allocs_this_frame = 0;
+	int high_water = 0;
+};
+
+class MeshBuilder;
+
+// MeshBuilder geometry for one frame: vertex and index rings behind one shared vertex input.
+// Draw with draw_elements_base_vertex(mode, num_indices, uint32, index_byte_offset, base_vertex).
+struct TransientMesh
+{
+	IGraphicsVertexInput* vao = nullptr;
+	int index_byte_offset = 0;
+	int base_vertex = 0;
+	int num_indices = 0;
+};
+
+class TransientMeshRing
+{
+public:
+	void init();
+	void next_frame();
+	TransientMesh upload(MeshBuilder& mb);
+
+private:
+	void rebuild_vertex_input();
+
+	struct RetiredVertexInput
+	{
+		IGraphicsVertexInput* vao = nullptr;
+		uint64_t last_serial = 0;
+	};
+
+	GpuUploadRing vertices;
+	GpuUploadRing indices;
+	IGraphicsVertexInput* vao = nullptr;
+	int vao_vertex_generation = -1;
+	int vao_index_generation = -1;
+	std::vector<RetiredVertexInput> retired_vaos;
+};
@@ -79,7 +79,7 @@ void Canvas2d::update() {
 }
 
 void Canvas2d::sync_to_renderer() {
-	g_recorder.get_transient_gpu_mesh().upload_from(g_recorder.get_transient_arena());
+	g_recorder.get_transient_gpu_mesh().upload_transient(g_recorder.get_transient_arena(), draw.get_transient_meshes());
 	draw.get_canvas2d_drawer()->set_depth_texture(g_depth_texture);
 	draw.get_canvas2d_drawer()->update(std::move(g_recorder.get_batches()));
 }
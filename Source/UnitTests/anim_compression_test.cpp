@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "Animation/SkeletonData.h"
+#include "Animation/AnimationCompression.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdio>
+
+// Builds raw clips the same way ModelCompile_Animation does (channel_offsets into pose_data, high bit = constant
+// track), compresses them and checks the decompressor against the raw keys.
+
+namespace {
+const uint32_t CONSTANT_TRACK = 1u << 31u;
+
+void push_vec3(AnimationSeq& seq, glm::vec3 v) {
+	seq.pose_data.push_back(v.x);
+	seq.pose_data.push_back(v.y);
+	seq.pose_data.push_back(v.z);
+}
+void push_quat(AnimationSeq& seq, glm::quat q) {
+	seq.pose_data.push_back(q.x);
+	seq.pose_data.push_back(q.y);
+	seq.pose_data.push_back(q.z);
+	seq.pose_data.push_back(q.w);
+}
+
+// channel 0: root walking forward with a bob, channel 1: constant, channel 2..: swinging limbs
+AnimationSeq make_walk_clip(int num_frames, int num_channels) {
+	AnimationSeq seq;
+	seq.num_frames = num_frames;
+	const int keys = seq.get_num_keyframes_inclusive();
+	for (int ch = 0; ch < num_channels; ch++) {
+		ChannelOffset ofs;
+		ofs.pos = (uint32_t)seq.pose_data.size();
+		if (ch == 1) {
+			ofs.pos |= CONSTANT_TRACK;
+			push_vec3(seq, glm::vec3(0.f, 0.3f, 0.f));
+		} else {
+			for (int f = 0; f < keys; f++) {
+				const float t = f / 30.f;
+				if (ch == 0)
+					push_vec3(seq, glm::vec3(0.f, 0.9f + 0.04f * std::sin(t * 8.f), t * 1.4f));
+				else
+					push_vec3(seq, glm::vec3(0.1f * ch, 0.25f, 0.f));
+			}
+		}
+		ofs.rot = (uint32_t)seq.pose_data.size();
+		if (ch == 1) {
+			ofs.rot |= CONSTANT_TRACK;
+			push_quat(seq, glm::quat(1, 0, 0, 0));
+		} else {
+			for (int f = 0; f < keys; f++) {
+				const float t = f / 30.f;
+				glm::quat q = glm::angleAxis(std::sin(t * 4.f + ch) * 1.1f, glm::normalize(glm::vec3(1.f, 0.2f * ch, 0.f)));
+				// raw data isn't guaranteed to be hemisphere-consistent
+				if (f % 5 == 0)
+					q = -q;
+				push_quat(seq, q);
+			}
+		}
+		ofs.scale = (uint32_t)seq.pose_data.size() | CONSTANT_TRACK;
+		seq.pose_data.push_back(1.f);
+		seq.channel_offsets.push_back(ofs);
+	}
+	return seq;
+}
+} // namespace
+
+TEST(AnimCompressionTest, ErrorStaysUnderBound) {
+	const AnimationSeq raw = make_walk_clip(90, 12);
+	for (float bound : {0.002f, 0.0005f, 0.0001f}) {
+		AnimCompressionSettings settings;
+		settings.max_error = bound;
+		const CompressedAnimClip clip = compress_animation_clip(raw, settings);
+		ASSERT_FALSE(clip.empty());
+		const AnimCompressionReport r = measure_compressed_clip(raw, clip, settings.shell_distance);
+		printf("[AnimCompression] bound %.2fmm: %d -> %d bytes (%.2fx), keys %d/%d, max error %.3fmm\n", bound * 1000.f,
+			   (int)r.raw_bytes, (int)r.compressed_bytes, r.ratio, r.kept_keys, r.total_keys, r.max_error * 1000.f);
+		EXPECT_LE(r.max_error, bound);
+		EXPECT_GT(r.ratio, 1.f);
+	}
+}
+
+TEST(AnimCompressionTest, LinearTracksKeepOnlyEndKeys) {
+	AnimationSeq raw;
+	raw.num_frames = 60;
+	ChannelOffset ofs;
+	ofs.pos = 0;
+	for (int f = 0; f <= raw.num_frames; f++)
+		push_vec3(raw, glm::vec3(f * 0.05f, 0.f, -f * 0.02f));
+	ofs.rot = (uint32_t)raw.pose_data.size() | CONSTANT_TRACK;
+	push_quat(raw, glm::quat(1, 0, 0, 0));
+	ofs.scale = (uint32_t)raw.pose_data.size() | CONSTANT_TRACK;
+	raw.pose_data.push_back(1.f);
+	raw.channel_offsets.push_back(ofs);
+
+	const CompressedAnimClip clip = compress_animation_clip(raw, AnimCompressionSettings());
+	ASSERT_EQ(clip.channels.size(), 1u);
+	EXPECT_EQ(clip.channels[0].pos.num_keys, 2);
+	EXPECT_EQ(clip.channels[0].rot.num_keys, 0);
+	EXPECT_EQ(clip.channels[0].scale.num_keys, 0);
+
+	// in-between frames and sub-frame lerps come out of the two remaining keys
+	const ScalePositionRot mid = clip.sample(0, 30, 0.5f);
+	EXPECT_NEAR(mid.pos.x, 30.5f * 0.05f, 1e-3f);
+	EXPECT_NEAR(mid.pos.z, -30.5f * 0.02f, 1e-3f);
+	EXPECT_FLOAT_EQ(mid.scale, 1.f);
+}
+
+TEST(AnimCompressionTest, GetKeyframeUsesCompressedData) {
+	AnimationSeq raw = make_walk_clip(40, 4);
+	AnimationSeq packed = raw;
+	packed.compressed = compress_animation_clip(raw, AnimCompressionSettings());
+	packed.channel_offsets.clear();
+	packed.pose_data.clear();
+	ASSERT_TRUE(packed.is_compressed());
+	EXPECT_EQ(packed.get_num_channels(), 4u);
+
+	for (int ch = 0; ch < 4; ch++) {
+		for (int f = 0; f < raw.get_num_keyframes_exclusive(); f++) {
+			const ScalePositionRot a = raw.get_keyframe(ch, f, 0.25f);
+			const ScalePositionRot b = packed.get_keyframe(ch, f, 0.25f);
+			EXPECT_LT(glm::length(a.pos - b.pos), 0.001f);
+			EXPECT_GT(std::abs(glm::dot(glm::normalize(a.rot), b.rot)), 0.9999f);
+			EXPECT_NEAR(a.scale, b.scale, 1e-4f);
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "Animation/AnimationLod.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+// Rate selection for the animation update LOD and the bone matrix interpolation used on skipped frames.
+
+namespace {
+const float FOV = glm::radians(70.f);
+
+// camera at the origin looking down -z
+AnimUpdateLodView make_view() {
+	AnimUpdateLodView view;
+	view.origin = glm::vec3(0.f);
+	view.viewproj = glm::perspective(FOV, 16.f / 9.f, 0.1f, 1000.f) *
+					glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	view.tan_half_fov = std::tan(FOV * 0.5f);
+	return view;
+}
+
+glm::mat4 make_bone(glm::quat q, glm::vec3 pos, glm::vec3 scale) {
+	glm::mat4 m = glm::mat4_cast(q);
+	m[0] = m[0] * scale.x;
+	m[1] = m[1] * scale.y;
+	m[2] = m[2] * scale.z;
+	m[3] = glm::vec4(pos, 1.f);
+	return m;
+}
+} // namespace
+
+TEST(AnimLodTest, DistanceBands) {
+	AnimUpdateLodSettings settings;
+	settings.half_rate_screen_size = 0.f;
+	settings.quarter_rate_screen_size = 0.f;
+	const AnimUpdateLodView view = make_view();
+
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -5.f), 1.f).interval, 1);
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -25.f), 1.f).interval, 2);
+	const AnimUpdateLod far = compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -45.f), 1.f);
+	EXPECT_EQ(far.interval, 4);
+	EXPECT_FALSE(far.offscreen);
+}
+
+TEST(AnimLodTest, ScreenSizeBands) {
+	AnimUpdateLodSettings settings;
+	settings.half_rate_distance = 1000.f;
+	settings.quarter_rate_distance = 1000.f;
+	const AnimUpdateLodView view = make_view();
+
+	// a 1m sphere 3m away covers ~0.48 of the screen height, 10m away ~0.14, 30m away ~0.05
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -3.f), 1.f).interval, 1);
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -10.f), 1.f).interval, 2);
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, -30.f), 1.f).interval, 4);
+}
+
+TEST(AnimLodTest, Offscreen) {
+	AnimUpdateLodSettings settings;
+	const AnimUpdateLodView view = make_view();
+
+	const AnimUpdateLod behind = compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, 10.f), 1.f);
+	EXPECT_TRUE(behind.offscreen);
+	EXPECT_EQ(behind.interval, settings.offscreen_interval);
+	EXPECT_TRUE(compute_anim_update_lod(settings, view, glm::vec3(50.f, 0.f, -5.f), 1.f).offscreen);
+	// just past the right edge, inside the margin
+	const float edge_x = 5.f * view.tan_half_fov * 16.f / 9.f;
+	EXPECT_FALSE(compute_anim_update_lod(settings, view, glm::vec3(edge_x + 1.5f, 0.f, -5.f), 1.f).offscreen);
+	// camera inside the bounds is always full rate
+	EXPECT_EQ(compute_anim_update_lod(settings, view, glm::vec3(0.f, 0.f, 1.f), 2.f).interval, 1);
+}
+
+TEST(AnimLodTest, InterpolateBoneMatrices) {
+	const glm::vec3 axis = glm::normalize(glm::vec3(0.3f, 1.f, 0.2f));
+	const glm::mat4 a[2] = { make_bone(glm::angleAxis(0.f, axis), glm::vec3(0.f), glm::vec3(1.f)),
+							 make_bone(glm::angleAxis(0.2f, axis), glm::vec3(1.f, 2.f, 3.f), glm::vec3(1.f, 2.f, 1.f)) };
+	const glm::mat4 b[2] = { make_bone(glm::angleAxis(2.f, axis), glm::vec3(2.f, 0.f, 0.f), glm::vec3(1.f)),
+							 make_bone(glm::angleAxis(0.4f, axis), glm::vec3(3.f, 2.f, 1.f), glm::vec3(1.f, 4.f, 1.f)) };
+	glm::mat4 out[2];
+
+	interpolate_bone_matrices(a, b, 0.5f, 2, out);
+	const glm::mat4 expect0 = make_bone(glm::angleAxis(1.f, axis), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f));
+	const glm::mat4 expect1 = make_bone(glm::angleAxis(0.3f, axis), glm::vec3(2.f, 2.f, 2.f), glm::vec3(1.f, 3.f, 1.f));
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			EXPECT_NEAR(out[0][c][r], expect0[c][r], 1e-4f);
+			EXPECT_NEAR(out[1][c][r], expect1[c][r], 1e-4f);
+		}
+	}
+	// a 2 radian swing stays unit length instead of shrinking like a plain matrix lerp would
+	EXPECT_NEAR(glm::length(glm::vec3(out[0][0])), 1.f, 1e-4f);
+
+	interpolate_bone_matrices(a, b, 1.f, 2, out);
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			EXPECT_NEAR(out[1][c][r], b[1][c][r], 1e-4f);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "MyGame/bike/BikeObject_Local.h"
+#include <cmath>
+
+// BikeObject::finish_transform places the bike from its front/rear terrain probe
+// hits through fit_bike_to_terrain, whether the probes came back from the pack's
+// batch or were traced one by one.
+
+TEST(BikeTerrainFitTest, FlatGroundUnderBothWheels) {
+	const glm::vec3 front(0.f, 2.f, 1.f), rear(0.f, 2.f, -1.f);
+	const BikeTerrainFit fit = fit_bike_to_terrain(&front, &rear, BIKE_FRONT_Z, 10.f);
+	EXPECT_FLOAT_EQ(fit.y, 2.f);
+	EXPECT_FLOAT_EQ(fit.gradient, 0.f);
+	EXPECT_FLOAT_EQ(fit.horiz, BIKE_WHEELBASE);
+}
+
+TEST(BikeTerrainFitTest, SlopeInterpolatesAtTheOrigin) {
+	const glm::vec3 front(0.f, 1.f, 0.f), rear(0.f, 0.f, 0.f);
+	const BikeTerrainFit fit = fit_bike_to_terrain(&front, &rear, BIKE_FRONT_Z, 10.f);
+	EXPECT_FLOAT_EQ(fit.rise, 1.f);
+	EXPECT_FLOAT_EQ(fit.gradient, std::atan2(1.f, BIKE_WHEELBASE));
+	// the origin sits -BIKE_REAR_Z ahead of the rear contact
+	EXPECT_FLOAT_EQ(fit.y, -BIKE_REAR_Z / BIKE_WHEELBASE);
+
+	// steering pulls the front contact back, the same rise over a shorter span is steeper
+	const BikeTerrainFit steered = fit_bike_to_terrain(&front, &rear, BIKE_FRONT_Z - 0.2f, 10.f);
+	EXPECT_GT(steered.gradient, fit.gradient);
+}
+
+TEST(BikeTerrainFitTest, OneWheelHitIsFlat) {
+	const glm::vec3 hit(0.f, 3.f, 0.f);
+	const BikeTerrainFit rear_only = fit_bike_to_terrain(nullptr, &hit, BIKE_FRONT_Z, 10.f);
+	EXPECT_FLOAT_EQ(rear_only.y, 3.f);
+	EXPECT_FLOAT_EQ(rear_only.gradient, 0.f);
+	const BikeTerrainFit front_only = fit_bike_to_terrain(&hit, nullptr, BIKE_FRONT_Z, 10.f);
+	EXPECT_FLOAT_EQ(front_only.y, 3.f);
+	EXPECT_FLOAT_EQ(front_only.gradient, 0.f);
+}
+
+TEST(BikeTerrainFitTest, NoHitKeepsHeight) {
+	const BikeTerrainFit fit = fit_bike_to_terrain(nullptr, nullptr, BIKE_FRONT_Z, 10.f);
+	EXPECT_FLOAT_EQ(fit.y, 10.f);
+	EXPECT_FLOAT_EQ(fit.gradient, 0.f);
+	EXPECT_FLOAT_EQ(fit.rise, 0.f);
+}
@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include "Framework/BVH.h"
+#include "Framework/Jobs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// BVH builds checked for structure, serial against parallel, and queries against brute force, also after a refit.
+
+namespace {
+struct BvhScopedJobSystem
+{
+	BvhScopedJobSystem(int workers) : prev(JobSystem::inst), sys(workers) {}
+	~BvhScopedJobSystem() { JobSystem::inst = prev; }
+	JobSystem* prev = nullptr;
+	JobSystem sys;
+};
+// builds without a JobSystem, whatever the process has
+struct NoJobSystem
+{
+	NoJobSystem() : prev(JobSystem::inst) { JobSystem::inst = nullptr; }
+	~NoJobSystem() { JobSystem::inst = prev; }
+	JobSystem* prev = nullptr;
+};
+
+std::vector<Bounds> random_boxes(unsigned seed, int count, float extent) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> pos(-extent, extent);
+	std::uniform_real_distribution<float> size(0.05f, 1.f);
+	std::vector<Bounds> out;
+	for (int i = 0; i < count; i++) {
+		const glm::vec3 c(pos(rng), pos(rng), pos(rng));
+		const glm::vec3 h(size(rng), size(rng), size(rng));
+		out.push_back(Bounds(c - h, c + h));
+	}
+	return out;
+}
+
+bool contains(const Bounds& outer, const Bounds& inner) {
+	return outer.bmin.x <= inner.bmin.x && outer.bmin.y <= inner.bmin.y && outer.bmin.z <= inner.bmin.z &&
+		   outer.bmax.x >= inner.bmax.x && outer.bmax.y >= inner.bmax.y && outer.bmax.z >= inner.bmax.z;
+}
+
+// every index once, children after parents, boxes contain what is below them
+bool is_valid(const BVH& bvh, const std::vector<Bounds>& bounds) {
+	std::vector<int> seen(bounds.size(), 0);
+	for (int i = 0; i < (int)bvh.nodes.size(); i++) {
+		const BVHNode& n = bvh.nodes[i];
+		if (n.count == BVH_BRANCH) {
+			if (n.left_node <= i || n.left_node + 1 >= (int)bvh.nodes.size())
+				return false;
+			if (!contains(n.aabb, bvh.nodes[n.left_node].aabb) || !contains(n.aabb, bvh.nodes[n.left_node + 1].aabb))
+				return false;
+			continue;
+		}
+		for (int j = n.left_node; j < n.left_node + n.count; j++) {
+			if (!contains(n.aabb, bounds[bvh.indicies[j]]))
+				return false;
+			seen[bvh.indicies[j]]++;
+		}
+	}
+	return std::all_of(seen.begin(), seen.end(), [](int c) { return c == 1; });
+}
+
+float sah_cost(const BVH& bvh) {
+	float cost = 0.f;
+	for (auto& n : bvh.nodes)
+		cost += n.aabb.surface_area() * (n.count == BVH_BRANCH ? 1.f : (float)n.count);
+	return cost;
+}
+
+bool touches_planes(const Bounds& b, const glm::vec4* planes, int num_planes) {
+	for (int p = 0; p < num_planes; p++) {
+		const glm::vec3 n(planes[p]);
+		const glm::vec3 far_corner(n.x >= 0.f ? b.bmax.x : b.bmin.x, n.y >= 0.f ? b.bmax.y : b.bmin.y,
+								   n.z >= 0.f ? b.bmax.z : b.bmin.z);
+		if (glm::dot(n, far_corner) + planes[p].w < 0.f)
+			return false;
+	}
+	return true;
+}
+
+// slab test of one box, false on a miss
+bool ray_box(const Ray& r, const Bounds& b, float& t) {
+	float t_enter = 0.f;
+	float t_exit = 1e30f;
+	for (int a = 0; a < 3; a++) {
+		const float inv = 1.f / r.dir[a];
+		float t0 = (b.bmin[a] - r.pos[a]) * inv;
+		float t1 = (b.bmax[a] - r.pos[a]) * inv;
+		if (t0 > t1)
+			std::swap(t0, t1);
+		t_enter = std::max(t_enter, t0);
+		t_exit = std::min(t_exit, t1);
+	}
+	t = t_enter;
+	return t_enter <= t_exit;
+}
+
+// the candidates a query returns, narrowed down with the exact test, have to be what brute force finds
+template <typename Fn>
+void expect_query_matches(const std::vector<Bounds>& bounds, std::vector<int> candidates, const Fn& touches) {
+	std::sort(candidates.begin(), candidates.end());
+	EXPECT_TRUE(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+	std::vector<int> found, expect;
+	for (int i : candidates)
+		if (touches(bounds[i]))
+			found.push_back(i);
+	for (int i = 0; i < (int)bounds.size(); i++)
+		if (touches(bounds[i]))
+			expect.push_back(i);
+	EXPECT_GT(expect.size(), 0u);
+	EXPECT_EQ(found, expect);
+}
+
+void expect_queries_match(const BVH& bvh, const std::vector<Bounds>& bounds) {
+	const Bounds box(glm::vec3(-10.f, -5.f, -20.f), glm::vec3(5.f, 10.f, 0.f));
+	std::vector<int> out;
+	bvh.query_aabb(box, out);
+	expect_query_matches(bounds, out, [&](const Bounds& b) { return b.intersect(box); });
+
+	// 90 degree pyramid looking down -z from the origin
+	const float s = 0.70710678f;
+	const glm::vec4 planes[4] = {glm::vec4(0.f, -s, -s, 0.f), glm::vec4(0.f, s, -s, 0.f), glm::vec4(s, 0.f, -s, 0.f),
+								 glm::vec4(-s, 0.f, -s, 0.f)};
+	out.clear();
+	bvh.query_planes(planes, 4, out);
+	expect_query_matches(bounds, out, [&](const Bounds& b) { return touches_planes(b, planes, 4); });
+
+	const glm::vec3 point = bounds[17].get_center();
+	out.clear();
+	bvh.find(point, out);
+	expect_query_matches(bounds, out, [&](const Bounds& b) { return b.inside(point, 0.f); });
+}
+} // namespace
+
+TEST(BVHTest, BuildIsValidAndQueriesMatch) {
+	NoJobSystem serial;
+	const std::vector<Bounds> bounds = random_boxes(1, 20000, 50.f);
+	for (PartitionStrategy strat : {BVH_SAH, BVH_MIDDLE}) {
+		const BVH bvh = BVH::build(bounds, 4, strat);
+		ASSERT_TRUE(is_valid(bvh, bounds));
+		expect_queries_match(bvh, bounds);
+	}
+	EXPECT_TRUE(BVH::build({}, 4, BVH_SAH).nodes.empty());
+}
+
+TEST(BVHTest, ParallelBuildMatchesSerial) {
+	const std::vector<Bounds> bounds = random_boxes(2, 200000, 200.f);
+	BVH serial_bvh;
+	{
+		NoJobSystem serial;
+		serial_bvh = BVH::build(bounds, 4, BVH_SAH);
+	}
+	BvhScopedJobSystem js(4);
+	const BVH parallel_bvh = BVH::build(bounds, 4, BVH_SAH);
+	ASSERT_TRUE(is_valid(parallel_bvh, bounds));
+	// same splits, only the node order (and so the order the cost is summed in) differs
+	EXPECT_EQ(parallel_bvh.indicies, serial_bvh.indicies);
+	EXPECT_EQ(parallel_bvh.nodes.size(), serial_bvh.nodes.size());
+	EXPECT_NEAR(sah_cost(parallel_bvh), sah_cost(serial_bvh), sah_cost(serial_bvh) * 1e-5f);
+	expect_queries_match(parallel_bvh, bounds);
+}
+
+TEST(BVHTest, RefitFollowsMovedBounds) {
+	NoJobSystem serial;
+	std::vector<Bounds> bounds = random_boxes(3, 5000, 30.f);
+	BVH bvh = BVH::build(bounds, 4, BVH_SAH);
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> offset(-3.f, 3.f);
+	for (auto& b : bounds) {
+		const glm::vec3 d(offset(rng), offset(rng), offset(rng));
+		b = Bounds(b.bmin + d, b.bmax + d);
+	}
+	bvh.refit(bounds);
+	ASSERT_TRUE(is_valid(bvh, bounds));
+	expect_queries_match(bvh, bounds);
+}
+
+TEST(BVHTest, RayFindsNearestHit) {
+	NoJobSystem serial;
+	const std::vector<Bounds> bounds = random_boxes(5, 10000, 40.f);
+	const BVH bvh = BVH::build(bounds, 4, BVH_SAH);
+	std::mt19937 rng(6);
+	std::uniform_real_distribution<float> dir(-1.f, 1.f);
+	for (int i = 0; i < 200; i++) {
+		const Ray ray(glm::vec3(0.f), glm::vec3(dir(rng), dir(rng), dir(rng)));
+		int expect = -1;
+		float expect_t = 1000.f;
+		for (int j = 0; j < (int)bounds.size(); j++) {
+			float t = 0.f;
+			if (ray_box(ray, bounds[j], t) && t < expect_t) {
+				expect = j;
+				expect_t = t;
+			}
+		}
+		int nearest = -1;
+		float nearest_t = 1000.f;
+		bvh.query_ray(ray, 1000.f, [&](int index, float) {
+			float t = 0.f;
+			if (ray_box(ray, bounds[index], t) && t < nearest_t) {
+				nearest = index;
+				nearest_t = t;
+			}
+			return nearest_t;
+		});
+		EXPECT_EQ(nearest, expect);
+	}
+
+	// a segment stops at its end
+	const glm::vec3 target = bounds[0].get_center();
+	bool hit_target = false;
+	bvh.query_segment(target - glm::vec3(100.f, 0.f, 0.f), target, [&](int index, float t) {
+		EXPECT_LE(t, 1.f);
+		hit_target |= index == 0;
+		return 1.f;
+	});
+	EXPECT_TRUE(hit_target);
+}
+
+// ---- microbenchmark ------------------------------------------------------
+
+TEST(BVHBench, BuildAndRefit) {
+	using clock = std::chrono::high_resolution_clock;
+	const std::vector<Bounds> bounds = random_boxes(7, 1000000, 500.f);
+	auto time_ms = [&](auto&& fn) {
+		auto start = clock::now();
+		fn();
+		return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	};
+	BVH bvh;
+	double serial_ms = 0.0;
+	{
+		NoJobSystem serial;
+		serial_ms = time_ms([&] { bvh = BVH::build(bounds, 4, BVH_SAH); });
+	}
+	BvhScopedJobSystem js(0);
+	const double parallel_ms = time_ms([&] { bvh = BVH::build(bounds, 4, BVH_SAH); });
+	const double refit_ms = time_ms([&] { bvh.refit(bounds); });
+	printf("[BVHBench] %d boxes: serial build %.1f ms, parallel build %.1f ms (%d workers), refit %.2f ms\n",
+		   (int)bounds.size(), serial_ms, parallel_ms, js.sys.get_num_workers(), refit_ms);
+}
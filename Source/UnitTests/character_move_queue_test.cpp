@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "Game/Entities/CharacterController.h"
+#include <memory>
+#include <vector>
+
+// Moves queued with CharacterController::queue_move run in flush_queued_moves. Every move here is shorter than its
+// min_dist, so move_batch stops it before sweeping and no physics scene is needed.
+
+namespace {
+const glm::vec3 SHORT_STEP(0.01f, 0.f, 0.f);
+const float DT = 0.5f;
+const float MIN_DIST = 1.f;
+} // namespace
+
+TEST(CharacterMoveQueueTest, FlushRunsCallbacksInQueueOrder) {
+	CharacterController a(nullptr), b(nullptr);
+	a.set_position(glm::vec3(1.f, 0.f, 0.f));
+	b.set_position(glm::vec3(2.f, 0.f, 0.f));
+	std::vector<const CharacterController*> done;
+	std::vector<float> velocities;
+	auto record = [&](const CharacterMove& m) {
+		done.push_back(m.controller);
+		velocities.push_back(m.out_velocity.x);
+	};
+	a.queue_move(SHORT_STEP, DT, MIN_DIST, record);
+	b.queue_move(SHORT_STEP, DT, MIN_DIST, record);
+	EXPECT_TRUE(done.empty());
+
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(done, (std::vector<const CharacterController*>{&a, &b}));
+	EXPECT_EQ(velocities, (std::vector<float>{SHORT_STEP.x / DT, SHORT_STEP.x / DT}));
+	// too short to move, both stay put
+	EXPECT_EQ(a.get_character_pos().x, 1.f);
+	EXPECT_EQ(b.get_character_pos().x, 2.f);
+
+	// nothing queued, nothing runs
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(done.size(), 2u);
+}
+
+TEST(CharacterMoveQueueTest, MovesQueuedByCallbacksWaitForTheNextFlush) {
+	CharacterController a(nullptr);
+	int count = 0;
+	a.queue_move(SHORT_STEP, DT, MIN_DIST, [&](const CharacterMove&) {
+		count++;
+		a.queue_move(SHORT_STEP, DT, MIN_DIST, [&](const CharacterMove&) { count++; });
+	});
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(count, 1);
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(count, 2);
+}
+
+TEST(CharacterMoveQueueTest, DestroyedControllerDropsItsMove) {
+	auto a = std::make_unique<CharacterController>(nullptr);
+	CharacterController b(nullptr);
+	std::vector<const CharacterController*> done;
+	auto record = [&](const CharacterMove& m) { done.push_back(m.controller); };
+	a->queue_move(SHORT_STEP, DT, MIN_DIST, record);
+	b.queue_move(SHORT_STEP, DT, MIN_DIST, record);
+	a.reset();
+
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(done, (std::vector<const CharacterController*>{&b}));
+}
+
+TEST(CharacterMoveQueueTest, DestroyedMidFlushSkipsItsCallback) {
+	CharacterController a(nullptr), c(nullptr);
+	auto b = std::make_unique<CharacterController>(nullptr);
+	std::vector<const CharacterController*> done;
+	auto record = [&](const CharacterMove& m) { done.push_back(m.controller); };
+	// a's callback kills b, like a hit landing during the flush
+	a.queue_move(SHORT_STEP, DT, MIN_DIST, [&](const CharacterMove& m) {
+		record(m);
+		b.reset();
+	});
+	b->queue_move(SHORT_STEP, DT, MIN_DIST, record);
+	c.queue_move(SHORT_STEP, DT, MIN_DIST, record);
+
+	CharacterController::flush_queued_moves();
+	EXPECT_EQ(done, (std::vector<const CharacterController*>{&a, &c}));
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "Render/DrawKeySort.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+// keys built like draw_call_key: a few fields with a handful of values each, most bytes constant
+std::vector<DrawKeySortItem> random_items(std::mt19937& rng, int count) {
+	std::uniform_int_distribution<int> shader(0, 40);
+	std::uniform_int_distribution<int> texture(0, 300);
+	std::uniform_int_distribution<int> mesh(0, 2000);
+	std::uniform_int_distribution<int> submesh(0, 5);
+	std::vector<DrawKeySortItem> items(count);
+	for (int i = 0; i < count; i++) {
+		const uint64_t key = ((uint64_t)shader(rng) << 49) | ((uint64_t)texture(rng) << 31) | ((uint64_t)mesh(rng) << 14);
+		items[i] = {key, (uint32_t)submesh(rng), (uint32_t)i};
+	}
+	return items;
+}
+} // namespace
+
+TEST(DrawKeySortTest, RadixMatchesStableSort) {
+	std::mt19937 rng(3);
+	for (int count : {0, 1, 2, 17, 5000}) {
+		std::vector<DrawKeySortItem> items = random_items(rng, count);
+		std::vector<DrawKeySortItem> expected = items;
+		std::stable_sort(expected.begin(), expected.end(), draw_key_less);
+
+		std::vector<DrawKeySortItem> scratch(items.size());
+		const int passes = radix_sort_draw_keys(items, scratch);
+		if (count > 100) {
+			// the constant bytes are skipped
+			EXPECT_LT(passes, 12);
+		}
+		for (int i = 0; i < count; i++) {
+			EXPECT_EQ(items[i].key, expected[i].key);
+			EXPECT_EQ(items[i].submesh, expected[i].submesh);
+			EXPECT_EQ(items[i].index, expected[i].index) << "radix sort must be stable";
+		}
+	}
+}
+
+TEST(DrawKeySortTest, MergeMatchesFullSort) {
+	std::mt19937 rng(4);
+	std::vector<DrawKeySortItem> existing = random_items(rng, 900);
+	std::vector<DrawKeySortItem> added = random_items(rng, 60);
+	for (auto& a : added)
+		a.index += 900;
+	// an exact duplicate of an existing item goes after it
+	added.push_back(existing[10]);
+	added.back().index = 2000;
+
+	std::vector<DrawKeySortItem> scratch(existing.size());
+	radix_sort_draw_keys(existing, scratch);
+	radix_sort_draw_keys(added, scratch);
+
+	std::vector<int> existing_to_merged(existing.size()), added_to_merged(added.size());
+	merge_sorted_draw_keys(existing, added, existing_to_merged.data(), added_to_merged.data());
+
+	std::vector<DrawKeySortItem> merged(existing.size() + added.size());
+	std::vector<int> filled(merged.size(), 0);
+	for (size_t i = 0; i < existing.size(); i++) {
+		merged[existing_to_merged[i]] = existing[i];
+		filled[existing_to_merged[i]]++;
+	}
+	for (size_t i = 0; i < added.size(); i++) {
+		merged[added_to_merged[i]] = added[i];
+		filled[added_to_merged[i]]++;
+	}
+	for (int f : filled)
+		EXPECT_EQ(f, 1);
+	EXPECT_TRUE(std::is_sorted(merged.begin(), merged.end(), draw_key_less));
+
+	// relative order inside each list is kept
+	for (size_t i = 1; i < existing.size(); i++)
+		EXPECT_LT(existing_to_merged[i - 1], existing_to_merged[i]);
+	for (size_t i = 1; i < added.size(); i++)
+		EXPECT_LT(added_to_merged[i - 1], added_to_merged[i]);
+	int dup = 0;
+	for (size_t i = 0; i < added.size(); i++)
+		if (added[i].index == 2000)
+			dup = added_to_merged[i];
+	ASSERT_GT(dup, 0);
+	EXPECT_FALSE(draw_key_less(merged[dup - 1], merged[dup]));
+	EXPECT_NE(merged[dup - 1].index, 2000u);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "Framework/DynamicAabbTree.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// DynamicAabbTree queries against brute force over the fat boxes, through random inserts, moves and removes.
+
+namespace {
+Bounds random_box(std::mt19937& rng, float extent) {
+	std::uniform_real_distribution<float> pos(-extent, extent);
+	std::uniform_real_distribution<float> size(0.1f, 4.f);
+	const glm::vec3 c(pos(rng), pos(rng), pos(rng));
+	const glm::vec3 h(size(rng), size(rng), size(rng));
+	return Bounds(c - h, c + h);
+}
+
+bool box_touches_planes(const Bounds& b, const glm::vec4* planes, int num_planes) {
+	for (int p = 0; p < num_planes; p++) {
+		const glm::vec3 n(planes[p]);
+		const glm::vec3 far_corner(n.x >= 0.f ? b.bmax.x : b.bmin.x, n.y >= 0.f ? b.bmax.y : b.bmin.y,
+								   n.z >= 0.f ? b.bmax.z : b.bmin.z);
+		if (glm::dot(n, far_corner) + planes[p].w < 0.f)
+			return false;
+	}
+	return true;
+}
+
+// 90 degree pyramid looking down -z from the origin, planes point inwards
+void make_frustum_planes(glm::vec4* planes) {
+	const float s = 0.70710678f;
+	planes[0] = glm::vec4(0.f, -s, -s, 0.f);
+	planes[1] = glm::vec4(0.f, s, -s, 0.f);
+	planes[2] = glm::vec4(s, 0.f, -s, 0.f);
+	planes[3] = glm::vec4(-s, 0.f, -s, 0.f);
+}
+
+std::vector<int> sorted(std::vector<int> v) {
+	std::sort(v.begin(), v.end());
+	return v;
+}
+
+// live proxies by user data, -1 once removed
+struct TreeFixture
+{
+	DynamicAabbTree tree;
+	std::vector<int> proxies;
+
+	void populate(std::mt19937& rng, int count, float extent) {
+		for (int i = 0; i < count; i++)
+			proxies.push_back(tree.insert(random_box(rng, extent), i));
+	}
+	template <typename Fn> std::vector<int> brute_force(const Fn& touches) const {
+		std::vector<int> out;
+		for (int i = 0; i < (int)proxies.size(); i++)
+			if (proxies[i] != -1 && touches(tree.get_fat_aabb(proxies[i])))
+				out.push_back(i);
+		return out;
+	}
+};
+} // namespace
+
+TEST(DynamicAabbTreeTest, InsertMoveRemoveStaysValid) {
+	std::mt19937 rng(1);
+	TreeFixture f;
+	f.populate(rng, 500, 100.f);
+	EXPECT_TRUE(f.tree.validate());
+	EXPECT_EQ(f.tree.get_num_leaves(), 500);
+
+	for (int round = 0; round < 5; round++) {
+		for (int i = 0; i < (int)f.proxies.size(); i += 3)
+			if (f.proxies[i] != -1)
+				f.tree.move(f.proxies[i], random_box(rng, 100.f));
+		for (int i = round; i < (int)f.proxies.size(); i += 7) {
+			if (f.proxies[i] != -1) {
+				f.tree.remove(f.proxies[i]);
+				f.proxies[i] = -1;
+			}
+		}
+		ASSERT_TRUE(f.tree.validate());
+	}
+	int live = 0;
+	for (int p : f.proxies)
+		live += p != -1;
+	EXPECT_EQ(f.tree.get_num_leaves(), live);
+
+	for (int i = 0; i < (int)f.proxies.size(); i++)
+		if (f.proxies[i] != -1)
+			f.tree.remove(f.proxies[i]);
+	EXPECT_TRUE(f.tree.validate());
+	EXPECT_EQ(f.tree.get_height(), 0);
+}
+
+TEST(DynamicAabbTreeTest, SmallMovesKeepTheFatBox) {
+	DynamicAabbTree tree;
+	tree.set_margin(0.5f);
+	const int proxy = tree.insert(Bounds(glm::vec3(0.f), glm::vec3(1.f)), 7);
+	EXPECT_FALSE(tree.move(proxy, Bounds(glm::vec3(0.2f), glm::vec3(1.2f))));
+	EXPECT_TRUE(tree.move(proxy, Bounds(glm::vec3(5.f), glm::vec3(6.f))));
+	EXPECT_EQ(tree.get_user_data(proxy), 7);
+	EXPECT_FLOAT_EQ(tree.get_fat_aabb(proxy).bmin.x, 4.5f);
+}
+
+TEST(DynamicAabbTreeTest, RotationsKeepSortedInsertsShallow) {
+	// boxes along a line are the worst case for a tree without rotations
+	DynamicAabbTree tree;
+	for (int i = 0; i < 4096; i++)
+		tree.insert(Bounds(glm::vec3((float)i, 0.f, 0.f), glm::vec3((float)i + 0.5f, 1.f, 1.f)), i);
+	EXPECT_TRUE(tree.validate());
+	EXPECT_LE(tree.get_height(), 40);
+}
+
+TEST(DynamicAabbTreeTest, QueriesMatchBruteForce) {
+	std::mt19937 rng(2);
+	TreeFixture f;
+	f.populate(rng, 2000, 60.f);
+	for (int i = 0; i < 2000; i += 5) {
+		f.tree.remove(f.proxies[i]);
+		f.proxies[i] = -1;
+	}
+
+	glm::vec4 planes[4];
+	make_frustum_planes(planes);
+	std::vector<int> out;
+	f.tree.query_planes(planes, 4, out);
+	const std::vector<int> expect_planes =
+		f.brute_force([&](const Bounds& b) { return box_touches_planes(b, planes, 4); });
+	EXPECT_GT(expect_planes.size(), 0u);
+	EXPECT_EQ(sorted(out), expect_planes);
+
+	f.tree.build_wide();
+	out.clear();
+	f.tree.query_planes_wide(planes, 4, out);
+	EXPECT_EQ(sorted(out), expect_planes);
+
+	const glm::vec3 center(5.f, -3.f, 10.f);
+	const float radius = 15.f;
+	out.clear();
+	f.tree.query_sphere(center, radius, out);
+	EXPECT_EQ(sorted(out), f.brute_force([&](const Bounds& b) {
+		const glm::vec3 d = glm::clamp(center, b.bmin, b.bmax) - center;
+		return glm::dot(d, d) <= radius * radius;
+	}));
+
+	const Bounds box(glm::vec3(-20.f), glm::vec3(10.f));
+	out.clear();
+	f.tree.query_aabb(box, out);
+	EXPECT_EQ(sorted(out), f.brute_force([&](const Bounds& b) { return b.intersect(box); }));
+}
+
+TEST(DynamicAabbTreeTest, RayVisitsNearestFirst) {
+	DynamicAabbTree tree;
+	tree.set_margin(0.f);
+	for (int i = 0; i < 64; i++) {
+		const float x = (float)((i * 37) % 64) * 3.f; // shuffled along the ray
+		tree.insert(Bounds(glm::vec3(x, -1.f, -1.f), glm::vec3(x + 1.f, 1.f, 1.f)), i);
+	}
+	tree.insert(Bounds(glm::vec3(0.f, 50.f, 0.f), glm::vec3(1.f, 51.f, 1.f)), 100); // off the ray
+
+	const Ray ray(glm::vec3(-10.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f));
+	std::vector<float> hits;
+	tree.query_ray(ray, 1000.f, [&](int user_data, float t) {
+		EXPECT_NE(user_data, 100);
+		hits.push_back(t);
+		return 1000.f;
+	});
+	EXPECT_EQ(hits.size(), 64u);
+
+	// returning the hit distance clips everything behind it
+	int nearest = -1;
+	tree.query_ray(ray, 1000.f, [&](int user_data, float t) {
+		nearest = user_data;
+		return t;
+	});
+	EXPECT_EQ(nearest, 0);
+}
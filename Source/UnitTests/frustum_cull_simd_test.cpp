@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "Render/FrustumCullSimd.h"
+#include "Render/Frustum.h"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// The SIMD sphere/frustum test against the scalar reference. Counts that aren't a multiple of 8 so the scalar tail
+// runs in both SSE and AVX builds.
+
+namespace {
+// 90 degree pyramid looking down -z from the origin, planes point inwards
+Frustum make_frustum() {
+	Frustum f;
+	const float s = 0.70710678f;
+	f.top_plane = glm::vec4(0.f, -s, -s, 0.f);
+	f.bot_plane = glm::vec4(0.f, s, -s, 0.f);
+	f.left_plane = glm::vec4(s, 0.f, -s, 0.f);
+	f.right_plane = glm::vec4(-s, 0.f, -s, 0.f);
+	return f;
+}
+
+SphereBoundsSoA random_spheres(std::mt19937& rng, int count) {
+	std::uniform_real_distribution<float> pos(-50.f, 50.f);
+	std::uniform_real_distribution<float> radius(0.1f, 4.f);
+	SphereBoundsSoA bounds;
+	for (int i = 0; i < count; i++)
+		bounds.set(i, glm::vec4(pos(rng), pos(rng), pos(rng), radius(rng)));
+	return bounds;
+}
+} // namespace
+
+TEST(FrustumCullSimdTest, MatchesReference) {
+	std::mt19937 rng(1);
+	const int count = 1003;
+	SphereBoundsSoA bounds = random_spheres(rng, count);
+	std::vector<uint8_t> simd(count, 0xff), ref(count, 0xff);
+	const Frustum f = make_frustum();
+	cull_spheres_frustum_simd(f, bounds, 0, count, simd.data());
+	cull_spheres_frustum_reference(f, bounds, 0, count, ref.data());
+	int visible = 0;
+	for (int i = 0; i < count; i++) {
+		EXPECT_EQ(simd[i], ref[i]) << "sphere " << i;
+		visible += ref[i];
+	}
+	// a 90 degree pyramid sees some of a cube around its apex, not all of it
+	EXPECT_GT(visible, 0);
+	EXPECT_LT(visible, count);
+}
+
+TEST(FrustumCullSimdTest, SubrangesAndClearedSlots) {
+	SphereBoundsSoA bounds;
+	for (int i = 0; i < 21; i++)
+		bounds.set(i, glm::vec4(0.f, 0.f, -10.f, 1.f)); // straight ahead
+	bounds.set(4, glm::vec4(0.f, 0.f, 10.f, 1.f));		 // behind
+	bounds.set(5, glm::vec4(0.f, 0.f, 10.f, 20.f));		 // behind, but big enough to reach in
+	bounds.clear(6);
+	bounds.clear(30); // grows the arrays
+	EXPECT_EQ(bounds.size(), 31);
+
+	std::vector<uint8_t> out(bounds.size(), 0xff);
+	const Frustum f = make_frustum();
+	// unaligned begin, only [3,29) is written
+	cull_spheres_frustum_simd(f, bounds, 3, 29, out.data());
+	EXPECT_EQ(out[2], 0xff);
+	EXPECT_EQ(out[3], 1);
+	EXPECT_EQ(out[4], 0);
+	EXPECT_EQ(out[5], 1);
+	EXPECT_EQ(out[6], 0);
+	EXPECT_EQ(out[20], 1);
+	EXPECT_EQ(out[21], 0); // grown slots start cleared
+	EXPECT_EQ(out[29], 0xff);
+}
+
+// ---- microbenchmark ------------------------------------------------------
+
+TEST(FrustumCullSimdBench, ScalarVsSimd) {
+	using clock = std::chrono::high_resolution_clock;
+	std::mt19937 rng(2);
+	const int count = 50000;
+	const int ITERATIONS = 200;
+	SphereBoundsSoA bounds = random_spheres(rng, count);
+	std::vector<uint8_t> out(count);
+	const Frustum f = make_frustum();
+
+	auto time_ms = [&](auto&& fn) {
+		auto start = clock::now();
+		for (int i = 0; i < ITERATIONS; i++)
+			fn();
+		return std::chrono::duration<double, std::milli>(clock::now() - start).count() / ITERATIONS;
+	};
+	const double ref = time_ms([&]() { cull_spheres_frustum_reference(f, bounds, 0, count, out.data()); });
+	const double simd = time_ms([&]() { cull_spheres_frustum_simd(f, bounds, 0, count, out.data()); });
+	printf("[FrustumCullSimdBench] %d spheres: reference %.3f ms, simd %.3f ms\n", count, ref, simd);
+}
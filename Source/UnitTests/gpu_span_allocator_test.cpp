@@ -0,0 +1,313 @@
+#include <gtest/gtest.h>
+#include "Render/GpuAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The TLSF gpuSpanAllocator against the first-fit free list it replaced, replaying alloc/free traces.
+// Traces are text, one op per line: "a <id> <bytes> <align>" or "f <id>". GPU_ALLOC_TRACE=<file> replays a recorded
+// one in the benchmark, otherwise a generated trace of models streaming in and out is used.
+
+namespace {
+struct TraceOp
+{
+	bool is_alloc = false;
+	int id = 0;
+	int bytes = 0;
+	int align = 0;
+};
+
+std::vector<TraceOp> parse_trace(std::istream& in) {
+	std::vector<TraceOp> ops;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream ss(line);
+		char c = 0;
+		TraceOp op;
+		if (!(ss >> c >> op.id))
+			continue;
+		op.is_alloc = c == 'a';
+		if (op.is_alloc && !(ss >> op.bytes >> op.align))
+			continue;
+		ops.push_back(op);
+	}
+	return ops;
+}
+
+// levels of models loading and unloading: sizes log-uniform from a few hundred bytes to a couple MB, vertex
+// (32 byte) or index (2 byte) aligned
+std::vector<TraceOp> make_streaming_trace(unsigned seed, int num_ops) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> log_size(8.f, 21.f);
+	std::vector<TraceOp> ops;
+	std::vector<int> live;
+	int next_id = 0;
+	while ((int)ops.size() < num_ops) {
+		const bool unload = !live.empty() && (live.size() > 300 || rng() % 100 < 45);
+		TraceOp op;
+		if (unload) {
+			const int i = rng() % live.size();
+			op.id = live[i];
+			live[i] = live.back();
+			live.pop_back();
+		} else {
+			op.is_alloc = true;
+			op.id = next_id++;
+			op.bytes = (int)std::exp2(log_size(rng));
+			op.align = (rng() & 1) ? 32 : 2;
+			live.push_back(op.id);
+		}
+		ops.push_back(op);
+	}
+	return ops;
+}
+
+// what gpuSpanAllocator used to be: sorted vector of free spans, first fit, O(n) alloc and free
+class LinearSpanAllocator
+{
+public:
+	void init_clear(int bytes) {
+		free_spans.clear();
+		free_spans.push_back({0, bytes});
+	}
+	gpuAllocSpan allocate(int bytes, int align_to_size) {
+		bytes += align_to_size;
+		bytes = bytes <= 2048 ? (bytes + 255) & ~255 : (bytes + 2047) & ~2047;
+		for (auto it = free_spans.begin(); it != free_spans.end(); ++it) {
+			if (it->size >= bytes) {
+				gpuAllocSpan result;
+				result.start = it->start;
+				result.size = bytes;
+				if (it->size > bytes) {
+					it->start += bytes;
+					it->size -= bytes;
+				} else {
+					free_spans.erase(it);
+				}
+				return result;
+			}
+		}
+		return {};
+	}
+	void free(gpuAllocSpan span) {
+		if (span.size == 0)
+			return;
+		Span s = {span.start, span.size};
+		auto it = std::lower_bound(free_spans.begin(), free_spans.end(), s,
+								   [](const Span& a, const Span& b) { return a.start < b.start; });
+		it = free_spans.insert(it, s);
+		if (it != free_spans.begin() && std::prev(it)->start + std::prev(it)->size == it->start) {
+			std::prev(it)->size += it->size;
+			it = std::prev(free_spans.erase(it));
+		}
+		auto next = std::next(it);
+		if (next != free_spans.end() && it->start + it->size == next->start) {
+			it->size += next->size;
+			free_spans.erase(next);
+		}
+	}
+
+private:
+	struct Span
+	{
+		int start = 0;
+		int size = 0;
+	};
+	std::vector<Span> free_spans;
+};
+
+// replays ops, frees of allocations that failed are skipped. returns the number of failed allocations.
+template <typename Allocator>
+int replay(Allocator& a, const std::vector<TraceOp>& ops, std::vector<gpuAllocSpan>& spans) {
+	int failed = 0;
+	for (const TraceOp& op : ops) {
+		if (op.id >= (int)spans.size())
+			spans.resize(op.id + 1);
+		if (op.is_alloc) {
+			spans[op.id] = a.allocate(op.bytes, op.align);
+			if (spans[op.id].size == 0)
+				failed++;
+		} else {
+			a.free(spans[op.id]);
+			spans[op.id] = {};
+		}
+	}
+	return failed;
+}
+
+// live spans must stay inside the buffer and not overlap
+bool spans_are_disjoint(const std::vector<gpuAllocSpan>& spans, int total) {
+	std::map<int, int> by_start;
+	for (auto& s : spans)
+		if (s.size != 0)
+			by_start[s.start] = s.size;
+	int end = 0;
+	for (auto& [start, size] : by_start) {
+		if (start < end)
+			return false;
+		end = start + size;
+	}
+	return end <= total;
+}
+
+const int TRACE_BUFFER_SIZE = 128 << 20;
+} // namespace
+
+TEST(GpuSpanAllocatorTest, FreeingEverythingMergesBack) {
+	gpuSpanAllocator a;
+	a.init_clear(1 << 20);
+	std::vector<gpuAllocSpan> spans;
+	for (int i = 0; i < 50; i++)
+		spans.push_back(a.allocate(100 + i * 97, 32));
+	EXPECT_EQ(spans[0].start, 0);
+	for (auto& s : spans)
+		EXPECT_GT(s.size, 0);
+	EXPECT_EQ(a.get_stats().num_used_blocks, 50);
+
+	// every other first, then the rest
+	for (int i = 0; i < 50; i += 2)
+		a.free(spans[i]);
+	EXPECT_GT(a.get_stats().num_free_blocks, 1);
+	for (int i = 1; i < 50; i += 2)
+		a.free(spans[i]);
+
+	const gpuAllocStats s = a.get_stats();
+	EXPECT_EQ(s.used, 0);
+	EXPECT_EQ(s.num_free_blocks, 1);
+	EXPECT_EQ(s.largest_free, 1 << 20);
+	EXPECT_EQ(s.used_end, 0);
+	EXPECT_FLOAT_EQ(s.get_fragmentation(), 0.f);
+}
+
+TEST(GpuSpanAllocatorTest, AlignsAndFits) {
+	gpuSpanAllocator a;
+	a.init_clear(1 << 20);
+	for (int i = 0; i < 40; i++) {
+		const int bytes = 37 + i * 411;
+		const int align = (i % 3 == 0) ? 2 : 48; // ModelVertex style strides aren't powers of two
+		const gpuAllocSpan s = a.allocate(bytes, align);
+		ASSERT_GT(s.size, 0);
+		EXPECT_EQ(s.aligned_start % align, 0);
+		EXPECT_LE(s.aligned_start + bytes, s.start + s.size);
+	}
+}
+
+TEST(GpuSpanAllocatorTest, OutOfMemoryReturnsEmptySpan) {
+	gpuSpanAllocator a;
+	a.init_clear(8192);
+	const gpuAllocSpan big = a.allocate(6000, 2);
+	ASSERT_GT(big.size, 0);
+	EXPECT_EQ(a.allocate(4000, 2).size, 0);
+	// the span at offset 0 is freed like any other
+	a.free(big);
+	EXPECT_GT(a.allocate(4000, 2).size, 0);
+	a.free(gpuAllocSpan()); // no-op
+}
+
+TEST(GpuSpanAllocatorTest, AllocateBelowFillsLowHoles) {
+	gpuSpanAllocator a;
+	a.init_clear(1 << 20);
+	std::vector<gpuAllocSpan> spans;
+	for (int i = 0; i < 8; i++)
+		spans.push_back(a.allocate(10000, 2));
+	a.free(spans[1]);
+	a.free(spans[3]);
+	const gpuAllocStats before = a.get_stats();
+	EXPECT_GT(before.get_fragmentation(), 0.f);
+
+	// the top span moves into the lowest hole, the next one into the other
+	gpuAllocSpan moved = a.allocate_below(10000, 2, spans[7].start);
+	ASSERT_GT(moved.size, 0);
+	EXPECT_EQ(moved.start, spans[1].start);
+	a.free(spans[7]);
+	moved = a.allocate_below(10000, 2, spans[6].start);
+	ASSERT_GT(moved.size, 0);
+	EXPECT_EQ(moved.start, spans[3].start);
+	a.free(spans[6]);
+
+	const gpuAllocStats after = a.get_stats();
+	EXPECT_EQ(after.num_free_blocks, 1);
+	EXPECT_FLOAT_EQ(after.get_fragmentation(), 0.f);
+	EXPECT_EQ(after.used_end, spans[6].start);
+	// nothing lower than the lowest span
+	EXPECT_EQ(a.allocate_below(10000, 2, spans[0].start).size, 0);
+}
+
+TEST(GpuSpanAllocatorTest, TraceReplayStaysConsistent) {
+	const std::vector<TraceOp> ops = make_streaming_trace(7, 20000);
+	gpuSpanAllocator a;
+	a.init_clear(TRACE_BUFFER_SIZE);
+	std::vector<gpuAllocSpan> spans;
+	for (int chunk = 0; chunk < (int)ops.size(); chunk += 1000) {
+		std::vector<TraceOp> part(ops.begin() + chunk, ops.begin() + std::min((int)ops.size(), chunk + 1000));
+		EXPECT_EQ(replay(a, part, spans), 0);
+		ASSERT_TRUE(spans_are_disjoint(spans, TRACE_BUFFER_SIZE));
+
+		int live = 0;
+		int live_bytes = 0;
+		for (auto& s : spans) {
+			live += s.size != 0;
+			live_bytes += s.size;
+		}
+		const gpuAllocStats s = a.get_stats();
+		EXPECT_EQ(s.num_used_blocks, live);
+		EXPECT_EQ(s.used, live_bytes);
+		EXPECT_LE(s.largest_free, s.free_bytes);
+	}
+
+	// the trace format round trips
+	std::stringstream ss;
+	for (auto& op : ops) {
+		if (op.is_alloc)
+			ss << "a " << op.id << " " << op.bytes << " " << op.align << "\n";
+		else
+			ss << "f " << op.id << "\n";
+	}
+	EXPECT_EQ(parse_trace(ss).size(), ops.size());
+}
+
+// ---- microbenchmark ------------------------------------------------------
+
+TEST(GpuSpanAllocatorBench, TraceReplay) {
+	using clock = std::chrono::high_resolution_clock;
+	std::vector<TraceOp> ops;
+	if (const char* path = std::getenv("GPU_ALLOC_TRACE")) {
+		std::ifstream file(path);
+		ops = parse_trace(file);
+		printf("[GpuSpanAllocatorBench] replaying %s (%d ops)\n", path, (int)ops.size());
+	}
+	if (ops.empty())
+		ops = make_streaming_trace(3, 200000);
+	const int ITERATIONS = 5;
+
+	auto time_ms = [&](auto& alloc, int& failed) {
+		double total = 0.0;
+		for (int i = 0; i < ITERATIONS; i++) {
+			std::vector<gpuAllocSpan> spans;
+			alloc.init_clear(TRACE_BUFFER_SIZE);
+			auto start = clock::now();
+			failed = replay(alloc, ops, spans);
+			total += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		}
+		return total / ITERATIONS;
+	};
+	LinearSpanAllocator linear;
+	gpuSpanAllocator tlsf;
+	int linear_failed = 0;
+	int tlsf_failed = 0;
+	const double linear_ms = time_ms(linear, linear_failed);
+	const double tlsf_ms = time_ms(tlsf, tlsf_failed);
+	const gpuAllocStats stats = tlsf.get_stats(); // state after the last replay
+	printf("[GpuSpanAllocatorBench] %d ops: first fit %.3f ms (%d failed), tlsf %.3f ms (%d failed)\n",
+		   (int)ops.size(), linear_ms, linear_failed, tlsf_ms, tlsf_failed);
+	printf("[GpuSpanAllocatorBench] tlsf end state: %d spans, %d free blocks, fragmentation %.3f, used end %d\n",
+		   stats.num_used_blocks, stats.num_free_blocks, stats.get_fragmentation(), stats.used_end);
+}
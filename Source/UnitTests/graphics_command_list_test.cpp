@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "Render/GraphicsCommandList.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+// keeps the last upload so replayed data can be checked
+class FakeBuffer : public IGraphicsBuffer
+{
+public:
+	void upload(const void* data, int size) override {
+		bytes.assign((const uint8_t*)data, (const uint8_t*)data + size);
+		num_uploads++;
+	}
+	void sub_upload(const void* data, int size, int offset) override {
+		if ((int)bytes.size() < offset + size)
+			bytes.resize(offset + size);
+		memcpy(bytes.data() + offset, data, size);
+		num_uploads++;
+	}
+	void release() override {}
+	uint32_t get_internal_handle() override { return 0; }
+
+	std::vector<uint8_t> bytes;
+	int num_uploads = 0;
+};
+
+// a list as the replay target, with uploads applied like a real device would
+class UploadingList : public GraphicsCommandList
+{
+public:
+	void upload_buffer(IGraphicsBuffer* buf, const void* data, int size) override {
+		IGraphicsDevice::upload_buffer(buf, data, size);
+	}
+	void sub_upload_buffer(IGraphicsBuffer* buf, const void* data, int size, int offset) override {
+		IGraphicsDevice::sub_upload_buffer(buf, data, size, offset);
+	}
+};
+
+void record_pass(GraphicsCommandList& list, FakeBuffer& ubo) {
+	RenderPipelineState state;
+	list.set_pipeline(state);
+	list.set_viewport(0, 0, 64, 64);
+	list.bind_uniform_buffer_base(0, &ubo);
+	int consts[4] = {1, 2, 3, 4};
+	list.push_vertex_constants(0, consts, sizeof(consts));
+	list.draw_elements(GraphicsPrimitiveType::Triangles, 36, VertexInputIndexType::uint32, 0);
+	list.draw_arrays(GraphicsPrimitiveType::Triangles, 0, 3);
+	list.begin_compute_pass();
+	list.dispatch_compute(4, 1, 1);
+}
+} // namespace
+
+TEST(GraphicsCommandListTest, ReplayMatchesRecording) {
+	FakeBuffer ubo;
+	GraphicsCommandList list;
+	EXPECT_TRUE(list.is_empty());
+	record_pass(list, ubo);
+	EXPECT_EQ(list.get_num_draws(), 2);
+	EXPECT_EQ(list.get_num_dispatches(), 1);
+	EXPECT_GE(list.get_payload_bytes(), (int)sizeof(int) * 4);
+
+	GraphicsCommandList target;
+	list.replay(target);
+	EXPECT_EQ(target.get_num_commands(), list.get_num_commands());
+	EXPECT_EQ(target.get_num_draws(), list.get_num_draws());
+	EXPECT_EQ(target.get_num_dispatches(), list.get_num_dispatches());
+	EXPECT_EQ(target.get_payload_bytes(), list.get_payload_bytes());
+
+	// replaying doesn't consume the list
+	GraphicsCommandList second;
+	list.replay(second);
+	EXPECT_EQ(second.get_num_commands(), list.get_num_commands());
+}
+
+TEST(GraphicsCommandListTest, UploadsAreCopiedAndOrdered) {
+	FakeBuffer ubo;
+	GraphicsCommandList list;
+	int value = 10;
+	list.upload_buffer(&ubo, &value, sizeof(value));
+	list.draw_arrays(GraphicsPrimitiveType::Triangles, 0, 3);
+	value = 20; // the caller reuses its memory right away
+	list.upload_buffer(&ubo, &value, sizeof(value));
+	int tail = 7;
+	list.sub_upload_buffer(&ubo, &tail, sizeof(tail), 4);
+	value = 30;
+	EXPECT_EQ(ubo.num_uploads, 0) << "nothing reaches the buffer until replay";
+
+	UploadingList target;
+	list.replay(target);
+	EXPECT_EQ(ubo.num_uploads, 3);
+	ASSERT_EQ(ubo.bytes.size(), 8u);
+	int replayed[2];
+	memcpy(replayed, ubo.bytes.data(), sizeof(replayed));
+	EXPECT_EQ(replayed[0], 20);
+	EXPECT_EQ(replayed[1], 7);
+}
+
+TEST(GraphicsCommandListTest, ClearKeepsNothing) {
+	FakeBuffer ubo;
+	GraphicsCommandList list;
+	record_pass(list, ubo);
+	list.clear();
+	EXPECT_TRUE(list.is_empty());
+	EXPECT_EQ(list.get_num_draws(), 0);
+	EXPECT_EQ(list.get_num_dispatches(), 0);
+	EXPECT_EQ(list.get_payload_bytes(), 0);
+	EXPECT_EQ(list.get_active_shader(), nullptr);
+}
+
+TEST(GraphicsCommandListTest, RecordingRedirectsGfx) {
+	GraphicsCommandList list;
+	EXPECT_FALSE(gfx_is_recording());
+	gfx_begin_recording(&list);
+	EXPECT_TRUE(gfx_is_recording());
+	EXPECT_EQ(&gfx(), &list);
+	gfx().draw_arrays(GraphicsPrimitiveType::Triangles, 0, 6);
+	gfx_end_recording();
+	EXPECT_FALSE(gfx_is_recording());
+	EXPECT_EQ(list.get_num_draws(), 1);
+}
@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include "Framework/Jobs.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+// Each test owns its own JobSystem; restore whatever the process had before.
+struct ScopedJobSystem
+{
+	ScopedJobSystem(int workers) : prev(JobSystem::inst), sys(workers) {}
+	~ScopedJobSystem() { JobSystem::inst = prev; }
+	JobSystem* prev = nullptr;
+	JobSystem sys;
+};
+
+static void increment_job(uintptr_t arg) {
+	reinterpret_cast<std::atomic<int>*>(arg)->fetch_add(1, std::memory_order_relaxed);
+}
+
+TEST(JobSystemTest, AllJobsRun) {
+	ScopedJobSystem js(3);
+	std::atomic<int> count{0};
+	JobCounter* c = nullptr;
+	for (int i = 0; i < 1000; i++)
+		js.sys.add_job(increment_job, uintptr_t(&count), c);
+	js.sys.wait_and_free_counter(c);
+	EXPECT_EQ(c, nullptr);
+	EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(JobSystemTest, AddJobsBatchMoreThanDequeCapacity) {
+	ScopedJobSystem js(2);
+	std::atomic<int> count{0};
+	std::vector<JobDecl> decls(10000);
+	for (auto& d : decls) {
+		d.func = increment_job;
+		d.funcarg = uintptr_t(&count);
+	}
+	JobCounter* c = nullptr;
+	js.sys.add_jobs(decls.data(), (int)decls.size(), c);
+	js.sys.wait_and_free_counter(c);
+	EXPECT_EQ(count.load(), 10000);
+}
+
+TEST(JobSystemTest, WaitHelpsWithZeroProgressFromWorkers) {
+	// one worker that is stuck: waiting must still finish by running the jobs itself
+	ScopedJobSystem js(1);
+	std::atomic<bool> release{false};
+	JobCounter* blocker = nullptr;
+	js.sys.add_job(
+		[](uintptr_t arg) {
+			auto* r = reinterpret_cast<std::atomic<bool>*>(arg);
+			while (!r->load())
+				std::this_thread::yield();
+		},
+		uintptr_t(&release), blocker);
+	// let the worker pick up the blocking job
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	std::atomic<int> count{0};
+	JobCounter* c = nullptr;
+	for (int i = 0; i < 100; i++)
+		js.sys.add_job(increment_job, uintptr_t(&count), c);
+	js.sys.wait_and_free_counter(c);
+	EXPECT_EQ(count.load(), 100);
+
+	release = true;
+	js.sys.wait_and_free_counter(blocker);
+}
+
+struct NestedJobArgs
+{
+	JobSystem* sys = nullptr;
+	std::atomic<int>* count = nullptr;
+};
+TEST(JobSystemTest, NestedWaitInsideJob) {
+	ScopedJobSystem js(3);
+	std::atomic<int> count{0};
+	NestedJobArgs args{&js.sys, &count};
+	JobCounter* c = nullptr;
+	for (int i = 0; i < 16; i++) {
+		js.sys.add_job(
+			[](uintptr_t arg) {
+				auto* a = reinterpret_cast<NestedJobArgs*>(arg);
+				JobCounter* inner = nullptr;
+				for (int j = 0; j < 32; j++)
+					a->sys->add_job(increment_job, uintptr_t(a->count), inner);
+				a->sys->wait_and_free_counter(inner);
+			},
+			uintptr_t(&args), c);
+	}
+	js.sys.wait_and_free_counter(c);
+	EXPECT_EQ(count.load(), 16 * 32);
+}
+
+TEST(JobSystemTest, CountersAreReused) {
+	ScopedJobSystem js(2);
+	std::atomic<int> count{0};
+	JobCounter* c = nullptr;
+	js.sys.add_job(increment_job, uintptr_t(&count), c);
+	JobCounter* first = c;
+	js.sys.wait_and_free_counter(c);
+	js.sys.add_job(increment_job, uintptr_t(&count), c);
+	EXPECT_EQ(c, first);
+	js.sys.wait_and_free_counter(c);
+	EXPECT_EQ(count.load(), 2);
+}
+
+TEST(JobSystemTest, ParallelForVisitsEveryIndexOnce) {
+	ScopedJobSystem js(3);
+	std::vector<std::atomic<int>> hits(1003);
+	js.sys.parallel_for(0, (int)hits.size(), 16, [&](int i) { hits[i].fetch_add(1); });
+	for (auto& h : hits)
+		EXPECT_EQ(h.load(), 1);
+}
+
+TEST(JobSystemTest, ParallelForChunksRespectGrain) {
+	ScopedJobSystem js(2);
+	std::atomic<int> chunks{0};
+	std::atomic<int> total{0};
+	js.sys.parallel_for_chunks(10, 110, 25, [&](int b, int e) {
+		EXPECT_EQ((b - 10) % 25, 0);
+		EXPECT_LE(e - b, 25);
+		chunks.fetch_add(1);
+		total.fetch_add(e - b);
+	});
+	EXPECT_EQ(chunks.load(), 4);
+	EXPECT_EQ(total.load(), 100);
+
+	// empty range is a no-op
+	js.sys.parallel_for(5, 5, 1, [&](int) { chunks.fetch_add(1); });
+	EXPECT_EQ(chunks.load(), 4);
+}
+
+TEST(JobGraphTest, DependenciesRunInOrder) {
+	ScopedJobSystem js(3);
+	std::atomic<int> step{0};
+	int a_at = -1, b_at = -1, c_at = -1, d_at = -1;
+	JobGraph g;
+	auto a = g.add_node("a", [&]() { a_at = step++; });
+	auto b = g.add_node("b", [&]() { b_at = step++; });
+	auto c = g.add_node("c", [&]() { c_at = step++; });
+	auto d = g.add_node("d", [&]() { d_at = step++; }, JobGraph::MainThread);
+	g.run_after(b, a);
+	g.run_after(c, a);
+	g.run_after(d, b);
+	g.run_after(d, c);
+	g.run();
+	EXPECT_EQ(step.load(), 4);
+	EXPECT_EQ(a_at, 0);
+	EXPECT_LT(a_at, b_at);
+	EXPECT_LT(a_at, c_at);
+	EXPECT_EQ(d_at, 3);
+}
+
+TEST(JobGraphTest, MainThreadNodesRunOnCaller) {
+	ScopedJobSystem js(3);
+	const auto caller = std::this_thread::get_id();
+	std::atomic<int> wrong_thread{0};
+	std::atomic<int> ran{0};
+	JobGraph g;
+	JobGraph::NodeId prev = -1;
+	for (int i = 0; i < 32; i++) {
+		// alternate worker/main nodes in a chain so main nodes become ready from workers
+		const bool main_only = (i % 2) == 1;
+		auto n = g.add_node(
+			"node",
+			[&, main_only]() {
+				ran++;
+				if (main_only && std::this_thread::get_id() != caller)
+					wrong_thread++;
+			},
+			main_only ? JobGraph::MainThread : JobGraph::AnyThread);
+		if (prev != -1)
+			g.run_after(n, prev);
+		prev = n;
+	}
+	g.run();
+	EXPECT_EQ(ran.load(), 32);
+	EXPECT_EQ(wrong_thread.load(), 0);
+}
+
+// ---- contention benchmark ------------------------------------------------
+//
+// LegacyJobQueue is the scheduler JobSystem used before work stealing: one
+// mutex-protected RingBuffer shared by every worker, and waiting parks on a
+// condition variable. Kept here only as the baseline for the comparison.
+class LegacyJobQueue
+{
+public:
+	LegacyJobQueue(int num_workers) {
+		for (int i = 0; i < num_workers; i++)
+			threads.push_back(std::thread([this]() { worker_loop(); }));
+	}
+	~LegacyJobQueue() {
+		{
+			std::lock_guard<std::mutex> lock(job_mutex);
+			stopping = true;
+		}
+		cv.notify_all();
+		for (auto& t : threads)
+			t.join();
+	}
+	void add_jobs(JobDecl* j, int count, std::atomic<int>& counter) {
+		counter.fetch_add(count);
+		{
+			std::lock_guard<std::mutex> lock(job_mutex);
+			for (int i = 0; i < count; i++)
+				job_queue.push_back({j[i], &counter});
+		}
+		cv.notify_all();
+	}
+	void wait(std::atomic<int>& counter) {
+		std::unique_lock<std::mutex> lock(mt_mutex);
+		mt_cv.wait(lock, [&]() { return counter.load() <= 0; });
+	}
+
+private:
+	struct Item
+	{
+		JobDecl decl;
+		std::atomic<int>* counter = nullptr;
+	};
+	void worker_loop() {
+		for (;;) {
+			Item item;
+			{
+				std::unique_lock<std::mutex> lock(job_mutex);
+				cv.wait(lock, [&]() { return !job_queue.empty() || stopping; });
+				if (stopping)
+					return;
+				item = job_queue[0];
+				job_queue.pop_front();
+			}
+			item.decl.func(item.decl.funcarg);
+			if (item.counter->fetch_sub(1) == 1) {
+				std::unique_lock<std::mutex> lock(mt_mutex);
+				mt_cv.notify_all();
+			}
+		}
+	}
+	std::vector<std::thread> threads;
+	RingBuffer<Item> job_queue;
+	std::mutex job_mutex;
+	std::condition_variable cv;
+	std::mutex mt_mutex;
+	std::condition_variable mt_cv;
+	bool stopping = false;
+};
+
+// Small jobs (a few hundred ns) so the queue, not the work, dominates.
+static void tiny_work_job(uintptr_t arg) {
+	volatile float acc = 0.f;
+	for (int i = 0; i < 64; i++)
+		acc = acc + float(i) * 0.5f;
+	reinterpret_cast<std::atomic<int>*>(arg)->fetch_add(1, std::memory_order_relaxed);
+}
+
+TEST(JobSystemBench, ContentionOldVsNew) {
+	const int NUM_WORKERS = std::max(2, (int)std::thread::hardware_concurrency() - 1);
+	const int JOBS_PER_BATCH = 256;
+	const int BATCHES = 200;
+	using clock = std::chrono::high_resolution_clock;
+
+	std::atomic<int> done{0};
+	std::vector<JobDecl> decls(JOBS_PER_BATCH);
+	for (auto& d : decls) {
+		d.func = tiny_work_job;
+		d.funcarg = uintptr_t(&done);
+	}
+
+	double legacy_ms = 0.0;
+	{
+		LegacyJobQueue legacy(NUM_WORKERS);
+		auto start = clock::now();
+		for (int b = 0; b < BATCHES; b++) {
+			std::atomic<int> counter{0};
+			legacy.add_jobs(decls.data(), JOBS_PER_BATCH, counter);
+			legacy.wait(counter);
+		}
+		legacy_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	}
+	EXPECT_EQ(done.load(), JOBS_PER_BATCH * BATCHES);
+
+	done = 0;
+	double stealing_ms = 0.0;
+	{
+		ScopedJobSystem js(NUM_WORKERS);
+		auto start = clock::now();
+		for (int b = 0; b < BATCHES; b++) {
+			JobCounter* c = nullptr;
+			js.sys.add_jobs(decls.data(), JOBS_PER_BATCH, c);
+			js.sys.wait_and_free_counter(c);
+		}
+		stealing_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	}
+	EXPECT_EQ(done.load(), JOBS_PER_BATCH * BATCHES);
+
+	printf("[JobSystemBench] %d workers, %d x %d jobs: mutex queue %.2f ms, work stealing %.2f ms (%.2fx)\n",
+		   NUM_WORKERS, BATCHES, JOBS_PER_BATCH, legacy_ms, stealing_ms, legacy_ms / std::max(stealing_ms, 0.001));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "Render/Meshlet.h"
+#include <vector>
+
+// Chunks are culled by their world space sphere against the view planes, and by their normal cone against the eye.
+
+namespace {
+// the box from -1 to 1 on x and y, unbounded on z
+const glm::vec4 UNIT_PLANES[4] = {glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec4(-1.f, 0.f, 0.f, 1.f),
+								  glm::vec4(0.f, 1.f, 0.f, 1.f), glm::vec4(0.f, -1.f, 0.f, 1.f)};
+
+Chunk make_chunk(glm::vec3 center, float radius, glm::vec3 axis, float cutoff) {
+	const int8_t axis_s8[3] = {int8_t(axis.x * 127.f), int8_t(axis.y * 127.f), int8_t(axis.z * 127.f)};
+	Chunk c{};
+	c.bounding_sphere = glm::vec4(center, radius);
+	c.cone = pack_chunk_cone(axis_s8, int8_t(cutoff * 127.f));
+	return c;
+}
+
+std::vector<uint32_t> cull(const std::vector<Chunk>& chunks, const glm::mat4& transform, const glm::vec3* eye) {
+	std::vector<uint32_t> out(chunks.size());
+	out.resize(cull_chunks(chunks.data(), (int)chunks.size(), transform, UNIT_PLANES, 4, eye, out.data()));
+	return out;
+}
+} // namespace
+
+TEST(MeshletCullTest, ConeRoundTrips) {
+	const int8_t axis[3] = {-127, 0, 64};
+	const uint32_t cone = pack_chunk_cone(axis, -12);
+	EXPECT_FLOAT_EQ(get_chunk_cone_axis(cone).x, -1.f);
+	EXPECT_FLOAT_EQ(get_chunk_cone_axis(cone).y, 0.f);
+	EXPECT_FLOAT_EQ(get_chunk_cone_axis(cone).z, 64.f / 127.f);
+	EXPECT_FLOAT_EQ(get_chunk_cone_cutoff(cone), -12.f / 127.f);
+}
+
+TEST(MeshletCullTest, SpheresAgainstPlanesUseTheTransform) {
+	const std::vector<Chunk> chunks = {make_chunk(glm::vec3(0.f), 0.5f, glm::vec3(0.f, 0.f, 1.f), 1.f),
+									   make_chunk(glm::vec3(3.f, 0.f, 0.f), 0.5f, glm::vec3(0.f, 0.f, 1.f), 1.f),
+									   make_chunk(glm::vec3(1.2f, 0.f, 0.f), 0.5f, glm::vec3(0.f, 0.f, 1.f), 1.f),
+									   make_chunk(glm::vec3(0.4f, 0.f, 0.f), 0.2f, glm::vec3(0.f, 0.f, 1.f), 1.f)};
+	EXPECT_EQ(cull(chunks, glm::mat4(1.f), nullptr), (std::vector<uint32_t>{0, 2, 3}));
+
+	// moved 3 units left, only the second chunk lands in the box
+	glm::mat4 moved(1.f);
+	moved[3] = glm::vec4(-3.f, 0.f, 0.f, 1.f);
+	EXPECT_EQ(cull(chunks, moved, nullptr), (std::vector<uint32_t>{1}));
+
+	// scaled by 4 the radius grows too, the last chunk at x=1.6 r=0.8 still touches x=1
+	const glm::mat4 scaled(4.f, 0.f, 0.f, 0.f, 0.f, 4.f, 0.f, 0.f, 0.f, 0.f, 4.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+	EXPECT_EQ(cull(chunks, scaled, nullptr), (std::vector<uint32_t>{0, 3}));
+}
+
+TEST(MeshletCullTest, BackfacingConesAreCulled) {
+	// every triangle faces away when the eye is within ~25 degrees of -z from the chunk
+	const std::vector<Chunk> chunks = {make_chunk(glm::vec3(0.f), 0.1f, glm::vec3(0.f, 0.f, 1.f), 0.9f),
+									   make_chunk(glm::vec3(0.f), 0.1f, glm::vec3(0.f, 0.f, 1.f), 1.f)};
+	const glm::vec3 in_front(0.f, 0.f, 10.f);
+	const glm::vec3 behind(0.f, 0.f, -10.f);
+	EXPECT_EQ(cull(chunks, glm::mat4(1.f), &in_front), (std::vector<uint32_t>{0, 1}));
+	// a cutoff of 1 is a degenerate cone that never culls
+	EXPECT_EQ(cull(chunks, glm::mat4(1.f), &behind), (std::vector<uint32_t>{1}));
+	EXPECT_EQ(cull(chunks, glm::mat4(1.f), nullptr), (std::vector<uint32_t>{0, 1}));
+
+	// flipping the model around y turns the chunk towards the eye behind it
+	const glm::mat4 flipped(-1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+	EXPECT_EQ(cull(chunks, flipped, &behind), (std::vector<uint32_t>{0, 1}));
+	EXPECT_EQ(cull(chunks, flipped, &in_front), (std::vector<uint32_t>{1}));
+}
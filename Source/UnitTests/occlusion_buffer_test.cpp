@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "Render/OcclusionBuffer.h"
+#include "Framework/Jobs.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+// Software occlusion buffer: a quad in front of the camera hides boxes behind it and nothing else.
+
+namespace {
+// camera at the origin looking down -z, view is identity
+glm::mat4 make_view_proj() {
+	return glm::perspective(glm::radians(90.f), 1.f, 0.1f, 1000.f);
+}
+
+// 4x4 quad facing the camera at z = -10, counter clockwise from the front
+const glm::vec3 QUAD_POSITIONS[4] = {glm::vec3(-2.f, -2.f, -10.f), glm::vec3(2.f, -2.f, -10.f),
+									 glm::vec3(2.f, 2.f, -10.f), glm::vec3(-2.f, 2.f, -10.f)};
+const uint16_t QUAD_FRONT[6] = {0, 1, 2, 0, 2, 3};
+const uint16_t QUAD_BACK[6] = {0, 2, 1, 0, 3, 2};
+
+Bounds box_at(glm::vec3 center, float half) {
+	return Bounds(center - glm::vec3(half), center + glm::vec3(half));
+}
+
+struct NoJobSystem
+{
+	NoJobSystem() : prev(JobSystem::inst) { JobSystem::inst = nullptr; }
+	~NoJobSystem() { JobSystem::inst = prev; }
+	JobSystem* prev = nullptr;
+};
+} // namespace
+
+TEST(OcclusionBufferTest, QuadHidesBoxesBehindIt) {
+	NoJobSystem serial;
+	OcclusionBuffer buffer;
+	buffer.init(320, 180);
+	EXPECT_EQ(buffer.get_width() % OcclusionBuffer::TILE_WIDTH, 0);
+	EXPECT_EQ(buffer.get_height() % OcclusionBuffer::TILE_HEIGHT, 0);
+	buffer.begin(make_view_proj(), 0.1f);
+	buffer.add_triangles(QUAD_POSITIONS, QUAD_FRONT, 6, glm::mat4(1.f));
+	buffer.rasterize(false);
+	EXPECT_EQ(buffer.get_num_triangles(), 2);
+
+	EXPECT_FALSE(buffer.is_visible(box_at(glm::vec3(0.f, 0.f, -50.f), 1.f)));
+	EXPECT_TRUE(buffer.is_visible(box_at(glm::vec3(0.f, 0.f, -5.f), 1.f)));		// in front of the quad
+	EXPECT_TRUE(buffer.is_visible(box_at(glm::vec3(30.f, 0.f, -50.f), 1.f)));	// off to the side
+	EXPECT_TRUE(buffer.is_visible(box_at(glm::vec3(9.f, 0.f, -50.f), 2.f)));	// partly behind the edge
+	EXPECT_TRUE(buffer.is_visible(Bounds(glm::vec3(-1.f), glm::vec3(1.f)))); // crosses the near plane
+}
+
+TEST(OcclusionBufferTest, BackfacesAndTransformedOccluders) {
+	NoJobSystem serial;
+	OcclusionBuffer buffer;
+	buffer.init(256, 128);
+	buffer.begin(make_view_proj(), 0.1f);
+	buffer.add_triangles(QUAD_POSITIONS, QUAD_BACK, 6, glm::mat4(1.f));
+	buffer.rasterize(false);
+	EXPECT_EQ(buffer.get_num_triangles(), 0);
+	EXPECT_TRUE(buffer.is_visible(box_at(glm::vec3(0.f, 0.f, -50.f), 1.f)));
+
+	// moved right, so it now hides that side instead
+	buffer.begin(make_view_proj(), 0.1f);
+	buffer.add_triangles(QUAD_POSITIONS, QUAD_FRONT, 6, glm::translate(glm::mat4(1.f), glm::vec3(4.f, 0.f, 0.f)));
+	buffer.rasterize(false);
+	EXPECT_TRUE(buffer.is_visible(box_at(glm::vec3(0.f, 0.f, -50.f), 1.f)));
+	EXPECT_FALSE(buffer.is_visible(box_at(glm::vec3(20.f, 0.f, -50.f), 1.f)));
+
+	// sloped floor starting behind the camera, the part past the near plane still draws
+	const glm::vec3 floor[4] = {glm::vec3(-50.f, -2.f, 1.f), glm::vec3(50.f, -2.f, 1.f), glm::vec3(50.f, 2.f, -20.f),
+								glm::vec3(-50.f, 2.f, -20.f)};
+	buffer.begin(make_view_proj(), 0.1f);
+	buffer.add_triangles(floor, QUAD_FRONT, 6, glm::mat4(1.f));
+	buffer.rasterize(false);
+	EXPECT_GT(buffer.get_num_triangles(), 0);
+	EXPECT_FALSE(buffer.is_visible(box_at(glm::vec3(0.f, 0.f, -50.f), 1.f)));
+}
+
+TEST(OcclusionBufferTest, ParallelMatchesSerial) {
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> pos(-30.f, 30.f);
+	std::uniform_real_distribution<float> depth(-80.f, -2.f);
+	std::vector<glm::vec3> positions;
+	std::vector<uint16_t> indices;
+	for (int i = 0; i < 2000; i++) {
+		const glm::vec3 c(pos(rng), pos(rng), depth(rng));
+		positions.push_back(c);
+		positions.push_back(c + glm::vec3(pos(rng) * 0.2f, pos(rng) * 0.2f, 0.f));
+		positions.push_back(c + glm::vec3(pos(rng) * 0.2f, pos(rng) * 0.2f, 0.f));
+		indices.push_back(uint16_t(i * 3));
+		indices.push_back(uint16_t(i * 3 + 1));
+		indices.push_back(uint16_t(i * 3 + 2));
+	}
+	auto draw = [&](OcclusionBuffer& buffer, bool parallel) {
+		buffer.init(400, 300);
+		buffer.begin(make_view_proj(), 0.1f);
+		buffer.add_triangles(positions.data(), indices.data(), (int)indices.size(), glm::mat4(1.f));
+		buffer.rasterize(parallel);
+	};
+	OcclusionBuffer serial_buffer, parallel_buffer;
+	{
+		NoJobSystem serial;
+		draw(serial_buffer, false);
+	}
+	JobSystem* prev = JobSystem::inst;
+	{
+		JobSystem js(4);
+		draw(parallel_buffer, true);
+	}
+	JobSystem::inst = prev;
+	const int count = serial_buffer.get_width() * serial_buffer.get_height();
+	EXPECT_TRUE(std::equal(serial_buffer.get_depth(), serial_buffer.get_depth() + count, parallel_buffer.get_depth()));
+	EXPECT_GT(serial_buffer.get_num_triangles(), 0);
+}
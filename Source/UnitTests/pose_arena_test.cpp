@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "Animation/PoseArena.h"
+
+// PoseArena hands out skeleton sized poses as a stack, the way agGetPoseCtx copies nest down the graph.
+
+TEST(PoseArenaTest, PosesAreSizedToBoneCount) {
+	PoseArena arena("pose_arena_test", 64 * 1024);
+	{
+		ScopedPose a(arena, 30);
+		EXPECT_EQ(a->get_num_bones(), 30);
+		EXPECT_EQ(arena.get_bytes_in_use(), 30 * Pose::BYTES_PER_BONE);
+		// arrays are packed back to back in the one allocation
+		EXPECT_EQ((uint8_t*)a->pos, (uint8_t*)a->q + sizeof(glm::quat) * 30);
+		EXPECT_EQ((uint8_t*)a->scale, (uint8_t*)a->pos + sizeof(glm::vec3) * 30);
+		EXPECT_EQ((uintptr_t)a->q % 16, 0u);
+	}
+	EXPECT_EQ(arena.get_bytes_in_use(), 0);
+}
+
+TEST(PoseArenaTest, NestedScopesFreeInOrder) {
+	PoseArena arena("pose_arena_test", 64 * 1024);
+	ScopedPose outer(arena, 61);
+	for (int i = 0; i < 61; i++)
+		outer->scale[i] = float(i);
+	const int64_t outer_bytes = arena.get_bytes_in_use();
+	{
+		ScopedPose child(outer.get_parent(), outer->get_num_bones());
+		child->copy_from(*outer);
+		{
+			ScopedPose grandchild(child.get_parent(), child->get_num_bones());
+			for (int i = 0; i < 61; i++)
+				grandchild->scale[i] = -1.f;
+		}
+		EXPECT_GT(arena.get_bytes_in_use(), outer_bytes);
+		for (int i = 0; i < 61; i++)
+			EXPECT_EQ(child->scale[i], float(i));
+	}
+	EXPECT_EQ(arena.get_bytes_in_use(), outer_bytes);
+	EXPECT_EQ(arena.get_num_allocations(), 3);
+	EXPECT_GE(arena.get_high_water_bytes(), 3 * 61 * Pose::BYTES_PER_BONE);
+
+	arena.report_stats();
+	EXPECT_EQ(arena.get_num_allocations(), 0);
+	EXPECT_EQ(arena.get_high_water_bytes(), outer_bytes);
+}
+
+TEST(PoseArenaTest, PoseBufferCopiesBoneData) {
+	PoseBuffer a(20);
+	for (int i = 0; i < 20; i++) {
+		a.pos[i] = glm::vec3(float(i));
+		a.q[i] = glm::quat(1.f, 0.f, 0.f, 0.f);
+		a.scale[i] = 2.f;
+	}
+	PoseBuffer b = a;
+	EXPECT_NE(b.q, a.q);
+	EXPECT_EQ(b.get_num_bones(), 20);
+	a.pos[5] = glm::vec3(-1.f);
+	EXPECT_EQ(b.pos[5].x, 5.f);
+	EXPECT_EQ(b.scale[19], 2.f);
+
+	InlinePose full;
+	EXPECT_EQ(full.get_num_bones(), Pose::MAX_BONES);
+}
+
+TEST(PoseArenaTest, PoseArrayAndBorrowedPoses) {
+	PoseArena arena("pose_arena_test", 64 * 1024);
+	ScopedPose outer(arena, 45);
+	const int64_t outer_bytes = arena.get_bytes_in_use();
+	{
+		ScopedPoseArray registers(arena, 45, 3);
+		ASSERT_EQ(registers.size(), 3);
+		for (int i = 0; i < 3; i++) {
+			EXPECT_EQ(registers[i].get_num_bones(), 45);
+			EXPECT_EQ((uintptr_t)registers[i].q % 16, 0u);
+			if (i > 0)
+				EXPECT_GE((uint8_t*)registers[i].q, (uint8_t*)registers[i - 1].scale + sizeof(float) * 45);
+		}
+		// a borrowed pose writes through to the array's memory and frees nothing
+		{
+			ScopedPose view(arena, registers[1]);
+			EXPECT_EQ(view->q, registers[1].q);
+			view->scale[7] = 3.f;
+			ScopedPose nested(arena, 45); // still LIFO against the array
+		}
+		EXPECT_EQ(registers[1].scale[7], 3.f);
+	}
+	EXPECT_EQ(arena.get_bytes_in_use(), outer_bytes);
+}
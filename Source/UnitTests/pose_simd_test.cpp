@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "Animation/AnimationTypes.h"
+#include "Animation/PoseSimd.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+// The SIMD pose kernels against their scalar reference versions. Bone counts that aren't a multiple of 8 so the
+// scalar tails get covered in both SSE and AVX builds.
+
+namespace {
+const float EPS = 1e-5f;
+
+glm::quat random_quat(std::mt19937& rng) {
+	std::normal_distribution<float> n(0.f, 1.f);
+	glm::quat q;
+	q.x = n(rng);
+	q.y = n(rng);
+	q.z = n(rng);
+	q.w = n(rng);
+	return glm::normalize(q);
+}
+
+std::unique_ptr<PoseBuffer> random_pose(std::mt19937& rng, int count) {
+	std::uniform_real_distribution<float> u(-1.f, 1.f);
+	auto pose = std::make_unique<PoseBuffer>(count);
+	for (int i = 0; i < count; i++) {
+		pose->q[i] = random_quat(rng);
+		pose->pos[i] = glm::vec3(u(rng), u(rng), u(rng));
+		pose->scale[i] = 1.f + 0.25f * u(rng);
+	}
+	return pose;
+}
+
+// parents always come before children, like MSkeleton
+std::vector<int16_t> random_parents(std::mt19937& rng, int count) {
+	std::vector<int16_t> parents(count);
+	parents[0] = -1;
+	for (int i = 1; i < count; i++)
+		parents[i] = (i % 23 == 0) ? -1 : (int16_t)std::uniform_int_distribution<int>(0, i - 1)(rng);
+	return parents;
+}
+
+void expect_pose_near(const Pose& a, const Pose& b, int count) {
+	for (int i = 0; i < count; i++) {
+		// q and -q are the same rotation
+		EXPECT_NEAR(std::abs(glm::dot(a.q[i], b.q[i])), 1.f, EPS) << "bone " << i;
+		EXPECT_NEAR(a.pos[i].x, b.pos[i].x, EPS) << "bone " << i;
+		EXPECT_NEAR(a.pos[i].y, b.pos[i].y, EPS) << "bone " << i;
+		EXPECT_NEAR(a.pos[i].z, b.pos[i].z, EPS) << "bone " << i;
+		EXPECT_NEAR(a.scale[i], b.scale[i], EPS) << "bone " << i;
+	}
+}
+} // namespace
+
+TEST(PoseSimdTest, BlendMatchesReference) {
+	std::mt19937 rng(1);
+	const int count = 61;
+	auto a = random_pose(rng, count);
+	auto b = random_pose(rng, count);
+	for (float f : {0.f, 0.3f, 0.5f, 1.f}) {
+		PoseBuffer simd = *b;
+		PoseBuffer ref = *b;
+		pose_blend_simd(count, *a, simd, f);
+		pose_blend_reference(count, *a, ref, f);
+		expect_pose_near(simd, ref, count);
+	}
+}
+
+TEST(PoseSimdTest, BlendTakesShortestPath) {
+	// b = -a is the same rotation: any blend must stay on it instead of going through zero
+	std::mt19937 rng(2);
+	const int count = 13;
+	auto a = random_pose(rng, count);
+	auto b = std::make_unique<PoseBuffer>(*a);
+	for (int i = 0; i < count; i++)
+		b->q[i] = -a->q[i];
+	pose_blend_simd(count, *a, *b, 0.5f);
+	for (int i = 0; i < count; i++)
+		EXPECT_NEAR(std::abs(glm::dot(a->q[i], b->q[i])), 1.f, EPS);
+}
+
+TEST(PoseSimdTest, MaskedBlendMatchesReference) {
+	std::mt19937 rng(3);
+	const int count = 45;
+	auto a = random_pose(rng, count);
+	auto b = random_pose(rng, count);
+	std::vector<float> mask(count);
+	for (int i = 0; i < count; i++)
+		mask[i] = (i % 3 == 0) ? 0.f : float(i) / count;
+	PoseBuffer simd = *b;
+	PoseBuffer ref = *b;
+	pose_blend_masked_simd(count, *a, simd, 0.8f, mask.data());
+	pose_blend_masked_reference(count, *a, ref, 0.8f, mask.data());
+	expect_pose_near(simd, ref, count);
+}
+
+TEST(PoseSimdTest, AddAndSubtractMatchReference) {
+	std::mt19937 rng(4);
+	const int count = 37;
+	auto additive = random_pose(rng, count);
+	auto base = random_pose(rng, count);
+
+	PoseBuffer simd = *base;
+	PoseBuffer ref = *base;
+	pose_add_simd(count, *additive, simd, 0.6f);
+	pose_add_reference(count, *additive, ref, 0.6f);
+	expect_pose_near(simd, ref, count);
+
+	simd = *base;
+	ref = *base;
+	pose_subtract_simd(count, *additive, simd);
+	pose_subtract_reference(count, *additive, ref);
+	expect_pose_near(simd, ref, count);
+}
+
+TEST(PoseSimdTest, LocalToMeshMatchesReference) {
+	std::mt19937 rng(5);
+	const int count = 75;
+	auto pose = random_pose(rng, count);
+	const std::vector<int16_t> parents = random_parents(rng, count);
+	std::vector<glm::mat4> simd(count), ref(count);
+	pose_local_to_mesh_simd(*pose, parents.data(), count, simd.data());
+	pose_local_to_mesh_reference(*pose, parents.data(), count, ref.data());
+	for (int i = 0; i < count; i++) {
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++)
+				EXPECT_NEAR(simd[i][c][r], ref[i][c][r], 1e-4f) << "bone " << i;
+		}
+	}
+}
+
+// ---- microbenchmark ------------------------------------------------------
+
+TEST(PoseSimdBench, ScalarVsSimd) {
+	using clock = std::chrono::high_resolution_clock;
+	std::mt19937 rng(6);
+	const int count = 120;
+	const int ITERATIONS = 20000;
+	auto a = random_pose(rng, count);
+	auto b = random_pose(rng, count);
+	const std::vector<int16_t> parents = random_parents(rng, count);
+	std::vector<glm::mat4> mats(count);
+
+	auto time_ms = [&](auto&& fn) {
+		auto start = clock::now();
+		for (int i = 0; i < ITERATIONS; i++)
+			fn();
+		return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	};
+	PoseBuffer work = *b;
+	const double blend_ref = time_ms([&]() { pose_blend_reference(count, *a, work, 0.5f); });
+	const double blend_simd = time_ms([&]() { pose_blend_simd(count, *a, work, 0.5f); });
+	const double add_ref = time_ms([&]() { pose_add_reference(count, *a, work, 0.01f); });
+	const double add_simd = time_ms([&]() { pose_add_simd(count, *a, work, 0.01f); });
+	const double mesh_ref = time_ms([&]() { pose_local_to_mesh_reference(*b, parents.data(), count, mats.data()); });
+	const double mesh_simd = time_ms([&]() { pose_local_to_mesh_simd(*b, parents.data(), count, mats.data()); });
+
+	printf("[PoseSimdBench] %d bones x %d: blend %.2f -> %.2f ms, add %.2f -> %.2f ms, local->mesh %.2f -> %.2f ms\n",
+		   count, ITERATIONS, blend_ref, blend_simd, add_ref, add_simd, mesh_ref, mesh_simd);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "Animation/AnimationTypes.h"
+#include "Animation/SharedPoseCache.h"
+#include <cmath>
+
+namespace {
+void fill_pose(Pose& pose, float value) {
+	for (int i = 0; i < pose.get_num_bones(); i++) {
+		pose.q[i] = glm::quat(1.f, 0.f, 0.f, 0.f);
+		pose.pos[i] = glm::vec3(value, value * 2.f, value * 3.f);
+		pose.scale[i] = 1.f;
+	}
+}
+
+SharedPoseCacheSettings enabled_settings() {
+	SharedPoseCacheSettings s;
+	s.enabled = true;
+	s.time_step = 0.1f;
+	s.num_phases = 8;
+	return s;
+}
+} // namespace
+
+TEST(SharedPoseCacheTest, StoreThenFind) {
+	SharedPoseCache cache;
+	cache.begin_frame(0.016f, enabled_settings());
+	int skeleton = 0, clip_a = 0, clip_b = 0;
+
+	SharedPoseKey key;
+	key.skeleton = &skeleton;
+	key.clip = &clip_a;
+	key.time_step = cache.quantize_time(0.52f);
+	EXPECT_EQ(key.time_step, 5);
+
+	PoseBuffer out(20);
+	EXPECT_FALSE(cache.find(key, out));
+	PoseBuffer sampled(20);
+	fill_pose(sampled, 4.f);
+	cache.store(key, sampled);
+	// a second store of the same key keeps the first pose
+	PoseBuffer other(20);
+	fill_pose(other, 9.f);
+	cache.store(key, other);
+
+	fill_pose(out, 0.f);
+	ASSERT_TRUE(cache.find(key, out));
+	EXPECT_EQ(out.pos[19].z, 12.f);
+
+	SharedPoseKey different = key;
+	different.clip = &clip_b;
+	EXPECT_FALSE(cache.find(different, out));
+	different = key;
+	different.state = 1;
+	EXPECT_FALSE(cache.find(different, out));
+	// wrong bone count never copies
+	PoseBuffer small(10);
+	EXPECT_FALSE(cache.find(key, small));
+
+	EXPECT_EQ(cache.get_num_poses(), 1);
+	EXPECT_EQ(cache.get_num_hits(), 1);
+	EXPECT_EQ(cache.get_num_misses(), 4);
+
+	cache.begin_frame(0.016f, enabled_settings());
+	EXPECT_FALSE(cache.find(key, out));
+	EXPECT_EQ(cache.get_num_poses(), 0);
+}
+
+TEST(SharedPoseCacheTest, PhaseSnapMovesWithClock) {
+	const float duration = 2.f;
+	// clock at 0: phases are k/8
+	EXPECT_NEAR(shared_phase_snap(0.26f, duration, 0.0, 8), 0.25f, 1e-5f);
+	EXPECT_NEAR(shared_phase_snap(0.99f, duration, 0.0, 8), 0.f, 1e-5f);
+	// half a second into a 2 second clip every phase moved by 0.25
+	EXPECT_NEAR(shared_phase_snap(0.30f, duration, 0.5, 8), 0.25f, 1e-5f);
+	EXPECT_NEAR(shared_phase_snap(0.40f, duration, 0.55, 8), 0.4f, 1e-5f);
+	// groups started a frame apart that advance at the clip's rate end up on the same phase
+	const float dt = 1.f / 60.f;
+	const float started_early = shared_phase_snap(0.61f, duration, 10.0, 8) + dt / duration;
+	const float started_late = shared_phase_snap(0.62f, duration, 10.0 + dt, 8);
+	EXPECT_NEAR(started_early, started_late, 1e-4f);
+	// disabled
+	EXPECT_EQ(shared_phase_snap(0.3f, duration, 1.0, 0), 0.3f);
+	EXPECT_EQ(shared_phase_snap(0.3f, 0.f, 1.0, 8), 0.3f);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "Render/StaticShadowCache.h"
+#include <vector>
+
+// Static shadow layers are reused until their matrix/rect changes or a dirty box lands inside their planes.
+
+namespace {
+// the box from -1 to 1 on x and y, unbounded on z
+const glm::vec4 UNIT_PLANES[4] = {glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec4(-1.f, 0.f, 0.f, 1.f),
+								  glm::vec4(0.f, 1.f, 0.f, 1.f), glm::vec4(0.f, -1.f, 0.f, 1.f)};
+const glm::ivec4 RECT(0, 0, 256, 256);
+
+Bounds box_at(glm::vec3 center, float half) {
+	return Bounds(center - glm::vec3(half), center + glm::vec3(half));
+}
+} // namespace
+
+TEST(StaticShadowCacheTest, RedrawsOnlyWhenLayerChanges) {
+	StaticShadowCache cache;
+	const glm::mat4 m(1.f);
+	EXPECT_FALSE(cache.is_valid(0));
+	EXPECT_TRUE(cache.begin_layer(0, m, RECT, UNIT_PLANES, 4));
+	EXPECT_TRUE(cache.is_valid(0));
+	EXPECT_FALSE(cache.begin_layer(0, m, RECT, UNIT_PLANES, 4));
+
+	// a new matrix or a new spot in the atlas is a redraw
+	const glm::mat4 moved = glm::mat4(2.f);
+	EXPECT_TRUE(cache.begin_layer(0, moved, RECT, UNIT_PLANES, 4));
+	EXPECT_FALSE(cache.begin_layer(0, moved, RECT, UNIT_PLANES, 4));
+	EXPECT_TRUE(cache.begin_layer(0, moved, glm::ivec4(256, 0, 256, 256), UNIT_PLANES, 4));
+
+	cache.remove_layer(0);
+	EXPECT_FALSE(cache.is_valid(0));
+	EXPECT_EQ(cache.get_num_layers(), 0);
+}
+
+TEST(StaticShadowCacheTest, DirtyBoxesInvalidateTouchedLayers) {
+	StaticShadowCache cache;
+	// layer 1 is shifted 10 units along x
+	glm::vec4 shifted[4];
+	for (int i = 0; i < 4; i++)
+		shifted[i] = UNIT_PLANES[i];
+	shifted[0].w = -9.f;
+	shifted[1].w = 11.f;
+	cache.begin_layer(0, glm::mat4(1.f), RECT, UNIT_PLANES, 4);
+	cache.begin_layer(1, glm::mat4(1.f), RECT, shifted, 4);
+
+	// far away on z is still inside, the planes only bound x and y
+	const std::vector<Bounds> inside_first = {box_at(glm::vec3(0.5f, 0.f, -100.f), 0.1f)};
+	cache.invalidate(inside_first);
+	EXPECT_FALSE(cache.is_valid(0));
+	EXPECT_TRUE(cache.is_valid(1));
+
+	cache.begin_layer(0, glm::mat4(1.f), RECT, UNIT_PLANES, 4);
+	const std::vector<Bounds> between = {box_at(glm::vec3(5.f, 0.f, 0.f), 1.f)};
+	cache.invalidate(between);
+	EXPECT_TRUE(cache.is_valid(0));
+	EXPECT_TRUE(cache.is_valid(1));
+
+	// overlapping the edge of both
+	const std::vector<Bounds> straddle = {Bounds(glm::vec3(0.9f, -0.5f, 0.f), glm::vec3(9.5f, 0.5f, 1.f))};
+	cache.invalidate(straddle);
+	EXPECT_FALSE(cache.is_valid(0));
+	EXPECT_FALSE(cache.is_valid(1));
+
+	cache.begin_layer(0, glm::mat4(1.f), RECT, UNIT_PLANES, 4);
+	cache.begin_layer(1, glm::mat4(1.f), RECT, shifted, 4);
+	cache.invalidate_all();
+	EXPECT_TRUE(cache.begin_layer(0, glm::mat4(1.f), RECT, UNIT_PLANES, 4));
+	EXPECT_TRUE(cache.begin_layer(1, glm::mat4(1.f), RECT, shifted, 4));
+}
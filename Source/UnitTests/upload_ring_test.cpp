@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "Render/UploadRing.h"
+
+TEST(UploadRingRangeTest, AlignsAndFills) {
+	UploadRingRange r;
+	r.init(1000);
+	EXPECT_EQ(r.alloc(10, 4), 0);
+	EXPECT_EQ(r.alloc(24, 24), 24); // MbVertex stride, not a power of two
+	EXPECT_EQ(r.alloc(16, 16), 48);
+	EXPECT_EQ(r.get_used(), 64);
+	// nothing retired yet, so the rest of the ring is all there is
+	EXPECT_EQ(r.alloc(1000 - 64 + 1, 1), -1);
+	EXPECT_EQ(r.alloc(1000 - 64, 1), 64);
+	EXPECT_EQ(r.alloc(1, 1), -1);
+}
+
+TEST(UploadRingRangeTest, ReusesRetiredFramesOnly) {
+	UploadRingRange r;
+	r.init(300);
+	EXPECT_EQ(r.alloc(100, 1), 0);
+	r.end_frame();
+	EXPECT_EQ(r.alloc(100, 1), 100);
+	r.end_frame();
+	EXPECT_EQ(r.alloc(100, 1), 200);
+	// the open frame and two in flight fill the ring
+	EXPECT_EQ(r.alloc(1, 1), -1);
+	EXPECT_EQ(r.get_num_frames(), 2);
+
+	r.retire_frame();
+	EXPECT_EQ(r.get_num_frames(), 1);
+	EXPECT_EQ(r.alloc(100, 1), 0);
+	EXPECT_EQ(r.alloc(1, 1), -1);
+}
+
+TEST(UploadRingRangeTest, NeverWrapsAnAllocation) {
+	UploadRingRange r;
+	r.init(256);
+	EXPECT_EQ(r.alloc(200, 1), 0);
+	r.end_frame();
+	r.retire_frame();
+	// 56 bytes left before the end: the tail is skipped and the allocation starts at 0
+	EXPECT_EQ(r.alloc(100, 1), 0);
+	EXPECT_EQ(r.get_used(), 56 + 100);
+	r.end_frame();
+	// alignment is in ring offsets, not in the monotonic head
+	EXPECT_EQ(r.alloc(24, 24), 120);
+	EXPECT_EQ(r.alloc(300, 1), -1);
+}
+
+TEST(UploadRingRangeTest, ManyFramesStayInBounds) {
+	UploadRingRange r;
+	r.init(16384);
+	int in_flight = 0;
+	for (int frame = 0; frame < 500; frame++) {
+		for (int i = 0; i < 7; i++) {
+			const int size = 24 * (1 + (frame * 7 + i) % 19);
+			const int ofs = r.alloc(size, 24);
+			ASSERT_GE(ofs, 0);
+			EXPECT_EQ(ofs % 24, 0);
+			EXPECT_LE(ofs + size, 16384);
+		}
+		r.end_frame();
+		if (++in_flight > 2) {
+			r.retire_frame();
+			in_flight--;
+		}
+		EXPECT_LE(r.get_used(), 16384);
+	}
+}